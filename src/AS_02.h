@@ -72,11 +72,29 @@ namespace AS_02
     // to the actual file position
     class AS02IndexReader : public ASDCP::MXF::Partition
     {
+      class h__PartitionSet;
+
+      // The parsed segments point into these buffers, which live as long as the reader.
       Kumu::ByteString m_IndexSegmentData;
+      std::list<Kumu::ByteString> m_RetiredIndexData;
       ui32_t m_Duration;
       ui32_t m_BytesPerEditUnit;
 
+      // The entries of leading VBR segments are moved here as they are parsed,
+      // and Lookup() answers from it for the frames it covers. Compaction stops
+      // at the first segment that does not continue it (CBR, gap or overlap);
+      // that segment and those after it keep their IndexEntryArray. Segments
+      // returned by GetMDObjectsByType() and friends are therefore empty of
+      // entries where the compact index covers them; use Lookup() to read
+      // entries. Dump() shows the entries as they appear in the file.
+      ASDCP::MXF::CompactIndex m_CompactIndex;
+      bool m_CompactIndexOpen;
+
+      void CompactSegment(ASDCP::MXF::IndexTableSegment&);
+      Result_t ReserveIndexData(ui32_t bytes);
+
       Result_t InitFromBuffer(const byte_t* p, ui32_t l, const ui64_t& body_offset, const ui64_t& essence_container_offset);
+      Result_t InitFromPartitionSet(h__PartitionSet&, const ASDCP::MXF::RIP& rip, const bool has_header_essence);
 
       ASDCP_NO_COPY_CONSTRUCT(AS02IndexReader);
       AS02IndexReader();
@@ -88,6 +106,13 @@ namespace AS_02
       virtual ~AS02IndexReader();
     
       Result_t InitFromFile(const Kumu::IFileReader& reader, const ASDCP::MXF::RIP& rip, const bool has_header_essence);
+
+      // As above, but the partitions are read concurrently by up to eight helper
+      // threads, each opening filename with its own reader from factory.
+      Result_t InitFromFile(const Kumu::IFileReader& reader, const Kumu::IFileReaderFactory& factory,
+			    const std::string& filename, const ASDCP::MXF::RIP& rip, const bool has_header_essence);
+      Result_t AppendFromFile(const Kumu::IFileReader& reader, const ui64_t& index_byte_count,
+			      const ui64_t& body_offset, const ui64_t& essence_container_offset);
       ui32_t GetDuration() const;
       void     Dump(FILE* = 0);
       Result_t GetMDObjectByID(const Kumu::UUID&, ASDCP::MXF::InterchangeObject** = 0);
@@ -150,7 +175,17 @@ namespace AS_02
     IS_FILE_SPECIFIC,
     IS_MAX
   };
- 
+
+  // Completes a frame-wrapped AS-02 file that has no footer or RIP because the
+  // writer stopped before Finalize(). Each index partition written during the
+  // session is a checkpoint: the last one is found by scanning backward from the
+  // end of the file and the RIP is rebuilt from the PreviousPartition links.
+  // Complete frames written after the last checkpoint are indexed and a partial
+  // frame at the end is discarded. The header metadata is rewritten with the
+  // recovered duration, which is also returned in the duration argument.
+  // A file that already has a RIP is not modified.
+  Result_t RecoverFile(const std::string& filename, ui32_t& duration);
+
   namespace JP2K
   { 
     //
@@ -184,6 +219,11 @@ namespace AS_02
       // error occurs.
       Result_t WriteFrame(const ASDCP::JP2K::FrameBuffer&, ASDCP::AESEncContext* = 0, ASDCP::HMACContext* = 0);
 
+      // Accumulates the time spent in each stage of writing essence into the
+      // given StageStats, which must outlive the writer; 0 stops the collection.
+      // Returns RESULT_INIT if the file is not open.
+      Result_t SetStageStats(ASDCP::StageStats*);
+
       // Closes the MXF file, writing the index and revised header.
       Result_t Finalize();
     };
@@ -209,6 +249,16 @@ namespace AS_02
       // operation cannot be completed.
       Result_t OpenRead(const std::string& filename) const;
 
+      // Open a file that is still being written and has no footer yet. Only the
+      // frames covered by the index partitions flushed so far can be read.
+      Result_t OpenReadGrowing(const std::string& filename) const;
+
+      // Index the partitions written since the file was opened or last refreshed.
+      // On return frame_count is the number of readable frames, and is_complete is
+      // true once the writer has written the footer (always for OpenRead()).
+      // Returns RESULT_INIT if the file is not open.
+      Result_t Refresh(ui32_t& frame_count, bool& is_complete) const;
+
       // Returns RESULT_INIT if the file is not open.
       Result_t Close() const;
 
@@ -225,6 +275,21 @@ namespace AS_02
       // out of range, or if optional decrypt or HAMC operations fail.
       Result_t ReadFrame(ui32_t frame_number, ASDCP::JP2K::FrameBuffer&, ASDCP::AESDecContext* = 0, ASDCP::HMACContext* = 0) const;
 
+      // Reads the listed frames with coalesced reads and passes each to the
+      // callback in list order. See ASDCP::JP2K::MXFReader::ReadFrames().
+      Result_t ReadFrames(const std::vector<ui32_t>& frame_numbers, ASDCP::JP2K::FrameBuffer&, ASDCP::FrameReadCallback&,
+			  ASDCP::AESDecContext* = 0, ASDCP::HMACContext* = 0) const;
+
+      // Reads part of a frame's codestream. See ASDCP::JP2K::MXFReader::ReadFrameRange().
+      Result_t ReadFramePrefix(ui32_t frame_number, ui32_t length, ASDCP::JP2K::FrameBuffer&,
+			       ASDCP::AESDecContext* = 0) const;
+      Result_t ReadFrameRange(ui32_t frame_number, ui32_t offset, ui32_t length, ASDCP::JP2K::FrameBuffer&,
+			      ASDCP::AESDecContext* = 0) const;
+
+      // Accumulates the time spent in each stage of reading essence into the
+      // given StageStats, which must outlive the reader; 0 stops the collection.
+      void     SetStageStats(ASDCP::StageStats*) const;
+
       // Print debugging information to stream
       void     DumpHeaderMetadata(FILE* = 0) const;
       void     DumpIndex(FILE* = 0) const;
@@ -277,6 +342,11 @@ namespace AS_02
       // error occurs.
       Result_t WriteFrame(const ASDCP::FrameBuffer&, ASDCP::AESEncContext* = 0, ASDCP::HMACContext* = 0);
       
+      // Accumulates the time spent in each stage of writing essence into the
+      // given StageStats, which must outlive the writer; 0 stops the collection.
+      // Returns RESULT_INIT if the file is not open.
+      Result_t SetStageStats(ASDCP::StageStats*);
+
       // Closes the MXF file, writing the index and revised header.
       Result_t Finalize();
     };
@@ -318,6 +388,10 @@ namespace AS_02
       // out of range, or if optional decrypt or HAMC operations fail.
       Result_t ReadFrame(ui32_t frame_number, ASDCP::PCM::FrameBuffer&, ASDCP::AESDecContext* = 0, ASDCP::HMACContext* = 0) const;
       
+      // Accumulates the time spent in each stage of reading essence into the
+      // given StageStats, which must outlive the reader; 0 stops the collection.
+      void     SetStageStats(ASDCP::StageStats*) const;
+
       // Print debugging information to stream
       void     DumpHeaderMetadata(FILE* = 0) const;
       void     DumpIndex(FILE* = 0) const;
@@ -432,6 +506,17 @@ namespace AS_02
 	  // WriteTimedTextResource()
 	  Result_t WriteAncillaryResource(const ASDCP::TimedText::FrameBuffer&, ASDCP::AESEncContext* = 0, ASDCP::HMACContext* = 0);
 
+	  // Writes an Ancillary Resource in pieces, for resources that are not held
+	  // in memory all at once. See ASDCP::TimedText::MXFWriter::BeginAncillaryResource().
+	  Result_t BeginAncillaryResource(ui32_t resource_length, ASDCP::AESEncContext* = 0, ASDCP::HMACContext* = 0);
+	  Result_t AppendAncillaryResource(const byte_t* buf, ui32_t buf_len);
+	  Result_t EndAncillaryResource();
+
+	  // Accumulates the time spent in each stage of writing essence into the
+	  // given StageStats, which must outlive the writer; 0 stops the collection.
+	  // Returns RESULT_INIT if the file is not open.
+	  Result_t SetStageStats(ASDCP::StageStats*);
+
 	  // Closes the MXF file, writing the index and revised header.
 	  Result_t Finalize();
 	};
@@ -491,6 +576,17 @@ namespace AS_02
 	  // out of range, or if optional decrypt or HAMC operations fail.
 	  Result_t ReadAncillaryResource(const Kumu::UUID&, ASDCP::TimedText::FrameBuffer&, ASDCP::AESDecContext* = 0, ASDCP::HMACContext* = 0) const;
 
+	  // Reads the resource having the given UUID in pieces, for resources that are
+	  // not held in memory all at once. See ASDCP::TimedText::MXFReader::BeginReadAncillaryResource().
+	  Result_t BeginReadAncillaryResource(const Kumu::UUID&, ui32_t& resource_length,
+					      ASDCP::AESDecContext* = 0, ASDCP::HMACContext* = 0) const;
+	  Result_t ReadAncillaryResourceData(byte_t* buf, ui32_t buf_len, ui32_t& read_count) const;
+	  Result_t EndReadAncillaryResource() const;
+
+	  // Accumulates the time spent in each stage of reading essence into the
+	  // given StageStats, which must outlive the reader; 0 stops the collection.
+	  void     SetStageStats(ASDCP::StageStats*) const;
+
 	  // Print debugging information to stream
 	  void     DumpHeaderMetadata(FILE* = 0) const;
 	  void     DumpIndex(FILE* = 0) const;
@@ -535,6 +631,11 @@ namespace AS_02
       // operating system error occurs.
       Result_t AddDmsGenericPartUtf8Text(const ASDCP::FrameBuffer& frame_buffer, ASDCP::AESEncContext* enc = 0, ASDCP::HMACContext* hmac = 0);
 
+      // Accumulates the time spent in each stage of writing essence into the
+      // given StageStats, which must outlive the writer; 0 stops the collection.
+      // Returns RESULT_INIT if the file is not open.
+      Result_t SetStageStats(ASDCP::StageStats*);
+
       // Closes the MXF file, writing the index and revised header.
       Result_t Finalize();
     };
@@ -583,6 +684,10 @@ namespace AS_02
       // Encryption is not currently supported.
       Result_t ReadGenericStreamPartitionPayload(ui32_t SID, ASDCP::FrameBuffer& FrameBuf);
   
+      // Accumulates the time spent in each stage of reading essence into the
+      // given StageStats, which must outlive the reader; 0 stops the collection.
+      void     SetStageStats(ASDCP::StageStats*) const;
+
       // Print debugging information to stream
       void     DumpHeaderMetadata(FILE* = 0) const;
       void     DumpIndex(FILE* = 0) const;
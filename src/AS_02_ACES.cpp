@@ -470,6 +470,12 @@ AS_02::Result_t AS_02::ACES::MXFReader::h__Reader::FillAncillaryResourceDescript
   return result;
 }
 
+void
+AS_02::ACES::MXFReader::SetStageStats(ASDCP::StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
+
 void
 AS_02::ACES::MXFReader::DumpHeaderMetadata(FILE* stream) const
 {
@@ -698,7 +704,7 @@ AS_02::Result_t AS_02::ACES::MXFWriter::h__Writer::WriteAncillaryResource(const
 
     result = Write_EKLV_Packet(m_File, *m_Dict, m_HeaderPart, m_Info, m_CtFrameBuf, m_FramesWritten,
 			       m_StreamOffset, FrameBuf, GenericStream_DataElement.Value(),
-			       MXF_BER_LENGTH, Ctx, HMAC);
+			       MXF_BER_LENGTH, Ctx, HMAC, m_Stats);
   }
   return result;
 }
@@ -764,6 +770,15 @@ AS_02::Result_t AS_02::ACES::MXFWriter::WriteFrame(const FrameBuffer &FrameBuf,
   return m_Writer->WriteFrame(FrameBuf, Ctx, HMAC);
 }
 
+AS_02::Result_t AS_02::ACES::MXFWriter::SetStageStats(ASDCP::StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 AS_02::Result_t AS_02::ACES::MXFWriter::Finalize()
 {
 
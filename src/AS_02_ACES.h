@@ -430,6 +430,11 @@ public:
   // WriteFrame()
   Result_t WriteAncillaryResource(const AS_02::ACES::FrameBuffer &rBuf, ASDCP::AESEncContext* = 0, ASDCP::HMACContext* = 0);
 
+  // Accumulates the time spent in each stage of writing essence into the
+  // given StageStats, which must outlive the writer; 0 stops the collection.
+  // Returns RESULT_INIT if the file is not open.
+  Result_t SetStageStats(ASDCP::StageStats*);
+
   // Closes the MXF file, writing the index and revised header.
   Result_t Finalize();
 };
@@ -484,6 +489,10 @@ public:
   // out of range, or if optional decrypt or HAMC operations fail.
   Result_t ReadAncillaryResource(const Kumu::UUID&, AS_02::ACES::FrameBuffer&, ASDCP::AESDecContext* = 0, ASDCP::HMACContext* = 0) const;
 
+  // Accumulates the time spent in each stage of reading essence into the
+  // given StageStats, which must outlive the reader; 0 stops the collection.
+  void     SetStageStats(ASDCP::StageStats*) const;
+
   // Print debugging information to stream
          void     DumpHeaderMetadata(FILE* = 0) const;
          void     DumpIndex(FILE* = 0) const;
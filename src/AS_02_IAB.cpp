@@ -262,6 +262,7 @@ AS_02::IAB::MXFWriter::WriteFrame(const ui8_t* frame, ui32_t sz) {
 
   /* write the frame */
 
+  StageTimer write_timer(this->m_Writer->m_Stats, StageStats::STAGE_FILE_WRITE);
   result = this->m_Writer->m_File.Write(frame, sz);
 
   if (result.Failure()) {
@@ -269,6 +270,8 @@ AS_02::IAB::MXFWriter::WriteFrame(const ui8_t* frame, ui32_t sz) {
     return result;
   }
 
+  write_timer.Stop(sz);
+
   /* increment the frame counter */
 
   this->m_Writer->m_FramesWritten++;
@@ -288,6 +291,17 @@ Result_t AS_02::IAB::MXFWriter::WriteFrame(const ASDCP::FrameBuffer& frame) {
   return WriteFrame(frame.RoData(), frame.Size());
 }
 
+Result_t
+AS_02::IAB::MXFWriter::SetStageStats(ASDCP::StageStats* stats) {
+  if (this->m_Writer.empty() || this->m_Writer->m_State == ST_BEGIN) {
+    return Kumu::RESULT_INIT;
+  }
+
+  this->m_Writer->m_Stats = stats;
+
+  return Kumu::RESULT_OK;
+}
+
 Result_t
 AS_02::IAB::MXFWriter::AddDmsGenericPartUtf8Text(const ASDCP::FrameBuffer& FrameBuf, ASDCP::AESEncContext* Ctx,
                           ASDCP::HMACContext* HMAC, const std::string& trackDescription, const std::string& dataDescription)
@@ -506,127 +520,182 @@ Result_t AS_02::IAB::MXFReader::GetFrameCount(ui32_t& frameCount) const {
 
 /* Anonymous namespace with ReadFrame helpers */
 namespace {
-  bool checkFrameCapacity(ASDCP::FrameBuffer& frame, size_t size, bool reallocate_if_needed) {
 
-    if (frame.Capacity() < size) {
-      if (!reallocate_if_needed) {
-        return false;
-      }
-      Result_t result = frame.Capacity(size);
-      return result == RESULT_OK;
-    }
-    return true;
+  /* Size of the tag and length that precede the preamble and the IA Frame */
+  const ui32_t IATagLengthSize = 5;
+
+  /* Frame extents larger than this are not trusted, the frame is then read in pieces */
+  const ui64_t MaxFrameExtent = 64 * Kumu::Megabyte;
+
+  ui32_t readLength(const byte_t* p) {
+    return ((ui32_t)p[1] << 24) + ((ui32_t)p[2] << 16) + ((ui32_t)p[3] << 8) + (ui32_t)p[4];
   }
 
-  Result_t
-  ReadFrameImpl(ui32_t frame_number, ASDCP::FrameBuffer& frame, ReaderState_t& reader_state, AS_02::h__AS02Reader *reader, bool reallocate_if_needed) {
-    assert(reader);
-    /* are we already running */
+  /* grows the buffer to hold size bytes, keeping its contents */
+  Result_t growFrameBuffer(ASDCP::FrameBuffer& frame, ui32_t size, bool reallocate_if_needed) {
 
-    if (reader_state == ST_READER_BEGIN) {
-      return Kumu::RESULT_INIT;
+    if (frame.Capacity() >= size) {
+      return RESULT_OK;
     }
 
-    Result_t result = RESULT_OK;
+    if (!reallocate_if_needed) {
+      return RESULT_SMALLBUF;
+    }
 
-    // look up frame index node
-    IndexTableSegment::IndexEntry index_entry;
+    return frame.Reserve(size);
+  }
 
-    result = reader->m_IndexAccess.Lookup(frame_number, index_entry);
+  /* reads from the current file position until the buffer holds size bytes */
+  Result_t readFrameBytes(AS_02::h__AS02Reader *reader, ASDCP::FrameBuffer& frame, ui32_t& have, ui32_t size, bool reallocate_if_needed) {
 
-    if (result.Failure()) {
-      DefaultLogSink().Error("Frame value out of range: %u\n", frame_number);
-      return result;
+    if (have >= size) {
+      return RESULT_OK;
     }
 
-    result = reader->m_File->Seek(index_entry.StreamOffset);
+    Result_t result = growFrameBuffer(frame, size, reallocate_if_needed);
 
     if (result.Failure()) {
-      DefaultLogSink().Error("Cannot seek to stream offset: %u\n", index_entry.StreamOffset);
       return result;
     }
 
-    /* read the preamble info */
+    ui32_t read_count = 0;
+    StageTimer read_timer(reader->m_Stats, StageStats::STAGE_FILE_READ);
+    result = reader->m_File->Read(&frame.Data()[have], size - have, &read_count);
+    read_timer.Stop(read_count);
+    have += read_count;
 
-    const int preambleTLLen = 5;
-    const int frameTLLen = 5;
+    if (result.Success() && have < size) {
+      result = RESULT_READFAIL;
+    }
 
-    ui32_t buffer_offset = 0;
+    return result;
+  }
 
-    if (!checkFrameCapacity(frame, preambleTLLen, reallocate_if_needed)) {
-        return RESULT_SMALLBUF;
+  /*
+   * Returns the number of bytes from the frame's offset to the next frame in
+   * the index or, for the last frame, to the next partition or the end of the
+   * file. Returns 0 if the index does not give a usable extent.
+   */
+  ui64_t frameExtent(AS_02::h__AS02Reader *reader, ui32_t frame_number, const IndexTableSegment::IndexEntry& index_entry) {
+
+    ui64_t offset = index_entry.StreamOffset;
+    ui64_t end = 0;
+    IndexTableSegment::IndexEntry next_entry;
+
+    if (frame_number + 1 < reader->m_IndexAccess.GetDuration()
+        && reader->m_IndexAccess.Lookup(frame_number + 1, next_entry).Success()) {
+      end = next_entry.StreamOffset;
+    } else {
+      end = reader->m_File->Size();
+      RIP::const_pair_iterator i;
+
+      for (i = reader->m_RIP.PairArray.begin(); i != reader->m_RIP.PairArray.end(); ++i) {
+        if (i->ByteOffset > offset && i->ByteOffset < end) {
+          end = i->ByteOffset;
+        }
+      }
     }
 
-    result = reader->m_File->Read(&frame.Data()[buffer_offset], preambleTLLen);
-
-    if (result.Failure()) {
-      DefaultLogSink().Error("Error reading IA Frame preamble\n", index_entry.StreamOffset);
-      return result;
+    if (end <= offset || end - offset > MaxFrameExtent) {
+      return 0;
     }
 
-    ui32_t preambleLen = ((ui32_t)frame.Data()[1 + buffer_offset] << 24) +
-      ((ui32_t)frame.Data()[2 + buffer_offset] << 16) +
-      ((ui32_t)frame.Data()[3 + buffer_offset] << 8) +
-      (ui32_t)frame.Data()[4 + buffer_offset];
+    return end - offset;
+  }
+
+  /*
+   * Reads the preamble and IA Frame of one frame. The index gives the extent
+   * of the frame, so the frame is normally fetched with a single read and then
+   * measured in the buffer. If the extent is unknown or too short, the
+   * remaining bytes are read as the lengths in the frame call for them.
+   */
+  Result_t
+  ReadFrameImpl(ui32_t frame_number, ASDCP::FrameBuffer& frame, ReaderState_t& reader_state, AS_02::h__AS02Reader *reader, bool reallocate_if_needed) {
+    assert(reader);
+    /* are we already running */
 
-    buffer_offset += preambleTLLen;
+    if (reader_state == ST_READER_BEGIN) {
+      return Kumu::RESULT_INIT;
+    }
 
-    /* read the preamble*/
+    Result_t result = RESULT_OK;
 
-    if (preambleLen > 0) {
+    // look up frame index node
+    IndexTableSegment::IndexEntry index_entry;
 
-      if (!checkFrameCapacity(frame, preambleTLLen + preambleLen, reallocate_if_needed)) {
-        return RESULT_SMALLBUF;
-      }
+    result = reader->m_IndexAccess.Lookup(frame_number, index_entry);
 
-      result = reader->m_File->Read(&frame.Data()[buffer_offset], preambleLen);
+    if (result.Failure()) {
+      DefaultLogSink().Error("Frame value out of range: %u\n", frame_number);
+      return result;
+    }
+
+    if (reader->m_LastPosition != (Kumu::fpos_t)index_entry.StreamOffset) {
+      result = reader->m_File->Seek(index_entry.StreamOffset);
 
       if (result.Failure()) {
-        DefaultLogSink().Error("Error reading IA Frame preamble\n", index_entry.StreamOffset);
+        DefaultLogSink().Error("Cannot seek to stream offset: %u\n", index_entry.StreamOffset);
+        reader->m_LastPosition = 0;
         return result;
       }
+    }
 
-      buffer_offset += preambleLen;
+    /* the smallest frame is an empty preamble and an empty IA Frame */
 
-    }
+    ui32_t read_size = 2 * IATagLengthSize;
+    ui64_t extent = frameExtent(reader, frame_number, index_entry);
 
-    /* read the IA Frame info */
+    if (extent > read_size) {
+      read_size = (ui32_t)extent;
 
-    if (!checkFrameCapacity(frame,  preambleTLLen + preambleLen + frameTLLen, reallocate_if_needed)) {
-      return RESULT_SMALLBUF;
+      if (!reallocate_if_needed && frame.Capacity() < read_size) {
+        read_size = Kumu::xmax<ui32_t>(frame.Capacity(), 2 * IATagLengthSize);
+      }
     }
 
-    result = reader->m_File->Read(&frame.Data()[buffer_offset], frameTLLen);
+    ui32_t have = 0;
+    result = readFrameBytes(reader, frame, have, read_size, reallocate_if_needed);
 
-    if (result.Failure()) {
-      DefaultLogSink().Error("Error reading IA Frame data\n", index_entry.StreamOffset);
-      return result;
+    /* the extent may run past the end of a short file, keep what was read */
+
+    if (result == RESULT_READFAIL && have >= 2 * IATagLengthSize) {
+      result = RESULT_OK;
     }
 
-    ui32_t frameLen = ((ui32_t)frame.Data()[buffer_offset + 1] << 24) +
-      ((ui32_t)frame.Data()[buffer_offset + 2] << 16) +
-      ((ui32_t)frame.Data()[buffer_offset + 3] << 8) +
-      (ui32_t)frame.Data()[buffer_offset + 4];
+    if (result.Failure()) {
+      DefaultLogSink().Error("Error reading IA Frame preamble\n");
+    }
 
-    buffer_offset += frameTLLen;
+    ui32_t preambleLen = 0;
+    ui32_t frameLen = 0;
 
-    /* read the IA Frame */
+    if (result.Success()) {
+      preambleLen = readLength(frame.RoData());
 
-    if (frameLen > 0) {
+      result = readFrameBytes(reader, frame, have, 2 * IATagLengthSize + preambleLen, reallocate_if_needed);
 
-      if (!checkFrameCapacity(frame, preambleTLLen + preambleLen + frameTLLen + frameLen, reallocate_if_needed)) {
-        return RESULT_SMALLBUF;
+      if (result.Failure()) {
+        DefaultLogSink().Error("Error reading IA Frame preamble\n");
       }
-      frame.Size(preambleTLLen + preambleLen + frameTLLen + frameLen);
+    }
+
+    if (result.Success()) {
+      frameLen = readLength(frame.RoData() + IATagLengthSize + preambleLen);
 
-      result = reader->m_File->Read(&frame.Data()[buffer_offset], frameLen);
+      result = readFrameBytes(reader, frame, have, 2 * IATagLengthSize + preambleLen + frameLen, reallocate_if_needed);
 
       if (result.Failure()) {
-        DefaultLogSink().Error("Error reading IA Frame data\n", index_entry.StreamOffset);
-        return result;
+        DefaultLogSink().Error("Error reading IA Frame data\n");
       }
     }
 
+    if (result.Failure()) {
+      reader->m_LastPosition = 0; // the next read must seek
+      return result;
+    }
+
+    frame.Size(2 * IATagLengthSize + preambleLen + frameLen);
+    reader->m_LastPosition = index_entry.StreamOffset + have;
     reader_state = ST_READER_RUNNING;
 
     return result;
@@ -674,6 +743,13 @@ AS_02::IAB::MXFReader::FillWriterInfo(WriterInfo& Info) const {
   return Kumu::RESULT_OK;
 }
 
+void
+AS_02::IAB::MXFReader::SetStageStats(ASDCP::StageStats* stats) const {
+  if (this->m_Reader && this->m_Reader->m_State != ST_READER_BEGIN) {
+    this->m_Reader->m_Stats = stats;
+  }
+}
+
 void
 AS_02::IAB::MXFReader::DumpHeaderMetadata(FILE* stream) const {
   if (this->m_Reader->m_State != ST_READER_BEGIN) {
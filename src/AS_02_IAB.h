@@ -133,6 +133,14 @@ namespace AS_02 {
        */
       Result_t WriteFrame(const ASDCP::FrameBuffer& frame);
 
+      /**
+       * Accumulates the time spent writing frames into the given StageStats,
+       * which must outlive the writer; 0 stops the collection.
+       *
+       * @return RESULT_INIT if the file is not open.
+       */
+      Result_t SetStageStats(ASDCP::StageStats* stats);
+
       /**
        * Writes an XML text document to the MXF file as per RP 2057. If the
        * optional AESEncContext argument is present, the document is encrypted
@@ -269,6 +277,13 @@ namespace AS_02 {
        */
       Result_t GetFrameCount(ui32_t& frameCount) const;
 
+      /**
+       * Accumulates the time spent reading frames into the given StageStats,
+       * which must outlive the reader; 0 stops the collection. Has no effect
+       * unless the file is open, and the setting ends when the file is closed.
+       */
+      void     SetStageStats(ASDCP::StageStats* stats) const;
+
       // Print debugging information to stream
       void     DumpHeaderMetadata(FILE* = 0) const;
       void     DumpIndex(FILE* = 0) const;
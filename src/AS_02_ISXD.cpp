@@ -229,6 +229,13 @@ AS_02::ISXD::MXFReader::FillWriterInfo(WriterInfo& Info) const
   return RESULT_INIT;
 }
 
+//
+void
+AS_02::ISXD::MXFReader::SetStageStats(ASDCP::StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
+
 //
 void
 AS_02::ISXD::MXFReader::DumpHeaderMetadata(FILE* stream) const
@@ -491,6 +498,17 @@ AS_02::ISXD::MXFWriter::AddDmsGenericPartUtf8Text(const ASDCP::FrameBuffer& Fram
 }
 
 
+//
+ASDCP::Result_t
+AS_02::ISXD::MXFWriter::SetStageStats(ASDCP::StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 Result_t
 AS_02::ISXD::MXFWriter::Finalize()
@@ -60,15 +60,18 @@ public:
 
   virtual ~h__Reader() {}
 
-  Result_t    OpenRead(const std::string&);
+  Result_t    OpenRead(const std::string&, bool growing = false);
   Result_t    ReadFrame(ui32_t, ASDCP::JP2K::FrameBuffer&, AESDecContext*, HMACContext*);
+  Result_t    ReadFrames(const std::vector<ui32_t>&, ASDCP::JP2K::FrameBuffer&, ASDCP::FrameReadCallback&,
+			 AESDecContext*, HMACContext*);
+  Result_t    ReadFrameRange(ui32_t, ui32_t, ui32_t, ASDCP::JP2K::FrameBuffer&, AESDecContext*);
 };
 
 //
 Result_t
-AS_02::JP2K::MXFReader::h__Reader::OpenRead(const std::string& filename)
+AS_02::JP2K::MXFReader::h__Reader::OpenRead(const std::string& filename, bool growing)
 {
-  Result_t result = OpenMXFRead(filename);
+  Result_t result = growing ? OpenMXFReadGrowing(filename) : OpenMXFRead(filename);
 
   if( KM_SUCCESS(result) )
     {
@@ -119,6 +122,31 @@ AS_02::JP2K::MXFReader::h__Reader::ReadFrame(ui32_t FrameNum, ASDCP::JP2K::Frame
   return ReadEKLVFrame(FrameNum, FrameBuf, m_Dict->ul(MDD_JPEG2000Essence), Ctx, HMAC);
 }
 
+//
+Result_t
+AS_02::JP2K::MXFReader::h__Reader::ReadFrames(const std::vector<ui32_t>& frame_numbers, ASDCP::JP2K::FrameBuffer& FrameBuf,
+					      ASDCP::FrameReadCallback& Callback,
+					      ASDCP::AESDecContext* Ctx, ASDCP::HMACContext* HMAC)
+{
+  if ( ! m_File->IsOpen() )
+    return RESULT_INIT;
+
+  assert(m_Dict);
+  return ReadEKLVFrames(frame_numbers, FrameBuf, m_Dict->ul(MDD_JPEG2000Essence), Ctx, HMAC, Callback);
+}
+
+//
+Result_t
+AS_02::JP2K::MXFReader::h__Reader::ReadFrameRange(ui32_t FrameNum, ui32_t offset, ui32_t length,
+						  ASDCP::JP2K::FrameBuffer& FrameBuf, ASDCP::AESDecContext* Ctx)
+{
+  if ( ! m_File->IsOpen() )
+    return RESULT_INIT;
+
+  assert(m_Dict);
+  return ReadEKLVFrameRange(FrameNum, offset, length, FrameBuf, m_Dict->ul(MDD_JPEG2000Essence), Ctx);
+}
+
 //------------------------------------------------------------------------------------------
 //
 
@@ -185,6 +213,24 @@ AS_02::JP2K::MXFReader::OpenRead(const std::string& filename) const
   return m_Reader->OpenRead(filename);
 }
 
+// Open a file that is still being written. The file must exist and have a
+// complete header.
+Result_t
+AS_02::JP2K::MXFReader::OpenReadGrowing(const std::string& filename) const
+{
+  return m_Reader->OpenRead(filename, true);
+}
+
+//
+Result_t
+AS_02::JP2K::MXFReader::Refresh(ui32_t& frame_count, bool& is_complete) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->Refresh(frame_count, is_complete);
+
+  return RESULT_INIT;
+}
+
 //
 Result_t
 AS_02::JP2K::MXFReader::Close() const
@@ -209,6 +255,37 @@ AS_02::JP2K::MXFReader::ReadFrame(ui32_t FrameNum, ASDCP::JP2K::FrameBuffer& Fra
   return RESULT_INIT;
 }
 
+//
+Result_t
+AS_02::JP2K::MXFReader::ReadFrames(const std::vector<ui32_t>& frame_numbers, ASDCP::JP2K::FrameBuffer& FrameBuf,
+				   ASDCP::FrameReadCallback& Callback,
+				   ASDCP::AESDecContext* Ctx, ASDCP::HMACContext* HMAC) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->ReadFrames(frame_numbers, FrameBuf, Callback, Ctx, HMAC);
+
+  return RESULT_INIT;
+}
+
+//
+Result_t
+AS_02::JP2K::MXFReader::ReadFramePrefix(ui32_t FrameNum, ui32_t length, ASDCP::JP2K::FrameBuffer& FrameBuf,
+					ASDCP::AESDecContext* Ctx) const
+{
+  return ReadFrameRange(FrameNum, 0, length, FrameBuf, Ctx);
+}
+
+//
+Result_t
+AS_02::JP2K::MXFReader::ReadFrameRange(ui32_t FrameNum, ui32_t offset, ui32_t length,
+				       ASDCP::JP2K::FrameBuffer& FrameBuf, ASDCP::AESDecContext* Ctx) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->ReadFrameRange(FrameNum, offset, length, FrameBuf, Ctx);
+
+  return RESULT_INIT;
+}
+
 // Fill the struct with the values from the file's header.
 // Returns RESULT_INIT if the file is not open.
 Result_t
@@ -223,6 +300,13 @@ AS_02::JP2K::MXFReader::FillWriterInfo(WriterInfo& Info) const
   return RESULT_INIT;
 }
 
+//
+void
+AS_02::JP2K::MXFReader::SetStageStats(ASDCP::StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
+
 //
 void
 AS_02::JP2K::MXFReader::DumpHeaderMetadata(FILE* stream) const
@@ -513,6 +597,17 @@ AS_02::JP2K::MXFWriter::WriteFrame(const ASDCP::JP2K::FrameBuffer& FrameBuf, AES
   return m_Writer->WriteFrame(FrameBuf, Ctx, HMAC);
 }
 
+//
+ASDCP::Result_t
+AS_02::JP2K::MXFWriter::SetStageStats(ASDCP::StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 Result_t
 AS_02::JP2K::MXFWriter::Finalize()
@@ -62,7 +62,7 @@ public:
 
   virtual ~h__Reader() {}
 
-  Result_t    OpenRead(const std::string&);
+  Result_t    OpenRead(const std::string&, bool growing = false);
   Result_t    ReadFrame(ui32_t, ASDCP::JXS::FrameBuffer&, AESDecContext*, HMACContext*);
   Result_t    CalcFrameBufferSize(ui64_t &size);
 };
@@ -104,9 +104,9 @@ AS_02::JXS::MXFReader::h__Reader::CalcFrameBufferSize(ui64_t &size)
 
 //
 Result_t
-AS_02::JXS::MXFReader::h__Reader::OpenRead(const std::string& filename)
+AS_02::JXS::MXFReader::h__Reader::OpenRead(const std::string& filename, bool growing)
 {
-  Result_t result = OpenMXFRead(filename);
+  Result_t result = growing ? OpenMXFReadGrowing(filename) : OpenMXFRead(filename);
 
   if( KM_SUCCESS(result) )
     {
@@ -223,6 +223,24 @@ AS_02::JXS::MXFReader::OpenRead(const std::string& filename) const
   return m_Reader->OpenRead(filename);
 }
 
+// Open a file that is still being written. The file must exist and have a
+// complete header.
+Result_t
+AS_02::JXS::MXFReader::OpenReadGrowing(const std::string& filename) const
+{
+  return m_Reader->OpenRead(filename, true);
+}
+
+//
+Result_t
+AS_02::JXS::MXFReader::Refresh(ui32_t& frame_count, bool& is_complete) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->Refresh(frame_count, is_complete);
+
+  return RESULT_INIT;
+}
+
 //
 Result_t
 AS_02::JXS::MXFReader::Close() const
@@ -272,6 +290,13 @@ AS_02::JXS::MXFReader::FillWriterInfo(WriterInfo& Info) const
   return RESULT_INIT;
 }
 
+//
+void
+AS_02::JXS::MXFReader::SetStageStats(ASDCP::StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
+
 //
 void
 AS_02::JXS::MXFReader::DumpHeaderMetadata(FILE* stream) const
@@ -558,6 +583,17 @@ AS_02::JXS::MXFWriter::WriteFrame(const ASDCP::JXS::FrameBuffer& FrameBuf, AESEn
   return m_Writer->WriteFrame(FrameBuf, Ctx, HMAC);
 }
 
+//
+Result_t
+AS_02::JXS::MXFWriter::SetStageStats(ASDCP::StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 Result_t
 AS_02::JXS::MXFWriter::Finalize()
@@ -88,6 +88,11 @@ namespace AS_02
 		  // error occurs.
 		  Result_t WriteFrame(const ASDCP::JXS::FrameBuffer&, ASDCP::AESEncContext* = 0, ASDCP::HMACContext* = 0);
 
+		  // Accumulates the time spent in each stage of writing essence into the
+		  // given StageStats, which must outlive the writer; 0 stops the collection.
+		  // Returns RESULT_INIT if the file is not open.
+		  Result_t SetStageStats(ASDCP::StageStats*);
+
 		  // Closes the MXF file, writing the index and revised header.
 		  Result_t Finalize();
 	  };
@@ -113,6 +118,16 @@ namespace AS_02
 		  // operation cannot be completed.
 		  Result_t OpenRead(const std::string& filename) const;
 
+		  // Open a file that is still being written and has no footer yet. Only the
+		  // frames covered by the index partitions flushed so far can be read.
+		  Result_t OpenReadGrowing(const std::string& filename) const;
+
+		  // Index the partitions written since the file was opened or last refreshed.
+		  // On return frame_count is the number of readable frames, and is_complete is
+		  // true once the writer has written the footer (always for OpenRead()).
+		  // Returns RESULT_INIT if the file is not open.
+		  Result_t Refresh(ui32_t& frame_count, bool& is_complete) const;
+
 		  // Returns RESULT_INIT if the file is not open.
 		  Result_t Close() const;
 
@@ -133,6 +148,10 @@ namespace AS_02
 		  // out of range, or if optional decrypt or HAMC operations fail.
 		  Result_t ReadFrame(ui32_t frame_number, ASDCP::JXS::FrameBuffer&, ASDCP::AESDecContext* = 0, ASDCP::HMACContext* = 0) const;
 
+		  // Accumulates the time spent in each stage of reading essence into the
+		  // given StageStats, which must outlive the reader; 0 stops the collection.
+		  void     SetStageStats(ASDCP::StageStats*) const;
+
 		  // Print debugging information to stream
 		  void     DumpHeaderMetadata(FILE* = 0) const;
 		  void     DumpIndex(FILE* = 0) const;
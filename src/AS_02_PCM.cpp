@@ -177,10 +177,12 @@ AS_02::PCM::MXFReader::h__Reader::ReadFrame(ui32_t FrameNum, ASDCP::PCM::FrameBu
     {
       ui64_t remainder = m_ClipSize - offset;
       ui32_t read_size = ( remainder < m_BytesPerFrame ) ? remainder : m_BytesPerFrame;
+      StageTimer read_timer(m_Stats, StageStats::STAGE_FILE_READ);
       result = m_File->Read(FrameBuf.Data(), read_size);
 
       if ( KM_SUCCESS(result) )
 	{
+	  read_timer.Stop(read_size);
 	  FrameBuf.Size(read_size);
 
 	  if ( read_size < FrameBuf.Capacity() )
@@ -302,6 +304,13 @@ AS_02::PCM::MXFReader::FillWriterInfo(WriterInfo& Info) const
   return RESULT_INIT;
 }
 
+//
+void
+AS_02::PCM::MXFReader::SetStageStats(ASDCP::StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
+
 //
 void
 AS_02::PCM::MXFReader::DumpHeaderMetadata(FILE* stream) const
@@ -585,6 +594,17 @@ AS_02::PCM::MXFWriter::WriteFrame(const FrameBuffer& FrameBuf, AESEncContext* Ct
   return m_Writer->WriteFrame(FrameBuf, Ctx, HMAC);
 }
 
+//
+ASDCP::Result_t
+AS_02::PCM::MXFWriter::SetStageStats(ASDCP::StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 ASDCP::Result_t
 AS_02::PCM::MXFWriter::Finalize()
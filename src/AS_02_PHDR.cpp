@@ -563,6 +563,9 @@ AS_02::PHDR::MXFWriter::h__Writer::WriteFrame(const AS_02::PHDR::FrameBuffer& Fr
   if ( m_State.Test_READY() )
     {
       result = m_State.Goto_RUNNING(); // first time through
+
+      if ( KM_SUCCESS(result) )
+	result = m_IndexWriter.SetPartitionSpace(m_PartitionSpace);
     }
 
   if ( KM_SUCCESS(result) )
@@ -591,7 +594,8 @@ AS_02::PHDR::MXFWriter::h__Writer::WriteFrame(const AS_02::PHDR::FrameBuffer& Fr
 	  m_IndexWriter.PushIndexEntry(Entry);
 	}
 
-      if ( m_FramesWritten > 1 && ( ( m_FramesWritten + 1 ) % m_PartitionSpace ) == 0 )
+      if ( ( m_FramesWritten > 1 && ( ( m_FramesWritten + 1 ) % m_PartitionSpace ) == 0 )
+           || m_IndexWriter.IsFull() )
 	{
 	  assert(m_IndexWriter.GetDuration() > 0);
 	  FlushIndexPartition();
@@ -604,6 +608,7 @@ AS_02::PHDR::MXFWriter::h__Writer::WriteFrame(const AS_02::PHDR::FrameBuffer& Fr
 	  body_part.OperationalPattern = m_HeaderPart.OperationalPattern;
 	  body_part.EssenceContainers = m_HeaderPart.EssenceContainers;
 	  body_part.ThisPartition = m_File.TellPosition();
+	  body_part.PreviousPartition = m_RIP.PairArray.back().ByteOffset;
 
 	  body_part.BodyOffset = m_StreamOffset;
 	  result = body_part.WriteToFile(m_File, body_ul);
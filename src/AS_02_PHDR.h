@@ -52,6 +52,12 @@ namespace AS_02
 	FrameBuffer(ui32_t size) { Capacity(size); }
 	virtual ~FrameBuffer() {}
 
+	// Exchanges the buffer and the metadata with rhs.
+	void Swap(FrameBuffer& rhs) {
+	  ASDCP::FrameBuffer::Swap(rhs);
+	  OpaqueMetadata.swap(rhs.OpaqueMetadata);
+	}
+
 	// Print debugging information to stream (stderr default)
 	void Dump(FILE* = 0, ui32_t dump_bytes = 0) const;
       };
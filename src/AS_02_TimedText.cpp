@@ -58,7 +58,15 @@ MIME2str(TimedText::MIMEType_t m)
 
 //------------------------------------------------------------------------------------------
 
-typedef std::map<Kumu::UUID, Kumu::UUID> ResourceMap_t;
+// The location of an ancillary resource, resolved when the file is opened so that
+// each fetch needs only one seek and one read.
+struct ResourceLocation
+{
+  GenericStreamLocation Stream;
+  std::string           MIMEType;
+};
+
+typedef std::map<Kumu::UUID, ResourceLocation> ResourceMap_t;
 
 class AS_02::TimedText::MXFReader::h__Reader : public AS_02::h__AS02Reader
 {
@@ -69,6 +77,7 @@ class AS_02::TimedText::MXFReader::h__Reader : public AS_02::h__AS02Reader
 
 public:
   TimedTextDescriptor m_TDesc;
+  EKLVPacketReader    m_ResourceReader;
 
   h__Reader(const Dictionary* d, const Kumu::IFileReaderFactory& fileReaderFactory) : AS_02::h__AS02Reader(d, fileReaderFactory), m_EssenceDescriptor(0) {
     memset(&m_TDesc.AssetID, 0, UUIDlen);
@@ -80,6 +89,8 @@ public:
   Result_t    MD_to_TimedText_TDesc(TimedTextDescriptor& TDesc);
   Result_t    ReadTimedTextResource(ASDCP::TimedText::FrameBuffer& FrameBuf, AESDecContext* Ctx, HMACContext* HMAC);
   Result_t    ReadAncillaryResource(const Kumu::UUID&, ASDCP::TimedText::FrameBuffer& FrameBuf, AESDecContext* Ctx, HMACContext* HMAC);
+  Result_t    FindResource(const Kumu::UUID&, const ResourceLocation*&);
+  Result_t    BeginReadAncillaryResource(const Kumu::UUID&, ui32_t& resource_length, AESDecContext* Ctx, HMACContext* HMAC);
 };
 
 //
@@ -104,6 +115,11 @@ AS_02::TimedText::MXFReader::h__Reader::MD_to_TimedText_TDesc(TimedTextDescripto
   TimedTextResourceSubDescriptor* DescObject = 0;
   Result_t result = RESULT_OK;
 
+  // index the generic stream partitions once, rather than walking the RIP per resource
+  GenericStreamMap_t stream_map;
+  IndexGenericStreamPartitions(stream_map);
+  m_ResourceMap.clear();
+
   for ( ; sdi != TDescObj->SubDescriptors.end() && KM_SUCCESS(result); sdi++ )
     {
       InterchangeObject* tmp_iobj = 0;
@@ -131,7 +147,16 @@ AS_02::TimedText::MXFReader::h__Reader::MD_to_TimedText_TDesc(TimedTextDescripto
 	    }
 
 	  TDesc.ResourceList.push_back(TmpResource);
-	  m_ResourceMap.insert(ResourceMap_t::value_type(DescObject->AncillaryResourceID, *sdi));
+	  ResourceLocation TmpLocation;
+	  TmpLocation.MIMEType = DescObject->MIMEMediaType;
+	  GenericStreamMap_t::const_iterator si = stream_map.find(DescObject->EssenceStreamID);
+
+	  if ( si != stream_map.end() )
+	    TmpLocation.Stream = si->second;
+	  else
+	    TmpLocation.Stream.BodySID = DescObject->EssenceStreamID; // reported when read
+
+	  m_ResourceMap.insert(ResourceMap_t::value_type(DescObject->AncillaryResourceID, TmpLocation));
 	}
       else
 	{
@@ -147,6 +172,7 @@ AS_02::TimedText::MXFReader::h__Reader::MD_to_TimedText_TDesc(TimedTextDescripto
 ASDCP::Result_t
 AS_02::TimedText::MXFReader::h__Reader::OpenRead(const std::string& filename)
 {
+  m_ResourceReader.Discard();
   Result_t result = OpenMXFRead(filename.c_str());
   
   if( ASDCP_SUCCESS(result) )
@@ -176,6 +202,7 @@ AS_02::TimedText::MXFReader::h__Reader::ReadTimedTextResource(ASDCP::TimedText::
     }
 
   assert(m_Dict);
+  m_ResourceReader.Discard();
   Result_t result = ReadEKLVFrame(0, FrameBuf, m_Dict->ul(MDD_TimedTextEssence), Ctx, HMAC);
 
  if( ASDCP_SUCCESS(result) )
@@ -192,6 +219,28 @@ ASDCP::Result_t
 AS_02::TimedText::MXFReader::h__Reader::ReadAncillaryResource(const Kumu::UUID& uuid,
 							      ASDCP::TimedText::FrameBuffer& frame_buf,
 							      AESDecContext* Ctx, HMACContext* HMAC)
+{
+  const ResourceLocation* location = 0;
+  Result_t result = FindResource(uuid, location);
+
+  if ( KM_SUCCESS(result) )
+    {
+      m_ResourceReader.Discard();
+      result = ReadGenericStreamPartitionPayload(location->Stream, frame_buf, Ctx, HMAC);
+    }
+
+  if ( KM_SUCCESS(result) )
+    {
+      frame_buf.AssetID(uuid.Value());
+      frame_buf.MIMEType(location->MIMEType);
+    }
+  
+  return result;
+}
+
+// returns the location of the resource having the given ID
+ASDCP::Result_t
+AS_02::TimedText::MXFReader::h__Reader::FindResource(const Kumu::UUID& uuid, const ResourceLocation*& location)
 {
   ResourceMap_t::const_iterator ri = m_ResourceMap.find(uuid);
   if ( ri == m_ResourceMap.end() )
@@ -201,23 +250,33 @@ AS_02::TimedText::MXFReader::h__Reader::ReadAncillaryResource(const Kumu::UUID&
       return RESULT_RANGE;
     }
 
-  // get the subdescriptor
-  InterchangeObject* tmp_iobj = 0;
-  Result_t result = m_HeaderPart.GetMDObjectByID((*ri).second, &tmp_iobj);
-  TimedTextResourceSubDescriptor* desc_object = dynamic_cast<TimedTextResourceSubDescriptor*>(tmp_iobj);
+  location = &ri->second;
+  return RESULT_OK;
+}
+
+//
+ASDCP::Result_t
+AS_02::TimedText::MXFReader::h__Reader::BeginReadAncillaryResource(const Kumu::UUID& uuid, ui32_t& resource_length,
+								   AESDecContext* Ctx, HMACContext* HMAC)
+{
+  const ResourceLocation* location = 0;
+  Result_t result = FindResource(uuid, location);
+  ui64_t value_length = 0;
+  m_ResourceReader.Discard();
 
   if ( KM_SUCCESS(result) )
     {
-      assert(desc_object);
-      result = ReadGenericStreamPartitionPayload(desc_object->EssenceStreamID, frame_buf, Ctx, HMAC);
+      result = BeginGenericStreamPartitionPayload(location->Stream, m_ResourceReader,
+						  value_length, Ctx, HMAC);
     }
 
-  if ( KM_SUCCESS(result) )
+  if ( KM_SUCCESS(result) && value_length > 0xffffffffUL )
     {
-      frame_buf.AssetID(uuid.Value());
-      frame_buf.MIMEType(desc_object->MIMEMediaType);
+      m_ResourceReader.Discard();
+      result = RESULT_FORMAT;
     }
-  
+
+  resource_length = KM_SUCCESS(result) ? (ui32_t)value_length : 0;
   return result;
 }
 
@@ -351,6 +410,44 @@ AS_02::TimedText::MXFReader::ReadAncillaryResource(const Kumu::UUID& uuid, ASDCP
   return RESULT_INIT;
 }
 
+//
+ASDCP::Result_t
+AS_02::TimedText::MXFReader::BeginReadAncillaryResource(const Kumu::UUID& uuid, ui32_t& resource_length,
+							AESDecContext* Ctx, HMACContext* HMAC) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->BeginReadAncillaryResource(uuid, resource_length, Ctx, HMAC);
+
+  return RESULT_INIT;
+}
+
+//
+ASDCP::Result_t
+AS_02::TimedText::MXFReader::ReadAncillaryResourceData(byte_t* buf, ui32_t buf_len, ui32_t& read_count) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->m_ResourceReader.Read(buf, buf_len, read_count);
+
+  return RESULT_INIT;
+}
+
+//
+ASDCP::Result_t
+AS_02::TimedText::MXFReader::EndReadAncillaryResource() const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->m_ResourceReader.End();
+
+  return RESULT_INIT;
+}
+
+
+//
+void
+AS_02::TimedText::MXFReader::SetStageStats(ASDCP::StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
 
 //
 void
@@ -397,6 +494,7 @@ public:
   byte_t m_EssenceUL[SMPTE_UL_LENGTH];
   ui32_t m_EssenceStreamID;
   ASDCP::Rational m_EditRate;
+  EKLVPacketWriter m_ResourceWriter;
 
   h__Writer(const Dictionary *d) : AS_02::h__AS02WriterClip<AS_02::MXF::AS02IndexWriterCBR>(d), m_EssenceStreamID(10)
   {
@@ -409,6 +507,10 @@ public:
   Result_t SetSourceStream(const ASDCP::TimedText::TimedTextDescriptor&);
   Result_t WriteTimedTextResource(const std::string& XMLDoc, AESEncContext* = 0, HMACContext* = 0);
   Result_t WriteAncillaryResource(const ASDCP::TimedText::FrameBuffer&, AESEncContext* = 0, HMACContext* = 0);
+  Result_t BeginAncillaryResource(ui32_t resource_length, ui32_t plaintext_offset,
+				  AESEncContext* = 0, HMACContext* = 0);
+  Result_t AppendAncillaryResource(const byte_t* buf, ui32_t buf_len);
+  Result_t EndAncillaryResource();
   Result_t Finalize();
   Result_t TimedText_TDesc_to_MD(ASDCP::TimedText::TimedTextDescriptor& TDesc);
 };
@@ -527,7 +629,7 @@ AS_02::TimedText::MXFWriter::h__Writer::WriteTimedTextResource(const std::string
       index_entry.StreamOffset = m_StreamOffset;
       
       result = Write_EKLV_Packet(m_File, *m_Dict, m_HeaderPart, m_Info, m_CtFrameBuf, m_FramesWritten,
-				 m_StreamOffset, FrameBuf, m_EssenceUL, MXF_BER_LENGTH, Ctx, HMAC);
+				 m_StreamOffset, FrameBuf, m_EssenceUL, MXF_BER_LENGTH, Ctx, HMAC, m_Stats);
     }
 
   if ( KM_SUCCESS(result) )
@@ -596,7 +698,32 @@ ASDCP::Result_t
 AS_02::TimedText::MXFWriter::h__Writer::WriteAncillaryResource(const ASDCP::TimedText::FrameBuffer& FrameBuf,
 							       ASDCP::AESEncContext* Ctx, ASDCP::HMACContext* HMAC)
 {
-  if ( ! m_State.Test_RUNNING() )
+  Result_t result = BeginAncillaryResource(FrameBuf.Size(), FrameBuf.PlaintextOffset(), Ctx, HMAC);
+
+  if ( KM_SUCCESS(result) )
+    {
+      result = AppendAncillaryResource(FrameBuf.RoData(), FrameBuf.Size());
+    }
+
+  if ( m_ResourceWriter.IsOpen() )
+    {
+      Result_t end_result = EndAncillaryResource();
+
+      if ( KM_SUCCESS(result) )
+	{
+	  result = end_result;
+	}
+    }
+
+  return result;
+}
+
+//
+ASDCP::Result_t
+AS_02::TimedText::MXFWriter::h__Writer::BeginAncillaryResource(ui32_t resource_length, ui32_t plaintext_offset,
+							       ASDCP::AESEncContext* Ctx, ASDCP::HMACContext* HMAC)
+{
+  if ( ! m_State.Test_RUNNING() || m_ResourceWriter.IsOpen() )
     {
       KM_RESULT_STATE_HERE();
       return RESULT_STATE;
@@ -623,15 +750,42 @@ AS_02::TimedText::MXFWriter::h__Writer::WriteAncillaryResource(const ASDCP::Time
 
   if ( KM_SUCCESS(result) )
     {
-      result = Write_EKLV_Packet(m_File, *m_Dict, m_HeaderPart, m_Info, m_CtFrameBuf, m_FramesWritten,
-				 m_StreamOffset, FrameBuf, GenericStream_DataElement.Value(),
-				 MXF_BER_LENGTH, Ctx, HMAC);
+      result = m_ResourceWriter.Begin(m_File, *m_Dict, m_Info, GenericStream_DataElement.Value(),
+				      resource_length, plaintext_offset, m_FramesWritten + 1, Ctx, HMAC);
     }
 
   m_FramesWritten++;
   return result;
 }
 
+//
+ASDCP::Result_t
+AS_02::TimedText::MXFWriter::h__Writer::AppendAncillaryResource(const byte_t* buf, ui32_t buf_len)
+{
+  if ( ! m_ResourceWriter.IsOpen() )
+    {
+      KM_RESULT_STATE_HERE();
+      return RESULT_STATE;
+    }
+
+  return m_ResourceWriter.Append(buf, buf_len);
+}
+
+//
+ASDCP::Result_t
+AS_02::TimedText::MXFWriter::h__Writer::EndAncillaryResource()
+{
+  if ( ! m_ResourceWriter.IsOpen() )
+    {
+      KM_RESULT_STATE_HERE();
+      return RESULT_STATE;
+    }
+
+  Result_t result = m_ResourceWriter.End();
+  m_StreamOffset += m_ResourceWriter.BytesWritten();
+  return result;
+}
+
 //
 ASDCP::Result_t
 AS_02::TimedText::MXFWriter::h__Writer::Finalize()
@@ -641,6 +795,12 @@ AS_02::TimedText::MXFWriter::h__Writer::Finalize()
       DefaultLogSink().Error("Cannot finalize file, the primary essence resource has not been written.\n");
       return RESULT_STATE;
     }
+
+  if ( m_ResourceWriter.IsOpen() )
+    {
+      DefaultLogSink().Error("Cannot finalize file, an ancillary resource is incomplete.\n");
+      return RESULT_STATE;
+    }
   m_FramesWritten = m_TDesc.ContainerDuration;
 
   Result_t result = m_State.Goto_FINAL();
@@ -740,6 +900,47 @@ AS_02::TimedText::MXFWriter::WriteAncillaryResource(const ASDCP::TimedText::Fram
   return m_Writer->WriteAncillaryResource(FrameBuf, Ctx, HMAC);
 }
 
+//
+ASDCP::Result_t
+AS_02::TimedText::MXFWriter::BeginAncillaryResource(ui32_t resource_length, AESEncContext* Ctx, HMACContext* HMAC)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  return m_Writer->BeginAncillaryResource(resource_length, 0, Ctx, HMAC);
+}
+
+//
+ASDCP::Result_t
+AS_02::TimedText::MXFWriter::AppendAncillaryResource(const byte_t* buf, ui32_t buf_len)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  return m_Writer->AppendAncillaryResource(buf, buf_len);
+}
+
+//
+ASDCP::Result_t
+AS_02::TimedText::MXFWriter::EndAncillaryResource()
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  return m_Writer->EndAncillaryResource();
+}
+
+//
+ASDCP::Result_t
+AS_02::TimedText::MXFWriter::SetStageStats(ASDCP::StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 ASDCP::Result_t
 AS_02::TimedText::MXFWriter::Finalize()
@@ -59,6 +59,17 @@ namespace AS_02
       ASDCP_NO_COPY_CONSTRUCT(h__AS02Reader);
       h__AS02Reader();
 
+      const Kumu::IFileReaderFactory& m_FileReaderFactory; // opens helper readers during index discovery
+
+      // growing file state, the scan resumes at m_ScanPosition on each Refresh()
+      bool         m_Growing;
+      bool         m_GrowingComplete;
+      Kumu::fpos_t m_ScanPosition;
+      ui32_t       m_ScanBodySID;
+      bool         m_ScanHasBody;
+      ui64_t       m_ScanBodyOffset;
+      ui64_t       m_ScanEssenceOffset;
+
     public:
       h__AS02Reader(const ASDCP::Dictionary*, const Kumu::IFileReaderFactory& fileReaderFactory);
 
@@ -66,9 +77,20 @@ namespace AS_02
 
       Result_t OpenMXFRead(const std::string& filename);
 
+      // Opens a file that is still being written, before it has a footer or a RIP.
+      // Only the frames described by index partitions already flushed by the writer
+      // are readable. Call Refresh() to index partitions written since the last call.
+      Result_t OpenMXFReadGrowing(const std::string& filename);
+      Result_t Refresh(ui32_t& frame_count, bool& is_complete);
+
       // USE FRAME WRAPPING...
       Result_t ReadEKLVFrame(ui32_t FrameNum, ASDCP::FrameBuffer& FrameBuf,
 			     const byte_t* EssenceUL, ASDCP::AESDecContext* Ctx, ASDCP::HMACContext* HMAC);
+      Result_t ReadEKLVFrames(const std::vector<ui32_t>& frame_numbers, ASDCP::FrameBuffer& FrameBuf,
+			      const byte_t* EssenceUL, ASDCP::AESDecContext* Ctx, ASDCP::HMACContext* HMAC,
+			      ASDCP::FrameReadCallback& Callback);
+      Result_t ReadEKLVFrameRange(ui32_t FrameNum, ui32_t offset, ui32_t length, ASDCP::FrameBuffer& FrameBuf,
+				  const byte_t* EssenceUL, ASDCP::AESDecContext* Ctx);
 
      // OR CLIP WRAPPING...
       // clip wrapping is handled directly by the essence-specific classes
@@ -81,15 +103,25 @@ namespace AS_02
 
   namespace MXF
   {
+    // true if the key is that of a header, body or footer partition pack
+    bool IsPartitionPackKey(const byte_t* key);
+
     //
     class AS02IndexWriterVBR : public ASDCP::MXF::Partition
       {
 	ASDCP::MXF::IndexTableSegment*  m_CurrentSegment;
 	ASDCP::MXF::Rational m_EditRate;
+	Kumu::ByteString m_IndexBodyBuffer;  // serialized segments of the current partition
+	ui32_t m_SegmentCount;
+	ui32_t m_PartitionDuration;
+	ui32_t m_PartitionSpace;  // expected edit units per partition, 0 if not known
+	ui64_t m_StartPosition;
 
 	KM_NO_COPY_CONSTRUCT(AS02IndexWriterVBR);
 	AS02IndexWriterVBR();
 
+	Result_t SerializeCurrentSegment();
+
       public:
 	const ASDCP::Dictionary*  m_Dict;
 	ASDCP::IPrimerLookup*      m_Lookup;
@@ -107,6 +139,9 @@ namespace AS_02
 	void     Dump(FILE* = 0);
 
 	ui32_t GetDuration() const;
+	bool IsFull() const;  // true if the current partition should be closed
+	void SetStartPosition(ui64_t start_position);  // edit unit of the first entry, default 0
+	Result_t SetPartitionSpace(ui32_t edit_units);  // preallocates the index of one partition
 	void PushIndexEntry(const ASDCP::MXF::IndexTableSegment::IndexEntry&);
 	void SetEditRate(const ASDCP::Rational& edit_rate);
       };
@@ -215,6 +250,7 @@ namespace AS_02
 	    if ( this->m_IndexWriter.GetDuration() > 0 )
 	    {
 	    this->m_IndexWriter.ThisPartition = this->m_File.TellPosition();
+	    this->m_IndexWriter.PreviousPartition = this->m_RIP.PairArray.back().ByteOffset;
 	    result = this->m_IndexWriter.WriteToFile(this->m_File);
 	    this->m_RIP.PairArray.push_back(RIP::PartitionPair(0, this->m_IndexWriter.ThisPartition));
 	    }
@@ -367,7 +403,13 @@ namespace AS_02
                 return RESULT_STATE;
             }
 
-            return h__AS02Writer<IndexWriterType>::m_File.Write(FrameBuf.RoData(), FrameBuf.Size());
+            StageTimer write_timer(h__AS02Writer<IndexWriterType>::m_Stats, StageStats::STAGE_FILE_WRITE);
+            Result_t result = h__AS02Writer<IndexWriterType>::m_File.Write(FrameBuf.RoData(), FrameBuf.Size());
+
+            if (KM_SUCCESS(result))
+                write_timer.Stop(FrameBuf.Size());
+
+            return result;
         }
         Result_t FinalizeClip(ui32_t bytes_per_frame)
         {
@@ -30,7 +30,14 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "AS_DCP_internal.h"
+#include <KM_mutex.h>
+#include <KM_thread.h>
 #include <assert.h>
+#include <algorithm>
+
+#ifdef KM_WIN32
+#include <malloc.h>
+#endif
 
 const char*
 ASDCP::Version()
@@ -79,12 +86,295 @@ ASDCP::DecodeRational(const char* str_rational, Rational& rational)
 }
 
 
+//------------------------------------------------------------------------------------------
+//
+// frame buffer allocator
+
+//
+static void*
+default_fb_allocate(ui32_t size, ui32_t alignment)
+{
+#ifdef KM_WIN32
+  return _aligned_malloc(size, alignment > 16 ? alignment : 16);
+#else
+  if ( alignment <= 16 )
+    return malloc(size);
+
+  void* p = 0;
+
+  if ( posix_memalign(&p, alignment, size) != 0 )
+    return 0;
+
+  return p;
+#endif
+}
+
+//
+static void
+default_fb_release(void* p)
+{
+#ifdef KM_WIN32
+  _aligned_free(p);
+#else
+  free(p);
+#endif
+}
+
+static const ASDCP::FrameBufferAllocator s_DefaultFBAllocator = { default_fb_allocate, default_fb_release };
+static ASDCP::FrameBufferAllocator s_FBAllocator = s_DefaultFBAllocator;
+
+//
+void
+ASDCP::SetFrameBufferAllocator(const FrameBufferAllocator* allocator)
+{
+  if ( allocator == 0 || allocator->Allocate == 0 || allocator->Release == 0 )
+    s_FBAllocator = s_DefaultFBAllocator;
+  else
+    s_FBAllocator = *allocator;
+}
+
+//
+const ASDCP::FrameBufferAllocator&
+ASDCP::GetFrameBufferAllocator()
+{
+  return s_FBAllocator;
+}
+
+
+//------------------------------------------------------------------------------------------
+//
+// frame buffer pool
+
+static const ui32_t PoolMinBlock = 4096;       // smallest size class, and the block alignment
+static const ui32_t PoolMaxShift = 30;         // no size classes at or above 1 GB
+static const ui32_t PoolStepsPerDoubling = 4;  // size classes between successive powers of two
+static const ui32_t PoolHeaderSpace = 64;      // room for the block header, and the least alignment
+
+// Stored immediately ahead of the pointer returned by Acquire(), so that
+// Release() needs no lookup. The base is the start of the underlying
+// block, which is always PoolMinBlock aligned.
+struct PoolBlockHeader
+{
+  void*  base;
+  ui32_t size_class;
+};
+
+//
+class ASDCP::FrameBufferPool::h__FrameBufferPool
+{
+  ASDCP_NO_COPY_CONSTRUCT(h__FrameBufferPool);
+  h__FrameBufferPool();
+
+public:
+  static const ui32_t NotPooled = 0xffffffff;
+
+  mutable Kumu::Mutex m_Lock;
+  std::vector<ui32_t> m_ClassSize;               // ascending block sizes
+  std::vector<std::vector<void*> > m_FreeList;   // retained block bases, by size class
+  ui64_t m_RetainLimit;
+  ui64_t m_Retained;
+  volatile ui32_t m_Outstanding;                 // blocks acquired and not yet released
+
+  h__FrameBufferPool(ui64_t retain_limit) : m_RetainLimit(retain_limit), m_Retained(0), m_Outstanding(0)
+  {
+    assert(sizeof(PoolBlockHeader) <= PoolHeaderSpace);
+
+    for ( ui32_t shift = 12; shift < PoolMaxShift; ++shift )
+      {
+	for ( ui32_t step = 0; step < PoolStepsPerDoubling; ++step )
+	  m_ClassSize.push_back((1U << shift) + step * ((1U << shift) / PoolStepsPerDoubling));
+      }
+
+    m_FreeList.resize(m_ClassSize.size());
+  }
+
+  ~h__FrameBufferPool()
+  {
+    // a block released after this point would be handed to a destroyed pool
+    ui32_t outstanding = Kumu::AtomicLoad(&m_Outstanding);
+
+    if ( outstanding != 0 )
+      DefaultLogSink().Error("FrameBufferPool destroyed with %u blocks in use.\n", outstanding);
+
+    assert(outstanding == 0);
+    Trim();
+  }
+
+  //
+  void Trim()
+  {
+    Kumu::AutoMutex Lock(m_Lock);
+
+    for ( ui32_t i = 0; i < m_FreeList.size(); ++i )
+      {
+	std::vector<void*>::iterator j;
+	for ( j = m_FreeList[i].begin(); j != m_FreeList[i].end(); ++j )
+	  default_fb_release(*j);
+
+	m_FreeList[i].clear();
+      }
+
+    m_Retained = 0;
+  }
+
+  //
+  void* Acquire(ui32_t size, ui32_t alignment)
+  {
+    ui32_t offset = Kumu::xmax(PoolHeaderSpace, alignment);
+    ui64_t block_size = (ui64_t)size + offset;
+
+    if ( block_size > 0xffffffffUL )
+      return 0;
+
+    ui32_t size_class = NotPooled;
+    void* base = 0;
+
+    if ( alignment <= PoolMinBlock )
+      {
+	std::vector<ui32_t>::const_iterator ci = std::lower_bound(m_ClassSize.begin(), m_ClassSize.end(), (ui32_t)block_size);
+
+	if ( ci != m_ClassSize.end() )
+	  size_class = (ui32_t)( ci - m_ClassSize.begin() );
+      }
+
+    if ( size_class != NotPooled )
+      {
+	Kumu::AutoMutex Lock(m_Lock);
+
+	// a block from the next class up is close enough
+	for ( ui32_t i = size_class; i < m_FreeList.size() && i < size_class + 2; ++i )
+	  {
+	    if ( ! m_FreeList[i].empty() )
+	      {
+		base = m_FreeList[i].back();
+		m_FreeList[i].pop_back();
+		m_Retained -= m_ClassSize[i];
+		size_class = i;
+		break;
+	      }
+	  }
+      }
+
+    if ( base == 0 )
+      {
+	base = default_fb_allocate(size_class == NotPooled ? (ui32_t)block_size : m_ClassSize[size_class],
+				   Kumu::xmax(PoolMinBlock, alignment));
+
+	if ( base == 0 )
+	  return 0;
+      }
+
+    Kumu::AtomicAdd(&m_Outstanding, 1);
+    byte_t* p = (byte_t*)base + offset;
+    PoolBlockHeader* header = (PoolBlockHeader*)( p - sizeof(PoolBlockHeader) );
+    header->base = base;
+    header->size_class = size_class;
+    return p;
+  }
+
+  //
+  void Release(void* p)
+  {
+    if ( p == 0 )
+      return;
+
+    const PoolBlockHeader* header = (const PoolBlockHeader*)( (byte_t*)p - sizeof(PoolBlockHeader) );
+    void* base = header->base;
+    ui32_t size_class = header->size_class;
+    assert(size_class == NotPooled || size_class < m_ClassSize.size());
+    Kumu::AtomicAdd(&m_Outstanding, (ui32_t)-1);
+
+    if ( size_class != NotPooled )
+      {
+	Kumu::AutoMutex Lock(m_Lock);
+
+	if ( m_Retained + m_ClassSize[size_class] <= m_RetainLimit )
+	  {
+	    m_FreeList[size_class].push_back(base);
+	    m_Retained += m_ClassSize[size_class];
+	    return;
+	  }
+      }
+
+    default_fb_release(base);
+  }
+};
+
+//
+ASDCP::FrameBufferPool::FrameBufferPool(ui64_t retain_limit)
+{
+  m_Pool = new h__FrameBufferPool(retain_limit);
+}
+
+ASDCP::FrameBufferPool::~FrameBufferPool() {}
+
+//
+void*
+ASDCP::FrameBufferPool::Acquire(ui32_t size, ui32_t alignment)
+{
+  return m_Pool->Acquire(size, alignment);
+}
+
+//
+void
+ASDCP::FrameBufferPool::Release(void* ptr)
+{
+  m_Pool->Release(ptr);
+}
+
+//
+void
+ASDCP::FrameBufferPool::Trim()
+{
+  m_Pool->Trim();
+}
+
+//
+ui64_t
+ASDCP::FrameBufferPool::RetainedBytes() const
+{
+  Kumu::AutoMutex Lock(m_Pool->m_Lock);
+  return m_Pool->m_Retained;
+}
+
+//
+ASDCP::FrameBufferPool&
+ASDCP::DefaultFrameBufferPool()
+{
+  // never destroyed, so that buffers released during static destruction still have a home
+  static FrameBufferPool* s_Pool = new FrameBufferPool;
+  return *s_Pool;
+}
+
+//
+static void*
+pooled_fb_allocate(ui32_t size, ui32_t alignment)
+{
+  return ASDCP::DefaultFrameBufferPool().Acquire(size, alignment);
+}
+
+//
+static void
+pooled_fb_release(void* p)
+{
+  ASDCP::DefaultFrameBufferPool().Release(p);
+}
+
+//
+const ASDCP::FrameBufferAllocator&
+ASDCP::PooledFrameBufferAllocator()
+{
+  static const FrameBufferAllocator s_PooledAllocator = { pooled_fb_allocate, pooled_fb_release };
+  return s_PooledAllocator;
+}
+
+
 //------------------------------------------------------------------------------------------
 //
 // frame buffer base class implementation
 
 ASDCP::FrameBuffer::FrameBuffer() :
-  m_Data(0), m_Capacity(0), m_OwnMem(false), m_Size(0),
+  m_Data(0), m_Capacity(0), m_OwnMem(false), m_Release(0), m_Allocator(0), m_Size(0),
   m_FrameNumber(0), m_SourceLength(0), m_PlaintextOffset(0)
 {
 }
@@ -92,7 +382,7 @@ ASDCP::FrameBuffer::FrameBuffer() :
 ASDCP::FrameBuffer::~FrameBuffer()
 {
   if ( m_OwnMem && m_Data != 0 )
-    free(m_Data);
+    m_Release(m_Data);
 }
 
 // Instructs the object to use an externally allocated buffer. The external
@@ -118,9 +408,10 @@ ASDCP::FrameBuffer::SetData(byte_t* buf_addr, ui32_t buf_size)
     }
 
   if ( m_OwnMem && m_Data != 0 )
-    free(m_Data);
+    m_Release(m_Data);
 
   m_OwnMem = false;
+  m_Release = 0;
   m_Capacity = buf_size;
   m_Data = buf_addr;
   m_Size = 0;
@@ -128,6 +419,21 @@ ASDCP::FrameBuffer::SetData(byte_t* buf_addr, ui32_t buf_size)
   return RESULT_OK;
 }
 
+// Exchanges the buffer memory and the frame properties with rhs.
+void
+ASDCP::FrameBuffer::Swap(FrameBuffer& rhs)
+{
+  std::swap(m_Data, rhs.m_Data);
+  std::swap(m_Capacity, rhs.m_Capacity);
+  std::swap(m_OwnMem, rhs.m_OwnMem);
+  std::swap(m_Release, rhs.m_Release);
+  std::swap(m_Allocator, rhs.m_Allocator);
+  std::swap(m_Size, rhs.m_Size);
+  std::swap(m_FrameNumber, rhs.m_FrameNumber);
+  std::swap(m_SourceLength, rhs.m_SourceLength);
+  std::swap(m_PlaintextOffset, rhs.m_PlaintextOffset);
+}
+
 // Sets the size of the internally allocate buffer. Returns RESULT_CAPEXTMEM
 // if the object is using an externally allocated buffer via SetData();
 // Resets content size to zero.
@@ -142,14 +448,22 @@ ASDCP::FrameBuffer::Capacity(ui32_t cap_size)
       if ( m_Data != 0 )
 	{
 	  assert(m_OwnMem);
-	  free(m_Data);
+	  m_Release(m_Data);
+	  m_Data = 0;
+	  m_Capacity = 0;
 	}
 
-      m_Data = (byte_t*)malloc(cap_size);
+      const FrameBufferAllocator& allocator = ( m_Allocator != 0 ) ? *m_Allocator : s_FBAllocator;
+      m_Data = (byte_t*)allocator.Allocate(cap_size, 0);
 
       if ( m_Data == 0 )
-	return RESULT_ALLOC;
+	{
+	  m_OwnMem = false;
+	  m_Size = 0;
+	  return RESULT_ALLOC;
+	}
 
+      m_Release = allocator.Release;
       m_Capacity = cap_size;
       m_OwnMem = true;
       m_Size = 0;
@@ -158,6 +472,63 @@ ASDCP::FrameBuffer::Capacity(ui32_t cap_size)
   return RESULT_OK;
 }
 
+// Ensures that the internally allocated buffer holds at least cap bytes,
+// growing it according to policy. Returns RESULT_CAPEXTMEM if the object
+// is using an externally allocated buffer that is too small.
+ASDCP::Result_t
+ASDCP::FrameBuffer::Reserve(ui32_t cap_size, ui32_t policy)
+{
+  if ( m_Capacity >= cap_size )
+    return RESULT_OK;
+
+  if ( ! m_OwnMem && m_Data != 0 )
+    return RESULT_CAPEXTMEM; // cannot resize external memory
+
+  ui64_t new_size = cap_size;
+
+  if ( ( policy & FBG_GEOMETRIC ) != 0 )
+    new_size = Kumu::xmax(new_size, (ui64_t)m_Capacity + ( m_Capacity >> 1 ));
+
+  ui32_t alignment = 0;
+
+  if ( ( policy & FBG_ALIGN_PAGE ) != 0 )
+    alignment = 4096;
+  else if ( ( policy & FBG_ALIGN_64 ) != 0 )
+    alignment = 64;
+
+  if ( alignment != 0 )
+    new_size = ( new_size + alignment - 1 ) & ~((ui64_t)alignment - 1);
+
+  if ( new_size > 0xffffffffUL )
+    new_size = cap_size; // growth would overflow; settle for the request
+
+  const FrameBufferAllocator& allocator = ( m_Allocator != 0 ) ? *m_Allocator : s_FBAllocator;
+  byte_t* new_data = (byte_t*)allocator.Allocate((ui32_t)new_size, alignment);
+
+  if ( new_data == 0 )
+    return RESULT_ALLOC;
+
+  bool preserve = ( policy & FBG_PRESERVE ) != 0;
+
+  if ( m_Data != 0 )
+    {
+      if ( preserve )
+	memcpy(new_data, m_Data, m_Capacity);
+
+      m_Release(m_Data);
+    }
+
+  m_Data = new_data;
+  m_Release = allocator.Release;
+  m_Capacity = (ui32_t)new_size;
+  m_OwnMem = true;
+
+  if ( ! preserve )
+    m_Size = 0;
+
+  return RESULT_OK;
+}
+
 
 //
 // end AS_DCP.cpp
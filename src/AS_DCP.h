@@ -92,7 +92,9 @@ This project depends upon the following libraries:
 #include <iosfwd>
 #include <string>
 #include <cstring>
+#include <algorithm>
 #include <list>
+#include <vector>
 
 //--------------------------------------------------------------------------------
 // common integer types
@@ -416,6 +418,46 @@ namespace ASDCP {
   // Print WriterInfo to stream, stderr by default.
   void WriterInfoDump(const WriterInfo&, FILE* = 0);
 
+  //---------------------------------------------------------------------------------
+  // essence I/O instrumentation
+  //
+  // Readers and writers accumulate the time spent in each stage of moving essence
+  // into a StageStats object passed to SetStageStats(). The object belongs to the
+  // caller and may be shared by several readers and writers, one thread at a time.
+  // Nothing is measured while no StageStats is set.
+  struct StageStats
+  {
+    enum Stage_t {
+      STAGE_FILE_READ,     // reading essence from the file
+      STAGE_KL_PARSE,      // reading and decoding packet keys and lengths
+      STAGE_INDEX_LOOKUP,  // finding a frame in the index
+      STAGE_DECRYPT,
+      STAGE_ENCRYPT,
+      STAGE_HMAC,          // calculating or checking integrity packs
+      STAGE_FILE_WRITE,    // writing essence packets to the file
+      STAGE_MAX
+    };
+
+    ui64_t Microseconds[STAGE_MAX];
+    ui64_t Bytes[STAGE_MAX];
+    ui64_t Count[STAGE_MAX];
+
+    StageStats() { Reset(); }
+    void Reset();
+
+    inline void Add(Stage_t stage, ui64_t microseconds, ui64_t bytes) {
+      Microseconds[stage] += microseconds;
+      Bytes[stage] += bytes;
+      ++Count[stage];
+    }
+
+    // Returns a short name for the stage, e.g., "file-read".
+    static const char* StageName(Stage_t);
+
+    // Print the stages that were measured to stream, stderr by default.
+    void Dump(FILE* = 0) const;
+  };
+
   //---------------------------------------------------------------------------------
   // cryptographic support
 
@@ -490,7 +532,8 @@ namespace ASDCP {
 
       // Initializes HMAC context. The key argument must point to a binary
       // key that is CBC_KEY_SIZE bytes in length. Returns error if the key
-      // argument is NULL.
+      // argument is NULL. The keyed inner and outer pad states are computed
+      // here once, so each subsequent digest only hashes its payload.
       Result_t InitKey(const byte_t* key, LabelSet_t);
 
       // Reset internal state, allows repeated cycles of Update -> Finalize
@@ -513,6 +556,18 @@ namespace ASDCP {
       // Returns error if the buf argument is NULL or if the values do ot match.
       Result_t TestHMACValue(const byte_t* buf) const;
 
+      // Calculates the HMAC of each of count buffers and tests it against the
+      // corresponding expected value. bufs[i] points to buf_lens[i] bytes of
+      // data and values[i] to HMAC_SIZE bytes. If results is not NULL it must
+      // have count elements and receives the outcome for each buffer: RESULT_OK,
+      // RESULT_HMACFAIL if the value does not match, or RESULT_PTR if bufs[i] or
+      // values[i] is NULL. Returns the first failing outcome, RESULT_PTR if an
+      // array argument is NULL, or RESULT_INIT if the context is not keyed. Does
+      // not change the state of the context, and may be called concurrently on
+      // a keyed context.
+      Result_t TestHMACValues(ui32_t count, const byte_t* const* bufs, const ui32_t* buf_lens,
+			      const byte_t* const* values, Result_t* results = 0) const;
+
       // Writes MIC key to given buffer. buf must point to a writable area of
       // memory that is at least KeyLen bytes in length. Returns error if the
       // buf argument is NULL.
@@ -526,6 +581,80 @@ namespace ASDCP {
   // following class implements essence-neutral functionality for managing a buffer
   // containing a frame of essence.
 
+  // Memory owned by FrameBuffer objects is obtained from and returned to an
+  // allocator. The default uses malloc() (or an aligned allocation when an
+  // alignment greater than 16 is requested) and free(). An application may
+  // install its own, e.g., to draw from a pool or from pinned memory. Allocate()
+  // returns 0 on failure. The alignment argument is 0 or a power of two. A
+  // buffer is always returned to the Release() function of the allocator that
+  // was installed when it was obtained, so a new allocator may be installed at
+  // any time, but the call itself is not thread-safe.
+  struct FrameBufferAllocator
+  {
+    void* (*Allocate)(ui32_t size, ui32_t alignment);
+    void  (*Release)(void* ptr);
+  };
+
+  // Installs the given allocator for all subsequent FrameBuffer allocations.
+  // Call with 0 to restore the default allocator.
+  void SetFrameBufferAllocator(const FrameBufferAllocator* allocator);
+
+  // Returns the allocator currently in use.
+  const FrameBufferAllocator& GetFrameBufferAllocator();
+
+  // A thread-safe cache of released frame buffer memory. Requests are rounded
+  // up to a size class (four classes per power of two, from 4 KB) and served
+  // from the blocks of that class that were released earlier, so a stream of
+  // frames of similar size stops calling into the system allocator. Blocks are
+  // aligned on at least 64 bytes. Released blocks are retained until
+  // retain_limit bytes are held; beyond that they are returned to the system.
+  // Requests larger than the largest class (1 GB) are not cached. A pool must
+  // outlive every block acquired from it.
+  class FrameBufferPool
+    {
+      class h__FrameBufferPool;
+      mem_ptr<h__FrameBufferPool> m_Pool;
+      ASDCP_NO_COPY_CONSTRUCT(FrameBufferPool);
+
+    public:
+      FrameBufferPool(ui64_t retain_limit = 512 * 1024 * 1024);
+      virtual ~FrameBufferPool();
+
+      // Returns a block of at least size bytes aligned on a multiple of
+      // alignment, or 0 if the memory is not available. The block must be
+      // returned with Release().
+      void* Acquire(ui32_t size, ui32_t alignment = 0);
+
+      // Returns a block obtained from Acquire() to the pool.
+      void Release(void* ptr);
+
+      // Frees all retained blocks. Blocks in use are not affected.
+      void Trim();
+
+      // Returns the number of bytes held in retained blocks.
+      ui64_t RetainedBytes() const;
+    };
+
+  // Returns the process-wide pool.
+  FrameBufferPool& DefaultFrameBufferPool();
+
+  // Returns an allocator that draws from the process-wide pool. Readers and
+  // writers use it for their internal scratch buffers; it may also be given
+  // to FrameBuffer::Allocator() or SetFrameBufferAllocator().
+  const FrameBufferAllocator& PooledFrameBufferAllocator();
+
+  // Growth policy flags for FrameBuffer::Reserve(). Combine with bitwise OR.
+  enum FrameBufferGrowth_t {
+    FBG_EXACT      = 0x00, // allocate exactly the requested size
+    FBG_GEOMETRIC  = 0x01, // allocate at least 1.5 times the current capacity
+    FBG_ALIGN_64   = 0x02, // round up to, and align on, a multiple of 64 bytes
+    FBG_ALIGN_PAGE = 0x04, // round up to, and align on, a multiple of 4096 bytes
+    FBG_PRESERVE   = 0x08  // keep the buffer contents and Size() when growing
+  };
+
+  // Policy used by readers and writers that size buffers frame-by-frame
+  const ui32_t FBG_DEFAULT = FBG_GEOMETRIC | FBG_ALIGN_64 | FBG_PRESERVE;
+
   class FrameBuffer
     {
       ASDCP_NO_COPY_CONSTRUCT(FrameBuffer);
@@ -534,6 +663,8 @@ namespace ASDCP {
       byte_t* m_Data;          // pointer to memory area containing frame data
       ui32_t  m_Capacity;      // size of memory area pointed to by m_Data
       bool    m_OwnMem;        // if false, m_Data points to externally allocated memory
+      void  (*m_Release)(void*); // returns m_Data to the allocator it came from
+      const FrameBufferAllocator* m_Allocator; // if not null, used instead of the process-wide allocator
       ui32_t  m_Size;          // size of frame data in memory area pointed to by m_Data
       ui32_t  m_FrameNumber;   // delivery-order frame number
 
@@ -563,6 +694,25 @@ namespace ASDCP {
       // Resets content size to zero.
       Result_t Capacity(ui32_t cap);
 
+      // Ensures that the internally allocated buffer holds at least cap bytes,
+      // growing it according to policy (see FrameBufferGrowth_t). Does nothing
+      // if the buffer is already large enough. With FBG_GEOMETRIC, a buffer that
+      // is sized for each frame of a variable-rate stream stops reallocating
+      // once it has seen the largest frames. Returns RESULT_CAPEXTMEM if the
+      // object is using an externally allocated buffer that is too small.
+      Result_t Reserve(ui32_t cap, ui32_t policy = FBG_DEFAULT);
+
+      // Selects the allocator used by subsequent calls to Capacity() and Reserve().
+      // Call with 0 to use the process-wide allocator. Memory already held is
+      // not affected.
+      inline void    Allocator(const FrameBufferAllocator* allocator) { m_Allocator = allocator; }
+
+      // Exchanges the buffer memory and the frame properties held by this class
+      // with those of rhs without copying the frame data. Use this to hand a
+      // frame from one stage of a pipeline to the next. Buffers that refer to
+      // external memory (see SetData()) exchange the references.
+      void Swap(FrameBuffer& rhs);
+
       // returns the size of the buffer
       inline ui32_t  Capacity() const { return m_Capacity; }
 
@@ -599,6 +749,32 @@ namespace ASDCP {
       inline ui32_t  PlaintextOffset() const { return m_PlaintextOffset; }
     };
 
+  //---------------------------------------------------------------------------------
+  // sparse frame reads
+
+  // ReadFrames() in the MXFReader classes fetches a list of frames, such as every
+  // 24th frame for a thumbnail strip or a QC sampling plan, with as few reads as
+  // it can. The frames are sorted by their position in the file and neighbours no
+  // more than SparseReadMaxGap bytes apart are fetched together, in reads of at
+  // most SparseReadMaxChunk bytes. Fetched data that is not yet needed is kept
+  // until SparseReadRetainLimit bytes are held, after which it is read again.
+  const ui32_t SparseReadMaxGap = 1 * Kumu::Megabyte;
+  const ui32_t SparseReadMaxChunk = 16 * Kumu::Megabyte;
+  const ui32_t SparseReadRetainLimit = 64 * Kumu::Megabyte;
+
+  // Receives the frames read by ReadFrames(), one call per requested frame and
+  // in the order the frames were requested.
+  class FrameReadCallback
+    {
+    public:
+      virtual ~FrameReadCallback() {}
+
+      // request_index is the position of the frame in the list given to
+      // ReadFrames(). The buffer is overwritten by the next frame. Return a
+      // failure value to stop reading; ReadFrames() will return it.
+      virtual Result_t FrameRead(ui32_t request_index, const FrameBuffer&) = 0;
+    };
+
   //---------------------------------------------------------------------------------
   // Accessors in the MXFReader and MXFWriter classes below return these types to
   // provide direct access to MXF metadata structures declared in MXF.h and Metadata.h
@@ -714,6 +890,15 @@ namespace ASDCP {
 	  // returns true.
 	  inline bool ClosedGOP() const { return m_ClosedGOP; }
 
+	  // Exchanges the buffer and all frame properties with rhs.
+	  void Swap(FrameBuffer& rhs) {
+	    ASDCP::FrameBuffer::Swap(rhs);
+	    std::swap(m_FrameType, rhs.m_FrameType);
+	    std::swap(m_TemporalOffset, rhs.m_TemporalOffset);
+	    std::swap(m_ClosedGOP, rhs.m_ClosedGOP);
+	    std::swap(m_GOPStart, rhs.m_GOPStart);
+	  }
+
 	  // Print object state to stream, include n bytes of frame data if indicated.
 	  // Default stream is stderr.
 	  void    Dump(FILE* = 0, ui32_t dump_len = 0) const;
@@ -783,10 +968,33 @@ namespace ASDCP {
 	  // error occurs.
 	  Result_t WriteFrame(const FrameBuffer&, AESEncContext* = 0, HMACContext* = 0);
 
+	  // Accumulates the time spent in each stage of writing essence into the
+	  // given StageStats, which must outlive the writer; 0 stops the collection.
+	  // Returns RESULT_INIT if the file is not open.
+	  Result_t SetStageStats(StageStats*);
+
 	  // Closes the MXF file, writing the index and revised header.
 	  Result_t Finalize();
 	};
 
+      // A group of pictures in an MPEG-2 track file, see MXFReader::FillGOPTable().
+      // Frame numbers are in transport order.
+      struct GOPInfo
+      {
+	ui32_t FirstFrame;      // the frame that starts the GOP
+	ui32_t FrameCount;
+	bool   ClosedGOP;
+      };
+
+      // A frame of a GOP read by MXFReader::ReadGOP()
+      struct GOPFrameInfo
+      {
+	ui32_t      Offset;         // of the frame's data in the GOP buffer
+	ui32_t      Size;
+	FrameType_t FrameType;
+	i8_t        TemporalOffset; // from the index table entry
+      };
+
       // A class which reads MPEG frame data from an AS-DCP format MXF file.
       class MXFReader
 	{
@@ -848,6 +1056,31 @@ namespace ASDCP {
 	  // Returns RESULT_INIT if the file is not open or RESULT_RANGE if the index is out of range.
 	  Result_t FrameType(ui32_t frame_number, FrameType_t&) const;
 
+	  // Fills the list with the GOPs of the file, in order. A GOP starts at a frame
+	  // whose index entry has the GOP start flag; only if no entry in the file has
+	  // the flag does a zero KeyFrameOffset start a GOP instead. The table is built
+	  // from the index when first needed and kept while the file is open.
+	  // Returns RESULT_INIT if the file is not open.
+	  Result_t FillGOPTable(std::vector<GOPInfo>&) const;
+
+	  // Finds the GOP that holds the given frame.
+	  // Returns RESULT_INIT if the file is not open or RESULT_RANGE if the index is out of range.
+	  Result_t FindGOP(ui32_t frame_number, GOPInfo&) const;
+
+	  // Reads every frame of the GOP that holds the given frame into the FrameBuffer,
+	  // in transport order, as one elementary stream. The frames are adjacent in the
+	  // file, so a GOP up to SparseReadMaxChunk bytes is fetched in one read. frames receives
+	  // the position, type and temporal offset of each frame; the FrameBuffer takes
+	  // the properties of the first. Decryption and HMAC are as for ReadFrame().
+	  // Returns RESULT_INIT if the file is not open, RESULT_RANGE if the index is out
+	  // of range, or RESULT_SMALLBUF if the GOP does not fit in the FrameBuffer.
+	  Result_t ReadGOP(ui32_t frame_number, FrameBuffer&, std::vector<GOPFrameInfo>& frames,
+			   AESDecContext* = 0, HMACContext* = 0) const;
+
+	  // Accumulates the time spent in each stage of reading essence into the
+	  // given StageStats, which must outlive the reader; 0 stops the collection.
+	  void     SetStageStats(StageStats*) const;
+
 	  // Print debugging information to stream
 	  void     DumpHeaderMetadata(FILE* = 0) const;
 	  void     DumpIndex(FILE* = 0) const;
@@ -931,6 +1164,10 @@ namespace ASDCP {
 	  void Dump(FILE* = 0, ui32_t dump_bytes = 0) const;
 	};
 
+      // Default size of the WAVParser read-ahead buffer. Long RF64 masters are read
+      // in runs of this size rather than one edit unit at a time.
+      const ui32_t DefaultWAVReadAheadSize = 4 * 1024 * 1024;
+
       // An object which opens and reads a WAV file.  The call to OpenRead() reads metadata from
       // the file and populates an internal AudioDescriptor object. Each subsequent call to
       // ReadFrame() reads exactly one frame from the stream into the given FrameBuffer object.
@@ -950,6 +1187,12 @@ namespace ASDCP {
 	  // ther frame rate for the MXF frame wrapping option.
 	  Result_t OpenRead(const std::string& filename, const Rational& PictureRate) const;
 
+	  // As above, but the data chunk is streamed through a read-ahead buffer of
+	  // read_ahead_size bytes (rounded to whole edit units) and each ReadFrame()
+	  // is sliced from memory. OpenRead() above uses DefaultWAVReadAheadSize.
+	  // A value of zero reads each edit unit directly from the file.
+	  Result_t OpenRead(const std::string& filename, const Rational& PictureRate, ui32_t read_ahead_size) const;
+
 	  // Fill an AudioDescriptor struct with the values from the file's header.
 	  // Returns RESULT_INIT if the file is not open.
 	  Result_t FillAudioDescriptor(AudioDescriptor&) const;
@@ -994,6 +1237,11 @@ namespace ASDCP {
 	  // error occurs.
 	  Result_t WriteFrame(const FrameBuffer&, AESEncContext* = 0, HMACContext* = 0);
 
+	  // Accumulates the time spent in each stage of writing essence into the
+	  // given StageStats, which must outlive the writer; 0 stops the collection.
+	  // Returns RESULT_INIT if the file is not open.
+	  Result_t SetStageStats(StageStats*);
+
 	  // Closes the MXF file, writing the index and revised header.
 	  Result_t Finalize();
 	};
@@ -1045,6 +1293,10 @@ namespace ASDCP {
 	  // out of range.
 	  Result_t LocateFrame(ui32_t FrameNum, Kumu::fpos_t& streamOffset, i8_t& temporalOffset, i8_t& keyFrameOffset) const;
 
+	  // Accumulates the time spent in each stage of reading essence into the
+	  // given StageStats, which must outlive the reader; 0 stops the collection.
+	  void     SetStageStats(StageStats*) const;
+
 	  // Print debugging information to stream
 	  void     DumpHeaderMetadata(FILE* = 0) const;
 	  void     DumpIndex(FILE* = 0) const;
@@ -1272,6 +1524,11 @@ namespace ASDCP {
 	  // error occurs.
 	  Result_t WriteFrame(const FrameBuffer&, AESEncContext* = 0, HMACContext* = 0);
 
+	  // Accumulates the time spent in each stage of writing essence into the
+	  // given StageStats, which must outlive the writer; 0 stops the collection.
+	  // Returns RESULT_INIT if the file is not open.
+	  Result_t SetStageStats(StageStats*);
+
 	  // Closes the MXF file, writing the index and revised header.
 	  Result_t Finalize();
 	};
@@ -1317,12 +1574,37 @@ namespace ASDCP {
 	  // out of range, or if optional decrypt or HAMC operations fail.
 	  Result_t ReadFrame(ui32_t frame_number, FrameBuffer&, AESDecContext* = 0, HMACContext* = 0) const;
 
+	  // Reads each of the listed frames into the given FrameBuffer and passes it to
+	  // the callback, in list order, using coalesced reads (see SparseReadMaxGap).
+	  // A frame may be listed more than once. The FrameBuffer must be large enough
+	  // for the largest frame, as for ReadFrame(). Returns RESULT_INIT if the file is
+	  // not open, RESULT_RANGE if a frame number is out of range (before any frame
+	  // is delivered), or the first failure from a read, decrypt, HMAC or callback.
+	  Result_t ReadFrames(const std::vector<ui32_t>& frame_numbers, FrameBuffer&, FrameReadCallback&,
+			      AESDecContext* = 0, HMACContext* = 0) const;
+
+	  // Reads length bytes of a frame's codestream, starting offset bytes in;
+	  // ReadFramePrefix() reads from the start. Fewer bytes are read if the frame
+	  // ends first, see FrameBuffer::Size(). With JP2K::CalculatePrefixLength()
+	  // this fetches only what a reduced resolution or quality decode needs.
+	  // Encrypted essence is decrypted if the AESDecContext is given and is
+	  // otherwise returned as stored. The HMAC cannot be checked on part of a
+	  // frame. Returns RESULT_INIT if the file is not open, RESULT_RANGE if the
+	  // frame number is out of range or offset is beyond the end of the frame.
+	  Result_t ReadFramePrefix(ui32_t frame_number, ui32_t length, FrameBuffer&, AESDecContext* = 0) const;
+	  Result_t ReadFrameRange(ui32_t frame_number, ui32_t offset, ui32_t length, FrameBuffer&,
+				  AESDecContext* = 0) const;
+
 	  // Using the index table read from the footer partition, lookup the frame number
 	  // and return the offset into the file at which to read that frame of essence.
 	  // Returns RESULT_INIT if the file is not open, and RESULT_FRAME if the frame number is
 	  // out of range.
 	  Result_t LocateFrame(ui32_t FrameNum, Kumu::fpos_t& streamOffset, i8_t& temporalOffset, i8_t& keyFrameOffset) const;
 
+	  // Accumulates the time spent in each stage of reading essence into the
+	  // given StageStats, which must outlive the reader; 0 stops the collection.
+	  void     SetStageStats(StageStats*) const;
+
 	  // Print debugging information to stream
 	  void     DumpHeaderMetadata(FILE* = 0) const;
 	  void     DumpIndex(FILE* = 0) const;
@@ -1386,6 +1668,11 @@ namespace ASDCP {
 	  Result_t WriteFrame(const FrameBuffer&, StereoscopicPhase_t phase,
 			      AESEncContext* = 0, HMACContext* = 0);
 
+	  // Accumulates the time spent in each stage of writing essence into the
+	  // given StageStats, which must outlive the writer; 0 stops the collection.
+	  // Returns RESULT_INIT if the file is not open.
+	  Result_t SetStageStats(StageStats*);
+
 	  // Closes the MXF file, writing the index and revised header.  Returns
 	  // RESULT_SPHASE if WriteFrame was called an odd number of times.
 	  Result_t Finalize();
@@ -1448,6 +1735,10 @@ namespace ASDCP {
 	  // out of range.
 	  Result_t LocateFrame(ui32_t FrameNum, Kumu::fpos_t& streamOffset, i8_t& temporalOffset, i8_t& keyFrameOffset) const;
 
+	  // Accumulates the time spent in each stage of reading essence into the
+	  // given StageStats, which must outlive the reader; 0 stops the collection.
+	  void     SetStageStats(StageStats*) const;
+
 	  // Print debugging information to stream
 	  void     DumpHeaderMetadata(FILE* = 0) const;
 	  void     DumpIndex(FILE* = 0) const;
@@ -1506,6 +1797,13 @@ namespace ASDCP {
 	inline const char*   MIMEType() const { return m_MIMEType.c_str(); }
 	inline void          MIMEType(const std::string& s) { m_MIMEType = s; }
 
+	// Exchanges the buffer and all resource properties with rhs.
+	void Swap(FrameBuffer& rhs) {
+	  ASDCP::FrameBuffer::Swap(rhs);
+	  std::swap_ranges(m_AssetID, m_AssetID + UUIDlen, rhs.m_AssetID);
+	  m_MIMEType.swap(rhs.m_MIMEType);
+	}
+
 	// Print debugging information to stream (stderr default)
 	void Dump(FILE* = 0, ui32_t dump_bytes = 0) const;
       };
@@ -1612,6 +1910,23 @@ namespace ASDCP {
 	  // WriteTimedTextResource()
 	  Result_t WriteAncillaryResource(const FrameBuffer&, AESEncContext* = 0, HMACContext* = 0);
 
+	  // Writes an Ancillary Resource in pieces, for resources that are not held
+	  // in memory all at once. Begin with the total length of the resource,
+	  // append exactly that many bytes in one or more calls, then end the resource.
+	  // Encryption and the HMAC are computed as the data is appended. The
+	  // conditions of WriteAncillaryResource() apply, and no other resource may be
+	  // written, nor the file finalized, while a resource is open (RESULT_STATE).
+	  // Appending more than resource_length bytes returns RESULT_RANGE; ending the
+	  // resource before all of them have been appended returns RESULT_STATE.
+	  Result_t BeginAncillaryResource(ui32_t resource_length, AESEncContext* = 0, HMACContext* = 0);
+	  Result_t AppendAncillaryResource(const byte_t* buf, ui32_t buf_len);
+	  Result_t EndAncillaryResource();
+
+	  // Accumulates the time spent in each stage of writing essence into the
+	  // given StageStats, which must outlive the writer; 0 stops the collection.
+	  // Returns RESULT_INIT if the file is not open.
+	  Result_t SetStageStats(StageStats*);
+
 	  // Closes the MXF file, writing the index and revised header.
 	  Result_t Finalize();
 	};
@@ -1671,6 +1986,24 @@ namespace ASDCP {
 	  // out of range, or if optional decrypt or HAMC operations fail.
 	  Result_t ReadAncillaryResource(const byte_t* uuid, FrameBuffer&, AESDecContext* = 0, HMACContext* = 0) const;
 
+	  // Reads the resource having the given UUID in pieces, for resources that are
+	  // not held in memory all at once. resource_length receives the number of bytes
+	  // ReadAncillaryResourceData() will return in total; read_count is zero once the
+	  // whole resource has been read. The AESDecContext and HMACContext arguments
+	  // behave as for ReadAncillaryResource(), except that the HMAC is tested by
+	  // EndReadAncillaryResource(), which requires that the whole resource was read.
+	  // Reading the timed text resource or another ancillary resource discards the
+	  // open resource, after which ReadAncillaryResourceData() and
+	  // EndReadAncillaryResource() return RESULT_STATE, as they do if the Begin fails.
+	  Result_t BeginReadAncillaryResource(const byte_t* uuid, ui32_t& resource_length,
+					      AESDecContext* = 0, HMACContext* = 0) const;
+	  Result_t ReadAncillaryResourceData(byte_t* buf, ui32_t buf_len, ui32_t& read_count) const;
+	  Result_t EndReadAncillaryResource() const;
+
+	  // Accumulates the time spent in each stage of reading essence into the
+	  // given StageStats, which must outlive the reader; 0 stops the collection.
+	  void     SetStageStats(StageStats*) const;
+
 	  // Print debugging information to stream
 	  void     DumpHeaderMetadata(FILE* = 0) const;
 	  void     DumpIndex(FILE* = 0) const;
@@ -1798,6 +2131,11 @@ namespace ASDCP {
 	  // error occurs.
 	  Result_t WriteFrame(const FrameBuffer&, AESEncContext* = 0, HMACContext* = 0);
 
+	  // Accumulates the time spent in each stage of writing essence into the
+	  // given StageStats, which must outlive the writer; 0 stops the collection.
+	  // Returns RESULT_INIT if the file is not open.
+	  Result_t SetStageStats(StageStats*);
+
 	  // Closes the MXF file, writing the index and revised header.
 	  Result_t Finalize();
 	};
@@ -1849,6 +2187,10 @@ namespace ASDCP {
 	  // out of range.
 	  Result_t LocateFrame(ui32_t FrameNum, Kumu::fpos_t& streamOffset, i8_t& temporalOffset, i8_t& keyFrameOffset) const;
 
+	  // Accumulates the time spent in each stage of reading essence into the
+	  // given StageStats, which must outlive the reader; 0 stops the collection.
+	  void     SetStageStats(StageStats*) const;
+
 	  // Print debugging information to stream
 	  void     DumpHeaderMetadata(FILE* = 0) const;
 	  void     DumpIndex(FILE* = 0) const;
@@ -1906,6 +2248,11 @@ namespace ASDCP {
 	  // error occurs.
       Result_t WriteFrame(const DCData::FrameBuffer&, AESEncContext* = 0, HMACContext* = 0);
 
+	  // Accumulates the time spent in each stage of writing essence into the
+	  // given StageStats, which must outlive the writer; 0 stops the collection.
+	  // Returns RESULT_INIT if the file is not open.
+	  Result_t SetStageStats(StageStats*);
+
 	  // Closes the MXF file, writing the index and revised header.
 	  Result_t Finalize();
 	};
@@ -1957,6 +2304,10 @@ namespace ASDCP {
 	  // out of range.
 	  Result_t LocateFrame(ui32_t FrameNum, Kumu::fpos_t& streamOffset, i8_t& temporalOffset, i8_t& keyFrameOffset) const;
 
+	  // Accumulates the time spent in each stage of reading essence into the
+	  // given StageStats, which must outlive the reader; 0 stops the collection.
+	  void     SetStageStats(StageStats*) const;
+
 	  // Print debugging information to stream
 	  void     DumpHeaderMetadata(FILE* = 0) const;
 	  void     DumpIndex(FILE* = 0) const;
@@ -251,9 +251,39 @@ static byte_t const opad_const = 0x5c;
 class HMACContext::h__HMACContext
 {
   SHA_CTX m_SHA;
+  SHA_CTX m_InnerPad;   // SHA-1 state after absorbing K XOR ipad
+  SHA_CTX m_OuterPad;   // SHA-1 state after absorbing K XOR opad
   byte_t  m_key[KeyLen];
   ASDCP_NO_COPY_CONSTRUCT(h__HMACContext);
 
+  // The keyed pad blocks are fixed for the life of the key, so hash each
+  // once here and start every digest from a copy of the resulting state.
+  void
+  InitPads()
+  {
+    byte_t ipad_buf[B_len];
+    byte_t opad_buf[B_len];
+    memset(ipad_buf, 0, B_len);
+    memcpy(ipad_buf, m_key, KeyLen);
+    memcpy(opad_buf, ipad_buf, B_len);
+
+    for ( ui32_t i = 0; i < B_len; i++ )
+      {
+	ipad_buf[i] ^= ipad_const;
+	opad_buf[i] ^= opad_const;
+      }
+
+    // H(K XOR opad, H(K XOR ipad, text))
+    //                 ^^^^^^^^^^
+    SHA1_Init(&m_InnerPad);
+    SHA1_Update(&m_InnerPad, ipad_buf, B_len);
+
+    // H(K XOR opad, H(K XOR ipad, text))
+    //   ^^^^^^^^^^
+    SHA1_Init(&m_OuterPad);
+    SHA1_Update(&m_OuterPad, opad_buf, B_len);
+  }
+
 public:
   byte_t     m_SHAValue[HMAC_SIZE];
   bool       m_Final;
@@ -270,6 +300,7 @@ public:
     // rng_buf contains two rounds, x0 and x1 (each 160 bits).
     // Use x1 per SMPTE 430-6-2006 Sec. 7.10
     memcpy(m_key, rng_buf+SHA_DIGEST_LENGTH, KeyLen);
+    InitPads();
     Reset();
   }
 
@@ -287,6 +318,7 @@ public:
     SHA1_Update(&SHA, key_nonce, KeyLen);
     SHA1_Final(sha_buf, &SHA);
     memcpy(m_key, sha_buf, KeyLen);
+    InitPads();
     Reset();
   }
 
@@ -294,20 +326,9 @@ public:
   void
   Reset()
   {
-    byte_t xor_buf[B_len];
-    memset(xor_buf, 0, B_len);
-    memcpy(xor_buf, m_key, KeyLen);
-
     memset(m_SHAValue, 0, HMAC_SIZE);
     m_Final = false;
-    SHA1_Init(&m_SHA);
-
-    // H(K XOR opad, H(K XOR ipad, text))
-    //                 ^^^^^^^^^^
-    for ( ui32_t i = 0; i < B_len; i++ )
-      xor_buf[i] ^= ipad_const;
-
-    SHA1_Update(&m_SHA, xor_buf, B_len);
+    m_SHA = m_InnerPad;
   }
 
   //
@@ -323,31 +344,34 @@ public:
   void
   Finalize()
   {
-    SHA_CTX SHA;
-    SHA1_Init(&SHA);
-
-    byte_t xor_buf[B_len];
-    memset(xor_buf, 0, B_len);
-    memcpy(xor_buf, m_key, KeyLen);
-
-    SHA1_Init(&SHA);
-
-    // H(K XOR opad, H(K XOR ipad, text))
-    //   ^^^^^^^^^^
-    for ( ui32_t i = 0; i < B_len; i++ )
-      xor_buf[i] ^= opad_const;
+    Digest(m_SHA, m_SHAValue);
+    m_Final = true;
+  }
 
-    SHA1_Update(&SHA, xor_buf, B_len);
+  // completes the digest of an inner state begun from m_InnerPad,
+  // does not modify the context
+  void
+  Digest(SHA_CTX inner, byte_t* value) const
+  {
+    SHA_CTX outer = m_OuterPad;
 
     // H(K XOR opad, H(K XOR ipad, text))
     //               ^
-    SHA1_Final(m_SHAValue, &m_SHA);
-    SHA1_Update(&SHA, m_SHAValue, HMAC_SIZE);
+    SHA1_Final(value, &inner);
+    SHA1_Update(&outer, value, HMAC_SIZE);
 
     // H(K XOR opad, H(K XOR ipad, text))
     // ^
-    SHA1_Final(m_SHAValue, &SHA);
-    m_Final = true;
+    SHA1_Final(value, &outer);
+  }
+
+  // calculates the HMAC of buf without modifying the context
+  void
+  Calculate(const byte_t* buf, ui32_t buf_len, byte_t* value) const
+  {
+    SHA_CTX inner = m_InnerPad;
+    SHA1_Update(&inner, buf, buf_len);
+    Digest(inner, value);
   }
 
   //
@@ -451,6 +475,48 @@ HMACContext::TestHMACValue(const byte_t* buf) const
 }
 
 
+//
+Result_t
+HMACContext::TestHMACValues(ui32_t count, const byte_t* const* bufs, const ui32_t* buf_lens,
+			    const byte_t* const* values, Result_t* results) const
+{
+  KM_TEST_NULL_L(bufs);
+  KM_TEST_NULL_L(buf_lens);
+  KM_TEST_NULL_L(values);
+
+  if ( m_Context.empty() )
+    return RESULT_INIT;
+
+  Result_t result = RESULT_OK;
+  byte_t hmac_buf[HMAC_SIZE];
+
+  for ( ui32_t i = 0; i < count; ++i )
+    {
+      Result_t item_result = RESULT_HMACFAIL;
+
+      if ( bufs[i] == 0 || values[i] == 0 )
+	{
+	  item_result = RESULT_PTR;
+	}
+      else
+	{
+	  m_Context->Calculate(bufs[i], buf_lens[i], hmac_buf);
+
+	  if ( memcmp(hmac_buf, values[i], HMAC_SIZE) == 0 )
+	    item_result = RESULT_OK;
+	}
+
+      if ( results != 0 )
+	results[i] = item_result;
+
+      if ( KM_FAILURE(item_result) && KM_SUCCESS(result) )
+	result = item_result;
+    }
+
+  return result;
+}
+
+
 //
 Result_t
 HMACContext::GetMICKey(byte_t* buf) const
@@ -362,6 +362,13 @@ ASDCP::ATMOS::MXFReader::FillWriterInfo(WriterInfo& Info) const
   return RESULT_INIT;
 }
 
+//
+void
+ASDCP::ATMOS::MXFReader::SetStageStats(StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
+
 //
 void
 ASDCP::ATMOS::MXFReader::DumpHeaderMetadata(FILE* stream) const
@@ -679,6 +686,17 @@ ASDCP::ATMOS::MXFWriter::WriteFrame(const DCData::FrameBuffer& FrameBuf, AESEncC
   return m_Writer->WriteFrame(FrameBuf, Ctx, HMAC);
 }
 
+//
+ASDCP::Result_t
+ASDCP::ATMOS::MXFWriter::SetStageStats(StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 ASDCP::Result_t
 ASDCP::ATMOS::MXFWriter::Finalize()
@@ -336,6 +336,13 @@ ASDCP::DCData::MXFReader::FillWriterInfo(WriterInfo& Info) const
   return RESULT_INIT;
 }
 
+//
+void
+ASDCP::DCData::MXFReader::SetStageStats(StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
+
 //
 void
 ASDCP::DCData::MXFReader::DumpHeaderMetadata(FILE* stream) const
@@ -622,6 +629,17 @@ ASDCP::DCData::MXFWriter::WriteFrame(const FrameBuffer& FrameBuf, AESEncContext*
   return m_Writer->WriteFrame(FrameBuf, Ctx, HMAC);
 }
 
+//
+ASDCP::Result_t
+ASDCP::DCData::MXFWriter::SetStageStats(StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 ASDCP::Result_t
 ASDCP::DCData::MXFWriter::Finalize()
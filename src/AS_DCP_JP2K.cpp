@@ -537,6 +537,8 @@ public:
 
   Result_t    OpenRead(const std::string&, EssenceType_t);
   Result_t    ReadFrame(ui32_t, JP2K::FrameBuffer&, AESDecContext*, HMACContext*);
+  Result_t    ReadFrames(const std::vector<ui32_t>&, JP2K::FrameBuffer&, FrameReadCallback&, AESDecContext*, HMACContext*);
+  Result_t    ReadFrameRange(ui32_t, ui32_t, ui32_t, JP2K::FrameBuffer&, AESDecContext*);
 };
 } // namespace JP2K
 } // namespace asdcp
@@ -713,6 +715,30 @@ lh__Reader::ReadFrame(ui32_t FrameNum, JP2K::FrameBuffer& FrameBuf,
   return ReadEKLVFrame(FrameNum, FrameBuf, m_Dict->ul(MDD_JPEG2000Essence), Ctx, HMAC);
 }
 
+//
+ASDCP::Result_t
+lh__Reader::ReadFrames(const std::vector<ui32_t>& frame_numbers, JP2K::FrameBuffer& FrameBuf,
+		       FrameReadCallback& Callback, AESDecContext* Ctx, HMACContext* HMAC)
+{
+  if ( ! m_File->IsOpen() )
+    return RESULT_INIT;
+
+  assert(m_Dict);
+  return ReadEKLVFrames(frame_numbers, FrameBuf, m_Dict->ul(MDD_JPEG2000Essence), Ctx, HMAC, Callback);
+}
+
+//
+ASDCP::Result_t
+lh__Reader::ReadFrameRange(ui32_t FrameNum, ui32_t offset, ui32_t length, JP2K::FrameBuffer& FrameBuf,
+			   AESDecContext* Ctx)
+{
+  if ( ! m_File->IsOpen() )
+    return RESULT_INIT;
+
+  assert(m_Dict);
+  return ReadEKLVFrameRange(FrameNum, offset, length, FrameBuf, m_Dict->ul(MDD_JPEG2000Essence), Ctx);
+}
+
 
 //
 class ASDCP::JP2K::MXFReader::h__Reader : public lh__Reader
@@ -823,6 +849,36 @@ ASDCP::JP2K::MXFReader::ReadFrame(ui32_t FrameNum, FrameBuffer& FrameBuf,
   return RESULT_INIT;
 }
 
+//
+ASDCP::Result_t
+ASDCP::JP2K::MXFReader::ReadFrames(const std::vector<ui32_t>& frame_numbers, FrameBuffer& FrameBuf,
+				   FrameReadCallback& Callback, AESDecContext* Ctx, HMACContext* HMAC) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->ReadFrames(frame_numbers, FrameBuf, Callback, Ctx, HMAC);
+
+  return RESULT_INIT;
+}
+
+//
+ASDCP::Result_t
+ASDCP::JP2K::MXFReader::ReadFramePrefix(ui32_t FrameNum, ui32_t length, FrameBuffer& FrameBuf,
+					AESDecContext* Ctx) const
+{
+  return ReadFrameRange(FrameNum, 0, length, FrameBuf, Ctx);
+}
+
+//
+ASDCP::Result_t
+ASDCP::JP2K::MXFReader::ReadFrameRange(ui32_t FrameNum, ui32_t offset, ui32_t length, FrameBuffer& FrameBuf,
+				       AESDecContext* Ctx) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->ReadFrameRange(FrameNum, offset, length, FrameBuf, Ctx);
+
+  return RESULT_INIT;
+}
+
 ASDCP::Result_t
 ASDCP::JP2K::MXFReader::LocateFrame(ui32_t FrameNum, Kumu::fpos_t& streamOffset, i8_t& temporalOffset, i8_t& keyFrameOffset) const
 {
@@ -859,6 +915,13 @@ ASDCP::JP2K::MXFReader::FillWriterInfo(WriterInfo& Info) const
   return RESULT_INIT;
 }
 
+//
+void
+ASDCP::JP2K::MXFReader::SetStageStats(StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
+
 //
 void
 ASDCP::JP2K::MXFReader::DumpHeaderMetadata(FILE* stream) const
@@ -1101,6 +1164,13 @@ ASDCP::JP2K::MXFSReader::FillWriterInfo(WriterInfo& Info) const
   return RESULT_INIT;
 }
 
+//
+void
+ASDCP::JP2K::MXFSReader::SetStageStats(StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
+
 //
 void
 ASDCP::JP2K::MXFSReader::DumpHeaderMetadata(FILE* stream) const
@@ -1402,6 +1472,17 @@ ASDCP::JP2K::MXFWriter::WriteFrame(const FrameBuffer& FrameBuf, AESEncContext* C
   return m_Writer->WriteFrame(FrameBuf, true, Ctx, HMAC);
 }
 
+//
+ASDCP::Result_t
+ASDCP::JP2K::MXFWriter::SetStageStats(StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 ASDCP::Result_t
 ASDCP::JP2K::MXFWriter::Finalize()
@@ -1607,6 +1688,17 @@ ASDCP::JP2K::MXFSWriter::WriteFrame(const FrameBuffer& FrameBuf, StereoscopicPha
   return m_Writer->WriteFrame(FrameBuf, phase, Ctx, HMAC);
 }
 
+//
+ASDCP::Result_t
+ASDCP::JP2K::MXFSWriter::SetStageStats(StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 ASDCP::Result_t
 ASDCP::JP2K::MXFSWriter::Finalize()
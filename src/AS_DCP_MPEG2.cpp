@@ -32,6 +32,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "AS_DCP_internal.h"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 
 //------------------------------------------------------------------------------------------
@@ -183,13 +184,64 @@ ASDCP::MPEG2::VideoDescriptorDump(const VideoDescriptor& VDesc, FILE* stream)
 //
 // hidden, internal implementation of MPEG2 reader
 
+// the picture coding type in bits 4 and 5 of an index entry's flags
+static ASDCP::MPEG2::FrameType_t
+frame_type_from_flags(ui8_t flags)
+{
+  switch ( ( flags >> 4 ) & 0x03 )
+    {
+    case 0:  return ASDCP::MPEG2::FRAME_I;
+    case 2:  return ASDCP::MPEG2::FRAME_P;
+    case 3:  return ASDCP::MPEG2::FRAME_B;
+    }
+
+  return ASDCP::MPEG2::FRAME_U;
+}
+
+// orders GOPs by first frame
+static bool
+gop_starts_before(ui32_t frame_number, const ASDCP::MPEG2::GOPInfo& gop)
+{
+  return frame_number < gop.FirstFrame;
+}
+
+// Appends each frame of a GOP to the GOP buffer. The frames are read straight
+// into the unused end of the GOP buffer, so no frame is copied.
+class GOPReadCallback : public ASDCP::FrameReadCallback
+{
+  ASDCP::MPEG2::FrameBuffer& m_GOPBuf;
+  std::vector<ASDCP::MPEG2::GOPFrameInfo>& m_Frames;
+
+public:
+  ASDCP::FrameBuffer m_FrameBuf;
+
+  GOPReadCallback(ASDCP::MPEG2::FrameBuffer& gop_buf, std::vector<ASDCP::MPEG2::GOPFrameInfo>& frames) :
+    m_GOPBuf(gop_buf), m_Frames(frames)
+  {
+    m_GOPBuf.Size(0);
+    m_FrameBuf.SetData(m_GOPBuf.Data(), m_GOPBuf.Capacity());
+  }
+
+  Result_t FrameRead(ui32_t request_index, const ASDCP::FrameBuffer& FrameBuf)
+  {
+    assert(FrameBuf.RoData() == m_GOPBuf.RoData() + m_GOPBuf.Size());
+    m_Frames[request_index].Offset = m_GOPBuf.Size();
+    m_Frames[request_index].Size = FrameBuf.Size();
+    m_GOPBuf.Size(m_GOPBuf.Size() + FrameBuf.Size());
+    return m_FrameBuf.SetData(m_GOPBuf.Data() + m_GOPBuf.Size(), m_GOPBuf.Capacity() - m_GOPBuf.Size());
+  }
+};
+
 class ASDCP::MPEG2::MXFReader::h__Reader : public ASDCP::h__ASDCPReader
 {
   ASDCP_NO_COPY_CONSTRUCT(h__Reader);
   h__Reader();
 
+  Result_t    BuildGOPTable();
+
 public:
   VideoDescriptor m_VDesc;        // video parameter list
+  std::vector<GOPInfo> m_GOPTable; // built by BuildGOPTable() when first needed
 
   h__Reader(const Dictionary *d, const Kumu::IFileReaderFactory& fileReaderFactory) : ASDCP::h__ASDCPReader(d, fileReaderFactory) {}
   virtual ~h__Reader() {}
@@ -198,6 +250,9 @@ public:
   Result_t    ReadFrameGOPStart(ui32_t, FrameBuffer&, AESDecContext*, HMACContext*);
   Result_t    FindFrameGOPStart(ui32_t, ui32_t&);
   Result_t    FrameType(ui32_t FrameNum, FrameType_t& type);
+  Result_t    FillGOPTable(std::vector<GOPInfo>&);
+  Result_t    FindGOP(ui32_t, GOPInfo&);
+  Result_t    ReadGOP(ui32_t, FrameBuffer&, std::vector<GOPFrameInfo>&, AESDecContext*, HMACContext*);
 };
 
 
@@ -206,6 +261,7 @@ public:
 ASDCP::Result_t
 ASDCP::MPEG2::MXFReader::h__Reader::OpenRead(const std::string& filename)
 {
+  m_GOPTable.clear();
   Result_t result = OpenMXFRead(filename);
 
   if( ASDCP_SUCCESS(result) )
@@ -306,14 +362,7 @@ ASDCP::MPEG2::MXFReader::h__Reader::ReadFrame(ui32_t FrameNum, FrameBuffer& Fram
   IndexTableSegment::IndexEntry TmpEntry;
   m_IndexAccess.Lookup(FrameNum, TmpEntry);
 
-  switch ( ( TmpEntry.Flags >> 4 ) & 0x03 )
-    {
-    case 0:  FrameBuf.FrameType(FRAME_I); break;
-    case 2:  FrameBuf.FrameType(FRAME_P); break;
-    case 3:  FrameBuf.FrameType(FRAME_B); break;
-    default: FrameBuf.FrameType(FRAME_U);
-    }
-
+  FrameBuf.FrameType(frame_type_from_flags(TmpEntry.Flags));
   FrameBuf.TemporalOffset(TmpEntry.TemporalOffset);
   FrameBuf.GOPStart(TmpEntry.Flags & 0x40 ? true : false);
   FrameBuf.ClosedGOP(TmpEntry.Flags & 0x80 ? true : false);
@@ -321,6 +370,155 @@ ASDCP::MPEG2::MXFReader::h__Reader::ReadFrame(ui32_t FrameNum, FrameBuffer& Fram
   return RESULT_OK;
 }
 
+// appends frame_num to the last GOP of the table, or starts a new GOP with it
+static void
+add_gop_frame(std::vector<ASDCP::MPEG2::GOPInfo>& gop_table, ui32_t frame_num, bool gop_start, ui8_t flags)
+{
+  if ( gop_table.empty() || gop_start )
+    {
+      ASDCP::MPEG2::GOPInfo tmp_gop;
+      tmp_gop.FirstFrame = frame_num;
+      tmp_gop.FrameCount = 0;
+      tmp_gop.ClosedGOP = ( flags & 0x80 ) ? true : false;
+      gop_table.push_back(tmp_gop);
+    }
+
+  ++gop_table.back().FrameCount;
+}
+
+// Walks the index once. A GOP starts at an entry with the GOP start flag.
+// KeyFrameOffset is only a fallback for files in which no entry has the
+// flag: writers that count it from the previous I-frame give every I-frame
+// a zero offset, and an i8_t offset wraps to zero every 256 frames. Frame
+// zero always opens the first GOP.
+ASDCP::Result_t
+ASDCP::MPEG2::MXFReader::h__Reader::BuildGOPTable()
+{
+  IndexTableSegment::IndexEntry TmpEntry;
+  std::vector<GOPInfo> offset_table;
+  bool has_gop_flags = false;
+  m_GOPTable.clear();
+
+  for ( ui32_t FrameNum = 0; FrameNum < 0xffffffffUL; ++FrameNum )
+    {
+      if ( m_VDesc.ContainerDuration != 0 && FrameNum >= m_VDesc.ContainerDuration )
+	break;
+
+      if ( ASDCP_FAILURE(m_IndexAccess.Lookup(FrameNum, TmpEntry)) )
+	break;
+
+      if ( TmpEntry.Flags & 0x40 )
+	has_gop_flags = true;
+
+      add_gop_frame(m_GOPTable, FrameNum, ( TmpEntry.Flags & 0x40 ) != 0, TmpEntry.Flags);
+
+      if ( ! has_gop_flags )
+	add_gop_frame(offset_table, FrameNum, TmpEntry.KeyFrameOffset == 0, TmpEntry.Flags);
+    }
+
+  if ( ! has_gop_flags )
+    m_GOPTable.swap(offset_table);
+
+  if ( m_GOPTable.empty() )
+    {
+      DefaultLogSink().Error("Index table has no entries.\n");
+      return RESULT_FORMAT;
+    }
+
+  return RESULT_OK;
+}
+
+//
+ASDCP::Result_t
+ASDCP::MPEG2::MXFReader::h__Reader::FillGOPTable(std::vector<GOPInfo>& gop_table)
+{
+  if ( ! m_File->IsOpen() )
+    return RESULT_INIT;
+
+  Result_t result = RESULT_OK;
+
+  if ( m_GOPTable.empty() )
+    result = BuildGOPTable();
+
+  if ( ASDCP_SUCCESS(result) )
+    gop_table = m_GOPTable;
+
+  return result;
+}
+
+//
+ASDCP::Result_t
+ASDCP::MPEG2::MXFReader::h__Reader::FindGOP(ui32_t FrameNum, GOPInfo& gop)
+{
+  if ( ! m_File->IsOpen() )
+    return RESULT_INIT;
+
+  Result_t result = RESULT_OK;
+
+  if ( m_GOPTable.empty() )
+    result = BuildGOPTable();
+
+  if ( ASDCP_FAILURE(result) )
+    return result;
+
+  std::vector<GOPInfo>::const_iterator i =
+    std::upper_bound(m_GOPTable.begin(), m_GOPTable.end(), FrameNum, gop_starts_before);
+
+  // frame zero always starts a GOP, so i is past the first entry
+  --i;
+
+  if ( FrameNum - i->FirstFrame >= i->FrameCount )
+    return RESULT_RANGE;
+
+  gop = *i;
+  return RESULT_OK;
+}
+
+//
+ASDCP::Result_t
+ASDCP::MPEG2::MXFReader::h__Reader::ReadGOP(ui32_t FrameNum, FrameBuffer& FrameBuf, std::vector<GOPFrameInfo>& frames,
+					    AESDecContext* Ctx, HMACContext* HMAC)
+{
+  assert(m_Dict);
+  GOPInfo gop;
+  Result_t result = FindGOP(FrameNum, gop);
+
+  if ( ASDCP_FAILURE(result) )
+    return result;
+
+  std::vector<ui32_t> frame_numbers;
+  IndexTableSegment::IndexEntry TmpEntry;
+  frames.resize(gop.FrameCount);
+
+  for ( ui32_t i = 0; i < gop.FrameCount; ++i )
+    {
+      frame_numbers.push_back(gop.FirstFrame + i);
+      m_IndexAccess.Lookup(gop.FirstFrame + i, TmpEntry);
+      frames[i].Offset = frames[i].Size = 0;
+      frames[i].FrameType = frame_type_from_flags(TmpEntry.Flags);
+      frames[i].TemporalOffset = TmpEntry.TemporalOffset;
+    }
+
+  GOPReadCallback callback(FrameBuf, frames);
+  result = ReadEKLVFrames(frame_numbers, callback.m_FrameBuf, m_Dict->ul(MDD_MPEG2Essence), Ctx, HMAC, callback);
+
+  if ( ASDCP_FAILURE(result) )
+    {
+      FrameBuf.Size(0);
+      return result;
+    }
+
+  FrameBuf.FrameNumber(gop.FirstFrame);
+  FrameBuf.FrameType(frames.front().FrameType);
+  FrameBuf.TemporalOffset(frames.front().TemporalOffset);
+  FrameBuf.GOPStart(true);
+  FrameBuf.ClosedGOP(gop.ClosedGOP);
+  FrameBuf.SourceLength(0);
+  FrameBuf.PlaintextOffset(0);
+
+  return RESULT_OK;
+}
+
 //------------------------------------------------------------------------------------------
 
 
@@ -482,6 +680,13 @@ ASDCP::MPEG2::MXFReader::FillWriterInfo(WriterInfo& Info) const
   return RESULT_INIT;
 }
 
+//
+void
+ASDCP::MPEG2::MXFReader::SetStageStats(StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
+
 //
 void
 ASDCP::MPEG2::MXFReader::DumpHeaderMetadata(FILE* stream) const
@@ -522,6 +727,37 @@ ASDCP::MPEG2::MXFReader::FrameType(ui32_t FrameNum, FrameType_t& type) const
   return m_Reader->FrameType(FrameNum, type);
 }
 
+//
+ASDCP::Result_t
+ASDCP::MPEG2::MXFReader::FillGOPTable(std::vector<GOPInfo>& gop_table) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->FillGOPTable(gop_table);
+
+  return RESULT_INIT;
+}
+
+//
+ASDCP::Result_t
+ASDCP::MPEG2::MXFReader::FindGOP(ui32_t FrameNum, GOPInfo& gop) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->FindGOP(FrameNum, gop);
+
+  return RESULT_INIT;
+}
+
+//
+ASDCP::Result_t
+ASDCP::MPEG2::MXFReader::ReadGOP(ui32_t FrameNum, FrameBuffer& FrameBuf, std::vector<GOPFrameInfo>& frames,
+				 AESDecContext* Ctx, HMACContext* HMAC) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->ReadGOP(FrameNum, FrameBuf, frames, Ctx, HMAC);
+
+  return RESULT_INIT;
+}
+
 
 //------------------------------------------------------------------------------------------
 
@@ -770,6 +1006,17 @@ ASDCP::MPEG2::MXFWriter::WriteFrame(const FrameBuffer& FrameBuf, AESEncContext*
   return m_Writer->WriteFrame(FrameBuf, Ctx, HMAC);
 }
 
+//
+ASDCP::Result_t
+ASDCP::MPEG2::MXFWriter::SetStageStats(StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 ASDCP::Result_t
 ASDCP::MPEG2::MXFWriter::Finalize()
@@ -105,6 +105,59 @@ ASDCP::WriterInfoDump(const WriterInfo& Info, FILE* stream)
 						 "Unknown" ) ));
 }
 
+//------------------------------------------------------------------------------------------
+//
+
+//
+void
+ASDCP::StageStats::Reset()
+{
+  memset(Microseconds, 0, sizeof(Microseconds));
+  memset(Bytes, 0, sizeof(Bytes));
+  memset(Count, 0, sizeof(Count));
+}
+
+//
+const char*
+ASDCP::StageStats::StageName(Stage_t stage)
+{
+  switch ( stage )
+    {
+    case STAGE_FILE_READ:    return "file-read";
+    case STAGE_KL_PARSE:     return "kl-parse";
+    case STAGE_INDEX_LOOKUP: return "index-lookup";
+    case STAGE_DECRYPT:      return "decrypt";
+    case STAGE_ENCRYPT:      return "encrypt";
+    case STAGE_HMAC:         return "hmac";
+    case STAGE_FILE_WRITE:   return "file-write";
+    default:                 break;
+    }
+
+  return "unknown";
+}
+
+//
+void
+ASDCP::StageStats::Dump(FILE* stream) const
+{
+  if ( stream == 0 )
+    stream = stderr;
+
+  char count_buf[IntBufferLen], bytes_buf[IntBufferLen];
+  fprintf(stream, "%-14s %10s %14s %12s %10s\n", "stage", "count", "bytes", "ms", "MB/s");
+
+  for ( ui32_t i = 0; i < STAGE_MAX; ++i )
+    {
+      if ( Count[i] == 0 )
+	continue;
+
+      double seconds = Microseconds[i] / 1000000.0;
+      fprintf(stream, "%-14s %10s %14s %12.3f %10.1f\n", StageName((Stage_t)i),
+	      ui64sz(Count[i], count_buf), ui64sz(Bytes[i], bytes_buf), seconds * 1000.0,
+	      ( Microseconds[i] == 0 ? 0.0 : Bytes[i] / seconds / 1000000.0 ));
+    }
+}
+
 //
 Result_t
 ASDCP::MD_to_WriterInfo(Identification* InfoObj, WriterInfo& Info)
@@ -478,8 +531,12 @@ ASDCP::EncryptFrameBuffer(const ASDCP::FrameBuffer& FBin, ASDCP::FrameBuffer& FB
   ASDCP_TEST_NULL(Ctx);
   FBout.Size(0);
 
-  // size the buffer
-  Result_t result = FBout.Capacity(calc_esv_length(FBin.Size(), FBin.PlaintextOffset()));
+  // size the buffer; writers reuse FBout for every frame, so let it grow geometrically
+  Result_t result = FBout.Reserve(calc_esv_length(FBin.Size(), FBin.PlaintextOffset()),
+				  FBG_GEOMETRIC | FBG_ALIGN_64);
+
+  if ( ASDCP_FAILURE(result) )
+    return result;
 
   // write the IV
   byte_t* p = FBout.Data();
@@ -607,14 +664,24 @@ ASDCP::IntegrityPack::CalcValues(const ASDCP::FrameBuffer& FB, const byte_t* Ass
 {
   ASDCP_TEST_NULL(AssetID);
   ASDCP_TEST_NULL(HMAC);
-  byte_t* p = Data;
   HMAC->Reset();
 
-  static byte_t ber_4[MXF_BER_LENGTH] = {0x83, 0, 0, 0};
-
   // update HMAC with essence data
   HMAC->Update(FB.RoData(), FB.Size());
 
+  return CalcValues(AssetID, sequence, HMAC);
+}
+
+//
+Result_t
+ASDCP::IntegrityPack::CalcValues(const byte_t* AssetID, ui32_t sequence, HMACContext* HMAC)
+{
+  ASDCP_TEST_NULL(AssetID);
+  ASDCP_TEST_NULL(HMAC);
+  byte_t* p = Data;
+
+  static byte_t ber_4[MXF_BER_LENGTH] = {0x83, 0, 0, 0};
+
   // track file ID length
   memcpy(p, ber_4, MXF_BER_LENGTH);
   *(p+3) = UUIDlen;;
@@ -659,7 +726,21 @@ ASDCP::IntegrityPack::TestValues(const ASDCP::FrameBuffer& FB, const byte_t* Ass
   ASDCP_TEST_NULL(HMAC);
 
   // find the start of the intpack
-  byte_t* p = (byte_t*)FB.RoData() + ( FB.Size() - klv_intpack_size );
+  memcpy(Data, FB.RoData() + ( FB.Size() - klv_intpack_size ), klv_intpack_size);
+
+  HMAC->Reset();
+  HMAC->Update(FB.RoData(), FB.Size() - klv_intpack_size);
+
+  return TestValues(AssetID, sequence, HMAC);
+}
+
+//
+Result_t
+ASDCP::IntegrityPack::TestValues(const byte_t* AssetID, ui32_t sequence, HMACContext* HMAC)
+{
+  ASDCP_TEST_NULL(AssetID);
+  ASDCP_TEST_NULL(HMAC);
+  byte_t* p = Data;
 
   // test the AssetID length
   if ( ! Kumu::read_test_BER(&p, UUIDlen) )
@@ -693,8 +774,7 @@ ASDCP::IntegrityPack::TestValues(const ASDCP::FrameBuffer& FB, const byte_t* Ass
         return RESULT_HMACFAIL;
 
   // test the HMAC
-  HMAC->Reset();
-  HMAC->Update(FB.RoData(), FB.Size() - HMAC_SIZE);
+  HMAC->Update(Data, klv_intpack_size - HMAC_SIZE);
   HMAC->Finalize();
 
   Result_t result = RESULT_OK;
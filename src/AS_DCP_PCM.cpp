@@ -484,6 +484,13 @@ ASDCP::PCM::MXFReader::FillWriterInfo(WriterInfo& Info) const
   return RESULT_INIT;
 }
 
+//
+void
+ASDCP::PCM::MXFReader::SetStageStats(StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
+
 //
 void
 ASDCP::PCM::MXFReader::DumpHeaderMetadata(FILE* stream) const
@@ -752,6 +759,17 @@ ASDCP::PCM::MXFWriter::WriteFrame(const FrameBuffer& FrameBuf, AESEncContext* Ct
   return m_Writer->WriteFrame(FrameBuf, Ctx, HMAC);
 }
 
+//
+ASDCP::Result_t
+ASDCP::PCM::MXFWriter::SetStageStats(StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 ASDCP::Result_t
 ASDCP::PCM::MXFWriter::Finalize()
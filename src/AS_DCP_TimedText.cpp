@@ -122,7 +122,15 @@ ASDCP::TimedText::FrameBuffer::Dump(FILE* stream, ui32_t dump_len) const
 
 //------------------------------------------------------------------------------------------
 
-typedef std::map<UUID, UUID> ResourceMap_t;
+// The location of an ancillary resource, resolved when the file is opened so that
+// each fetch needs only one seek and one read.
+struct ResourceLocation
+{
+  GenericStreamLocation Stream;
+  std::string           MIMEType;
+};
+
+typedef std::map<UUID, ResourceLocation> ResourceMap_t;
 
 class ASDCP::TimedText::MXFReader::h__Reader : public ASDCP::h__ASDCPReader
 {
@@ -133,6 +141,7 @@ class ASDCP::TimedText::MXFReader::h__Reader : public ASDCP::h__ASDCPReader
 
 public:
   TimedTextDescriptor m_TDesc;
+  EKLVPacketReader    m_ResourceReader;
 
   h__Reader(const Dictionary *d, const Kumu::IFileReaderFactory& fileReaderFactory) : ASDCP::h__ASDCPReader(d, fileReaderFactory), m_EssenceDescriptor(0) {
     memset(&m_TDesc.AssetID, 0, UUIDlen);
@@ -144,6 +153,8 @@ public:
   Result_t    MD_to_TimedText_TDesc(TimedText::TimedTextDescriptor& TDesc);
   Result_t    ReadTimedTextResource(FrameBuffer& FrameBuf, AESDecContext* Ctx, HMACContext* HMAC);
   Result_t    ReadAncillaryResource(const byte_t*, FrameBuffer& FrameBuf, AESDecContext* Ctx, HMACContext* HMAC);
+  Result_t    FindResource(const UUID&, const ResourceLocation*&);
+  Result_t    BeginReadAncillaryResource(const byte_t*, ui32_t& resource_length, AESDecContext* Ctx, HMACContext* HMAC);
 };
 
 //
@@ -169,6 +180,11 @@ ASDCP::TimedText::MXFReader::h__Reader::MD_to_TimedText_TDesc(TimedText::TimedTe
   TimedTextResourceSubDescriptor* DescObject = 0;
   Result_t result = RESULT_OK;
 
+  // index the generic stream partitions once, rather than walking the RIP per resource
+  GenericStreamMap_t stream_map;
+  IndexGenericStreamPartitions(stream_map);
+  m_ResourceMap.clear();
+
   for ( ; sdi != TDescObj->SubDescriptors.end() && KM_SUCCESS(result); sdi++ )
     {
       InterchangeObject* tmp_iobj = 0;
@@ -192,7 +208,16 @@ ASDCP::TimedText::MXFReader::h__Reader::MD_to_TimedText_TDesc(TimedText::TimedTe
 	    TmpResource.Type = MT_BIN;
 
 	  TDesc.ResourceList.push_back(TmpResource);
-	  m_ResourceMap.insert(ResourceMap_t::value_type(DescObject->AncillaryResourceID, *sdi));
+	  ResourceLocation TmpLocation;
+	  TmpLocation.MIMEType = DescObject->MIMEMediaType;
+	  GenericStreamMap_t::const_iterator si = stream_map.find(DescObject->EssenceStreamID);
+
+	  if ( si != stream_map.end() )
+	    TmpLocation.Stream = si->second;
+	  else
+	    TmpLocation.Stream.BodySID = DescObject->EssenceStreamID; // reported when read
+
+	  m_ResourceMap.insert(ResourceMap_t::value_type(DescObject->AncillaryResourceID, TmpLocation));
 	}
       else
 	{
@@ -208,6 +233,7 @@ ASDCP::TimedText::MXFReader::h__Reader::MD_to_TimedText_TDesc(TimedText::TimedTe
 ASDCP::Result_t
 ASDCP::TimedText::MXFReader::h__Reader::OpenRead(const std::string& filename)
 {
+  m_ResourceReader.Discard();
   Result_t result = OpenMXFRead(filename);
   
   if( ASDCP_SUCCESS(result) )
@@ -235,6 +261,7 @@ ASDCP::TimedText::MXFReader::h__Reader::ReadTimedTextResource(FrameBuffer& Frame
     return RESULT_INIT;
 
   assert(m_Dict);
+  m_ResourceReader.Discard();
   Result_t result = ReadEKLVFrame(0, FrameBuf, m_Dict->ul(MDD_TimedTextEssence), Ctx, HMAC);
 
  if( ASDCP_SUCCESS(result) )
@@ -252,8 +279,29 @@ ASDCP::TimedText::MXFReader::h__Reader::ReadAncillaryResource(const byte_t* uuid
 							      AESDecContext* Ctx, HMACContext* HMAC)
 {
   KM_TEST_NULL_L(uuid);
-  UUID RID(uuid);
+  const ResourceLocation* location = 0;
+  Result_t result = FindResource(UUID(uuid), location);
+
+  if ( KM_SUCCESS(result) )
+    {
+      m_ResourceReader.Discard();
+      result = ReadGenericStreamPartitionPayload(location->Stream, frame_buf, Ctx, HMAC);
+    }
+
+  if ( KM_SUCCESS(result) )
+    {
+      frame_buf.AssetID(uuid);
+      frame_buf.MIMEType(location->MIMEType);
+    }
 
+  return result;
+}
+
+
+// returns the location of the resource having the given ID
+ASDCP::Result_t
+ASDCP::TimedText::MXFReader::h__Reader::FindResource(const UUID& RID, const ResourceLocation*& location)
+{
   ResourceMap_t::const_iterator ri = m_ResourceMap.find(RID);
   if ( ri == m_ResourceMap.end() )
     {
@@ -262,27 +310,37 @@ ASDCP::TimedText::MXFReader::h__Reader::ReadAncillaryResource(const byte_t* uuid
       return RESULT_RANGE;
     }
 
-  // get the subdescriptor
-  InterchangeObject* tmp_iobj = 0;
-  Result_t result = m_HeaderPart.GetMDObjectByID((*ri).second, &tmp_iobj);
-  TimedTextResourceSubDescriptor* desc_object = dynamic_cast<TimedTextResourceSubDescriptor*>(tmp_iobj);
+  location = &ri->second;
+  return RESULT_OK;
+}
+
+//
+ASDCP::Result_t
+ASDCP::TimedText::MXFReader::h__Reader::BeginReadAncillaryResource(const byte_t* uuid, ui32_t& resource_length,
+								   AESDecContext* Ctx, HMACContext* HMAC)
+{
+  KM_TEST_NULL_L(uuid);
+  const ResourceLocation* location = 0;
+  Result_t result = FindResource(UUID(uuid), location);
+  ui64_t value_length = 0;
+  m_ResourceReader.Discard();
 
   if ( KM_SUCCESS(result) )
     {
-      assert(desc_object);
-      result = ReadGenericStreamPartitionPayload(desc_object->EssenceStreamID, frame_buf, Ctx, HMAC);
+      result = BeginGenericStreamPartitionPayload(location->Stream, m_ResourceReader,
+						  value_length, Ctx, HMAC);
     }
 
-  if ( KM_SUCCESS(result) )
+  if ( KM_SUCCESS(result) && value_length > 0xffffffffUL )
     {
-      frame_buf.AssetID(uuid);
-      frame_buf.MIMEType(desc_object->MIMEMediaType);
+      m_ResourceReader.Discard();
+      result = RESULT_FORMAT;
     }
 
+  resource_length = KM_SUCCESS(result) ? (ui32_t)value_length : 0;
   return result;
 }
 
-
 //------------------------------------------------------------------------------------------
 
 ASDCP::TimedText::MXFReader::MXFReader(const Kumu::IFileReaderFactory& fileReaderFactory)
@@ -412,6 +470,44 @@ ASDCP::TimedText::MXFReader::ReadAncillaryResource(const byte_t* uuid, FrameBuff
   return RESULT_INIT;
 }
 
+//
+ASDCP::Result_t
+ASDCP::TimedText::MXFReader::BeginReadAncillaryResource(const byte_t* uuid, ui32_t& resource_length,
+							AESDecContext* Ctx, HMACContext* HMAC) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->BeginReadAncillaryResource(uuid, resource_length, Ctx, HMAC);
+
+  return RESULT_INIT;
+}
+
+//
+ASDCP::Result_t
+ASDCP::TimedText::MXFReader::ReadAncillaryResourceData(byte_t* buf, ui32_t buf_len, ui32_t& read_count) const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->m_ResourceReader.Read(buf, buf_len, read_count);
+
+  return RESULT_INIT;
+}
+
+//
+ASDCP::Result_t
+ASDCP::TimedText::MXFReader::EndReadAncillaryResource() const
+{
+  if ( m_Reader && m_Reader->m_File->IsOpen() )
+    return m_Reader->m_ResourceReader.End();
+
+  return RESULT_INIT;
+}
+
+
+//
+void
+ASDCP::TimedText::MXFReader::SetStageStats(StageStats* stats) const
+{
+  m_Reader->m_Stats = stats;
+}
 
 //
 void
@@ -457,6 +553,7 @@ public:
   TimedTextDescriptor m_TDesc;
   byte_t              m_EssenceUL[SMPTE_UL_LENGTH];
   ui32_t              m_EssenceStreamID;
+  EKLVPacketWriter    m_ResourceWriter;
 
   h__Writer(const Dictionary *d) : ASDCP::h__ASDCPWriter(d), m_EssenceStreamID(10) {
     memset(m_EssenceUL, 0, SMPTE_UL_LENGTH);
@@ -468,6 +565,10 @@ public:
   Result_t SetSourceStream(const TimedTextDescriptor&);
   Result_t WriteTimedTextResource(const std::string& XMLDoc, AESEncContext* = 0, HMACContext* = 0);
   Result_t WriteAncillaryResource(const FrameBuffer&, AESEncContext* = 0, HMACContext* = 0);
+  Result_t BeginAncillaryResource(ui32_t resource_length, ui32_t plaintext_offset,
+				  AESEncContext* = 0, HMACContext* = 0);
+  Result_t AppendAncillaryResource(const byte_t* buf, ui32_t buf_len);
+  Result_t EndAncillaryResource();
   Result_t Finalize();
   Result_t TimedText_TDesc_to_MD(TimedText::TimedTextDescriptor& TDesc);
 };
@@ -686,7 +787,28 @@ ASDCP::Result_t
 ASDCP::TimedText::MXFWriter::h__Writer::WriteAncillaryResource(const ASDCP::TimedText::FrameBuffer& FrameBuf,
 							       ASDCP::AESEncContext* Ctx, ASDCP::HMACContext* HMAC)
 {
-  if ( ! m_State.Test_RUNNING() )
+  Result_t result = BeginAncillaryResource(FrameBuf.Size(), FrameBuf.PlaintextOffset(), Ctx, HMAC);
+
+  if ( ASDCP_SUCCESS(result) )
+    result = AppendAncillaryResource(FrameBuf.RoData(), FrameBuf.Size());
+
+  if ( m_ResourceWriter.IsOpen() )
+    {
+      Result_t end_result = EndAncillaryResource();
+
+      if ( ASDCP_SUCCESS(result) )
+	result = end_result;
+    }
+
+  return result;
+}
+
+//
+ASDCP::Result_t
+ASDCP::TimedText::MXFWriter::h__Writer::BeginAncillaryResource(ui32_t resource_length, ui32_t plaintext_offset,
+							       ASDCP::AESEncContext* Ctx, ASDCP::HMACContext* HMAC)
+{
+  if ( ! m_State.Test_RUNNING() || m_ResourceWriter.IsOpen() )
     return RESULT_STATE;
 
   Kumu::fpos_t here = m_File.TellPosition();
@@ -707,17 +829,40 @@ ASDCP::TimedText::MXFWriter::h__Writer::WriteAncillaryResource(const ASDCP::Time
   Result_t result = GSPart.WriteToFile(m_File, TmpUL);
 
   if ( ASDCP_SUCCESS(result) )
-    result = WriteEKLVPacket(FrameBuf, GenericStream_DataElement.Value(), MXF_BER_LENGTH, Ctx, HMAC);
+    result = m_ResourceWriter.Begin(m_File, *m_Dict, m_Info, GenericStream_DataElement.Value(),
+				    resource_length, plaintext_offset, m_FramesWritten + 1, Ctx, HMAC);
 
   m_FramesWritten++;
   return result;
 }
 
+//
+ASDCP::Result_t
+ASDCP::TimedText::MXFWriter::h__Writer::AppendAncillaryResource(const byte_t* buf, ui32_t buf_len)
+{
+  if ( ! m_ResourceWriter.IsOpen() )
+    return RESULT_STATE;
+
+  return m_ResourceWriter.Append(buf, buf_len);
+}
+
+//
+ASDCP::Result_t
+ASDCP::TimedText::MXFWriter::h__Writer::EndAncillaryResource()
+{
+  if ( ! m_ResourceWriter.IsOpen() )
+    return RESULT_STATE;
+
+  Result_t result = m_ResourceWriter.End();
+  m_StreamOffset += m_ResourceWriter.BytesWritten();
+  return result;
+}
+
 //
 ASDCP::Result_t
 ASDCP::TimedText::MXFWriter::h__Writer::Finalize()
 {
-  if ( ! m_State.Test_RUNNING() )
+  if ( ! m_State.Test_RUNNING() || m_ResourceWriter.IsOpen() )
     return RESULT_STATE;
   m_FramesWritten = m_TDesc.ContainerDuration;
   m_State.Goto_FINAL();
@@ -827,6 +972,47 @@ ASDCP::TimedText::MXFWriter::WriteAncillaryResource(const FrameBuffer& FrameBuf,
   return m_Writer->WriteAncillaryResource(FrameBuf, Ctx, HMAC);
 }
 
+//
+ASDCP::Result_t
+ASDCP::TimedText::MXFWriter::BeginAncillaryResource(ui32_t resource_length, AESEncContext* Ctx, HMACContext* HMAC)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  return m_Writer->BeginAncillaryResource(resource_length, 0, Ctx, HMAC);
+}
+
+//
+ASDCP::Result_t
+ASDCP::TimedText::MXFWriter::AppendAncillaryResource(const byte_t* buf, ui32_t buf_len)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  return m_Writer->AppendAncillaryResource(buf, buf_len);
+}
+
+//
+ASDCP::Result_t
+ASDCP::TimedText::MXFWriter::EndAncillaryResource()
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  return m_Writer->EndAncillaryResource();
+}
+
+//
+ASDCP::Result_t
+ASDCP::TimedText::MXFWriter::SetStageStats(StageStats* stats)
+{
+  if ( m_Writer.empty() )
+    return RESULT_INIT;
+
+  m_Writer->m_Stats = stats;
+  return RESULT_OK;
+}
+
 // Closes the MXF file, writing the index and other closing information.
 ASDCP::Result_t
 ASDCP::TimedText::MXFWriter::Finalize()
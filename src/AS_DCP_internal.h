@@ -35,6 +35,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <KM_platform.h>
 #include <KM_util.h>
 #include <KM_log.h>
+#include <KM_thread.h>
 #include "Metadata.h"
 
 using Kumu::DefaultLogSink;
@@ -177,13 +178,56 @@ extern MXF::RIP *g_RIP;
   Result_t Read_EKLV_Packet(Kumu::IFileReader& File, const ASDCP::Dictionary& Dict,
 			    const ASDCP::WriterInfo& Info, Kumu::fpos_t& LastPosition, ASDCP::FrameBuffer& CtFrameBuf,
 			    ui32_t FrameNum, ui32_t SequenceNum, ASDCP::FrameBuffer& FrameBuf,
-			    const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC);
+			    const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC,
+			    StageStats* Stats = 0);
+
+  // A frame requested from ReadFrames(). End is the position of the frame that
+  // follows it in the file, or zero if that is not known.
+  struct SparseFrameRequest
+  {
+    ui32_t       FrameNum;
+    Kumu::fpos_t Offset;
+    Kumu::fpos_t End;
+  };
+
+  // Reads the requested frames, each a single KLV packet, with coalesced reads and
+  // passes them to the callback in request order. Frames whose End is not known
+  // are read individually. See SparseReadMaxGap in AS_DCP.h.
+  Result_t Read_EKLV_Frames(Kumu::IFileReader& File, const ASDCP::Dictionary& Dict,
+			    const ASDCP::WriterInfo& Info, ASDCP::FrameBuffer& CtFrameBuf,
+			    const std::vector<SparseFrameRequest>& Requests, ASDCP::FrameBuffer& FrameBuf,
+			    const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC,
+			    FrameReadCallback& Callback, StageStats* Stats = 0);
 
   Result_t Write_EKLV_Packet(Kumu::FileWriter& File, const ASDCP::Dictionary& Dict, const MXF::OP1aHeader& HeaderPart,
 			     const ASDCP::WriterInfo& Info, ASDCP::FrameBuffer& CtFrameBuf, ui32_t& FramesWritten,
 			     ui64_t & StreamOffset, const ASDCP::FrameBuffer& FrameBuf, const byte_t* EssenceUL,
 			     const ui32_t& MinEssenceElementBerLength,
-			     AESEncContext* Ctx, HMACContext* HMAC);
+			     AESEncContext* Ctx, HMACContext* HMAC, StageStats* Stats = 0);
+
+  // Adds the time from construction to Stop() to one stage of a StageStats. Does
+  // nothing if the StageStats pointer is null. A timer destroyed without being
+  // stopped, e.g., on an error return, counts no bytes.
+  class StageTimer
+    {
+      ASDCP_NO_COPY_CONSTRUCT(StageTimer);
+      StageStats* m_Stats;
+      StageStats::Stage_t m_Stage;
+      ui64_t m_Start;
+
+    public:
+      StageTimer(StageStats* stats, StageStats::Stage_t stage) :
+	m_Stats(stats), m_Stage(stage), m_Start(stats ? Kumu::MonotonicMicroseconds() : 0) {}
+      ~StageTimer() { Stop(0); }
+
+      inline void Stop(ui64_t bytes) {
+	if ( m_Stats != 0 )
+	  {
+	    m_Stats->Add(m_Stage, Kumu::MonotonicMicroseconds() - m_Start, bytes);
+	    m_Stats = 0;
+	  }
+      }
+    };
 
   //
  class KLReader : public ASDCP::KLVPacket
@@ -202,6 +246,153 @@ extern MXF::RIP *g_RIP;
       Result_t ReadKLFromFile(Kumu::IFileReader& Reader);
     };
 
+  // Presents a chunk of file data held in memory as an IFileReader. Positions
+  // are file positions, so the packet reader can be used unchanged on any packet
+  // contained in the chunk. Read() may copy into the chunk itself, towards its
+  // start, which lets a packet be unpacked in the buffer it was read into.
+  class ChunkReader : public Kumu::IFileReader
+    {
+      ASDCP_NO_COPY_CONSTRUCT(ChunkReader);
+
+      const byte_t*        m_Data;
+      ui32_t               m_Length;
+      Kumu::fpos_t         m_Base;
+      mutable Kumu::fpos_t m_Position;
+
+    public:
+      ChunkReader() : m_Data(0), m_Length(0), m_Base(0), m_Position(0) {}
+      virtual ~ChunkReader() {}
+
+      void SetChunk(const byte_t* data, ui32_t length, const Kumu::fpos_t& base);
+
+      virtual Result_t OpenRead(const std::string&) const { return Kumu::RESULT_NOTIMPL; }
+      virtual Result_t Close() const { return RESULT_OK; }
+      virtual int64_t  Size() const { return m_Base + m_Length; }
+      virtual bool     IsOpen() const { return m_Data != 0; }
+      virtual Result_t Seek(Kumu::fpos_t position = 0, Kumu::SeekPos_t whence = Kumu::SP_BEGIN) const;
+      virtual Result_t Tell(Kumu::fpos_t* position) const;
+      virtual Result_t Read(byte_t* buf, ui32_t buf_len, ui32_t* read_count = 0) const;
+    };
+
+  // The location of a Generic Stream Partition, from the RIP. Length is the distance
+  // to the next partition and Sequence is the value needed to complete the HMAC. A
+  // Length of zero means that BodySID was not found.
+  struct GenericStreamLocation
+  {
+    ui32_t       BodySID;
+    Kumu::fpos_t Offset;
+    ui64_t       Length;
+    ui32_t       Sequence;
+
+    GenericStreamLocation() : BodySID(0), Offset(0), Length(0), Sequence(0) {}
+  };
+
+  typedef std::map<ui32_t, GenericStreamLocation> GenericStreamMap_t;
+
+  // Writes a plaintext or encrypted KLV packet in pieces, for essence that need not
+  // be held in memory all at once. The source length must be known when the packet
+  // is begun. Encryption and the integrity pack are computed as data is appended,
+  // and the packet is identical to the one Write_EKLV_Packet() would write.
+  class EKLVPacketWriter
+    {
+      ASDCP_NO_COPY_CONSTRUCT(EKLVPacketWriter);
+
+      Kumu::FileWriter*  m_File;
+      const WriterInfo*  m_Info;
+      AESEncContext*     m_Ctx;
+      HMACContext*       m_HMAC;
+      ui32_t             m_Sequence;
+      ui32_t             m_SourceLength;
+      ui32_t             m_PlaintextOffset;
+      ui32_t             m_Appended;
+      ui64_t             m_BytesWritten;
+      byte_t             m_Carry[CBC_BLOCK_SIZE]; // plaintext awaiting a whole block
+      ui32_t             m_CarryLength;
+      ASDCP::FrameBuffer m_Scratch;
+      bool               m_Open;
+
+      Result_t WriteESV(const byte_t* buf, ui32_t buf_len);
+      Result_t EncryptAndWrite(const byte_t* buf, ui32_t buf_len);
+
+    public:
+      EKLVPacketWriter();
+      ~EKLVPacketWriter() {}
+
+      inline bool   IsOpen() const { return m_Open; }
+      inline ui64_t BytesWritten() const { return m_BytesWritten; } // including key and length
+
+      // Writes the packet key, length and, if the essence is encrypted, the triplet
+      // header. The sequence number is the one recorded in the integrity pack.
+      Result_t Begin(Kumu::FileWriter& File, const ASDCP::Dictionary& Dict, const ASDCP::WriterInfo& Info,
+		     const byte_t* EssenceUL, ui32_t source_length, ui32_t plaintext_offset,
+		     ui32_t sequence, AESEncContext* Ctx, HMACContext* HMAC);
+
+      // Fails with RESULT_RANGE if more than the source length would be written.
+      Result_t Append(const byte_t* buf, ui32_t buf_len);
+
+      // Completes the packet. Fails with RESULT_STATE if fewer than the source
+      // length bytes were appended.
+      Result_t End();
+    };
+
+  // Reads a plaintext or encrypted KLV packet in pieces. If the packet is encrypted
+  // and a decryption context is given, the plaintext is returned and the integrity
+  // pack is tested by End(); otherwise the packet value is returned as it is stored,
+  // as Read_EKLV_Packet() does.
+  class EKLVPacketReader
+    {
+      ASDCP_NO_COPY_CONSTRUCT(EKLVPacketReader);
+
+      Kumu::IFileReader* m_File;
+      const WriterInfo*  m_Info;
+      AESDecContext*     m_Ctx;
+      HMACContext*       m_HMAC;
+      ui32_t             m_Sequence;
+      bool               m_Decrypt;
+      ui64_t             m_Remaining;      // bytes yet to be returned to the caller
+      ui32_t             m_PlaintextLeft;  // unencrypted prefix bytes yet to be read
+      ui32_t             m_BlocksLeft;     // whole ciphertext block bytes yet to be read
+      ui32_t             m_LastBlockDiff;  // source bytes in the padded last block
+      bool               m_LastBlockRead;
+      byte_t             m_Pending[CBC_BLOCK_SIZE]; // decrypted bytes not yet returned
+      ui32_t             m_PendingStart;
+      ui32_t             m_PendingEnd;
+      ASDCP::FrameBuffer m_Scratch;
+      bool               m_Open;
+
+      Result_t ReadAndHash(byte_t* buf, ui32_t buf_len);
+      Result_t DecryptBlocks(byte_t* buf, ui32_t buf_len);
+      Result_t ReadLastBlock();
+
+    public:
+      EKLVPacketReader();
+      ~EKLVPacketReader() {}
+
+      inline bool IsOpen() const { return m_Open; }
+
+      // Reads the packet key, length and, if encrypted, the triplet header from the
+      // current file position. value_length receives the number of bytes Read() will
+      // return in total.
+      Result_t Begin(Kumu::IFileReader& File, const ASDCP::Dictionary& Dict, const ASDCP::WriterInfo& Info,
+		     const byte_t* EssenceUL, ui32_t sequence, AESDecContext* Ctx, HMACContext* HMAC,
+		     ui64_t& value_length);
+
+      // Returns up to buf_len bytes of the value. read_count is zero at the end.
+      Result_t Read(byte_t* buf, ui32_t buf_len, ui32_t& read_count);
+
+      // Passes over count bytes of the value without returning them. End() will
+      // not test the integrity pack once part of the value has been skipped.
+      Result_t Skip(ui64_t count);
+
+      // Tests the integrity pack if one is present and an HMAC context was given,
+      // which requires that the whole value has been read.
+      Result_t End();
+
+      // Closes the packet without testing the integrity pack. Use before moving the
+      // file position elsewhere; Read(), Skip() and End() then return RESULT_STATE.
+      inline void Discard() { m_Open = false; }
+    };
+
   namespace MXF
   {
       //---------------------------------------------------------------------------------
@@ -224,12 +415,14 @@ extern MXF::RIP *g_RIP;
 	WriterInfo         m_Info;
 	ASDCP::FrameBuffer m_CtFrameBuf;
 	Kumu::fpos_t       m_LastPosition;
+	StageStats*        m_Stats;  // not owned, may be null
 
       TrackFileReader(const Dictionary* d, const Kumu::IFileReaderFactory& fileReaderFactory) :
-	m_HeaderPart(m_Dict), m_IndexAccess(m_Dict), m_RIP(m_Dict), m_Dict(d)
+	m_HeaderPart(m_Dict), m_IndexAccess(m_Dict), m_RIP(m_Dict), m_Dict(d), m_Stats(0)
 	  {
 	    default_md_object_init();
 	    m_File = fileReaderFactory.CreateFileReader();
+	    m_CtFrameBuf.Allocator(&PooledFrameBufferAllocator());
 	  }
 
 	virtual ~TrackFileReader() {
@@ -319,6 +512,7 @@ extern MXF::RIP *g_RIP;
 	{
 	  // look up frame index node
 	  IndexTableSegment::IndexEntry TmpEntry;
+	  StageTimer lookup_timer(m_Stats, StageStats::STAGE_INDEX_LOOKUP);
 
 	  if ( KM_FAILURE(m_IndexAccess.Lookup(FrameNum, TmpEntry)) )
 	    {
@@ -326,6 +520,8 @@ extern MXF::RIP *g_RIP;
 	      return RESULT_RANGE;
 	    }
 
+	  lookup_timer.Stop(0);
+
 	  // get relative frame position, apply offset and go read the frame's key and length
 	  Kumu::fpos_t FilePosition = body_offset + TmpEntry.StreamOffset;
 	  Result_t result = RESULT_OK;
@@ -349,6 +545,7 @@ extern MXF::RIP *g_RIP;
 	{
 	  // look up frame index node
 	  IndexTableSegment::IndexEntry TmpEntry;
+	  StageTimer lookup_timer(m_Stats, StageStats::STAGE_INDEX_LOOKUP);
 
 	  if ( KM_FAILURE(m_IndexAccess.Lookup(FrameNum, TmpEntry)) )
 	    {
@@ -356,6 +553,8 @@ extern MXF::RIP *g_RIP;
 	      return RESULT_RANGE;
 	    }
 
+	  lookup_timer.Stop(0);
+
 	  // get absolute frame position and go read the frame's key and length
 	  Result_t result = RESULT_OK;
 
@@ -371,13 +570,112 @@ extern MXF::RIP *g_RIP;
 	  return result;
 	}
 
+	// Reads the listed frames with Read_EKLV_Frames(). Positions are found as for
+	// ReadEKLVFrame(), body_offset being zero when the index entries are absolute.
+	// The end of each frame is taken from the index entry of the next frame if
+	// that is less than frame_limit.
+	Result_t ReadEKLVFrames(const ui64_t& body_offset, ui32_t frame_limit,
+				const std::vector<ui32_t>& frame_numbers, ASDCP::FrameBuffer& FrameBuf,
+				const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC,
+				FrameReadCallback& Callback)
+	{
+	  std::vector<SparseFrameRequest> requests(frame_numbers.size());
+	  IndexTableSegment::IndexEntry TmpEntry;
+	  StageTimer lookup_timer(m_Stats, StageStats::STAGE_INDEX_LOOKUP);
+
+	  for ( ui32_t i = 0; i < frame_numbers.size(); ++i )
+	    {
+	      if ( KM_FAILURE(m_IndexAccess.Lookup(frame_numbers[i], TmpEntry)) )
+		{
+		  DefaultLogSink().Error("Frame value out of range: %u\n", frame_numbers[i]);
+		  return RESULT_RANGE;
+		}
+
+	      requests[i].FrameNum = frame_numbers[i];
+	      requests[i].Offset = body_offset + TmpEntry.StreamOffset;
+	      requests[i].End = 0;
+
+	      if ( frame_numbers[i] + 1 < frame_limit
+		   && KM_SUCCESS(m_IndexAccess.Lookup(frame_numbers[i] + 1, TmpEntry)) )
+		requests[i].End = body_offset + TmpEntry.StreamOffset;
+	    }
+
+	  lookup_timer.Stop(0);
+	  m_LastPosition = 0; // the next frame read must seek
+	  assert(m_Dict);
+	  return Read_EKLV_Frames(*m_File, *m_Dict, m_Info, m_CtFrameBuf, requests, FrameBuf,
+				  EssenceUL, Ctx, HMAC, Callback, m_Stats);
+	}
+
+	// Reads length bytes of a frame's value, starting offset bytes in, positioning
+	// the file as ReadEKLVFrame() does. Fewer bytes are read if the value ends
+	// first. Encrypted essence is decrypted if Ctx is given and is otherwise read
+	// as stored; the integrity pack is not tested.
+	Result_t ReadEKLVFrameRange(const ui64_t& body_offset, ui32_t FrameNum, ui32_t offset, ui32_t length,
+				    ASDCP::FrameBuffer& FrameBuf, const byte_t* EssenceUL, AESDecContext* Ctx)
+	{
+	  IndexTableSegment::IndexEntry TmpEntry;
+
+	  if ( KM_FAILURE(m_IndexAccess.Lookup(FrameNum, TmpEntry)) )
+	    {
+	      DefaultLogSink().Error("Frame value out of range: %u\n", FrameNum);
+	      return RESULT_RANGE;
+	    }
+
+	  m_LastPosition = 0; // the file is left inside the packet
+	  EKLVPacketReader packet_reader;
+	  ui64_t value_length = 0;
+	  Result_t result = m_File->Seek(body_offset + TmpEntry.StreamOffset);
+
+	  if ( KM_SUCCESS(result) )
+	    result = packet_reader.Begin(*m_File, *m_Dict, m_Info, EssenceUL, FrameNum + 1, Ctx, 0, value_length);
+
+	  if ( KM_SUCCESS(result) && offset > value_length )
+	    {
+	      DefaultLogSink().Error("Offset %u is beyond the end of frame %u.\n", offset, FrameNum);
+	      result = RESULT_RANGE;
+	    }
+
+	  if ( KM_SUCCESS(result) )
+	    {
+	      length = (ui32_t)Kumu::xmin<ui64_t>(length, value_length - offset);
+
+	      if ( FrameBuf.Capacity() < length )
+		{
+		  DefaultLogSink().Error("FrameBuf.Capacity: %u FrameLength: %u\n", FrameBuf.Capacity(), length);
+		  result = RESULT_SMALLBUF;
+		}
+	    }
+
+	  if ( KM_SUCCESS(result) )
+	    result = packet_reader.Skip(offset);
+
+	  ui32_t read_count = 0;
+
+	  if ( KM_SUCCESS(result) )
+	    result = packet_reader.Read(FrameBuf.Data(), length, read_count);
+
+	  if ( KM_SUCCESS(result) && read_count != length )
+	    result = RESULT_READFAIL;
+
+	  if ( KM_SUCCESS(result) )
+	    {
+	      FrameBuf.Size(read_count);
+	      FrameBuf.FrameNumber(FrameNum);
+	      FrameBuf.SourceLength(0);
+	      FrameBuf.PlaintextOffset(0);
+	    }
+
+	  return result;
+	}
+
 	// reads from current position
 	Result_t ReadEKLVPacket(ui32_t FrameNum, ui32_t SequenceNum, ASDCP::FrameBuffer& FrameBuf,
 				const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC)
 	{
 	  assert(m_Dict);
       return Read_EKLV_Packet(*m_File, *m_Dict, m_Info, m_LastPosition, m_CtFrameBuf,
-				  FrameNum, SequenceNum, FrameBuf, EssenceUL, Ctx, HMAC);
+				  FrameNum, SequenceNum, FrameBuf, EssenceUL, Ctx, HMAC, m_Stats);
 	}
 
 	//
@@ -402,6 +700,7 @@ extern MXF::RIP *g_RIP;
 	{
 	  // look up frame index node
 	  IndexTableSegment::IndexEntry TmpEntry;
+	  StageTimer lookup_timer(m_Stats, StageStats::STAGE_INDEX_LOOKUP);
 
 	  if ( KM_FAILURE(m_IndexAccess.Lookup(FrameNum, TmpEntry)) )
 	    {
@@ -409,6 +708,8 @@ extern MXF::RIP *g_RIP;
 	      return RESULT_RANGE;
 	    }
 
+	  lookup_timer.Stop(0);
+
 	  // get frame position, temporal offset, and key frame ofset
 	  streamOffset = body_offset + TmpEntry.StreamOffset;
 	  temporalOffset = TmpEntry.TemporalOffset;
@@ -417,73 +718,192 @@ extern MXF::RIP *g_RIP;
 	  return RESULT_OK;
 	}
 
+	// Indexes every partition in the RIP that can hold a Generic Stream payload,
+	// by BodySID, in a single pass. Where a SID appears more than once, the first
+	// partition is indexed.
+	void IndexGenericStreamPartitions(GenericStreamMap_t& stream_map) const
+	{
+	  ui32_t sequence = 0;
+	  stream_map.clear();
+
+	  ASDCP::MXF::RIP::const_pair_iterator i, next;
+	  for ( i = m_RIP.PairArray.begin(); i != m_RIP.PairArray.end(); i = next )
+	    {
+	      next = i;
+	      ++next;
+
+	      if ( i->BodySID == 0 )
+		continue;
+
+	      // Count the sequence length in because this is the sequence
+	      // value needed to complete the HMAC.
+	      ++sequence;
+
+	      if ( next != m_RIP.PairArray.end() && stream_map.find(i->BodySID) == stream_map.end() )
+		{
+		  GenericStreamLocation& location = stream_map[i->BodySID];
+		  location.BodySID = i->BodySID;
+		  location.Offset = i->ByteOffset;
+		  location.Length = next->ByteOffset - i->ByteOffset;
+		  location.Sequence = sequence;
+		}
+	    }
+	}
+
+	// Finds the Generic Stream Partition having the given SID. Returns RESULT_NOT_FOUND
+	// if the SID is not present in the RIP.
+	Result_t LocateGenericStreamPartition(const ui32_t sid, GenericStreamLocation& location) const
+	{
+	  GenericStreamMap_t stream_map;
+	  IndexGenericStreamPartitions(stream_map);
+	  GenericStreamMap_t::const_iterator i = stream_map.find(sid);
+
+	  if ( i == stream_map.end() )
+	    {
+	      DefaultLogSink().Error("Body SID not found: %u.\n", sid);
+	      return RESULT_NOT_FOUND;
+	    }
+
+	  location = i->second;
+	  return RESULT_OK;
+	}
+
+	// Positions the file at the payload of the given Generic Stream Partition. Returns
+	// RESULT_NOT_FOUND if the location is empty, or RESULT_FORMAT if the actual partition
+	// at the offset does not have a matching BodySID value.
+	Result_t SeekGenericStreamPartitionPayload(const GenericStreamLocation& location)
+	{
+	  if ( location.Length == 0 )
+	    {
+	      DefaultLogSink().Error("Body SID not found: %u.\n", location.BodySID);
+	      return RESULT_NOT_FOUND;
+	    }
+
+	  m_LastPosition = 0; // the next frame read must seek
+
+	  // Read the Partition header, leaving the file at the payload.
+	  Result_t result = m_File->Seek(location.Offset);
+
+	  if ( KM_SUCCESS(result) )
+	    {
+	      // read the partition header
+	      ASDCP::MXF::Partition GSPart(m_Dict);
+	      result = GSPart.InitFromFile(*m_File);
+
+	      // check the SID
+	      if ( KM_SUCCESS(result) && GSPart.BodySID != location.BodySID )
+		{
+		  DefaultLogSink().Error("Generic stream partition Body SID differs: %u\n", location.BodySID);
+		  result = RESULT_FORMAT;
+		}
+	    }
+
+	  return result;
+	}
+
 	// Reads a Generic Stream Partition payload. Returns RESULT_FORMAT if the SID is
 	// not present in the  RIP, or if the actual partition at ByteOffset does not have
 	// a matching BodySID value. Encryption is not currently supported.
 	Result_t ReadGenericStreamPartitionPayload(const ui32_t sid, ASDCP::FrameBuffer& frame_buf,
 						   AESDecContext* Ctx, HMACContext* HMAC)
 	{
-	  Kumu::fpos_t start_offset = 0, end_offset = 0;
-	  ui32_t sequence = 0;
+	  GenericStreamLocation location;
+	  Result_t result = LocateGenericStreamPartition(sid, location);
 
-	  // locate SID, record the offset
-	  // Count the sequence length in because this is the sequence
-	  // value needed to  complete the HMAC.
-	  ASDCP::MXF::RIP::const_pair_iterator i;
-	  for ( i = m_RIP.PairArray.begin(); i != m_RIP.PairArray.end(); ++i)
+	  if ( KM_SUCCESS(result) )
 	    {
-              if ( sid == i->BodySID )
-                {
-                  assert( start_offset == 0);
-                  start_offset = i->ByteOffset;
-                }
-              else if ( start_offset != 0 )
-                {
-                  end_offset = i->ByteOffset;
-                  break;
-                }
-
-              if ( i->BodySID > 0 )
-                {
-                  ++sequence;
-                }
+	      result = ReadGenericStreamPartitionPayload(location, frame_buf, Ctx, HMAC);
 	    }
 
-	  if ( start_offset == 0 || end_offset == 0 )
+	  return result;
+	}
+
+	// Reads the payload of the given Generic Stream Partition. The whole partition
+	// is fetched with one read into frame_buf and the payload is unpacked in place.
+	Result_t ReadGenericStreamPartitionPayload(const GenericStreamLocation& location, ASDCP::FrameBuffer& frame_buf,
+						   AESDecContext* Ctx, HMACContext* HMAC)
+	{
+	  if ( location.Length == 0 )
 	    {
-	      DefaultLogSink().Error("Body SID not found: %d.\n", sid);
+	      DefaultLogSink().Error("Body SID not found: %u.\n", location.BodySID);
 	      return RESULT_NOT_FOUND;
 	    }
 
-	  // Read the Partition header and then read the payload.
-	  Result_t result = m_File->Seek(start_offset);
+	  if ( location.Length > 0xffffffffUL )
+	    {
+	      DefaultLogSink().Error("Generic stream partition is too large: %u\n", location.BodySID);
+	      return RESULT_FORMAT;
+	    }
+
+	  m_LastPosition = 0; // the next frame read must seek
+	  ui32_t read_count = 0;
+	  Result_t result = frame_buf.Capacity((ui32_t)location.Length);
 
 	  if ( KM_SUCCESS(result) )
 	    {
-	      result = frame_buf.Capacity(end_offset-start_offset);
+	      result = m_File->Seek(location.Offset);
 	    }
-    
+
 	  if ( KM_SUCCESS(result) )
 	    {
-	      // read the partition header
+	      result = m_File->Read(frame_buf.Data(), (ui32_t)location.Length, &read_count);
+	    }
+
+	  if ( KM_SUCCESS(result) )
+	    {
+	      // the packet is copied towards the start of the buffer as it is read
+	      ChunkReader partition_reader;
+	      partition_reader.SetChunk(frame_buf.RoData(), read_count, location.Offset);
 	      ASDCP::MXF::Partition GSPart(m_Dict);
-          result = GSPart.InitFromFile(*m_File);
+	      result = GSPart.InitFromFile(partition_reader);
+
+	      // check the SID
+	      if ( KM_SUCCESS(result) && GSPart.BodySID != location.BodySID )
+		{
+		  DefaultLogSink().Error("Generic stream partition Body SID differs: %u\n", location.BodySID);
+		  result = RESULT_FORMAT;
+		}
 
 	      if ( KM_SUCCESS(result) )
 		{
-		  // check the SID
-		  if ( GSPart.BodySID != sid )
-		    {
-		      DefaultLogSink().Error("Generic stream partition Body SID differs: %s\n", sid);
-		      result = RESULT_FORMAT;
-		    }
-		  else
-		    {
-		      result = ReadEKLVPacket(0, sequence, frame_buf, m_Dict->ul(MDD_GenericStream_DataElement), Ctx, HMAC);
-		    }
+		  Kumu::fpos_t tmp_position = 0;
+		  result = Read_EKLV_Packet(partition_reader, *m_Dict, m_Info, tmp_position, m_CtFrameBuf,
+					    0, location.Sequence, frame_buf, m_Dict->ul(MDD_GenericStream_DataElement),
+					    Ctx, HMAC, m_Stats);
 		}
 	    }
-  
+
+	  return result;
+	}
+
+	// Begins reading a Generic Stream Partition payload in pieces with the given
+	// packet reader. See SeekGenericStreamPartitionPayload() for error values.
+	Result_t BeginGenericStreamPartitionPayload(const ui32_t sid, EKLVPacketReader& packet_reader,
+						    ui64_t& value_length, AESDecContext* Ctx, HMACContext* HMAC)
+	{
+	  GenericStreamLocation location;
+	  Result_t result = LocateGenericStreamPartition(sid, location);
+
+	  if ( KM_SUCCESS(result) )
+	    {
+	      result = BeginGenericStreamPartitionPayload(location, packet_reader, value_length, Ctx, HMAC);
+	    }
+
+	  return result;
+	}
+
+	//
+	Result_t BeginGenericStreamPartitionPayload(const GenericStreamLocation& location, EKLVPacketReader& packet_reader,
+						    ui64_t& value_length, AESDecContext* Ctx, HMACContext* HMAC)
+	{
+	  Result_t result = SeekGenericStreamPartitionPayload(location);
+
+	  if ( KM_SUCCESS(result) )
+	    {
+	      result = packet_reader.Begin(*m_File, *m_Dict, m_Info, m_Dict->ul(MDD_GenericStream_DataElement),
+					   location.Sequence, Ctx, HMAC, value_length);
+	    }
+
 	  return result;
 	}
 
@@ -622,6 +1042,7 @@ extern MXF::RIP *g_RIP;
 	ASDCP::FrameBuffer m_CtFrameBuf;
 	h__WriterState     m_State;
 	WriterInfo         m_Info;
+	StageStats*        m_Stats;  // not owned, may be null
 
 	typedef std::list<ui64_t*> DurationElementList_t;
 	DurationElementList_t m_DurationUpdateList;
@@ -629,9 +1050,10 @@ extern MXF::RIP *g_RIP;
       TrackFileWriter(const Dictionary *d) :
 	m_Dict(d), m_HeaderSize(0), m_HeaderPart(m_Dict), m_RIP(m_Dict),
 	  m_MaterialPackage(0), m_FilePackage(0), m_ContentStorage(0),
-	  m_EssenceDescriptor(0), m_FramesWritten(0), m_StreamOffset(0)
+	  m_EssenceDescriptor(0), m_FramesWritten(0), m_StreamOffset(0), m_Stats(0)
 	  {
 	    default_md_object_init();
+	    m_CtFrameBuf.Allocator(&PooledFrameBufferAllocator());
 	  }
 
 	virtual ~TrackFileWriter() {
@@ -897,7 +1319,7 @@ extern MXF::RIP *g_RIP;
           ui64_t streamOffset = m_StreamOffset;
 		  result = Write_EKLV_Packet(m_File, *m_Dict, m_HeaderPart, m_Info, m_CtFrameBuf, m_FramesWritten,
                          streamOffset, frame_buffer, GenericStream_DataElement.Value(),
-					     MXF_BER_LENGTH, enc, hmac);
+					     MXF_BER_LENGTH, enc, hmac, m_Stats);
 		}
 	    }
 
@@ -939,6 +1361,11 @@ extern MXF::RIP *g_RIP;
       Result_t OpenMXFRead(const std::string& filename);
       Result_t ReadEKLVFrame(ui32_t FrameNum, ASDCP::FrameBuffer& FrameBuf,
 			     const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC);
+      Result_t ReadEKLVFrames(const std::vector<ui32_t>& frame_numbers, ASDCP::FrameBuffer& FrameBuf,
+			      const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC,
+			      FrameReadCallback& Callback);
+      Result_t ReadEKLVFrameRange(ui32_t FrameNum, ui32_t offset, ui32_t length, ASDCP::FrameBuffer& FrameBuf,
+				  const byte_t* EssenceUL, AESDecContext* Ctx);
       Result_t LocateFrame(ui32_t FrameNum, Kumu::fpos_t& streamOffset,
                            i8_t& temporalOffset, i8_t& keyFrameOffset);
     };
@@ -985,6 +1412,11 @@ extern MXF::RIP *g_RIP;
 
       Result_t CalcValues(const ASDCP::FrameBuffer&, const byte_t* AssetID, ui32_t sequence, HMACContext* HMAC);
       Result_t TestValues(const ASDCP::FrameBuffer&, const byte_t* AssetID, ui32_t sequence, HMACContext* HMAC);
+
+      // As above, for an HMAC context that has already been updated with the
+      // encrypted source value. TestValues() reads the pack from Data.
+      Result_t CalcValues(const byte_t* AssetID, ui32_t sequence, HMACContext* HMAC);
+      Result_t TestValues(const byte_t* AssetID, ui32_t sequence, HMACContext* HMAC);
     };
 
 
@@ -31,6 +31,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "MXF.h"
 #include "KM_log.h"
+#include <algorithm>
 
 const ui32_t kl_length = ASDCP::SMPTE_UL_LENGTH + ASDCP::MXF_BER_LENGTH;
 
@@ -74,6 +75,24 @@ ASDCP::MXF::IndexTableSegment::Copy(const IndexTableSegment& rhs)
   IndexEntryArray = rhs.IndexEntryArray;
 }
 
+//
+void
+ASDCP::MXF::IndexTableSegment::Swap(IndexTableSegment& rhs)
+{
+  std::swap(RtFileOffset, rhs.RtFileOffset);
+  std::swap(RtEntryOffset, rhs.RtEntryOffset);
+  std::swap(IndexEditRate, rhs.IndexEditRate);
+  std::swap(IndexStartPosition, rhs.IndexStartPosition);
+  std::swap(IndexDuration, rhs.IndexDuration);
+  std::swap(EditUnitByteCount, rhs.EditUnitByteCount);
+  std::swap(IndexSID, rhs.IndexSID);
+  std::swap(BodySID, rhs.BodySID);
+  std::swap(SliceCount, rhs.SliceCount);
+  std::swap(PosTableCount, rhs.PosTableCount);
+  DeltaEntryArray.Swap(rhs.DeltaEntryArray);
+  IndexEntryArray.Swap(rhs.IndexEntryArray);
+}
+
 //
 ASDCP::MXF::InterchangeObject*
 ASDCP::MXF::IndexTableSegment::Clone() const
@@ -297,6 +316,104 @@ ASDCP::MXF::IndexTableSegment::IndexEntry::Archive(Kumu::MemIOWriter* Writer) co
 }
 
 
+//------------------------------------------------------------------------------------------
+//
+
+static const ui32_t CompactIndexBlockSize = 64; // entries per block
+
+//
+ASDCP::MXF::CompactIndex::CompactIndex() : m_Count(0) {}
+
+//
+void
+ASDCP::MXF::CompactIndex::Clear()
+{
+  m_Blocks.clear();
+  m_Deltas.clear();
+  m_Flags.clear();
+  m_FrameOffsets.clear();
+  m_Count = 0;
+}
+
+//
+void
+ASDCP::MXF::CompactIndex::Append(const IndexTableSegment::IndexEntry& Entry)
+{
+  // start a new block when the current one is full or the delta will not fit
+  if ( m_Blocks.empty()
+       || m_Count - m_Blocks.back().FirstEntry >= CompactIndexBlockSize
+       || Entry.StreamOffset < m_Blocks.back().BaseOffset
+       || Entry.StreamOffset - m_Blocks.back().BaseOffset > 0xffffffffUL )
+    {
+      Block tmp_block;
+      tmp_block.BaseOffset = Entry.StreamOffset;
+      tmp_block.FirstEntry = m_Count;
+      m_Blocks.push_back(tmp_block);
+    }
+
+  m_Deltas.push_back((ui32_t)(Entry.StreamOffset - m_Blocks.back().BaseOffset));
+  m_Flags.push_back(Entry.Flags);
+
+  if ( m_FrameOffsets.empty() && ( Entry.TemporalOffset != 0 || Entry.KeyFrameOffset != 0 ) )
+    m_FrameOffsets.resize(m_Count * 2, 0);
+
+  if ( ! m_FrameOffsets.empty() )
+    {
+      m_FrameOffsets.push_back(Entry.TemporalOffset);
+      m_FrameOffsets.push_back(Entry.KeyFrameOffset);
+    }
+
+  ++m_Count;
+}
+
+//
+void
+ASDCP::MXF::CompactIndex::Trim()
+{
+  std::vector<Block>(m_Blocks).swap(m_Blocks);
+  std::vector<ui32_t>(m_Deltas).swap(m_Deltas);
+  std::vector<ui8_t>(m_Flags).swap(m_Flags);
+  std::vector<i8_t>(m_FrameOffsets).swap(m_FrameOffsets);
+}
+
+//
+ASDCP::Result_t
+ASDCP::MXF::CompactIndex::Lookup(ui32_t entry_num, IndexTableSegment::IndexEntry& Entry) const
+{
+  if ( entry_num >= m_Count )
+    return RESULT_RANGE;
+
+  // the last block whose first entry is not after entry_num
+  std::vector<Block>::const_iterator block = std::upper_bound(m_Blocks.begin(), m_Blocks.end(),
+							      entry_num, FirstEntryLess);
+  assert(block != m_Blocks.begin());
+  --block;
+
+  Entry.StreamOffset = block->BaseOffset + m_Deltas[entry_num];
+  Entry.Flags = m_Flags[entry_num];
+
+  if ( m_FrameOffsets.empty() )
+    {
+      Entry.TemporalOffset = Entry.KeyFrameOffset = 0;
+    }
+  else
+    {
+      Entry.TemporalOffset = m_FrameOffsets[entry_num * 2];
+      Entry.KeyFrameOffset = m_FrameOffsets[entry_num * 2 + 1];
+    }
+
+  return RESULT_OK;
+}
+
+//
+ui64_t
+ASDCP::MXF::CompactIndex::MemorySize() const
+{
+  return ( m_Blocks.size() * sizeof(Block) ) + ( m_Deltas.size() * sizeof(ui32_t) )
+    + m_Flags.size() + m_FrameOffsets.size();
+}
+
+
 //
 // end Index.cpp
 //
@@ -35,6 +35,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <JP2K.h>
 #include <KM_log.h>
 using Kumu::DefaultLogSink;
+using namespace ASDCP;
 
 
 //
@@ -326,6 +327,1012 @@ ASDCP::JP2K::GetMarkerString(Marker_t m)
   return "Unknown marker code";
 }
 
+//-------------------------------------------------------------------------------------------------------
+// codestream index
+
+// coding style of one component
+struct ComponentStyle
+{
+  ui32_t XRsiz;
+  ui32_t YRsiz;
+  ui8_t  Levels;
+  ui8_t  PPx[33];
+  ui8_t  PPy[33];
+};
+
+// one progression volume, from the COD or from a POC entry; ends are exclusive
+struct ProgressionVolume
+{
+  ui32_t RS, RE;
+  ui32_t CS, CE;
+  ui32_t LE;
+  ui8_t  Order;
+};
+
+// the main header values needed to place packets
+struct CodestreamLayout
+{
+  ui32_t Xsiz, Ysiz, XOsiz, YOsiz;
+  ui32_t XTsiz, YTsiz, XTOsiz, YTOsiz;
+  ui32_t Layers;
+  ui8_t  Order;
+  std::vector<ComponentStyle> Components;
+  std::vector<ProgressionVolume> Progressions;
+  bool   UsesPPM;
+  std::vector<std::vector<ui32_t> > PLM; // packet lengths for each tile-part, in codestream order
+  std::vector<ui32_t> TLMTiles;          // tile of each tile-part listed by TLM
+  std::vector<ui32_t> TLMLengths;
+};
+
+// the precinct grid of one resolution of one tile-component
+struct PrecinctGrid
+{
+  ui64_t trx0, try0, trx1, try1;
+  ui32_t pw, ph;
+  ui32_t base; // index of the first precinct in the tile's precinct numbering
+};
+
+//
+static inline ui64_t ceil_div(ui64_t a, ui64_t b) { return ( a + b - 1 ) / b; }
+static inline ui16_t read_be16(const byte_t* p) { return (ui16_t)( ( p[0] << 8 ) | p[1] ); }
+static inline ui32_t read_be32(const byte_t* p) { return ( (ui32_t)p[0] << 24 ) | ( p[1] << 16 ) | ( p[2] << 8 ) | p[3]; }
+
+// reads the marker at p, first checking that it lies wholly before end_p
+static Result_t
+read_marker(const byte_t** p, const byte_t* end_p, JP2K::Marker& marker)
+{
+  if ( end_p - *p < 2 )
+    return RESULT_SMALLBUF;
+
+  if ( (*p)[0] != 0xff )
+    return RESULT_RAW_FORMAT;
+
+  JP2K::Marker_t type = (JP2K::Marker_t)( 0xff00 | (*p)[1] );
+
+  if ( type != JP2K::MRK_SOC && type != JP2K::MRK_SOD && type != JP2K::MRK_EOC )
+    {
+      if ( end_p - *p < 4 )
+	return RESULT_SMALLBUF;
+
+      ui32_t length = read_be16(*p + 2);
+
+      if ( length < 2 )
+	return RESULT_RAW_FORMAT;
+
+      if ( end_p - *p < (i64_t)( length + 2 ) )
+	return RESULT_SMALLBUF;
+    }
+
+  return JP2K::GetNextMarker(p, marker);
+}
+
+// decodes a run of Iplt or Iplm packet lengths
+static Result_t
+read_packet_lengths(const byte_t* p, const byte_t* end_p, std::vector<ui32_t>& lengths)
+{
+  ui32_t value = 0;
+  bool partial = false;
+
+  for ( ; p < end_p; ++p )
+    {
+      if ( value > ( 0xffffffffUL >> 7 ) )
+	return RESULT_RAW_FORMAT;
+
+      value = ( value << 7 ) | ( *p & 0x7f );
+      partial = ( *p & 0x80 ) != 0;
+
+      if ( ! partial )
+	{
+	  lengths.push_back(value);
+	  value = 0;
+	}
+    }
+
+  return partial ? RESULT_RAW_FORMAT : RESULT_OK;
+}
+
+// reads the precinct sizes of a COD or COC, or sets the maximum when none are signaled
+static Result_t
+read_coding_style(const byte_t* p, const byte_t* end_p, bool has_precincts, ComponentStyle& component)
+{
+  // SPcod: levels, code-block width, height and style, transformation, precincts
+  if ( end_p - p < 5 )
+    return RESULT_RAW_FORMAT;
+
+  component.Levels = p[0];
+
+  if ( component.Levels > 32 )
+    return RESULT_RAW_FORMAT;
+
+  p += 5;
+
+  for ( ui32_t r = 0; r <= component.Levels; ++r )
+    {
+      if ( has_precincts )
+	{
+	  if ( p >= end_p )
+	    return RESULT_RAW_FORMAT;
+
+	  component.PPx[r] = *p & 0x0f;
+	  component.PPy[r] = *p++ >> 4;
+	}
+      else
+	{
+	  component.PPx[r] = component.PPy[r] = 15;
+	}
+    }
+
+  return RESULT_OK;
+}
+
+// reads the entries of a POC marker segment
+static Result_t
+read_progressions(const JP2K::Marker& marker, ui32_t component_count, std::vector<ProgressionVolume>& progressions)
+{
+  ui32_t comp_size = component_count < 257 ? 1 : 2;
+  ui32_t entry_size = 5 + 2 * comp_size;
+
+  if ( marker.m_DataSize == 0 || marker.m_DataSize % entry_size != 0 )
+    return RESULT_RAW_FORMAT;
+
+  for ( const byte_t* p = marker.m_Data; p < marker.m_Data + marker.m_DataSize; p += entry_size )
+    {
+      ProgressionVolume tmp_prog;
+      tmp_prog.RS = p[0];
+      tmp_prog.CS = comp_size == 1 ? p[1] : read_be16(p + 1);
+      tmp_prog.LE = read_be16(p + 1 + comp_size);
+      tmp_prog.RE = p[3 + comp_size];
+      tmp_prog.CE = comp_size == 1 ? p[4 + comp_size] : read_be16(p + 4 + comp_size);
+      tmp_prog.Order = p[4 + 2 * comp_size];
+
+      if ( tmp_prog.CE == 0 )
+	tmp_prog.CE = comp_size == 1 ? 256 : 16384;
+
+      progressions.push_back(tmp_prog);
+    }
+
+  return RESULT_OK;
+}
+
+// reads the main header; p is left at the first SOT
+static Result_t
+read_main_header(const byte_t** p, const byte_t* end_p, CodestreamLayout& layout)
+{
+  JP2K::Marker marker;
+  ComponentStyle cod_style;
+  std::vector<bool> has_coc;
+  bool has_siz = false, has_cod = false;
+  layout.UsesPPM = false;
+  Result_t result = read_marker(p, end_p, marker);
+
+  if ( KM_SUCCESS(result) && marker.m_Type != JP2K::MRK_SOC )
+    result = RESULT_RAW_FORMAT;
+
+  while ( KM_SUCCESS(result) )
+    {
+      if ( end_p - *p >= 2 && read_be16(*p) == JP2K::MRK_SOT )
+	break;
+
+      result = read_marker(p, end_p, marker);
+
+      if ( KM_FAILURE(result) )
+	break;
+
+      const byte_t* data = marker.m_Data;
+      const byte_t* data_end = marker.m_Data + marker.m_DataSize;
+
+      switch ( marker.m_Type )
+	{
+	case JP2K::MRK_SIZ:
+	  {
+	    if ( marker.m_DataSize < 36 )
+	      return RESULT_RAW_FORMAT;
+
+	    JP2K::Accessor::SIZ SIZ_(marker);
+	    layout.Xsiz = SIZ_.Xsize();
+	    layout.Ysiz = SIZ_.Ysize();
+	    layout.XOsiz = SIZ_.XOsize();
+	    layout.YOsiz = SIZ_.YOsize();
+	    layout.XTsiz = SIZ_.XTsize();
+	    layout.YTsiz = SIZ_.YTsize();
+	    layout.XTOsiz = SIZ_.XTOsize();
+	    layout.YTOsiz = SIZ_.YTOsize();
+	    ui32_t component_count = SIZ_.Csize();
+
+	    if ( component_count == 0 || marker.m_DataSize < 36 + 3 * component_count
+		 || layout.XTsiz == 0 || layout.YTsiz == 0
+		 || layout.XTOsiz > layout.XOsiz || layout.YTOsiz > layout.YOsiz
+		 || layout.XOsiz >= layout.Xsiz || layout.YOsiz >= layout.Ysiz )
+	      return RESULT_RAW_FORMAT;
+
+	    layout.Components.resize(component_count);
+	    has_coc.resize(component_count, false);
+
+	    for ( ui32_t i = 0; i < component_count; ++i )
+	      {
+		layout.Components[i].XRsiz = data[36 + i * 3 + 1];
+		layout.Components[i].YRsiz = data[36 + i * 3 + 2];
+
+		if ( layout.Components[i].XRsiz == 0 || layout.Components[i].YRsiz == 0 )
+		  return RESULT_RAW_FORMAT;
+	      }
+
+	    has_siz = true;
+	  }
+	  break;
+
+	case JP2K::MRK_COD:
+	  // Scod, progression order, layers, multiple component transform, SPcod
+	  if ( marker.m_DataSize < 5 )
+	    return RESULT_RAW_FORMAT;
+
+	  layout.Order = data[1];
+	  layout.Layers = read_be16(data + 2);
+	  result = read_coding_style(data + 5, data_end, ( data[0] & 0x01 ) != 0, cod_style);
+	  has_cod = true;
+	  break;
+
+	case JP2K::MRK_COC:
+	  {
+	    if ( ! has_siz )
+	      return RESULT_RAW_FORMAT;
+
+	    // Ccoc, Scoc, SPcoc
+	    ui32_t comp_size = layout.Components.size() < 257 ? 1 : 2;
+
+	    if ( marker.m_DataSize < comp_size + 1 )
+	      return RESULT_RAW_FORMAT;
+
+	    ui32_t c = comp_size == 1 ? data[0] : read_be16(data);
+
+	    if ( c >= layout.Components.size() )
+	      return RESULT_RAW_FORMAT;
+
+	    result = read_coding_style(data + comp_size + 1, data_end, ( data[comp_size] & 0x01 ) != 0, layout.Components[c]);
+	    has_coc[c] = true;
+	  }
+	  break;
+
+	case JP2K::MRK_POC:
+	  if ( ! has_siz )
+	    return RESULT_RAW_FORMAT;
+
+	  result = read_progressions(marker, layout.Components.size(), layout.Progressions);
+	  break;
+
+	case JP2K::MRK_PLM:
+	  // Zplm, then for each tile-part Nplm and Nplm bytes of Iplm
+	  for ( const byte_t* q = data + 1; KM_SUCCESS(result) && q < data_end; )
+	    {
+	      ui32_t length = *q++;
+
+	      if ( data_end - q < (i64_t)length )
+		return RESULT_RAW_FORMAT;
+
+	      layout.PLM.push_back(std::vector<ui32_t>());
+	      result = read_packet_lengths(q, q + length, layout.PLM.back());
+	      q += length;
+	    }
+	  break;
+
+	case JP2K::MRK_TLM:
+	  {
+	    // Ztlm, Stlm, then for each tile-part Ttlm and Ptlm
+	    if ( marker.m_DataSize < 2 )
+	      return RESULT_RAW_FORMAT;
+
+	    ui32_t tile_size = ( data[1] >> 4 ) & 0x03;
+	    ui32_t length_size = ( data[1] & 0x40 ) ? 4 : 2;
+
+	    if ( tile_size == 3 || ( marker.m_DataSize - 2 ) % ( tile_size + length_size ) != 0 )
+	      return RESULT_RAW_FORMAT;
+
+	    for ( const byte_t* q = data + 2; q < data_end; q += tile_size + length_size )
+	      {
+		// without Ttlm each tile has one tile-part, in order
+		ui32_t tile = tile_size == 0 ? (ui32_t)layout.TLMTiles.size() : ( tile_size == 1 ? q[0] : read_be16(q) );
+		layout.TLMTiles.push_back(tile);
+		layout.TLMLengths.push_back(length_size == 2 ? read_be16(q + tile_size) : read_be32(q + tile_size));
+	      }
+	  }
+	  break;
+
+	case JP2K::MRK_PPM:
+	  layout.UsesPPM = true;
+	  break;
+
+	case JP2K::MRK_SOD:
+	case JP2K::MRK_EOC:
+	  return RESULT_RAW_FORMAT;
+
+	default:
+	  break;
+	}
+    }
+
+  if ( KM_SUCCESS(result) && ( ! has_siz || ! has_cod || layout.Layers == 0 ) )
+    return RESULT_RAW_FORMAT;
+
+  if ( KM_SUCCESS(result) )
+    {
+      for ( ui32_t i = 0; i < layout.Components.size(); ++i )
+	{
+	  if ( ! has_coc[i] )
+	    {
+	      ui32_t xr = layout.Components[i].XRsiz, yr = layout.Components[i].YRsiz;
+	      layout.Components[i] = cod_style;
+	      layout.Components[i].XRsiz = xr;
+	      layout.Components[i].YRsiz = yr;
+	    }
+	}
+    }
+
+  return result;
+}
+
+// The most packets a tile may have for PacketSequence to list them. Precinct
+// and layer counts come straight from the codestream; real tiles have a few
+// hundred thousand packets at most.
+static const ui64_t MaxTilePackets = 1 << 20;
+
+// Lists the packets of a tile in codestream order. Follows the progression
+// iteration of ITU-T T.800 B.12 as implemented by common decoders.
+class PacketSequence
+{
+  const CodestreamLayout& m_Layout;
+  ui64_t m_tx0, m_ty0, m_tx1, m_ty1;
+  ui64_t m_dx, m_dy; // position steps
+  ui64_t m_PacketCount;
+  std::vector<std::vector<PrecinctGrid> > m_Grids;
+  std::vector<bool> m_Included;
+  std::vector<JP2K::PacketInfo>& m_Packets;
+
+public:
+  PacketSequence(const CodestreamLayout& layout, ui32_t tile, std::vector<JP2K::PacketInfo>& packets) :
+    m_Layout(layout), m_dx(0), m_dy(0), m_PacketCount(0), m_Packets(packets)
+  {
+    ui32_t tiles_across = (ui32_t)ceil_div(layout.Xsiz - layout.XTOsiz, layout.XTsiz);
+    ui32_t p = tile % tiles_across, q = tile / tiles_across;
+    m_tx0 = Kumu::xmax<ui64_t>(layout.XTOsiz + (ui64_t)p * layout.XTsiz, layout.XOsiz);
+    m_ty0 = Kumu::xmax<ui64_t>(layout.YTOsiz + (ui64_t)q * layout.YTsiz, layout.YOsiz);
+    m_tx1 = Kumu::xmin<ui64_t>(layout.XTOsiz + (ui64_t)( p + 1 ) * layout.XTsiz, layout.Xsiz);
+    m_ty1 = Kumu::xmin<ui64_t>(layout.YTOsiz + (ui64_t)( q + 1 ) * layout.YTsiz, layout.Ysiz);
+
+    ui64_t precinct_count = 0;
+    m_Grids.resize(layout.Components.size());
+
+    for ( ui32_t c = 0; c < layout.Components.size(); ++c )
+      {
+	const ComponentStyle& comp = layout.Components[c];
+	m_Grids[c].resize(comp.Levels + 1);
+
+	for ( ui32_t r = 0; r <= comp.Levels; ++r )
+	  {
+	    PrecinctGrid& grid = m_Grids[c][r];
+	    ui32_t level = comp.Levels - r;
+	    grid.trx0 = ceil_div(m_tx0, (ui64_t)comp.XRsiz << level);
+	    grid.try0 = ceil_div(m_ty0, (ui64_t)comp.YRsiz << level);
+	    grid.trx1 = ceil_div(m_tx1, (ui64_t)comp.XRsiz << level);
+	    grid.try1 = ceil_div(m_ty1, (ui64_t)comp.YRsiz << level);
+	    grid.pw = grid.trx0 == grid.trx1 ? 0
+	      : (ui32_t)( ceil_div(grid.trx1, 1ULL << comp.PPx[r]) - ( grid.trx0 >> comp.PPx[r] ) );
+	    grid.ph = grid.try0 == grid.try1 ? 0
+	      : (ui32_t)( ceil_div(grid.try1, 1ULL << comp.PPy[r]) - ( grid.try0 >> comp.PPy[r] ) );
+	    grid.base = (ui32_t)precinct_count; // checked by Init()
+	    precinct_count += (ui64_t)grid.pw * grid.ph;
+
+	    ui64_t dx = (ui64_t)comp.XRsiz << ( comp.PPx[r] + level );
+	    ui64_t dy = (ui64_t)comp.YRsiz << ( comp.PPy[r] + level );
+	    m_dx = m_dx == 0 ? dx : Kumu::xmin(m_dx, dx);
+	    m_dy = m_dy == 0 ? dy : Kumu::xmin(m_dy, dy);
+	  }
+      }
+
+    m_PacketCount = precinct_count * layout.Layers;
+  }
+
+  // Allocates the inclusion map. Returns RESULT_FORMAT if the tile has more than
+  // MaxTilePackets packets.
+  Result_t Init()
+  {
+    if ( m_PacketCount > MaxTilePackets )
+      {
+	DefaultLogSink().Error("Tile has too many packets to index: %s\n", Kumu::ui64Printer(m_PacketCount).c_str());
+	return RESULT_FORMAT;
+      }
+
+    m_Included.resize((size_t)m_PacketCount, false);
+    return RESULT_OK;
+  }
+
+  //
+  void Emit(ui32_t l, ui32_t r, ui32_t c, ui32_t precinct)
+  {
+    size_t index = (size_t)( m_Grids[c][r].base + precinct ) * m_Layout.Layers + l;
+
+    if ( m_Included[index] )
+      return;
+
+    m_Included[index] = true;
+    JP2K::PacketInfo tmp_packet;
+    tmp_packet.Offset = tmp_packet.Length = 0;
+    tmp_packet.Precinct = precinct;
+    tmp_packet.Layer = l;
+    tmp_packet.Component = c;
+    tmp_packet.Resolution = r;
+    m_Packets.push_back(tmp_packet);
+  }
+
+  // emits every layer of the precinct of component c, resolution r that starts at (x, y), if any
+  void EmitAt(ui64_t x, ui64_t y, ui32_t c, ui32_t r, ui32_t layer_end)
+  {
+    const ComponentStyle& comp = m_Layout.Components[c];
+    const PrecinctGrid& grid = m_Grids[c][r];
+    ui32_t level = comp.Levels - r;
+    ui32_t rpx = comp.PPx[r] + level, rpy = comp.PPy[r] + level;
+
+    if ( grid.pw == 0 || grid.ph == 0 )
+      return;
+
+    if ( ! ( y % ( (ui64_t)comp.YRsiz << rpy ) == 0
+	     || ( y == m_ty0 && ( ( grid.try0 << level ) % ( 1ULL << rpy ) ) != 0 ) ) )
+      return;
+
+    if ( ! ( x % ( (ui64_t)comp.XRsiz << rpx ) == 0
+	     || ( x == m_tx0 && ( ( grid.trx0 << level ) % ( 1ULL << rpx ) ) != 0 ) ) )
+      return;
+
+    ui64_t prci = ( ceil_div(x, (ui64_t)comp.XRsiz << level) >> comp.PPx[r] ) - ( grid.trx0 >> comp.PPx[r] );
+    ui64_t prcj = ( ceil_div(y, (ui64_t)comp.YRsiz << level) >> comp.PPy[r] ) - ( grid.try0 >> comp.PPy[r] );
+
+    if ( prci >= grid.pw || prcj >= grid.ph )
+      return;
+
+    for ( ui32_t l = 0; l < layer_end; ++l )
+      Emit(l, r, c, (ui32_t)( prci + prcj * grid.pw ));
+  }
+
+  //
+  Result_t Iterate(const ProgressionVolume& prog)
+  {
+    ui32_t ce = Kumu::xmin<ui32_t>(prog.CE, m_Layout.Components.size());
+    ui32_t le = Kumu::xmin<ui32_t>(prog.LE, m_Layout.Layers);
+    ui64_t x, y;
+
+    switch ( prog.Order )
+      {
+      case 0: // LRCP
+	for ( ui32_t l = 0; l < le; ++l )
+	  for ( ui32_t r = prog.RS; r < prog.RE; ++r )
+	    for ( ui32_t c = prog.CS; c < ce; ++c )
+	      if ( r <= m_Layout.Components[c].Levels )
+		for ( ui32_t p = 0; p < m_Grids[c][r].pw * m_Grids[c][r].ph; ++p )
+		  Emit(l, r, c, p);
+	break;
+
+      case 1: // RLCP
+	for ( ui32_t r = prog.RS; r < prog.RE; ++r )
+	  for ( ui32_t l = 0; l < le; ++l )
+	    for ( ui32_t c = prog.CS; c < ce; ++c )
+	      if ( r <= m_Layout.Components[c].Levels )
+		for ( ui32_t p = 0; p < m_Grids[c][r].pw * m_Grids[c][r].ph; ++p )
+		  Emit(l, r, c, p);
+	break;
+
+      case 2: // RPCL
+	for ( ui32_t r = prog.RS; r < prog.RE; ++r )
+	  for ( y = m_ty0; y < m_ty1; y += m_dy - ( y % m_dy ) )
+	    for ( x = m_tx0; x < m_tx1; x += m_dx - ( x % m_dx ) )
+	      for ( ui32_t c = prog.CS; c < ce; ++c )
+		if ( r <= m_Layout.Components[c].Levels )
+		  EmitAt(x, y, c, r, le);
+	break;
+
+      case 3: // PCRL
+	for ( y = m_ty0; y < m_ty1; y += m_dy - ( y % m_dy ) )
+	  for ( x = m_tx0; x < m_tx1; x += m_dx - ( x % m_dx ) )
+	    for ( ui32_t c = prog.CS; c < ce; ++c )
+	      for ( ui32_t r = prog.RS; r < prog.RE && r <= m_Layout.Components[c].Levels; ++r )
+		EmitAt(x, y, c, r, le);
+	break;
+
+      case 4: // CPRL
+	for ( ui32_t c = prog.CS; c < ce; ++c )
+	  for ( y = m_ty0; y < m_ty1; y += m_dy - ( y % m_dy ) )
+	    for ( x = m_tx0; x < m_tx1; x += m_dx - ( x % m_dx ) )
+	      for ( ui32_t r = prog.RS; r < prog.RE && r <= m_Layout.Components[c].Levels; ++r )
+		EmitAt(x, y, c, r, le);
+	break;
+
+      default:
+	DefaultLogSink().Error("Unknown progression order: %u\n", prog.Order);
+	return RESULT_RAW_FORMAT;
+      }
+
+    return RESULT_OK;
+  }
+};
+
+// what the tile-part headers of one tile say about its packets
+struct TileStyle
+{
+  bool Seen;        // the first tile-part header has been read
+  bool Unsupported; // the tile changes its coding style or uses PPT
+  std::vector<ProgressionVolume> Progressions; // from a POC in the first tile-part header
+
+  TileStyle() : Seen(false), Unsupported(false) {}
+};
+
+//
+class ASDCP::JP2K::CodestreamIndex::h__CodestreamIndex
+{
+public:
+  CodestreamLayout       m_Layout;
+  std::vector<TileStyle> m_Tiles;
+};
+
+//
+ASDCP::JP2K::CodestreamIndex::CodestreamIndex() :
+  MainHeaderLength(0), TileCount(0), HasTLM(false), Complete(false), IndexedLength(0) {}
+
+ASDCP::JP2K::CodestreamIndex::~CodestreamIndex() {}
+
+//
+Result_t
+ASDCP::JP2K::CodestreamIndex::Build(const byte_t* buf, ui32_t buf_len)
+{
+  ASDCP_TEST_NULL(buf);
+  m_Index = new h__CodestreamIndex;
+  MainHeaderLength = TileCount = IndexedLength = 0;
+  TileParts.clear();
+  PacketLengths.clear();
+  HasTLM = Complete = false;
+
+  CodestreamLayout& layout = m_Index->m_Layout;
+  const byte_t* p = buf;
+  const byte_t* end_p = buf + buf_len;
+  Result_t result = read_main_header(&p, end_p, layout);
+
+  if ( KM_SUCCESS(result) )
+    {
+      ui64_t tile_count = ceil_div(layout.Xsiz - layout.XTOsiz, layout.XTsiz)
+	* ceil_div(layout.Ysiz - layout.YTOsiz, layout.YTsiz);
+
+      // Isot is 16 bits
+      if ( tile_count > 65535 )
+	result = RESULT_RAW_FORMAT;
+
+      TileCount = (ui32_t)tile_count;
+    }
+
+  if ( KM_FAILURE(result) )
+    {
+      m_Index.set(0);
+      return result;
+    }
+
+  MainHeaderLength = IndexedLength = (ui32_t)( p - buf );
+  m_Index->m_Tiles.resize(TileCount);
+
+  // enter the tile-parts listed by TLM; their headers are read below if present
+  ui64_t tlm_offset = MainHeaderLength;
+
+  for ( ui32_t i = 0; i < layout.TLMLengths.size(); ++i )
+    {
+      if ( layout.TLMTiles[i] >= TileCount || layout.TLMLengths[i] < 14 || tlm_offset > 0xffffffffUL )
+	{
+	  DefaultLogSink().Error("TLM entry %u is not valid.\n", i);
+	  m_Index.set(0);
+	  return RESULT_RAW_FORMAT;
+	}
+
+      TilePartInfo tmp_part;
+      tmp_part.Offset = (ui32_t)tlm_offset;
+      tmp_part.Length = layout.TLMLengths[i];
+      tmp_part.DataOffset = 0;
+      tmp_part.Tile = layout.TLMTiles[i];
+      tmp_part.Part = tmp_part.PartCount = 0;
+      tmp_part.FirstPacket = NoPacketLengths;
+      tmp_part.PacketCount = 0;
+      TileParts.push_back(tmp_part);
+      tlm_offset += layout.TLMLengths[i];
+    }
+
+  HasTLM = ! TileParts.empty();
+  ui32_t part = 0;
+
+  while ( KM_SUCCESS(result) )
+    {
+      if ( end_p - p >= 2 && read_be16(p) == JP2K::MRK_EOC )
+	{
+	  Complete = true;
+	  break;
+	}
+
+      // SOT: Lsot, Isot, Psot, TPsot, TNsot
+      const byte_t* sot_p = p;
+      ui32_t sot_offset = (ui32_t)( sot_p - buf );
+      JP2K::Marker marker;
+      result = read_marker(&p, end_p, marker);
+
+      if ( result == RESULT_SMALLBUF )
+	{
+	  p = sot_p;
+	  result = RESULT_OK;
+	  break;
+	}
+
+      if ( KM_SUCCESS(result) && ( marker.m_Type != JP2K::MRK_SOT || marker.m_DataSize < 8 ) )
+	result = RESULT_RAW_FORMAT;
+
+      if ( KM_FAILURE(result) )
+	break;
+
+      ui32_t tile = read_be16(marker.m_Data);
+      ui32_t psot = read_be32(marker.m_Data + 2);
+
+      if ( tile >= TileCount || ( psot != 0 && psot < 14 ) )
+	{
+	  result = RESULT_RAW_FORMAT;
+	  break;
+	}
+
+      if ( part < TileParts.size() )
+	{
+	  if ( TileParts[part].Offset != sot_offset || TileParts[part].Tile != tile
+	       || ( psot != 0 && TileParts[part].Length != psot ) )
+	    {
+	      DefaultLogSink().Error("Tile-part %u does not match its TLM entry.\n", part);
+	      result = RESULT_RAW_FORMAT;
+	      break;
+	    }
+	}
+      else
+	{
+	  TilePartInfo tmp_part;
+	  tmp_part.Offset = sot_offset;
+	  tmp_part.Tile = tile;
+	  tmp_part.DataOffset = 0;
+	  tmp_part.FirstPacket = NoPacketLengths;
+	  tmp_part.PacketCount = 0;
+	  TileParts.push_back(tmp_part);
+	}
+
+      TilePartInfo& tile_part = TileParts[part];
+      tile_part.Length = psot;
+      tile_part.Part = marker.m_Data[6];
+      tile_part.PartCount = marker.m_Data[7];
+
+      // the tile-part header
+      std::vector<ui32_t> lengths;
+      std::vector<ProgressionVolume> progressions;
+      bool has_lengths = false, changes_style = false;
+
+      while ( KM_SUCCESS(result) )
+	{
+	  result = read_marker(&p, end_p, marker);
+
+	  if ( KM_FAILURE(result) || marker.m_Type == JP2K::MRK_SOD )
+	    break;
+
+	  switch ( marker.m_Type )
+	    {
+	    case JP2K::MRK_PLT:
+	      if ( marker.m_DataSize < 1 )
+		result = RESULT_RAW_FORMAT;
+	      else
+		result = read_packet_lengths(marker.m_Data + 1, marker.m_Data + marker.m_DataSize, lengths);
+
+	      has_lengths = true;
+	      break;
+
+	    case JP2K::MRK_POC:
+	      result = read_progressions(marker, layout.Components.size(), progressions);
+	      break;
+
+	    case JP2K::MRK_COD:
+	    case JP2K::MRK_COC:
+	    case JP2K::MRK_PPT:
+	      changes_style = true;
+	      break;
+
+	    case JP2K::MRK_SOT:
+	    case JP2K::MRK_EOC:
+	      result = RESULT_RAW_FORMAT;
+	      break;
+
+	    default:
+	      break;
+	    }
+	}
+
+      if ( result == RESULT_SMALLBUF )
+	{
+	  // the header runs past the data; the tile-part stays unread
+	  p = sot_p;
+	  result = RESULT_OK;
+	  break;
+	}
+
+      if ( KM_FAILURE(result) )
+	break;
+
+      TileStyle& style = m_Index->m_Tiles[tile];
+
+      if ( ! style.Seen )
+	{
+	  style.Seen = true;
+	  style.Unsupported = changes_style;
+	  style.Progressions = progressions;
+	}
+      else if ( changes_style || ! progressions.empty() )
+	{
+	  style.Unsupported = true;
+	}
+
+      if ( ! has_lengths && part < layout.PLM.size() )
+	{
+	  lengths = layout.PLM[part];
+	  has_lengths = true;
+	}
+
+      tile_part.DataOffset = (ui32_t)( p - buf );
+
+      if ( has_lengths )
+	{
+	  tile_part.FirstPacket = PacketLengths.size();
+	  tile_part.PacketCount = lengths.size();
+	  PacketLengths.insert(PacketLengths.end(), lengths.begin(), lengths.end());
+	}
+
+      ++part;
+
+      if ( psot == 0 ) // the last tile-part
+	{
+	  Complete = true;
+	  break;
+	}
+
+      p = sot_p;
+
+      if ( (ui64_t)psot > (ui64_t)( end_p - p ) )
+	{
+	  IndexedLength = sot_offset + psot;
+	  break;
+	}
+
+      p += psot;
+    }
+
+  if ( KM_SUCCESS(result) && Complete && part < TileParts.size() )
+    {
+      DefaultLogSink().Error("TLM lists %u tile-parts, codestream has %u.\n", (ui32_t)TileParts.size(), part);
+      result = RESULT_RAW_FORMAT;
+    }
+
+  if ( KM_FAILURE(result) )
+    {
+      m_Index.set(0);
+      return result;
+    }
+
+  if ( Complete )
+    IndexedLength = 0;
+  else if ( IndexedLength < (ui32_t)( p - buf ) )
+    IndexedLength = (ui32_t)( p - buf );
+
+  return result;
+}
+
+//
+Result_t
+ASDCP::JP2K::CodestreamIndex::LocatePackets(ui32_t tile, std::vector<PacketInfo>& packets) const
+{
+  packets.clear();
+
+  if ( m_Index.empty() )
+    return RESULT_INIT;
+
+  if ( tile >= TileCount )
+    return RESULT_RANGE;
+
+  const CodestreamLayout& layout = m_Index->m_Layout;
+  const TileStyle& style = m_Index->m_Tiles[tile];
+
+  if ( ! style.Seen )
+    {
+      if ( ! Complete )
+	return RESULT_SMALLBUF;
+
+      DefaultLogSink().Error("Codestream has no tile-part for tile %u.\n", tile);
+      return RESULT_RAW_FORMAT;
+    }
+
+  if ( layout.UsesPPM || style.Unsupported )
+    return Kumu::RESULT_NOTIMPL;
+
+  std::vector<ProgressionVolume> progressions = style.Progressions;
+
+  if ( progressions.empty() )
+    progressions = layout.Progressions;
+
+  if ( progressions.empty() )
+    {
+      ProgressionVolume tmp_prog;
+      tmp_prog.RS = tmp_prog.CS = 0;
+      tmp_prog.RE = 33;
+      tmp_prog.CE = layout.Components.size();
+      tmp_prog.LE = layout.Layers;
+      tmp_prog.Order = layout.Order;
+      progressions.push_back(tmp_prog);
+    }
+
+  PacketSequence sequence(layout, tile, packets);
+  Result_t result = sequence.Init();
+
+  for ( ui32_t i = 0; KM_SUCCESS(result) && i < progressions.size(); ++i )
+    result = sequence.Iterate(progressions[i]);
+
+  // the packets of each tile-part follow SOD
+  std::vector<PacketInfo>::iterator pi = packets.begin();
+  std::vector<TilePartInfo>::const_iterator tpi;
+
+  for ( tpi = TileParts.begin(); KM_SUCCESS(result) && tpi != TileParts.end(); ++tpi )
+    {
+      if ( tpi->Tile != tile )
+	continue;
+
+      if ( tpi->DataOffset == 0 )
+	break;
+
+      if ( tpi->FirstPacket == NoPacketLengths )
+	{
+	  result = Kumu::RESULT_NOTIMPL;
+	  break;
+	}
+
+      ui64_t packet_offset = tpi->DataOffset;
+
+      for ( ui32_t i = 0; i < tpi->PacketCount; ++i, ++pi )
+	{
+	  if ( pi == packets.end() )
+	    {
+	      DefaultLogSink().Error("Tile %u has more packet lengths than packets.\n", tile);
+	      result = RESULT_RAW_FORMAT;
+	      break;
+	    }
+
+	  pi->Offset = (ui32_t)packet_offset;
+	  pi->Length = PacketLengths[tpi->FirstPacket + i];
+	  packet_offset += pi->Length;
+	}
+
+      if ( KM_SUCCESS(result) && ( packet_offset > 0xffffffffUL
+				   || ( tpi->Length != 0 && packet_offset > (ui64_t)tpi->Offset + tpi->Length ) ) )
+	{
+	  DefaultLogSink().Error("Packet lengths overrun tile-part at offset %u.\n", tpi->Offset);
+	  result = RESULT_RAW_FORMAT;
+	}
+    }
+
+  if ( KM_FAILURE(result) )
+    packets.clear();
+
+  return result;
+}
+
+//
+ui8_t
+ASDCP::JP2K::CodestreamIndex::DecompositionLevels(ui32_t component) const
+{
+  if ( m_Index.empty() || component >= m_Index->m_Layout.Components.size() )
+    return 0;
+
+  return m_Index->m_Layout.Components[component].Levels;
+}
+
+//
+void
+ASDCP::JP2K::CodestreamIndex::Dump(FILE* stream) const
+{
+  if ( stream == 0 )
+    stream = stderr;
+
+  fprintf(stream, "Codestream index: %u tiles, %u tile-parts, %u packet lengths%s\n",
+	  TileCount, (ui32_t)TileParts.size(), (ui32_t)PacketLengths.size(), HasTLM ? ", TLM" : "");
+  fprintf(stream, "  Main header: %u bytes\n", MainHeaderLength);
+
+  std::vector<TilePartInfo>::const_iterator i;
+  for ( i = TileParts.begin(); i != TileParts.end(); ++i )
+    {
+      fprintf(stream, "  Tile %5hu part %3u/%-3u offset %10u length %10u data %10u packets %u\n",
+	      i->Tile, i->Part, i->PartCount, i->Offset, i->Length, i->DataOffset,
+	      i->FirstPacket == NoPacketLengths ? 0 : i->PacketCount);
+    }
+
+  if ( ! Complete )
+    fprintf(stream, "  Indexed to offset %u\n", IndexedLength);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// codestream prefix calculation
+
+// read-ahead requested when a tile-part header lies beyond the data supplied
+static const ui32_t PrefixHeaderReadAhead = 16 * Kumu::Kilobyte;
+
+//
+Result_t
+ASDCP::JP2K::CalculatePrefixLength(const byte_t* buf, ui32_t buf_len, ui8_t discard_levels,
+				   ui16_t max_layers, ui32_t& prefix_length)
+{
+  ASDCP_TEST_NULL(buf);
+  prefix_length = 0;
+
+  CodestreamIndex index;
+  Result_t result = index.Build(buf, buf_len);
+
+  if ( result == RESULT_SMALLBUF )
+    prefix_length = buf_len + PrefixHeaderReadAhead;
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  ui32_t end = index.MainHeaderLength;
+  std::vector<PacketInfo> packets;
+
+  for ( ui32_t tile = 0; KM_SUCCESS(result) && tile < index.TileCount; ++tile )
+    {
+      result = index.LocatePackets(tile, packets);
+
+      // the last packet the reduced decode needs
+      std::vector<PacketInfo>::const_reverse_iterator pi;
+      for ( pi = packets.rbegin(); pi != packets.rend(); ++pi )
+	{
+	  if ( ( max_layers == 0 || pi->Layer < max_layers )
+	       && ( pi->Resolution == 0 || pi->Resolution + discard_levels <= index.DecompositionLevels(pi->Component) ) )
+	    break;
+	}
+
+      if ( KM_FAILURE(result) || pi == packets.rend() )
+	continue;
+
+      if ( pi->Offset != 0 )
+	{
+	  end = Kumu::xmax(end, pi->Offset + pi->Length);
+	}
+      else if ( index.Complete )
+	{
+	  DefaultLogSink().Error("Codestream ended before all tiles were found.\n");
+	  result = RESULT_RAW_FORMAT;
+	}
+      else
+	{
+	  result = RESULT_SMALLBUF;
+	}
+    }
+
+  if ( KM_SUCCESS(result) )
+    {
+      prefix_length = end;
+    }
+  else if ( result == RESULT_SMALLBUF )
+    {
+      // enough to read the next tile-part header, which may have been started
+      ui64_t want = (ui64_t)Kumu::xmax(index.IndexedLength, buf_len) + PrefixHeaderReadAhead;
+      std::vector<TilePartInfo>::const_iterator i;
+
+      for ( i = index.TileParts.begin(); i != index.TileParts.end(); ++i )
+	{
+	  if ( i->Offset == index.IndexedLength && i->Length != 0 )
+	    want = Kumu::xmin(want, (ui64_t)i->Offset + i->Length);
+	}
+
+      prefix_length = (ui32_t)Kumu::xmin<ui64_t>(Kumu::xmax<ui64_t>(want, (ui64_t)buf_len + 1), 0xffffffffUL);
+    }
+
+  return result;
+}
+
 //
 // end JP2K.cpp
 //
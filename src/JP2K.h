@@ -97,6 +97,95 @@ namespace JP2K
   //
   ASDCP::Result_t GetNextMarker(const byte_t**, Marker&);
 
+  // FirstPacket value of a tile-part that signals no packet lengths
+  const ui32_t NoPacketLengths = 0xffffffff;
+
+  // A tile-part of a codestream. Offsets are from the start of the codestream.
+  struct TilePartInfo
+  {
+    ui32_t Offset;      // the SOT marker
+    ui32_t Length;      // Psot; zero if the tile-part runs to the end of the codestream
+    ui32_t DataOffset;  // the first packet, following SOD; zero if the header has not been read
+    ui16_t Tile;        // Isot
+    ui8_t  Part;        // TPsot
+    ui8_t  PartCount;   // TNsot; zero if not signaled
+    ui32_t FirstPacket; // index of the tile-part's first entry in PacketLengths, or NoPacketLengths
+    ui32_t PacketCount; // number of entries in PacketLengths
+  };
+
+  // A packet of a tile, see CodestreamIndex::LocatePackets()
+  struct PacketInfo
+  {
+    ui32_t Offset;      // zero if the packet's tile-part has not been indexed
+    ui32_t Length;
+    ui32_t Precinct;    // in raster order within the resolution
+    ui16_t Layer;
+    ui16_t Component;
+    ui8_t  Resolution;  // zero is the lowest resolution
+  };
+
+  // Locates the tile-parts of a codestream and, where the codestream carries PLT or
+  // PLM markers, each packet, using only the main and tile-part headers. The index
+  // lets a decoder or a partial read go straight to the data for a tile, component,
+  // resolution or layer.
+  class CodestreamIndex
+    {
+      class h__CodestreamIndex;
+      mem_ptr<h__CodestreamIndex> m_Index;
+      KM_NO_COPY_CONSTRUCT(CodestreamIndex);
+
+    public:
+      ui32_t MainHeaderLength;              // offset of the first SOT
+      ui32_t TileCount;
+      std::vector<TilePartInfo> TileParts;  // in codestream order
+      std::vector<ui32_t> PacketLengths;    // from PLT or PLM, in codestream order
+      bool   HasTLM;                        // tile-parts beyond the data were listed by TLM
+      bool   Complete;                      // every tile-part header has been read
+      ui32_t IndexedLength;                 // if not Complete, offset of the first header not read
+
+      CodestreamIndex();
+      ~CodestreamIndex();
+
+      // Indexes as much of the codestream as buf holds; buf may hold only the first
+      // part of it. Tile-parts listed by a TLM marker are entered even when their
+      // headers lie beyond buf_len. Returns RESULT_SMALLBUF if the main header is
+      // not complete, RESULT_RAW_FORMAT if the markers are not well formed.
+      Result_t Build(const byte_t* buf, ui32_t buf_len);
+      Result_t Build(const ASDCP::FrameBuffer& FB) { return Build(FB.RoData(), FB.Size()); }
+
+      // Lists every packet of the tile in codestream order, with its position where
+      // its tile-part has been indexed. Returns RESULT_SMALLBUF if the first header
+      // of the tile has not been read, RESULT_NOTIMPL if packet lengths are missing,
+      // the codestream uses PPM or PPT, or the tile changes its coding style, or
+      // RESULT_FORMAT if the tile has more than 2^20 packets.
+      Result_t LocatePackets(ui32_t tile, std::vector<PacketInfo>& packets) const;
+
+      // decomposition levels of a component; its resolutions run from zero to this
+      ui8_t    DecompositionLevels(ui32_t component) const;
+
+      void     Dump(FILE* stream = 0) const;
+    };
+
+  // Finds the length of the shortest leading part of a codestream that holds every
+  // packet needed to decode it with the discard_levels highest resolution levels
+  // removed and with no more than max_layers quality layers (0 for all layers).
+  // Decoders that accept a truncated codestream can decode the prefix with the same
+  // reduction; a strict decoder also needs the Psot of the last tile-part in the
+  // prefix clipped and an EOC marker appended. Packets are placed with a
+  // CodestreamIndex, so no packet header is decoded. How much is saved depends on
+  // the progression order: resolution-first orders give the shortest prefix for a
+  // resolution reduction, layer-first orders for a layer reduction.
+  //
+  // buf holds the first buf_len bytes of the codestream. If a tile-part header
+  // lies beyond buf_len, returns RESULT_SMALLBUF and sets prefix_length to the
+  // number of bytes to supply on the next call (this may be more than the codestream
+  // holds; supply all of it). Returns RESULT_NOTIMPL if the codestream has no packet
+  // lengths, uses PPM or PPT, or changes the coding style or progression after the
+  // first tile-part of a tile (see CodestreamIndex::LocatePackets()); the whole
+  // codestream is needed in that case.
+  ASDCP::Result_t CalculatePrefixLength(const byte_t* buf, ui32_t buf_len, ui8_t discard_levels,
+					ui16_t max_layers, ui32_t& prefix_length);
+
   // accessor objects for marker segments
   namespace Accessor
     {
@@ -54,29 +54,19 @@ public:
 	//
 	Result_t InitFromDirectory(const std::string& path)
 	{
-		char next_file[Kumu::MaxFilePath];
-		Kumu::DirScanner Scanner;
+		Kumu::DirScannerEx Scanner;
+		Kumu::DirectoryListing Listing;
 
 		Result_t result = Scanner.Open(path);
 
+		if (ASDCP_SUCCESS(result))
+			result = Scanner.ReadFileNames(Listing);
+
 		if (ASDCP_SUCCESS(result))
 		{
 			m_DirName = path;
-
-			while (ASDCP_SUCCESS(Scanner.GetNext(next_file)))
-			{
-				if (next_file[0] == '.') // no hidden files or internal links
-					continue;
-
-				std::string Str(m_DirName);
-				Str += "/";
-				Str += next_file;
-
-				if (!Kumu::PathIsDirectory(Str))
-					push_back(Str);
-			}
-
-			sort();
+			Listing.SortNatural(); // frame_9 before frame_10
+			Listing.GetPaths(*this);
 		}
 
 		return result;
@@ -132,6 +122,7 @@ ASDCP::JXS::SequenceParser::h__SequenceParser::OpenRead()
 	m_CurrentFile = m_FileList.begin();
 	CodestreamParser Parser;
 	FrameBuffer TmpBuffer;
+	TmpBuffer.Allocator(&PooledFrameBufferAllocator());
 
 	Kumu::fsize_t file_size = Kumu::FileSize((*m_CurrentFile).c_str());
 
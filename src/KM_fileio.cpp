@@ -53,6 +53,13 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <sys/sysctl.h>
 #endif
 
+// only needed by DirScannerEx::ReadFileNames()
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+
 using namespace Kumu;
 
 #ifdef KM_WIN32
@@ -1653,6 +1660,241 @@ Kumu::DirScannerEx::GetNext(std::string& next_item_name, DirectoryEntryType_t& n
   return RESULT_OK;
 }
 
+// true if name has the given extension, compared as PathGetExtension() would
+static bool
+name_has_extension(const char* name, ui32_t name_length, const std::string& extension)
+{
+  if ( extension.empty() )
+    return true;
+
+  if ( name_length <= extension.size() )
+    return false;
+
+  const char* dot = name + name_length - extension.size() - 1;
+  return *dot == '.' && memcmp(dot + 1, extension.c_str(), extension.size()) == 0;
+}
+
+#if defined(__linux__)
+
+// the kernel's record layout for getdents64()
+struct kernel_dirent64
+{
+  ui64_t         d_ino;
+  i64_t          d_off;
+  unsigned short d_reclen;
+  unsigned char  d_type;
+  char           d_name[1];
+};
+
+const ui32_t DirentBatchSize = 64 * Kumu::Kilobyte;
+
+//
+Result_t
+Kumu::DirScannerEx::ReadFileNames(DirectoryListing& listing, const std::string& extension, bool include_hidden)
+{
+  if ( m_Handle == 0 )
+    return RESULT_FILEOPEN;
+
+  listing.Reset(m_Dirname);
+
+  // discard anything readdir() has buffered and read from the start
+  rewinddir(m_Handle);
+  int dir_fd = dirfd(m_Handle);
+  std::vector<ui64_t> batch(DirentBatchSize / sizeof(ui64_t)); // records are 8-byte aligned
+  char* batch_p = (char*)&batch[0];
+
+  for (;;)
+    {
+      long batch_length = syscall(SYS_getdents64, dir_fd, batch_p, DirentBatchSize);
+
+      if ( batch_length == 0 )
+	break;
+
+      if ( batch_length < 0 )
+	{
+	  DefaultLogSink().Error("DirScanner::ReadFileNames(%s): %s\n", m_Dirname.c_str(), strerror(errno));
+	  return RESULT_READFAIL;
+	}
+
+      for ( long offset = 0; offset < batch_length; )
+	{
+	  const kernel_dirent64* entry = (const kernel_dirent64*)(batch_p + offset);
+	  offset += entry->d_reclen;
+
+	  if ( entry->d_name[0] == '.' && ! include_hidden ) // no hidden files or internal links
+	    continue;
+
+	  ui32_t name_length = (ui32_t)strlen(entry->d_name);
+
+	  if ( ! name_has_extension(entry->d_name, name_length, extension) )
+	    continue;
+
+	  if ( entry->d_type == DT_DIR )
+	    continue;
+
+	  if ( entry->d_type != DT_REG )
+	    {
+	      // links and entries of unknown type are resolved with stat()
+	      struct stat entry_stat;
+	      if ( fstatat(dir_fd, entry->d_name, &entry_stat, 0) == 0 && S_ISDIR(entry_stat.st_mode) )
+		continue;
+	    }
+
+	  listing.AddName(entry->d_name, name_length);
+	}
+    }
+
+  return RESULT_OK;
+}
+
+#else // __linux__
+
+//
+Result_t
+Kumu::DirScannerEx::ReadFileNames(DirectoryListing& listing, const std::string& extension, bool include_hidden)
+{
+  if ( m_Handle == 0 )
+    return RESULT_FILEOPEN;
+
+  listing.Reset(m_Dirname);
+  rewinddir(m_Handle);
+
+  std::string next_item;
+  DirectoryEntryType_t next_item_type;
+
+  while ( KM_SUCCESS(GetNext(next_item, next_item_type)) )
+    {
+      if ( next_item[0] == '.' && ! include_hidden ) // no hidden files or internal links
+	continue;
+
+      if ( ! name_has_extension(next_item.c_str(), (ui32_t)next_item.size(), extension) )
+	continue;
+
+      if ( next_item_type == DET_DIR )
+	continue;
+
+      if ( next_item_type != DET_FILE && PathIsDirectory(PathJoin(m_Dirname, next_item)) )
+	continue;
+
+      listing.AddName(next_item.c_str(), (ui32_t)next_item.size());
+    }
+
+  return RESULT_OK;
+}
+
+#endif // __linux__
+
+// not isdigit(), which is locale dependent and slower in a sort comparison
+static inline bool
+is_decimal_digit(unsigned char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+//
+int
+Kumu::NaturalCompare(const char* lhs, const char* rhs)
+{
+  assert(lhs && rhs);
+  const unsigned char* l = (const unsigned char*)lhs;
+  const unsigned char* r = (const unsigned char*)rhs;
+
+  while ( *l != 0 && *r != 0 )
+    {
+      if ( is_decimal_digit(*l) && is_decimal_digit(*r) )
+	{
+	  // compare the digit runs by value: ignore leading zeros, then
+	  // the longer run is larger, then compare digit by digit
+	  while ( *l == '0' ) ++l;
+	  while ( *r == '0' ) ++r;
+
+	  const unsigned char* l_end = l;
+	  const unsigned char* r_end = r;
+	  while ( is_decimal_digit(*l_end) ) ++l_end;
+	  while ( is_decimal_digit(*r_end) ) ++r_end;
+
+	  if ( ( l_end - l ) != ( r_end - r ) )
+	    return ( l_end - l ) < ( r_end - r ) ? -1 : 1;
+
+	  for ( ; l < l_end; ++l, ++r )
+	    {
+	      if ( *l != *r )
+		return *l < *r ? -1 : 1;
+	    }
+	}
+      else
+	{
+	  if ( *l != *r )
+	    return *l < *r ? -1 : 1;
+
+	  ++l;
+	  ++r;
+	}
+    }
+
+  if ( *l != 0 || *r != 0 )
+    return *l == 0 ? -1 : 1;
+
+  // equal by value (e.g., "f01" and "f1"), use the byte order for a stable result
+  return strcmp(lhs, rhs);
+}
+
+//
+void
+Kumu::DirectoryListing::Reset(const std::string& dirname)
+{
+  m_Dirname = dirname;
+  m_Pool.clear();
+  m_Offsets.clear();
+}
+
+//
+void
+Kumu::DirectoryListing::AddName(const char* name, ui32_t name_length)
+{
+  assert(name);
+  m_Offsets.push_back((ui32_t)m_Pool.size());
+  m_Pool.insert(m_Pool.end(), name, name + name_length);
+  m_Pool.push_back(0);
+}
+
+//
+class NaturalOffsetOrder
+{
+  const char* m_Pool;
+
+public:
+  NaturalOffsetOrder(const char* pool) : m_Pool(pool) {}
+
+  bool operator()(ui32_t lhs, ui32_t rhs) const {
+    return NaturalCompare(m_Pool + lhs, m_Pool + rhs) < 0;
+  }
+};
+
+//
+void
+Kumu::DirectoryListing::SortNatural()
+{
+  if ( m_Offsets.size() > 1 )
+    std::sort(m_Offsets.begin(), m_Offsets.end(), NaturalOffsetOrder(&m_Pool[0]));
+}
+
+//
+void
+Kumu::DirectoryListing::GetPaths(std::list<std::string>& path_list) const
+{
+  std::string path(m_Dirname);
+  path += "/";
+  std::string::size_type prefix_length = path.size();
+
+  for ( ui32_t i = 0; i < m_Offsets.size(); ++i )
+    {
+      path.resize(prefix_length);
+      path += Name(i);
+      path_list.push_back(path);
+    }
+}
+
 
 //------------------------------------------------------------------------------------------
 
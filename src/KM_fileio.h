@@ -34,6 +34,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <KM_util.h>
 #include <string>
+#include <vector>
 
 #ifdef KM_WIN32
 #include <io.h>
@@ -77,6 +78,8 @@ namespace Kumu
     DET_LINK
   };
 
+  class DirectoryListing;
+
   //
   class DirScannerEx
   {
@@ -100,6 +103,47 @@ namespace Kumu
     }
 
     Result_t GetNext(std::string& next_item_name, DirectoryEntryType_t& next_item_type);
+
+    // Reads the names of all entries in the open directory that are not directories
+    // into listing, skipping hidden entries unless include_hidden is true. Links are
+    // followed. If extension is not empty, only names with that extension (without
+    // the dot, as PathGetExtension()) are kept. On Linux the entries are fetched with
+    // getdents64() in large batches, and an entry is only stat()ed if the file system
+    // does not report its type. Consumes the directory; GetNext() will return
+    // RESULT_ENDOFFILE afterwards.
+    Result_t ReadFileNames(DirectoryListing& listing, const std::string& extension = "",
+			   bool include_hidden = false);
+  };
+
+  // Compares two names in natural order: runs of decimal digits compare by their
+  // value, so that "frame_9" sorts before "frame_10". Returns less than, equal to
+  // or greater than zero, as strcmp().
+  int NaturalCompare(const char* lhs, const char* rhs);
+
+  // The entry names read from one directory, held back to back in a single string
+  // pool rather than as one allocation per name.
+  class DirectoryListing
+  {
+    std::string         m_Dirname;
+    std::vector<char>   m_Pool;
+    std::vector<ui32_t> m_Offsets;
+
+    KM_NO_COPY_CONSTRUCT(DirectoryListing);
+
+  public:
+    DirectoryListing() {}
+    ~DirectoryListing() {}
+
+    void Reset(const std::string& dirname);
+    void AddName(const char* name, ui32_t name_length);
+    void SortNatural();
+
+    inline const std::string& Dirname() const { return m_Dirname; }
+    inline ui32_t Size() const { return (ui32_t)m_Offsets.size(); }
+    inline const char* Name(ui32_t i) const { return &m_Pool[m_Offsets[i]]; }
+
+    // Appends dirname + "/" + name to path_list for each name, in listing order.
+    void GetPaths(std::list<std::string>& path_list) const;
   };
 
 #ifdef KM_WIN32
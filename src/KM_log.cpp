@@ -50,6 +50,9 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 void
 Kumu::ILogSink::vLogf(LogType_t type, const char* fmt, va_list* list)
 {
+  if ( ! IsEnabled(type) )
+    return;
+
   char buf[MaxLogLength];
   vsnprintf(buf, MaxLogLength, fmt, *list);
 
@@ -59,28 +62,28 @@ Kumu::ILogSink::vLogf(LogType_t type, const char* fmt, va_list* list)
 //------------------------------------------------------------------------------------------
 //
 
-static Kumu::Mutex     s_DefaultLogSinkLock;
-static Kumu::ILogSink* s_DefaultLogSink = 0;
+// The default sink pointer is read on every message, so it is accessed
+// atomically rather than under a lock.
+static void* volatile s_DefaultLogSink = 0;
 static Kumu::StdioLogSink s_StderrLogSink;
 
 //
 void
 Kumu::SetDefaultLogSink(ILogSink* Sink)
 {
-  AutoMutex L(s_DefaultLogSinkLock);
-  s_DefaultLogSink = Sink;
+  AtomicStorePtr(&s_DefaultLogSink, Sink);
 }
 
 // Returns the internal default sink.
 Kumu::ILogSink&
 Kumu::DefaultLogSink()
 {
-  AutoMutex L(s_DefaultLogSinkLock);
+  ILogSink* sink = static_cast<ILogSink*>(AtomicLoadPtr(&s_DefaultLogSink));
 
-  if ( s_DefaultLogSink == 0 )
-    s_DefaultLogSink = &s_StderrLogSink;
+  if ( sink == 0 )
+    sink = &s_StderrLogSink;
 
-  return *s_DefaultLogSink;
+  return *sink;
 }
 
 
@@ -115,6 +118,217 @@ Kumu::StdioLogSink::WriteEntry(const LogEntry& Entry)
     }
 }
 
+//------------------------------------------------------------------------------------------
+//
+
+// drains the ring into the target sink
+class Kumu::AsyncLogSink::h__Drain : public Kumu::Thread
+{
+  AsyncLogSink& m_Sink;
+  ui32_t m_ReportedDrops;
+  KM_NO_COPY_CONSTRUCT(h__Drain);
+  h__Drain();
+
+public:
+  h__Drain(AsyncLogSink& sink) : m_Sink(sink), m_ReportedDrops(0) {}
+
+  void ReportDrops()
+  {
+    ui32_t drops = m_Sink.DropCount();
+
+    if ( drops != m_ReportedDrops )
+      {
+	char buf[MaxLogLength];
+	snprintf(buf, MaxLogLength, "AsyncLogSink: %u messages dropped\n", drops - m_ReportedDrops);
+	m_Sink.m_Target.WriteEntry(LogEntry(getpid(), LOG_WARN, buf));
+	m_ReportedDrops = drops;
+      }
+  }
+
+  void Run()
+  {
+    for (;;)
+      {
+	bool stop = ( AtomicLoad(&m_Sink.m_Stop) != 0 );
+	bool busy = false;
+
+	while ( m_Sink.DrainOne() )
+	  busy = true;
+
+	ReportDrops();
+
+	if ( stop )
+	  break;
+
+	if ( ! busy )
+	  SleepMilliseconds(2);
+      }
+  }
+};
+
+//
+Kumu::AsyncLogSink::AsyncLogSink(ILogSink& target, ui32_t slot_count) :
+  m_Target(target), m_Ring(0), m_Mask(0), m_EnqueuePos(0), m_DequeuePos(0),
+  m_DropCount(0), m_Stop(0), m_Drain(0)
+{
+  ui32_t size = 2;
+  while ( size < slot_count && size < 0x80000000 )
+    size <<= 1;
+
+  m_Ring = new Slot[size];
+  m_Mask = size - 1;
+
+  for ( ui32_t i = 0; i < size; ++i )
+    m_Ring[i].Sequence = i;
+
+  m_Drain = new h__Drain(*this);
+
+  if ( ! m_Drain->Start() )
+    {
+      // without a drain thread the entries are delivered synchronously
+      delete m_Drain;
+      m_Drain = 0;
+    }
+}
+
+//
+Kumu::AsyncLogSink::~AsyncLogSink()
+{
+  if ( m_Drain != 0 )
+    {
+      AtomicStore(&m_Stop, 1);
+      m_Drain->Join();
+      delete m_Drain;
+    }
+
+  delete [] m_Ring;
+}
+
+// Reserves the next free slot for a producer. Returns zero if the ring is full.
+Kumu::AsyncLogSink::Slot*
+Kumu::AsyncLogSink::ClaimSlot()
+{
+  ui32_t pos = AtomicLoad(&m_EnqueuePos);
+
+  for (;;)
+    {
+      Slot* slot = &m_Ring[pos & m_Mask];
+      i32_t diff = (i32_t)(AtomicLoad(&slot->Sequence) - pos);
+
+      if ( diff == 0 )
+	{
+	  if ( AtomicCompareExchange(&m_EnqueuePos, pos, pos + 1) )
+	    return slot;
+	}
+      else if ( diff < 0 )
+	{
+	  return 0;
+	}
+
+      pos = AtomicLoad(&m_EnqueuePos);
+    }
+}
+
+// Makes a filled slot visible to the drain thread.
+void
+Kumu::AsyncLogSink::PublishSlot(Slot* slot)
+{
+  assert(slot);
+  AtomicStore(&slot->Sequence, slot->Sequence + 1);
+
+  if ( m_Drain == 0 )
+    {
+      AutoMutex L(m_lock);
+      while ( DrainOne() )
+	;
+    }
+}
+
+// Writes the oldest published entry to the listeners and the target. Returns
+// false if no entry was ready. Called only from one thread at a time.
+bool
+Kumu::AsyncLogSink::DrainOne()
+{
+  ui32_t pos = m_DequeuePos;
+  Slot* slot = &m_Ring[pos & m_Mask];
+
+  if ( AtomicLoad(&slot->Sequence) != pos + 1 )
+    return false;
+
+  LogEntry Entry(slot->PID, slot->Type, slot->Msg);
+  AtomicStore(&slot->Sequence, pos + m_Mask + 1);
+
+  if ( m_Drain != 0 )
+    {
+      AutoMutex L(m_lock);
+      WriteEntryToListeners(Entry);
+    }
+  else
+    {
+      WriteEntryToListeners(Entry);
+    }
+
+  if ( Entry.TestFilter(m_filter) )
+    m_Target.WriteEntry(Entry);
+
+  // advanced last so that Flush() returns only after the target has the entry
+  AtomicStore(&m_DequeuePos, pos + 1);
+  return true;
+}
+
+//
+void
+Kumu::AsyncLogSink::Flush()
+{
+  ui32_t target_pos = AtomicLoad(&m_EnqueuePos);
+
+  while ( m_Drain != 0 && (i32_t)(AtomicLoad(&m_DequeuePos) - target_pos) < 0 )
+    SleepMilliseconds(1);
+}
+
+// formats the message directly into a ring slot
+void
+Kumu::AsyncLogSink::vLogf(LogType_t type, const char* fmt, va_list* list)
+{
+  if ( ! IsEnabled(type) )
+    return;
+
+  Slot* slot = ClaimSlot();
+
+  if ( slot == 0 )
+    {
+      AtomicAdd(&m_DropCount, 1);
+      return;
+    }
+
+  vsnprintf(slot->Msg, MaxLogLength, fmt, *list);
+  slot->PID = getpid();
+  slot->Type = type;
+  PublishSlot(slot);
+}
+
+//
+void
+Kumu::AsyncLogSink::WriteEntry(const LogEntry& Entry)
+{
+  if ( ! IsEnabled(Entry.Type) )
+    return;
+
+  Slot* slot = ClaimSlot();
+
+  if ( slot == 0 )
+    {
+      AtomicAdd(&m_DropCount, 1);
+      return;
+    }
+
+  strncpy(slot->Msg, Entry.Msg.c_str(), MaxLogLength - 1);
+  slot->Msg[MaxLogLength - 1] = 0;
+  slot->PID = Entry.PID;
+  slot->Type = Entry.Type;
+  PublishSlot(slot);
+}
+
 //---------------------------------------------------------------------------------
 
 #ifdef KM_WIN32
@@ -256,51 +470,32 @@ Kumu::operator<<(std::basic_ostream<char, std::char_traits<char> >& strm, LogEnt
 
 
 //
-bool
-Kumu::LogEntry::TestFilter(i32_t filter) const
+i32_t
+Kumu::LogTypeToFilterFlag(LogType_t type)
 {
-  switch ( Type )
+  switch ( type )
     {
-    case LOG_CRIT:
-      if ( (filter & LOG_ALLOW_CRIT) == 0 )
-	return false;
-      break;
-
-    case LOG_ALERT:
-      if ( (filter & LOG_ALLOW_ALERT) == 0 )
-	return false;
-      break;
-
-    case LOG_NOTICE:
-      if ( (filter & LOG_ALLOW_NOTICE) == 0 )
-	return false;
-      break;
-
-    case LOG_ERROR:
-      if ( (filter & LOG_ALLOW_ERROR) == 0 )
-	return false;
-      break;
-
-    case LOG_WARN:
-      if ( (filter & LOG_ALLOW_WARN) == 0 )
-	return false;
-      break;
-
-    case LOG_INFO:
-      if ( (filter & LOG_ALLOW_INFO) == 0 )
-	return false;
-      break;
-
-    case LOG_DEBUG:
-      if ( (filter & LOG_ALLOW_DEBUG) == 0 )
-	return false;
-      break;
-
-    case LOG_MAX:
-      break;
+    case LOG_CRIT:   return LOG_ALLOW_CRIT;
+    case LOG_ALERT:  return LOG_ALLOW_ALERT;
+    case LOG_NOTICE: return LOG_ALLOW_NOTICE;
+    case LOG_ERROR:  return LOG_ALLOW_ERROR;
+    case LOG_WARN:   return LOG_ALLOW_WARN;
+    case LOG_INFO:   return LOG_ALLOW_INFO;
+    case LOG_DEBUG:  return LOG_ALLOW_DEBUG;
+    case LOG_MAX:    break;
     }
 
- return true;
+  return LOG_ALLOW_ALL;
+}
+
+//
+bool
+Kumu::LogEntry::TestFilter(i32_t filter) const
+{
+  if ( Type == LOG_MAX )
+    return true;
+
+  return ( filter & LogTypeToFilterFlag(Type) ) != 0;
 }
 
 //
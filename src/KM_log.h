@@ -35,6 +35,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <KM_platform.h>
 #include <KM_mutex.h>
+#include <KM_thread.h>
 #include <KM_util.h>
 #include <stdarg.h>
 #include <errno.h>
@@ -144,6 +145,9 @@ namespace Kumu
 
 
   typedef ArchivableList<LogEntry> LogEntryList;
+
+  // returns the LOG_ALLOW_* flag corresponding to the given message type
+  i32_t LogTypeToFilterFlag(LogType_t);
   
   //
   class ILogSink
@@ -153,6 +157,7 @@ namespace Kumu
       i32_t m_options;
       Mutex m_lock;
       std::set<ILogSink*> m_listeners;
+      volatile ui32_t m_listener_count; // mirrors m_listeners.size() for lock-free readers
 
       // you must obtain m_lock BEFORE calling this from your own WriteEntry
       void WriteEntryToListeners(const LogEntry& entry)
@@ -165,7 +170,7 @@ namespace Kumu
       KM_NO_COPY_CONSTRUCT(ILogSink);
 
     public:
-    ILogSink() : m_filter(LOG_ALLOW_ALL), m_options(LOG_OPTION_NONE) {}
+    ILogSink() : m_filter(LOG_ALLOW_ALL), m_options(LOG_OPTION_NONE), m_listener_count(0) {}
       virtual ~ILogSink() {}
 
       void  SetFilterFlag(i32_t f) { m_filter |= f; }
@@ -176,17 +181,26 @@ namespace Kumu
       void  UnsetOptionFlag(i32_t o) { m_options &= ~o; }
       bool  TestOptionFlag(i32_t o) const  { return ((m_options & o) == o); }
 
+      // Returns true if a message of the given type would be recorded by this
+      // sink or passed on to a listener. Messages that fail this test are
+      // discarded by vLogf() before they are formatted.
+      bool  IsEnabled(LogType_t t) {
+	return ( m_filter & LogTypeToFilterFlag(t) ) != 0 || AtomicLoad(&m_listener_count) > 0;
+      }
+
       void AddListener(ILogSink& s) {
 	if ( &s != this )
 	  {
 	    AutoMutex l(m_lock);
 	    m_listeners.insert(&s);
+	    AtomicStore(&m_listener_count, (ui32_t)m_listeners.size());
 	  }
       }
 
       void DelListener(ILogSink& s) {
 	AutoMutex l(m_lock);
 	m_listeners.erase(&s);
+	AtomicStore(&m_listener_count, (ui32_t)m_listeners.size());
       }
 
       // library messages
@@ -272,6 +286,56 @@ namespace Kumu
     void WriteEntry(const LogEntry&);
     };
 
+  // Decouples the caller from a slow sink. Messages are formatted on the
+  // calling thread directly into a fixed ring of slots without taking a lock
+  // and a background thread hands them to the target sink. If the ring is
+  // full the message is dropped and counted; the count is reported through
+  // the target when space becomes available. The filter and options of this
+  // sink apply on the producer side, those of the target when the entry is
+  // written.
+  class AsyncLogSink : public ILogSink
+    {
+      class h__Drain;
+
+      struct Slot
+      {
+	volatile ui32_t Sequence;
+	ui32_t          PID;
+	LogType_t       Type;
+	char            Msg[MaxLogLength];
+      };
+
+      ILogSink&       m_Target;
+      Slot*           m_Ring;
+      ui32_t          m_Mask;
+      volatile ui32_t m_EnqueuePos;
+      volatile ui32_t m_DequeuePos;
+      volatile ui32_t m_DropCount;
+      volatile ui32_t m_Stop;
+      h__Drain*       m_Drain;
+
+      KM_NO_COPY_CONSTRUCT(AsyncLogSink);
+      AsyncLogSink();
+
+      Slot* ClaimSlot();
+      void  PublishSlot(Slot*);
+      bool  DrainOne();
+
+    public:
+      // slot_count is rounded up to a power of two
+      AsyncLogSink(ILogSink& target, ui32_t slot_count = 1024);
+      virtual ~AsyncLogSink(); // drains the ring before returning
+
+      // waits until every message accepted so far has been written to the target
+      void Flush();
+
+      // number of messages discarded because the ring was full
+      ui32_t DropCount() { return AtomicLoad(&m_DropCount); }
+
+      virtual void vLogf(LogType_t, const char*, va_list*);
+      void WriteEntry(const LogEntry&);
+    };
+
 #ifdef KM_WIN32
   // write messages to the Win32 debug stream
   class WinDbgLogSink : public ILogSink
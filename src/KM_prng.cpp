@@ -34,6 +34,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <KM_aes.h>
 #include <KM_sha1.h>
 #include <KM_mutex.h>
+#include <KM_thread.h>
 #include <string.h>
 #include <assert.h>
 
@@ -60,7 +61,7 @@ const ui32_t RNG_BLOCK_SIZE = AES_BLOCKLEN;
 const ui32_t MAX_SEQUENCE_LEN = 0x00040000UL;
 
 namespace{
-    // internal implementation class
+    // internal implementation class, not thread safe
     class h__RNG
     {
       KM_NO_COPY_CONSTRUCT(h__RNG);
@@ -68,41 +69,43 @@ namespace{
     public:
       AES_ctx   m_Context;
       byte_t    m_ctr_buf[RNG_BLOCK_SIZE];
-      Mutex     m_Lock;
 
+      // seed from the operating system
       h__RNG()
       {
         memset(m_ctr_buf, 0, RNG_BLOCK_SIZE);
         byte_t rng_key[RNG_KEY_SIZE];
 
-        { // this block scopes the following AutoMutex so that it will be
-          // released before the call to set_key() below.
-          AutoMutex Lock(m_Lock);
-
     #ifdef KM_WIN32
-          HCRYPTPROV hProvider = 0;
-          CryptAcquireContext(&hProvider, 0, 0, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT);
-          CryptGenRandom(hProvider, RNG_KEY_SIZE, rng_key);
+        HCRYPTPROV hProvider = 0;
+        CryptAcquireContext(&hProvider, 0, 0, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT);
+        CryptGenRandom(hProvider, RNG_KEY_SIZE, rng_key);
     #else // KM_WIN32
-          // on POSIX systems we simply read some seed from /dev/urandom
-          FileReader URandom;
+        // on POSIX systems we simply read some seed from /dev/urandom
+        FileReader URandom;
 
-          Result_t result = URandom.OpenRead(DEV_URANDOM);
+        Result_t result = URandom.OpenRead(DEV_URANDOM);
 
-          if ( KM_SUCCESS(result) )
-        {
-          ui32_t read_count;
-          result = URandom.Read(rng_key, RNG_KEY_SIZE, &read_count);
-        }
+        if ( KM_SUCCESS(result) )
+          {
+            ui32_t read_count;
+            result = URandom.Read(rng_key, RNG_KEY_SIZE, &read_count);
+          }
 
-          if ( KM_FAILURE(result) )
-        DefaultLogSink().Error("Error opening random device: %s\n", DEV_URANDOM);
+        if ( KM_FAILURE(result) )
+          DefaultLogSink().Error("Error opening random device: %s\n", DEV_URANDOM);
 
     #endif // KM_WIN32
-        } // end AutoMutex context
 
         set_key(rng_key);
       }
+
+      // seed from RNG_KEY_SIZE bytes of another generator's output
+      h__RNG(const byte_t* key_fodder)
+      {
+        memset(m_ctr_buf, 0, RNG_BLOCK_SIZE);
+        set_key(key_fodder);
+      }
         
       //
       void
@@ -117,7 +120,6 @@ namespace{
         SHA1_Update(&SHA, key_fodder, RNG_KEY_SIZE);
         SHA1_Final(sha_buf, &SHA);
 
-        AutoMutex Lock(m_Lock);
         AES_init_ctx(&m_Context, sha_buf);
         *(ui32_t*)(m_ctr_buf + 12) = 1;
       }
@@ -128,7 +130,6 @@ namespace{
       {
         assert(len <= MAX_SEQUENCE_LEN);
         ui32_t gen_count = 0;
-        AutoMutex Lock(m_Lock);
 
         while ( gen_count + RNG_BLOCK_SIZE <= len )
           {
@@ -146,11 +147,164 @@ namespace{
         memcpy(buf + gen_count, tmp, len - gen_count);
           }
       }
+
+      // fill the buffer, re-seeding the generator after each sequence
+      void
+      generate(byte_t* buf, ui32_t len)
+      {
+        while ( len )
+          {
+            // 2^20 bytes max per seeding, use 2^19 to save
+            // room for generating reseed values
+            ui32_t gen_size = xmin(len, MAX_SEQUENCE_LEN);
+            fill_rand(buf, gen_size);
+            buf += gen_size;
+            len -= gen_size;
+
+            // re-seed the generator
+            byte_t rng_key[RNG_KEY_SIZE];
+            fill_rand(rng_key, RNG_KEY_SIZE);
+            set_key(rng_key);
+          }
+      }
+    };
+
+    // the process-wide generator, seeded by the OS and serialized by a lock
+    class h__SharedRNG
+    {
+      KM_NO_COPY_CONSTRUCT(h__SharedRNG);
+      h__RNG    m_RNG;
+      Mutex     m_Lock;
+
+    public:
+      h__SharedRNG() {}
+
+      void
+      generate(byte_t* buf, ui32_t len)
+      {
+        AutoMutex Lock(m_Lock);
+        m_RNG.generate(buf, len);
+      }
+    };
+
+    // A generator owned by one thread, seeded from the shared generator. Small
+    // requests (IVs, UUIDs) are served from a pool filled RNG_POOL_SIZE bytes
+    // per pass and re-seed, and consumed pool bytes are erased.
+    const ui32_t RNG_POOL_SIZE = 4096UL;
+
+    class h__LocalRNG
+    {
+      KM_NO_COPY_CONSTRUCT(h__LocalRNG);
+      h__LocalRNG();
+
+      h__RNG    m_RNG;
+      byte_t    m_Pool[RNG_POOL_SIZE];
+      ui32_t    m_PoolPos;
+
+    public:
+      h__LocalRNG(const byte_t* key_fodder) : m_RNG(key_fodder), m_PoolPos(RNG_POOL_SIZE) {}
+      ~h__LocalRNG() { memset(m_Pool, 0, RNG_POOL_SIZE); }
+
+      void
+      generate(byte_t* buf, ui32_t len)
+      {
+        if ( len >= RNG_POOL_SIZE )
+          {
+            m_RNG.generate(buf, len);
+            return;
+          }
+
+        while ( len )
+          {
+            if ( m_PoolPos == RNG_POOL_SIZE )
+              {
+                m_RNG.generate(m_Pool, RNG_POOL_SIZE);
+                m_PoolPos = 0;
+              }
+
+            ui32_t copy_size = xmin(len, RNG_POOL_SIZE - m_PoolPos);
+            memcpy(buf, m_Pool + m_PoolPos, copy_size);
+            memset(m_Pool + m_PoolPos, 0, copy_size);
+            m_PoolPos += copy_size;
+            buf += copy_size;
+            len -= copy_size;
+          }
+      }
     };
 }
 
 
-static h__RNG* s_RNG = 0;
+static void* volatile s_RNG = 0; // h__SharedRNG*
+static Mutex s_RNGInitLock;
+
+#ifdef KM_WIN32
+static DWORD s_LocalRNGKey = FLS_OUT_OF_INDEXES;
+static VOID WINAPI h__DeleteLocalRNG(PVOID p) { delete static_cast<h__LocalRNG*>(p); }
+#else // KM_WIN32
+static pthread_key_t s_LocalRNGKey;
+static bool s_LocalRNGKeyValid = false;
+static void h__DeleteLocalRNG(void* p) { delete static_cast<h__LocalRNG*>(p); }
+#endif // KM_WIN32
+
+//
+static h__SharedRNG*
+h__GetSharedRNG()
+{
+  h__SharedRNG* rng = static_cast<h__SharedRNG*>(AtomicLoadPtr(&s_RNG));
+
+  if ( rng == 0 )
+    {
+      AutoMutex L(s_RNGInitLock);
+      rng = static_cast<h__SharedRNG*>(s_RNG);
+
+      if ( rng == 0 )
+	{
+#ifdef KM_WIN32
+	  s_LocalRNGKey = FlsAlloc(h__DeleteLocalRNG);
+#else // KM_WIN32
+	  s_LocalRNGKeyValid = ( pthread_key_create(&s_LocalRNGKey, h__DeleteLocalRNG) == 0 );
+#endif // KM_WIN32
+	  rng = new h__SharedRNG;
+	  AtomicStorePtr(&s_RNG, rng);
+	}
+    }
+
+  return rng;
+}
+
+// Returns the calling thread's generator, creating it on first use.
+// Returns zero if thread local storage is not available.
+static h__LocalRNG*
+h__GetLocalRNG(h__SharedRNG* shared)
+{
+#ifdef KM_WIN32
+  if ( s_LocalRNGKey == FLS_OUT_OF_INDEXES )
+    return 0;
+
+  h__LocalRNG* local = static_cast<h__LocalRNG*>(FlsGetValue(s_LocalRNGKey));
+#else // KM_WIN32
+  if ( ! s_LocalRNGKeyValid )
+    return 0;
+
+  h__LocalRNG* local = static_cast<h__LocalRNG*>(pthread_getspecific(s_LocalRNGKey));
+#endif // KM_WIN32
+
+  if ( local == 0 )
+    {
+      byte_t rng_key[RNG_KEY_SIZE];
+      shared->generate(rng_key, RNG_KEY_SIZE);
+      local = new h__LocalRNG(rng_key);
+      memset(rng_key, 0, RNG_KEY_SIZE);
+
+#ifdef KM_WIN32
+      FlsSetValue(s_LocalRNGKey, local);
+#else // KM_WIN32
+      pthread_setspecific(s_LocalRNGKey, local);
+#endif // KM_WIN32
+    }
+
+  return local;
+}
 
 
 //------------------------------------------------------------------------------------------
@@ -159,8 +313,7 @@ static h__RNG* s_RNG = 0;
 
 Kumu::FortunaRNG::FortunaRNG()
 {
-  if ( s_RNG == 0 )
-    s_RNG = new h__RNG;
+  h__GetSharedRNG();
 }
 
 Kumu::FortunaRNG::~FortunaRNG() {}
@@ -170,25 +323,15 @@ const byte_t*
 Kumu::FortunaRNG::FillRandom(byte_t* buf, ui32_t len)
 {
   assert(buf);
-  assert(s_RNG);
-  const byte_t* front_of_buffer = buf;
+  h__SharedRNG* shared = h__GetSharedRNG();
+  h__LocalRNG* local = h__GetLocalRNG(shared);
 
-  while ( len )
-    {
-      // 2^20 bytes max per seeding, use 2^19 to save
-      // room for generating reseed values
-      ui32_t gen_size = xmin(len, MAX_SEQUENCE_LEN);
-      s_RNG->fill_rand(buf, gen_size);
-      buf += gen_size;
-      len -= gen_size;
-	  
-      // re-seed the generator
-      byte_t rng_key[RNG_KEY_SIZE];
-      s_RNG->fill_rand(rng_key, RNG_KEY_SIZE);
-      s_RNG->set_key(rng_key);
-  }
-  
-  return front_of_buffer;
+  if ( local != 0 )
+    local->generate(buf, len);
+  else
+    shared->generate(buf, len);
+
+  return buf;
 }
 
 //
@@ -36,6 +36,11 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace Kumu
 {
+  // Each thread draws from its own generator, seeded from a shared
+  // process-wide generator the first time the thread asks for random bytes.
+  // Small requests are served from a per-thread pool which is refilled in
+  // bulk, so concurrent writers do not contend for a lock when generating
+  // IVs or UUIDs.
   class FortunaRNG
     {
       KM_NO_COPY_CONSTRUCT(FortunaRNG);
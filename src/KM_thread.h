@@ -0,0 +1,203 @@
+/*
+Copyright (c) 2004-2016, John Hurst
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+3. The name of the author may not be used to endorse or promote products
+   derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+  /*! \file    KM_thread.h
+    \version $Id$
+    \brief   platform portability: threads and atomic operations
+  */
+
+#ifndef _KM_THREAD_H_
+#define _KM_THREAD_H_
+
+#include <KM_platform.h>
+
+#ifndef KM_WIN32
+# include <pthread.h>
+# include <unistd.h>
+# include <time.h>
+#endif
+
+namespace Kumu
+{
+  //------------------------------------------------------------------------------------------
+  // atomic operations on 32-bit counters and pointers. Loads have acquire
+  // semantics, stores have release semantics, the read-modify-write operations
+  // are full barriers.
+
+#ifdef KM_WIN32
+  inline ui32_t AtomicLoad(volatile ui32_t* p) {
+    return (ui32_t)::InterlockedCompareExchange((volatile LONG*)p, 0, 0);
+  }
+
+  inline void AtomicStore(volatile ui32_t* p, ui32_t v) {
+    ::InterlockedExchange((volatile LONG*)p, (LONG)v);
+  }
+
+  // returns the new value
+  inline ui32_t AtomicAdd(volatile ui32_t* p, ui32_t v) {
+    return (ui32_t)::InterlockedExchangeAdd((volatile LONG*)p, (LONG)v) + v;
+  }
+
+  // sets *p to desired if *p == expected, returns true if the exchange was made
+  inline bool AtomicCompareExchange(volatile ui32_t* p, ui32_t expected, ui32_t desired) {
+    return (ui32_t)::InterlockedCompareExchange((volatile LONG*)p, (LONG)desired, (LONG)expected) == expected;
+  }
+
+  inline void* AtomicLoadPtr(void* volatile* p) {
+    return ::InterlockedCompareExchangePointer(p, 0, 0);
+  }
+
+  inline void AtomicStorePtr(void* volatile* p, void* v) {
+    ::InterlockedExchangePointer(p, v);
+  }
+
+  // suspend the calling thread
+  inline void SleepMilliseconds(ui32_t ms) { ::Sleep(ms); }
+
+#else // KM_WIN32
+  inline ui32_t AtomicLoad(volatile ui32_t* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+  }
+
+  inline void AtomicStore(volatile ui32_t* p, ui32_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+  }
+
+  // returns the new value
+  inline ui32_t AtomicAdd(volatile ui32_t* p, ui32_t v) {
+    return __atomic_add_fetch(p, v, __ATOMIC_SEQ_CST);
+  }
+
+  // sets *p to desired if *p == expected, returns true if the exchange was made
+  inline bool AtomicCompareExchange(volatile ui32_t* p, ui32_t expected, ui32_t desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  }
+
+  inline void* AtomicLoadPtr(void* volatile* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+  }
+
+  inline void AtomicStorePtr(void* volatile* p, void* v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+  }
+
+  // suspend the calling thread
+  inline void SleepMilliseconds(ui32_t ms) { ::usleep(ms * 1000); }
+
+#endif // KM_WIN32
+
+  //------------------------------------------------------------------------------------------
+  // a joinable thread of execution. Derive from Thread, implement Run() and
+  // call Start(). The destructor does not join, call Join() before the
+  // derived object is destroyed.
+
+  class Thread
+    {
+#ifdef KM_WIN32
+      HANDLE m_Thread;
+      static DWORD WINAPI h__Run(LPVOID arg) { static_cast<Thread*>(arg)->Run(); return 0; }
+#else
+      pthread_t m_Thread;
+      static void* h__Run(void* arg) { static_cast<Thread*>(arg)->Run(); return 0; }
+#endif
+      bool m_Running;
+      KM_NO_COPY_CONSTRUCT(Thread);
+
+    public:
+      Thread() : m_Running(false) {}
+      virtual ~Thread() { assert(!m_Running); }
+
+      // the thread body
+      virtual void Run() = 0;
+
+      // returns true if the thread was started
+      bool Start() {
+	assert(!m_Running);
+#ifdef KM_WIN32
+	m_Thread = ::CreateThread(0, 0, h__Run, this, 0, 0);
+	m_Running = ( m_Thread != 0 );
+#else
+	m_Running = ( pthread_create(&m_Thread, 0, h__Run, this) == 0 );
+#endif
+	return m_Running;
+      }
+
+      // waits for Run() to return
+      void Join() {
+	if ( m_Running )
+	  {
+#ifdef KM_WIN32
+	    ::WaitForSingleObject(m_Thread, INFINITE);
+	    ::CloseHandle(m_Thread);
+#else
+	    pthread_join(m_Thread, 0);
+#endif
+	    m_Running = false;
+	  }
+      }
+
+      inline bool IsRunning() const { return m_Running; }
+    };
+
+  // a reasonable default size for a pool of worker threads
+  inline ui32_t HardwareConcurrency()
+    {
+#ifdef KM_WIN32
+      SYSTEM_INFO info;
+      ::GetSystemInfo(&info);
+      return xmax<ui32_t>(1, info.dwNumberOfProcessors);
+#elif defined(_SC_NPROCESSORS_ONLN)
+      long n = sysconf(_SC_NPROCESSORS_ONLN);
+      return ( n > 0 ) ? (ui32_t)n : 1;
+#else
+      return 1;
+#endif
+    }
+
+  // microseconds from an arbitrary origin on a clock that never steps, for
+  // measuring intervals
+  inline ui64_t MonotonicMicroseconds()
+    {
+#ifdef KM_WIN32
+      LARGE_INTEGER count, frequency;
+      ::QueryPerformanceCounter(&count);
+      ::QueryPerformanceFrequency(&frequency);
+      return (ui64_t)( count.QuadPart / frequency.QuadPart * 1000000
+		       + count.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart );
+#else
+      struct timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      return (ui64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+    }
+
+} // namespace Kumu
+
+#endif // _KM_THREAD_H_
+
+//
+// end KM_thread.h
+//
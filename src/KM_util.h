@@ -36,6 +36,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <KM_error.h>
 #include <KM_tai.h>
 #include <string.h>
+#include <algorithm>
 #include <list>
 
 namespace Kumu
@@ -519,19 +520,31 @@ namespace Kumu
 	
     public:
       ByteString();
-      ByteString(const ByteString& rhs) { Copy(rhs); }
+      ByteString(const ByteString& rhs) : m_Data(0), m_Capacity(0), m_Length(0) { Copy(rhs); }
       ByteString(ui32_t cap);
       virtual ~ByteString();
 
       const ByteString& operator=(const ByteString& rhs) { Copy(rhs); return *this; }
 
       void Copy(const ByteString& rhs) {
-        if ( KM_SUCCESS(Capacity(rhs.Length())) )
+	if ( this == &rhs )
+	  return;
+
+	m_Length = 0;
+
+        if ( rhs.Length() > 0 && KM_SUCCESS(Capacity(rhs.Length())) )
 	  {
-	    Set(rhs);
+	    Set(rhs.RoData(), rhs.Length());
 	  }
       }
 
+      // Exchanges contents with rhs without copying.
+      void Swap(ByteString& rhs) {
+	std::swap(m_Data, rhs.m_Data);
+	std::swap(m_Capacity, rhs.m_Capacity);
+	std::swap(m_Length, rhs.m_Length);
+      }
+
       // Sets or resets the size of the internally allocated buffer.
       Result_t Capacity(ui32_t cap);
 
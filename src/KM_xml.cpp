@@ -30,10 +30,12 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <KM_xml.h>
+#include <KM_fileio.h>
 #include <KM_log.h>
 #include <KM_mutex.h>
 #include <stack>
 #include <map>
+#include <new>
 
 #ifdef HAVE_EXPAT
 # ifdef HAVE_XERCES_C
@@ -91,17 +93,143 @@ namespace{
 }
 
 
-Kumu::XMLElement::XMLElement(const char* name) : m_Namespace(0), m_NamespaceOwner(0)
+//----------------------------------------------------------------------------------------------------
+
+// Element storage is allocated from blocks that grow geometrically, so a parsed
+// document costs a few block allocations rather than one per element. Each element
+// carved from the arena holds a reference to it, as does the root element that
+// created it; the blocks are freed when the last reference is released.
+class Kumu::XMLArena
+{
+  KM_NO_COPY_CONSTRUCT(XMLArena);
+
+  std::list<byte_t*>    m_Blocks;
+  byte_t*               m_Next;
+  ui32_t                m_Remaining;
+  ui32_t                m_NextBlockSize;
+  ui32_t                m_RefCount;
+  std::set<std::string> m_Names;
+  std::string           m_NameBuf; // re-used for lookups
+
+public:
+  XMLArena() : m_Next(0), m_Remaining(0), m_NextBlockSize(16 * Kilobyte), m_RefCount(1) {}
+
+  ~XMLArena()
+  {
+    while ( ! m_Blocks.empty() )
+      {
+	delete [] m_Blocks.front();
+	m_Blocks.pop_front();
+      }
+  }
+
+  inline void AddRef() { ++m_RefCount; }
+
+  inline void Release()
+  {
+    assert(m_RefCount > 0);
+    if ( --m_RefCount == 0 )
+      delete this;
+  }
+
+  //
+  void* Alloc(ui32_t size)
+  {
+    size = ( size + 15 ) & ~15;
+
+    if ( size > m_Remaining )
+      {
+	ui32_t block_size = Kumu::xmax(m_NextBlockSize, size);
+	m_Blocks.push_back(new byte_t[block_size]);
+	m_Next = m_Blocks.back();
+	m_Remaining = block_size;
+
+	if ( m_NextBlockSize < Megabyte )
+	  m_NextBlockSize *= 2;
+      }
+
+    void* p = m_Next;
+    m_Next += size;
+    m_Remaining -= size;
+    return p;
+  }
+
+  //
+  const std::string* Intern(const char* name)
+  {
+    m_NameBuf.assign(name);
+    return &*m_Names.insert(m_NameBuf).first;
+  }
+};
+
+// Each element is preceded by the arena it was carved from, 0 for the heap.
+static const size_t s_ElementHeaderSize = 16;
+
+//
+void*
+Kumu::XMLElement::operator new(size_t size)
 {
-  m_Name = name;
+  byte_t* p = (byte_t*)::operator new(size + s_ElementHeaderSize);
+  *(XMLArena**)p = 0;
+  return p + s_ElementHeaderSize;
 }
 
+//
+void
+Kumu::XMLElement::operator delete(void* p)
+{
+  if ( p == 0 )
+    return;
+
+  byte_t* header = (byte_t*)p - s_ElementHeaderSize;
+  XMLArena* arena = *(XMLArena**)header;
+
+  if ( arena == 0 )
+    ::operator delete(header);
+  else
+    arena->Release(); // the element's reference
+}
+
+//
+Kumu::XMLElement::XMLElement(const char* name) : m_Namespace(0), m_NamespaceOwner(0), m_InArena(false)
+{
+  m_Arena = new XMLArena;
+  m_Name = m_Arena->Intern(name);
+}
+
+//
+Kumu::XMLElement::XMLElement(const char* name, XMLArena* arena) :
+  m_Namespace(0), m_NamespaceOwner(0), m_Arena(arena), m_InArena(false)
+{
+  assert(m_Arena);
+  m_Arena->AddRef();
+  m_Name = m_Arena->Intern(name);
+}
+
+//
 Kumu::XMLElement::~XMLElement()
 {
   for ( Elem_i i = m_ChildList.begin(); i != m_ChildList.end(); i++ )
     delete *i;
 
   delete (ns_map*)m_NamespaceOwner;
+
+  // an element in the arena gives up its reference in operator delete,
+  // after its storage is no longer in use
+  if ( ! m_InArena )
+    m_Arena->Release();
+}
+
+// creates a child element in this tree's arena
+Kumu::XMLElement*
+Kumu::XMLElement::NewChild(const char* name)
+{
+  byte_t* p = (byte_t*)m_Arena->Alloc(sizeof(XMLElement) + s_ElementHeaderSize);
+  *(XMLArena**)p = m_Arena;
+  XMLElement* tmpE = ::new (p + s_ElementHeaderSize) XMLElement(name, m_Arena);
+  tmpE->m_InArena = true;
+  m_ChildList.push_back(tmpE);
+  return tmpE;
 }
 
 //
@@ -127,9 +255,7 @@ Kumu::XMLElement::AddChild(Kumu::XMLElement* element)
 Kumu::XMLElement*
 Kumu::XMLElement::AddChild(const char* name)
 {
-  XMLElement* tmpE = new XMLElement(name);
-  m_ChildList.push_back(tmpE);
-  return tmpE;
+  return NewChild(name);
 }
 
 //
@@ -146,6 +272,13 @@ Kumu::XMLElement::AppendBody(const std::string& value)
   m_Body += value;
 }
 
+//
+void
+Kumu::XMLElement::AppendBody(const char* value, ui32_t length)
+{
+  m_Body.append(value, length);
+}
+
 //
 void
 Kumu::XMLElement::SetBody(const std::string& value)
@@ -159,9 +292,8 @@ Kumu::XMLElement::AddChildWithContent(const char* name, const char* value)
 {
   assert(name);
   assert(value);
-  XMLElement* tmpE = new XMLElement(name);
+  XMLElement* tmpE = NewChild(name);
   tmpE->m_Body = value;
-  m_ChildList.push_back(tmpE);
   return tmpE;
 }
 
@@ -169,10 +301,9 @@ Kumu::XMLElement::AddChildWithContent(const char* name, const char* value)
 Kumu::XMLElement*
 Kumu::XMLElement::AddChildWithPrefixedContent(const char* name, const char* prefix, const char* value)
 {
-  XMLElement* tmpE = new XMLElement(name);
+  XMLElement* tmpE = NewChild(name);
   tmpE->m_Body = prefix;
   tmpE->m_Body += value;
-  m_ChildList.push_back(tmpE);
   return tmpE;
 }
 
@@ -186,74 +317,126 @@ Kumu::XMLElement::AddComment(const char* value)
 }
 
 //
+static const char s_XMLDeclaration[] = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+
+// The document is measured first and then written into a buffer of exactly that
+// size, so the output string is allocated once.
 void
 Kumu::XMLElement::Render(std::string& outbuf, const bool& pretty) const
 {
-  outbuf = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
-  RenderElement(outbuf, 0, pretty);
+  const ui32_t decl_length = sizeof(s_XMLDeclaration) - 1;
+  ui64_t length = RenderedLength(0, pretty);
+  outbuf.resize(decl_length + length);
+  memcpy(&outbuf[0], s_XMLDeclaration, decl_length);
+  char* end = RenderTo(&outbuf[0] + decl_length, 0, pretty);
+  assert(end == &outbuf[0] + outbuf.size());
+}
+
+//
+void
+Kumu::XMLElement::RenderElement(std::string& outbuf, const ui32_t& depth, const bool& pretty) const
+{
+  size_t start = outbuf.size();
+  outbuf.resize(start + RenderedLength(depth, pretty));
+  char* end = RenderTo(&outbuf[0] + start, depth, pretty);
+  assert(end == &outbuf[0] + outbuf.size());
+}
+
+// returns the number of bytes RenderTo() will write
+ui64_t
+Kumu::XMLElement::RenderedLength(const ui32_t& depth, const bool& pretty) const
+{
+  ui64_t length = ( pretty ? depth * 2 : 0 ) + 1 + m_Name->size() + 1; // <name>
+
+  for ( Attr_i i = m_AttrList.begin(); i != m_AttrList.end(); ++i )
+    length += 1 + i->name.size() + 2 + i->value.size() + 1; // name="value"
+
+  length += m_Body.size();
+
+  if ( ! m_ChildList.empty() )
+    {
+      length += 1 + ( pretty ? depth * 2 : 0 );
+
+      for ( Elem_i i = m_ChildList.begin(); i != m_ChildList.end(); ++i )
+	length += (*i)->RenderedLength(depth + 1, pretty);
+    }
+
+  return length + 2 + m_Name->size() + 2; // </name>\n
+}
+
+//
+inline char*
+put_chars(char* p, const char* s, size_t length)
+{
+  memcpy(p, s, length);
+  return p + length;
 }
 
 //
-inline void
-add_spacer(std::string& outbuf, i32_t depth)
+inline char*
+put_string(char* p, const std::string& s)
 {
-  while ( depth-- )
-    outbuf+= "  ";
+  return put_chars(p, s.c_str(), s.size());
 }
 
 //
-void
-Kumu::XMLElement::RenderElement(std::string& outbuf, const ui32_t& depth, const bool& pretty) const
+inline char*
+put_spacer(char* p, ui32_t depth)
+{
+  memset(p, ' ', depth * 2);
+  return p + depth * 2;
+}
+
+//
+char*
+Kumu::XMLElement::RenderTo(char* p, const ui32_t& depth, const bool& pretty) const
 {
   if ( pretty )
     {
-      add_spacer(outbuf, depth);
+      p = put_spacer(p, depth);
     }
 
-  outbuf += "<";
-  outbuf += m_Name;
+  *p++ = '<';
+  p = put_string(p, *m_Name);
 
   // render attributes
   for ( Attr_i i = m_AttrList.begin(); i != m_AttrList.end(); ++i )
     {
-      outbuf += " ";
-      outbuf += (*i).name;
-      outbuf += "=\"";
-      outbuf += (*i).value;
-      outbuf += "\"";
+      *p++ = ' ';
+      p = put_string(p, i->name);
+      p = put_chars(p, "=\"", 2);
+      p = put_string(p, i->value);
+      *p++ = '"';
     }
 
-  outbuf += ">";
+  *p++ = '>';
 
   // body contents and children
   if ( ! m_ChildList.empty() )
     {
-      outbuf += "\n";
+      *p++ = '\n';
 
       // render body
-      if ( m_Body.length() > 0 )
-	{
-	  outbuf += m_Body;
-	}
+      p = put_string(p, m_Body);
 
       for ( Elem_i i = m_ChildList.begin(); i != m_ChildList.end(); ++i )
 	{
-	  (*i)->RenderElement(outbuf, depth + 1, pretty);
+	  p = (*i)->RenderTo(p, depth + 1, pretty);
 	}
 
       if ( pretty )
 	{
-	  add_spacer(outbuf, depth);
+	  p = put_spacer(p, depth);
 	}
     }
-  else if ( m_Body.length() > 0 )
+  else
     {
-      outbuf += m_Body;
+      p = put_string(p, m_Body);
     }
 
-  outbuf += "</";
-  outbuf += m_Name;
-  outbuf += ">\n";
+  p = put_chars(p, "</", 2);
+  p = put_string(p, *m_Name);
+  return put_chars(p, ">\n", 2);
 }
 
 //
@@ -263,7 +446,7 @@ Kumu::XMLElement::HasName(const char* name) const
   if ( name == 0 || *name == 0 )
     return false;
 
-  return (m_Name == name);
+  return ( *m_Name == name );
 }
 
 
@@ -271,7 +454,7 @@ void
 Kumu::XMLElement::SetName(const char* name)
 {
   if ( name != 0)
-    m_Name = name;
+    m_Name = m_Arena->Intern(name);
 }
 
 //
@@ -503,9 +686,7 @@ xph_char(void* p, const XML_Char* data, int len)
 
   if ( len > 0 )
     {
-      std::string tmp_str;
-      tmp_str.assign(data, len);
-      Ctx->Scope.top()->AppendBody(tmp_str);
+      Ctx->Scope.top()->AppendBody(data, len);
     }
 }
 
@@ -630,7 +811,278 @@ Kumu::XMLElement::ParseFirstFromString(const char* document, ui32_t doc_len)
   return true;
 }
 
+//
+class ExpatStreamParser
+{
+  KM_NO_COPY_CONSTRUCT(ExpatStreamParser);
+  ExpatStreamParser();
+
+public:
+  XML_Parser         Parser;
+  IXMLStreamHandler& Handler;
+  std::string        NamespaceName; // re-used for every event
+  AttributeList      Attributes;
+  bool               Stopped;
+
+  ExpatStreamParser(IXMLStreamHandler& handler);
+  ~ExpatStreamParser();
+
+  bool Parse(const char* buf, ui32_t buf_len, bool is_final);
+};
+
+// expat stream wrapper functions
+//
+static const char*
+xph_split_name(const char* name, std::string& ns_name)
+{
+  const char* local_name = strchr(name, '|');
+
+  if ( local_name == 0 )
+    {
+      ns_name.clear();
+      return name;
+    }
+
+  ns_name.assign(name, local_name - name);
+  return local_name + 1;
+}
+
+//
+static void
+xph_stream_stop(ExpatStreamParser* Ctx)
+{
+  Ctx->Stopped = true;
+  XML_StopParser(Ctx->Parser, false);
+}
+
+//
+static void
+xph_stream_start(void* p, const XML_Char* name, const XML_Char** attrs)
+{
+  assert(p);  assert(name);  assert(attrs);
+  ExpatStreamParser* Ctx = (ExpatStreamParser*)p;
 
+  if ( Ctx->Stopped )
+    return;
+
+  Ctx->Attributes.clear();
+
+  for ( int i = 0; attrs[i] != 0; i += 2 )
+    {
+      const char* local_name = strchr(attrs[i], '|');
+      NVPair TmpPair;
+      TmpPair.name = ( local_name == 0 ) ? attrs[i] : local_name + 1;
+      TmpPair.value = attrs[i+1];
+      Ctx->Attributes.push_back(TmpPair);
+    }
+
+  const char* local_name = xph_split_name(name, Ctx->NamespaceName);
+
+  if ( ! Ctx->Handler.StartElement(Ctx->NamespaceName.c_str(), local_name, Ctx->Attributes) )
+    xph_stream_stop(Ctx);
+}
+
+//
+static void
+xph_stream_end(void* p, const XML_Char* name)
+{
+  assert(p);  assert(name);
+  ExpatStreamParser* Ctx = (ExpatStreamParser*)p;
+
+  if ( Ctx->Stopped )
+    return;
+
+  const char* local_name = xph_split_name(name, Ctx->NamespaceName);
+
+  if ( ! Ctx->Handler.EndElement(Ctx->NamespaceName.c_str(), local_name) )
+    xph_stream_stop(Ctx);
+}
+
+//
+static void
+xph_stream_char(void* p, const XML_Char* data, int len)
+{
+  assert(p);  assert(data);
+  ExpatStreamParser* Ctx = (ExpatStreamParser*)p;
+
+  if ( Ctx->Stopped || len <= 0 )
+    return;
+
+  if ( ! Ctx->Handler.CharacterData(data, len) )
+    xph_stream_stop(Ctx);
+}
+
+//
+ExpatStreamParser::ExpatStreamParser(IXMLStreamHandler& handler) : Handler(handler), Stopped(false)
+{
+  Parser = XML_ParserCreateNS("UTF-8", '|');
+
+  if ( Parser == 0 )
+    {
+      DefaultLogSink().Error("Error allocating memory for XML parser.\n");
+      return;
+    }
+
+  XML_SetUserData(Parser, (void*)this);
+  XML_SetElementHandler(Parser, xph_stream_start, xph_stream_end);
+  XML_SetCharacterDataHandler(Parser, xph_stream_char);
+}
+
+//
+ExpatStreamParser::~ExpatStreamParser()
+{
+  if ( Parser != 0 )
+    XML_ParserFree(Parser);
+}
+
+//
+bool
+ExpatStreamParser::Parse(const char* buf, ui32_t buf_len, bool is_final)
+{
+  if ( Parser == 0 )
+    return false;
+
+  if ( XML_Parse(Parser, buf, buf_len, is_final) == XML_STATUS_ERROR && ! Stopped )
+    {
+      DefaultLogSink().Error("XML Parse error on line %d: %s\n",
+			     XML_GetCurrentLineNumber(Parser),
+			     XML_ErrorString(XML_GetErrorCode(Parser)));
+      return false;
+    }
+
+  return true;
+}
+
+//
+bool
+Kumu::ParseXMLStream(const char* document, ui32_t doc_len, IXMLStreamHandler& handler)
+{
+  if ( doc_len == 0 )
+    {
+      return false;
+    }
+
+  ExpatStreamParser Parser(handler);
+  return Parser.Parse(document, doc_len, true);
+}
+
+//
+bool
+Kumu::ParseXMLFile(const std::string& filename, IXMLStreamHandler& handler)
+{
+  const ui32_t block_size = 64 * Kilobyte;
+  FileReader Reader;
+  ByteString ReadBuf;
+
+  Result_t result = Reader.OpenRead(filename);
+
+  if ( KM_SUCCESS(result) )
+    result = ReadBuf.Capacity(block_size);
+
+  if ( KM_FAILURE(result) )
+    {
+      DefaultLogSink().Error("%s: %s\n", filename.c_str(), result.Label());
+      return false;
+    }
+
+  ExpatStreamParser Parser(handler);
+  ui64_t total_read = 0;
+  bool is_final = false;
+
+  while ( ! is_final && ! Parser.Stopped )
+    {
+      ui32_t read_count = 0;
+      result = Reader.Read(ReadBuf.Data(), block_size, &read_count);
+
+      if ( result == RESULT_ENDOFFILE )
+	{
+	  result = RESULT_OK;
+	  read_count = 0;
+	}
+
+      if ( KM_FAILURE(result) )
+	{
+	  DefaultLogSink().Error("%s: %s\n", filename.c_str(), result.Label());
+	  return false;
+	}
+
+      total_read += read_count;
+      is_final = ( read_count < block_size );
+
+      if ( is_final && total_read == 0 )
+	{
+	  DefaultLogSink().Error("%s: file is empty\n", filename.c_str());
+	  return false;
+	}
+
+      if ( ! Parser.Parse((const char*)ReadBuf.RoData(), read_count, is_final) )
+	return false;
+    }
+
+  return true;
+}
+
+#endif
+
+//----------------------------------------------------------------------------------------------------
+
+#ifndef HAVE_EXPAT
+
+// Without expat the document is parsed into a tree and the events are replayed from it.
+static bool
+replay_element(const XMLElement& element, IXMLStreamHandler& handler)
+{
+  const char* ns_name = ( element.Namespace() == 0 ) ? "" : element.Namespace()->Name().c_str();
+
+  if ( ! handler.StartElement(ns_name, element.GetName().c_str(), element.GetAttributes()) )
+    return false;
+
+  if ( ! element.GetBody().empty()
+       && ! handler.CharacterData(element.GetBody().c_str(), element.GetBody().size()) )
+    return false;
+
+  const ElementList& children = element.GetChildren();
+
+  for ( Elem_i i = children.begin(); i != children.end(); ++i )
+    {
+      if ( ! replay_element(**i, handler) )
+	return false;
+    }
+
+  return handler.EndElement(ns_name, element.GetName().c_str());
+}
+
+//
+bool
+Kumu::ParseXMLStream(const char* document, ui32_t doc_len, IXMLStreamHandler& handler)
+{
+  XMLElement Root("**ParserRoot**");
+
+  if ( ! Root.ParseString(document, doc_len) )
+    return false;
+
+  replay_element(Root, handler);
+  return true;
+}
+
+//
+bool
+Kumu::ParseXMLFile(const std::string& filename, IXMLStreamHandler& handler)
+{
+  std::string document;
+  fsize_t file_size = FileSize(filename);
+
+  if ( file_size > 0xffffffff )
+    {
+      DefaultLogSink().Error("%s: file is too large to parse\n", filename.c_str());
+      return false;
+    }
+
+  if ( KM_FAILURE(ReadFileIntoString(filename, document, (ui32_t)file_size)) )
+    return false;
+
+  return ParseXMLStream(document.c_str(), document.size(), handler);
+}
 
 #endif
 
@@ -81,25 +81,41 @@ namespace Kumu
     inline const std::string& Name() const { return m_Name; }
   };
 
-  //
+  // Storage shared by the elements of one tree, see KM_xml.cpp
+  class XMLArena;
+
+  // Elements created through a tree (by the parser or by the AddChild() methods that
+  // take a name) are carved from an arena shared by the tree, and element names are
+  // stored once per tree. An element tree must not be shared between threads.
   class XMLElement
     {
       KM_NO_COPY_CONSTRUCT(XMLElement);
       XMLElement();
+      XMLElement(const char* name, XMLArena* arena);
 
     protected:
       AttributeList       m_AttrList;
       ElementList         m_ChildList;
       const XMLNamespace* m_Namespace;
       void*               m_NamespaceOwner;
+      XMLArena*           m_Arena;
+      bool                m_InArena; // storage belongs to m_Arena
+
+      const std::string*  m_Name; // interned in m_Arena
+      std::string         m_Body;
 
-      std::string   m_Name;
-      std::string   m_Body;
+      XMLElement* NewChild(const char* name);
+      ui64_t      RenderedLength(const ui32_t& depth, const bool& pretty) const;
+      char*       RenderTo(char* p, const ui32_t& depth, const bool& pretty) const;
 
     public:
       XMLElement(const char* name);
       ~XMLElement();
 
+      // elements may live in an arena, these dispose of either kind
+      static void* operator new(size_t size);
+      static void  operator delete(void* p);
+
       inline const XMLNamespace* Namespace() const { return m_Namespace; }
       inline void                SetNamespace(const XMLNamespace* ns) { assert(ns); m_Namespace = ns; }
 
@@ -115,6 +131,7 @@ namespace Kumu
       void        SetName(const char* name);
       void        SetBody(const std::string& value);
       void        AppendBody(const std::string& value);
+      void        AppendBody(const char* value, ui32_t length);
       void        SetAttr(const char* name, const char* value);
       void        SetAttr(const char* name, const std::string& value) { SetAttr(name, value.c_str()); }
       XMLElement* AddChild(XMLElement* element);
@@ -130,7 +147,7 @@ namespace Kumu
       // querying
       inline const std::string&   GetBody() const { return m_Body; }
       inline const ElementList&   GetChildren() const { return m_ChildList; }
-      inline const std::string&   GetName() const { return m_Name; }
+      inline const std::string&   GetName() const { return *m_Name; }
       inline const AttributeList& GetAttributes() const { return m_AttrList; }
       const char*        GetAttrWithName(const char* name) const;
       XMLElement*        GetChildWithName(const char* name) const;
@@ -145,6 +162,24 @@ namespace Kumu
       void        ForgetChild(const XMLElement* element);
     };
 
+  // Receives the events of ParseXMLStream() and ParseXMLFile(). Names are local
+  // names, ns_name is the namespace name ("" when there is none). Character data
+  // for one element may arrive in several pieces. Return false to end the parse
+  // early, which is not an error.
+  class IXMLStreamHandler
+    {
+    public:
+      virtual ~IXMLStreamHandler() {}
+      virtual bool StartElement(const char* ns_name, const char* name, const AttributeList& attributes) = 0;
+      virtual bool EndElement(const char* ns_name, const char* name) = 0;
+      virtual bool CharacterData(const char* data, ui32_t length) = 0;
+    };
+
+  // Parse a document without building an element tree. With expat the file is read
+  // in blocks, so memory use does not depend on the size of the document.
+  bool ParseXMLStream(const char* document, ui32_t doc_len, IXMLStreamHandler& handler);
+  bool ParseXMLFile(const std::string& filename, IXMLStreamHandler& handler);
+
   //
   template <class VisitorType>
     bool
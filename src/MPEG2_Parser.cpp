@@ -383,7 +383,12 @@ class Parser::h__Parser
   ASDCP_NO_COPY_CONSTRUCT(h__Parser);
 
 public:
-  h__Parser() : m_TmpBuffer(VESReadSize*8) {}
+  h__Parser()
+  {
+    m_TmpBuffer.Allocator(&PooledFrameBufferAllocator());
+    m_TmpBuffer.Capacity(VESReadSize*8);
+  }
+
   ~h__Parser() { Close(); }
 
   Result_t OpenRead(const std::string& filename);
@@ -417,6 +417,11 @@ namespace ASDCP
 
 	  const IndexTableSegment& operator=(const IndexTableSegment& rhs) { Copy(rhs); return *this; }
 	  virtual void Copy(const IndexTableSegment& rhs);
+
+	  // Exchanges the index table properties and entry arrays with rhs without
+	  // copying the entries. The InterchangeObject identity is not exchanged.
+	  void Swap(IndexTableSegment& rhs);
+
 	  virtual InterchangeObject *Clone() const;
 	  virtual Result_t InitFromTLVSet(TLVReader& TLVSet);
 	  virtual Result_t InitFromBuffer(const byte_t* p, ui32_t l);
@@ -425,6 +430,52 @@ namespace ASDCP
 	  virtual void     Dump(FILE* = 0);
 	};
 
+      // A read-only, compact form of the entries of a VBR index, for readers that
+      // keep the index of a long file resident. Entries are held in blocks of up to
+      // 64, each block having a 64-bit base offset; an entry stores a 32-bit delta
+      // from its block base and its flags, about five bytes against the sixteen of
+      // an IndexEntryArray element. Temporal and key frame offsets take space only
+      // once an entry with a non-zero value has been added. StreamOffset values are
+      // stored as given, so callers should append absolute file positions.
+      class CompactIndex
+	{
+	  struct Block
+	  {
+	    ui64_t BaseOffset;
+	    ui32_t FirstEntry;
+	  };
+
+	  std::vector<Block>  m_Blocks;
+	  std::vector<ui32_t> m_Deltas;
+	  std::vector<ui8_t>  m_Flags;
+	  std::vector<i8_t>   m_FrameOffsets; // temporal, key frame pairs; empty while all are zero
+	  ui32_t              m_Count;
+
+	  static bool FirstEntryLess(ui32_t entry_num, const Block& block) { return entry_num < block.FirstEntry; }
+	  ASDCP_NO_COPY_CONSTRUCT(CompactIndex);
+
+	public:
+	  CompactIndex();
+	  ~CompactIndex() {}
+
+	  void     Clear();
+
+	  // Appends the entry for the next edit unit.
+	  void     Append(const IndexTableSegment::IndexEntry&);
+
+	  // Releases unused capacity. Call when no more entries are expected.
+	  void     Trim();
+
+	  // Returns the entry for edit unit entry_num. Returns RESULT_RANGE if
+	  // entry_num is not less than Size().
+	  Result_t Lookup(ui32_t entry_num, IndexTableSegment::IndexEntry&) const;
+
+	  inline ui32_t Size() const { return m_Count; }
+
+	  // Returns the number of bytes held, not counting unused capacity.
+	  ui64_t   MemorySize() const;
+	};
+
       //---------------------------------------------------------------------------------
       //
       class Identification;
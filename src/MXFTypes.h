@@ -105,6 +105,9 @@ namespace ASDCP
 	  FixedSizeItemCollection() {}
 	  virtual ~FixedSizeItemCollection() {}
 
+	  // Exchanges the items with rhs without copying them.
+	  void Swap(FixedSizeItemCollection& rhs) { ContainerType::swap(rhs); }
+
 	  ui32_t ItemSize() const {
 	    typename ContainerType::value_type tmp_item;
 	    return tmp_item.ArchiveLength();
@@ -208,6 +211,9 @@ namespace ASDCP
 	  SimpleArray() {}
 	  virtual ~SimpleArray() {}
 
+	  // Exchanges the items with rhs without copying them.
+	  void Swap(SimpleArray& rhs) { std::list<T>::swap(rhs); }
+
 	  //
 	  bool Unarchive(Kumu::MemIOReader* Reader)
 	    {
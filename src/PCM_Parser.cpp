@@ -53,23 +53,27 @@ class ASDCP::PCM::WAVParser::h__WAVParser
   ui32_t             m_FrameBufferSize;
   ui32_t             m_FramesRead;
   Rational           m_PictureRate;
+  Kumu::ByteString   m_ReadAhead;      // holds the next run of the data chunk when streaming
+  ui32_t             m_ReadAheadPos;   // offset of the first unconsumed byte in m_ReadAhead
 
   ASDCP_NO_COPY_CONSTRUCT(h__WAVParser);
 
+  Result_t FillReadAhead(ui32_t want);
+
 public:
   AudioDescriptor  m_ADesc;
 
 
   h__WAVParser() :
     m_EOF(false), m_DataStart(0), m_DataLength(0), m_ReadCount(0),
-    m_FrameBufferSize(0), m_FramesRead(0) {}
+    m_FrameBufferSize(0), m_FramesRead(0), m_ReadAheadPos(0) {}
 
   ~h__WAVParser()
   {
     Close();
    }
 
-  Result_t OpenRead(const std::string& filename, const Rational& PictureRate);
+  Result_t OpenRead(const std::string& filename, const Rational& PictureRate, ui32_t read_ahead_size);
   void     Close();
   void     Reset();
   Result_t ReadFrame(FrameBuffer&);
@@ -91,11 +95,14 @@ ASDCP::PCM::WAVParser::h__WAVParser::Reset()
   m_FileReader.Seek(m_DataStart);
   m_FramesRead = 0;
   m_ReadCount = 0;
+  m_ReadAhead.Length(0);
+  m_ReadAheadPos = 0;
 }
 
 //
 ASDCP::Result_t
-ASDCP::PCM::WAVParser::h__WAVParser::OpenRead(const std::string& filename, const Rational& PictureRate)
+ASDCP::PCM::WAVParser::h__WAVParser::OpenRead(const std::string& filename, const Rational& PictureRate,
+						 ui32_t read_ahead_size)
 {
   Result_t result = m_FileReader.OpenRead(filename);
 
@@ -148,6 +155,31 @@ ASDCP::PCM::WAVParser::h__WAVParser::OpenRead(const std::string& filename, const
 	}
     }
 
+  if ( ASDCP_SUCCESS(result) && read_ahead_size > 0 )
+    {
+      // round the buffer down to a whole number of edit units (but at least one)
+      // so that most frames are sliced from memory without straddling a refill
+      read_ahead_size -= read_ahead_size % m_FrameBufferSize;
+      result = m_ReadAhead.Capacity(Kumu::xmax(read_ahead_size, m_FrameBufferSize));
+    }
+
+  return result;
+}
+
+// Copies up to 'want' bytes of the data chunk into m_ReadAhead, replacing the
+// consumed contents. Returns RESULT_ENDOFFILE if no bytes could be read.
+ASDCP::Result_t
+ASDCP::PCM::WAVParser::h__WAVParser::FillReadAhead(ui32_t want)
+{
+  assert(m_ReadAheadPos == m_ReadAhead.Length());
+  ui32_t read_count = 0;
+  Result_t result = m_FileReader.Read(m_ReadAhead.Data(), Kumu::xmin(want, m_ReadAhead.Capacity()), &read_count);
+  m_ReadAhead.Length(read_count);
+  m_ReadAheadPos = 0;
+
+  if ( result == RESULT_ENDOFFILE && read_count > 0 )
+    result = RESULT_OK;
+
   return result;
 }
 
@@ -170,7 +202,34 @@ ASDCP::PCM::WAVParser::h__WAVParser::ReadFrame(FrameBuffer& FB)
     }
 
   ui32_t read_count = 0;
-  Result_t result = m_FileReader.Read(FB.Data(), (m_DataLength - m_ReadCount >= m_FrameBufferSize) ? m_FrameBufferSize : m_DataLength - m_ReadCount, &read_count);
+  ui32_t frame_length = (m_DataLength - m_ReadCount >= m_FrameBufferSize) ? m_FrameBufferSize : m_DataLength - m_ReadCount;
+  Result_t result = RESULT_OK;
+
+  if ( m_ReadAhead.Capacity() == 0 )
+    {
+      result = m_FileReader.Read(FB.Data(), frame_length, &read_count);
+    }
+  else
+    {
+      // streaming mode: slice the edit unit out of the read-ahead buffer,
+      // refilling it with the next run of the data chunk as it drains
+      while ( read_count < frame_length )
+	{
+	  if ( m_ReadAheadPos == m_ReadAhead.Length() )
+	    {
+	      ui64_t remainder = m_DataLength - m_ReadCount - read_count;
+	      result = FillReadAhead(remainder > m_ReadAhead.Capacity() ? m_ReadAhead.Capacity() : (ui32_t)remainder);
+
+	      if ( ASDCP_FAILURE(result) )
+		break;
+	    }
+
+	  ui32_t copy_count = Kumu::xmin(frame_length - read_count, m_ReadAhead.Length() - m_ReadAheadPos);
+	  memcpy(FB.Data() + read_count, m_ReadAhead.RoData() + m_ReadAheadPos, copy_count);
+	  m_ReadAheadPos += copy_count;
+	  read_count += copy_count;
+	}
+    }
 
   if ( result == RESULT_ENDOFFILE || (m_DataLength == m_ReadCount + read_count) )
     {
@@ -202,6 +261,8 @@ ASDCP::Result_t ASDCP::PCM::WAVParser::h__WAVParser::Seek(ui32_t frame_number)
 {
   m_FramesRead = frame_number - 1;
   m_ReadCount = 0;
+  m_ReadAhead.Length(0);
+  m_ReadAheadPos = 0;
   return m_FileReader.Seek(m_DataStart + m_FrameBufferSize * frame_number);
 }
 
@@ -220,10 +281,19 @@ ASDCP::PCM::WAVParser::~WAVParser()
 // set of stream metadata for the MXFWriter below.
 ASDCP::Result_t
 ASDCP::PCM::WAVParser::OpenRead(const std::string& filename, const Rational& PictureRate) const
+{
+  return OpenRead(filename, PictureRate, DefaultWAVReadAheadSize);
+}
+
+// As above, but slices edit units from a read-ahead buffer of the given size.
+// A size of zero reads each edit unit directly from the file.
+ASDCP::Result_t
+ASDCP::PCM::WAVParser::OpenRead(const std::string& filename, const Rational& PictureRate,
+				ui32_t read_ahead_size) const
 {
   const_cast<ASDCP::PCM::WAVParser*>(this)->m_Parser = new h__WAVParser;
 
-  Result_t result = m_Parser->OpenRead(filename, PictureRate);
+  Result_t result = m_Parser->OpenRead(filename, PictureRate, read_ahead_size);
 
   if ( ASDCP_FAILURE(result) )
     const_cast<ASDCP::PCM::WAVParser*>(this)->m_Parser.release();
@@ -62,27 +62,19 @@ public:
   //
   Result_t InitFromDirectory(const std::string& path)
   {
-    char next_file[Kumu::MaxFilePath];
-    Kumu::DirScanner Scanner;
+    Kumu::DirScannerEx Scanner;
+    Kumu::DirectoryListing Listing;
 
     Result_t result = Scanner.Open(path);
 
+    if ( ASDCP_SUCCESS(result) )
+      result = Scanner.ReadFileNames(Listing, "j2c", true); // hidden frames are kept, as before
+
     if ( ASDCP_SUCCESS(result) )
       {
 	m_DirName = path;
-
-	while ( ASDCP_SUCCESS(Scanner.GetNext(next_file)) )
-	  {
-	    if ( PathGetExtension(next_file) == "j2c" )
-	      {
-		std::string path = PathJoin(m_DirName, next_file);
-
-		if ( ! Kumu::PathIsDirectory(path) )
-		  push_back(path);
-	      }
-	  }
-
-	sort();
+	Listing.SortNatural(); // frame_9 before frame_10
+	Listing.GetPaths(*this);
       }
 
     return result;
@@ -143,6 +135,7 @@ AS_02::PHDR::SequenceParser::h__SequenceParser::OpenRead()
   m_CurrentFile = m_FileList.begin();
   ASDCP::JP2K::CodestreamParser Parser;
   AS_02::PHDR::FrameBuffer TmpBuffer;
+  TmpBuffer.Allocator(&PooledFrameBufferAllocator());
 
   Kumu::fsize_t file_size = Kumu::FileSize(*m_CurrentFile);
 
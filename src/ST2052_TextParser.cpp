@@ -228,7 +228,6 @@ typedef std::map<Kumu::UUID, ASDCP::TimedText::MIMEType_t> ResourceTypeMap_t;
 
 class AS_02::TimedText::ST2052_TextParser::h__TextParser
 {
-  XMLElement  m_Root;
   ResourceTypeMap_t m_ResourceTypes;
   Result_t OpenRead();
 
@@ -236,11 +235,11 @@ class AS_02::TimedText::ST2052_TextParser::h__TextParser
 
 public:
   std::string m_Filename;
-  std::string m_XMLDoc;
+  std::string m_XMLDoc; // empty when the document was opened by name
   TimedTextDescriptor  m_TDesc;
   ASDCP::mem_ptr<ASDCP::TimedText::IResourceResolver> m_DefaultResolver;
 
-  h__TextParser() : m_Root("**ParserRoot**")
+  h__TextParser()
   {
     memset(&m_TDesc.AssetID, 0, UUIDlen);
   }
@@ -261,6 +260,7 @@ public:
 
   Result_t OpenRead(const std::string& filename);
   Result_t OpenRead(const std::string& xml_doc, const std::string& filename);
+  Result_t ReadTimedTextResource(std::string& s) const;
   Result_t ReadAncillaryResource(const byte_t *uuid, ASDCP::TimedText::FrameBuffer& FrameBuf,
 				 const ASDCP::TimedText::IResourceResolver& Resolver) const;
 };
@@ -269,15 +269,9 @@ public:
 Result_t
 AS_02::TimedText::ST2052_TextParser::h__TextParser::OpenRead(const std::string& filename)
 {
-  Result_t result = ReadFileIntoString(filename, m_XMLDoc);
-
-  if ( KM_SUCCESS(result) )
-    {
-      m_Filename = filename;
-      result = OpenRead();
-    }
-
-  return result;
+  m_XMLDoc.clear();
+  m_Filename = filename;
+  return OpenRead();
 }
 
 //
@@ -294,13 +288,89 @@ AS_02::TimedText::ST2052_TextParser::h__TextParser::OpenRead(const std::string&
 std::string const IMSC1_imageProfile = "http://www.w3.org/ns/ttml/profile/imsc1/image";
 std::string const IMSC1_textProfile = "http://www.w3.org/ns/ttml/profile/imsc1/text";
 
-//
+namespace {
+  // Collects the attribute values and profile declarations that OpenRead() needs
+  // while the document is parsed, so that no element tree is built. As with the
+  // tree visitors used before, attributes of the root element are not collected.
+  class TTMLResourceScanner : public Kumu::IXMLStreamHandler
+  {
+    KM_NO_COPY_CONSTRUCT(TTMLResourceScanner);
+
+    ui32_t      m_Depth;
+    ui32_t      m_CaptureDepth;
+    std::string m_Text;
+
+  public:
+    std::set<std::string> ConformsToStandardList;
+    std::set<std::string> ProfileList;
+    std::set<std::string> BackgroundImageList;
+    std::set<std::string> FontFamilyList;
+
+    TTMLResourceScanner() : m_Depth(0), m_CaptureDepth(0) {}
+
+    //
+    bool StartElement(const char*, const char* name, const AttributeList& attributes)
+    {
+      ++m_Depth;
+
+      if ( m_Depth > 1 )
+	{
+	  for ( Attr_i i = attributes.begin(); i != attributes.end(); ++i )
+	    {
+	      if ( i->name == "profile" )
+		ProfileList.insert(i->value);
+	      else if ( i->name == "backgroundImage" )
+		BackgroundImageList.insert(i->value);
+	      else if ( i->name == "fontFamily" )
+		FontFamilyList.insert(i->value);
+	    }
+	}
+
+      if ( m_CaptureDepth == 0 && strcmp(name, "conformsToStandard") == 0 )
+	{
+	  m_CaptureDepth = m_Depth;
+	  m_Text.clear();
+	}
+
+      return true;
+    }
+
+    //
+    bool CharacterData(const char* data, ui32_t length)
+    {
+      if ( m_CaptureDepth != 0 && m_Depth == m_CaptureDepth )
+	m_Text.append(data, length);
+
+      return true;
+    }
+
+    //
+    bool EndElement(const char*, const char*)
+    {
+      if ( m_CaptureDepth != 0 && m_Depth == m_CaptureDepth )
+	{
+	  ConformsToStandardList.insert(m_Text);
+	  m_CaptureDepth = 0;
+	}
+
+      --m_Depth;
+      return true;
+    }
+  };
+}
+
+// The document is parsed as a stream, no element tree is built. A document opened
+// by name is not held in memory, see ReadTimedTextResource().
 Result_t
 AS_02::TimedText::ST2052_TextParser::h__TextParser::OpenRead()
 {
   setup_default_font_family_list();
+  TTMLResourceScanner Scanner;
 
-  if ( ! m_Root.ParseString(m_XMLDoc.c_str()) )
+  bool parsed = m_XMLDoc.empty() ? ParseXMLFile(m_Filename, Scanner)
+    : ParseXMLStream(m_XMLDoc.c_str(), m_XMLDoc.size(), Scanner);
+
+  if ( ! parsed )
     {
       DefaultLogSink(). Error("ST 2052-1 document is not well-formed.\n");
       return RESULT_FORMAT;
@@ -314,10 +384,7 @@ AS_02::TimedText::ST2052_TextParser::h__TextParser::OpenRead()
   // Attempt to set the profile from <conformsToStandard>
   if ( m_TDesc.NamespaceName.empty() )
     {
-      ElementVisitor conforms_visitor("conformsToStandard");
-      apply_visitor(m_Root, conforms_visitor);
-
-      for ( i = conforms_visitor.value_list.begin(); i != conforms_visitor.value_list.end(); ++i )
+      for ( i = Scanner.ConformsToStandardList.begin(); i != Scanner.ConformsToStandardList.end(); ++i )
 	{
 	  if ( *i == IMSC1_imageProfile || *i == IMSC1_textProfile )
 	    {
@@ -330,10 +397,7 @@ AS_02::TimedText::ST2052_TextParser::h__TextParser::OpenRead()
   // Attempt to set the profile from the use of attribute "profile"
   if ( m_TDesc.NamespaceName.empty() )
     {
-      AttributeVisitor profile_visitor("profile");
-      apply_visitor(m_Root, profile_visitor);
-
-      for ( i = profile_visitor.value_list.begin(); i != profile_visitor.value_list.end(); ++i )
+      for ( i = Scanner.ProfileList.begin(); i != Scanner.ProfileList.end(); ++i )
 	{
 	  if ( *i == IMSC1_imageProfile || *i == IMSC1_textProfile )
 	    {
@@ -345,10 +409,7 @@ AS_02::TimedText::ST2052_TextParser::h__TextParser::OpenRead()
 
   // Find image resources for later packaging as GS partitions.
   // Attempt to set the profile; infer from use of images.
-  AttributeVisitor png_visitor("backgroundImage");
-  apply_visitor(m_Root, png_visitor);
-
-  for ( i = png_visitor.value_list.begin(); i != png_visitor.value_list.end(); ++i )
+  for ( i = Scanner.BackgroundImageList.begin(); i != Scanner.BackgroundImageList.end(); ++i )
     {
       UUID asset_id = CreatePNGNameId(PathBasename(*i));
       TimedTextResourceDescriptor png_resource;
@@ -378,11 +439,9 @@ AS_02::TimedText::ST2052_TextParser::h__TextParser::OpenRead()
     }
 
   // Find font resources for later packaging as GS partitions.
-  AttributeVisitor font_visitor("fontFamily");
-  apply_visitor(m_Root, font_visitor);
   char buf[64];
 
-  for ( i = font_visitor.value_list.begin(); i != font_visitor.value_list.end(); ++i )
+  for ( i = Scanner.FontFamilyList.begin(); i != Scanner.FontFamilyList.end(); ++i )
     {
       UUID font_id = CreateFontNameId(PathBasename(*i));
 
@@ -411,6 +470,19 @@ AS_02::TimedText::ST2052_TextParser::h__TextParser::OpenRead()
   return RESULT_OK;
 }
 
+// A document opened by name is read again from the file.
+Result_t
+AS_02::TimedText::ST2052_TextParser::h__TextParser::ReadTimedTextResource(std::string& s) const
+{
+  if ( ! m_XMLDoc.empty() )
+    {
+      s = m_XMLDoc;
+      return RESULT_OK;
+    }
+
+  return ReadFileIntoString(m_Filename, s, (ui32_t)Kumu::xmin<fsize_t>(FileSize(m_Filename), 0xffffffff));
+}
+
 //
 Result_t
 AS_02::TimedText::ST2052_TextParser::h__TextParser::ReadAncillaryResource(const byte_t* uuid, ASDCP::TimedText::FrameBuffer& FrameBuf,
@@ -508,8 +580,7 @@ AS_02::TimedText::ST2052_TextParser::ReadTimedTextResource(std::string& s) const
   if ( m_Parser.empty() )
     return RESULT_INIT;
 
-  s = m_Parser->m_XMLDoc;
-  return RESULT_OK;
+  return m_Parser->ReadTimedTextResource(s);
 }
 
 //
@@ -107,7 +107,6 @@ typedef std::map<Kumu::UUID, TimedText::MIMEType_t> ResourceTypeMap_t;
 
 class ASDCP::TimedText::DCSubtitleParser::h__SubtitleParser
 {
-  XMLElement  m_Root;
   ResourceTypeMap_t m_ResourceTypes;
   Result_t OpenRead();
 
@@ -115,11 +114,11 @@ class ASDCP::TimedText::DCSubtitleParser::h__SubtitleParser
 
 public:
   std::string m_Filename;
-  std::string m_XMLDoc;
+  std::string m_XMLDoc; // empty when the document was opened by name
   TimedTextDescriptor  m_TDesc;
   mem_ptr<LocalFilenameResolver> m_DefaultResolver;
 
-  h__SubtitleParser() : m_Root("**ParserRoot**")
+  h__SubtitleParser()
   {
     memset(&m_TDesc.AssetID, 0, UUIDlen);
   }
@@ -139,15 +138,16 @@ public:
 
   Result_t OpenRead(const std::string& filename);
   Result_t OpenRead(const std::string& xml_doc, const std::string& filename);
+  Result_t ReadTimedTextResource(std::string& s) const;
   Result_t ReadAncillaryResource(const byte_t* uuid, FrameBuffer& FrameBuf, const IResourceResolver& Resolver) const;
 };
+
 namespace {
     //
     bool
-    get_UUID_from_element(XMLElement* Element, UUID& ID)
+    get_UUID_from_body(const std::string& body, UUID& ID)
     {
-      assert(Element);
-      const char* p = Element->GetBody().c_str();
+      const char* p = body.c_str();
 
       if ( strncmp(p, "urn:uuid:", 9) == 0 )
         {
@@ -159,32 +159,222 @@ namespace {
 
     //
     bool
-    get_UUID_from_child_element(const char* name, XMLElement* Parent, UUID& outID)
+    is_supported_edit_rate(const ASDCP::Rational& edit_rate)
     {
-      assert(name);
-      assert(Parent);
-      XMLElement* Child = Parent->GetChildWithName(name);
+      return edit_rate == EditRate_23_98
+	|| edit_rate == EditRate_24
+	|| edit_rate == EditRate_25
+	|| edit_rate == EditRate_30
+	|| edit_rate == EditRate_48
+	|| edit_rate == EditRate_50
+	|| edit_rate == EditRate_60
+	|| edit_rate == EditRate_96
+	|| edit_rate == EditRate_100
+	|| edit_rate == EditRate_120
+	|| edit_rate == EditRate_192
+	|| edit_rate == EditRate_200
+	|| edit_rate == EditRate_240;
+    }
 
-      if ( Child == 0 )
-        {
-          return false;
-        }
+    // Collects the values needed for the TimedTextDescriptor while the document
+    // is parsed. Only the text of the elements of interest is kept, and the timeline
+    // is accumulated as each Subtitle element is seen.
+    class DCSubtitleScanner : public Kumu::IXMLStreamHandler
+    {
+      KM_NO_COPY_CONSTRUCT(DCSubtitleScanner);
 
-      return get_UUID_from_element(Child, outID);
-    }
+      enum Capture_t { CAP_NONE, CAP_ID, CAP_EDIT_RATE, CAP_START_TIME, CAP_LOAD_FONT, CAP_IMAGE };
+
+      ui32_t      m_Depth;
+      Capture_t   m_Capture;
+      ui32_t      m_CaptureDepth;
+      std::string m_Text;
+      ui32_t      m_TCFrameRate;
+      std::list<std::string> m_PendingTimeOuts; // seen before EditRate
+      std::set<Kumu::UUID> m_VisitedImages;
+
+      bool Fail(const char* message)
+      {
+	DefaultLogSink().Error("%s", message);
+	ParseResult = RESULT_FORMAT;
+	return false;
+      }
+
+      void AddTimeOut(const std::string& time_out)
+      {
+	S12MTimecode tmpTC(time_out, m_TCFrameRate);
+	if ( EndCount < tmpTC.GetFrames() )
+	  EndCount = tmpTC.GetFrames();
+      }
+
+    public:
+      Result_t    ParseResult;
+      std::string NamespaceName;
+      bool        HasId, HasEditRate, HasStartTime;
+      UUID        DocID;
+      ASDCP::Rational EditRate;
+      std::string EditRateText, StartTimeText;
+      std::list<UUID> FontList, ImageList;
+      ui32_t      SubtitleCount;
+      ui32_t      EndCount;
+
+      DCSubtitleScanner() : m_Depth(0), m_Capture(CAP_NONE), m_CaptureDepth(0), m_TCFrameRate(0),
+			    ParseResult(RESULT_OK), HasId(false), HasEditRate(false), HasStartTime(false),
+			    SubtitleCount(0), EndCount(0) {}
+
+      //
+      bool StartElement(const char* ns_name, const char* name, const AttributeList& attributes)
+      {
+	++m_Depth;
+
+	if ( m_Depth == 1 )
+	  {
+	    NamespaceName = ns_name;
+	    return true;
+	  }
+
+	if ( m_Capture != CAP_NONE )
+	  return true;
+
+	if ( m_Depth == 2 && ! HasId && strcmp(name, "Id") == 0 )
+	  m_Capture = CAP_ID;
+	else if ( m_Depth == 2 && ! HasEditRate && strcmp(name, "EditRate") == 0 )
+	  m_Capture = CAP_EDIT_RATE;
+	else if ( m_Depth == 2 && ! HasStartTime && strcmp(name, "StartTime") == 0 )
+	  m_Capture = CAP_START_TIME;
+	else if ( strcmp(name, "LoadFont") == 0 )
+	  m_Capture = CAP_LOAD_FONT;
+	else if ( strcmp(name, "Image") == 0 )
+	  m_Capture = CAP_IMAGE;
+	else if ( strcmp(name, "Subtitle") == 0 )
+	  {
+	    ++SubtitleCount;
+
+	    for ( Attr_i i = attributes.begin(); i != attributes.end(); ++i )
+	      {
+		if ( i->name == "TimeOut" )
+		  {
+		    if ( m_TCFrameRate == 0 )
+		      m_PendingTimeOuts.push_back(i->value);
+		    else
+		      AddTimeOut(i->value);
+		  }
+	      }
+	  }
+
+	if ( m_Capture != CAP_NONE )
+	  {
+	    m_CaptureDepth = m_Depth;
+	    m_Text.clear();
+	  }
+
+	return true;
+      }
+
+      //
+      bool CharacterData(const char* data, ui32_t length)
+      {
+	if ( m_Capture != CAP_NONE && m_Depth == m_CaptureDepth )
+	  m_Text.append(data, length);
+
+	return true;
+      }
+
+      //
+      bool EndElement(const char*, const char*)
+      {
+	bool result = true;
+
+	if ( m_Capture != CAP_NONE && m_Depth == m_CaptureDepth )
+	  {
+	    UUID TmpID;
+
+	    switch ( m_Capture )
+	      {
+	      case CAP_ID:
+		HasId = true;
+		if ( ! get_UUID_from_body(m_Text, DocID) )
+		  result = Fail("Id element missing from input document.\n");
+		break;
+
+	      case CAP_EDIT_RATE:
+		HasEditRate = true;
+		EditRateText = m_Text;
+		result = SetEditRate();
+		break;
+
+	      case CAP_START_TIME:
+		HasStartTime = true;
+		StartTimeText = m_Text;
+		break;
+
+	      case CAP_LOAD_FONT:
+		if ( ! get_UUID_from_body(m_Text, TmpID) )
+		  result = Fail("LoadFont element does not contain a urn:uuid value as expected.\n");
+		else
+		  FontList.push_back(TmpID);
+		break;
+
+	      case CAP_IMAGE:
+		if ( ! get_UUID_from_body(m_Text, TmpID) )
+		  result = Fail("Image element does not contain a urn:uuid value as expected.\n");
+		else if ( m_VisitedImages.insert(TmpID).second )
+		  ImageList.push_back(TmpID);
+		break;
+
+	      default:
+		break;
+	      }
+
+	    m_Capture = CAP_NONE;
+	  }
+
+	--m_Depth;
+	return result;
+      }
+
+      // decodes the edit rate and brings the timeline up to date
+      bool SetEditRate()
+      {
+	ASDCP::Rational edit_rate;
+
+	if ( ! DecodeRational(EditRateText.c_str(), edit_rate) )
+	  {
+	    DefaultLogSink().Error("Error decoding edit rate value: \"%s\"\n", EditRateText.c_str());
+	    ParseResult = RESULT_FORMAT;
+	    return false;
+	  }
+
+	if ( ! is_supported_edit_rate(edit_rate) )
+	  {
+	    DefaultLogSink(). Error("Unexpected EditRate: %d/%d\n", edit_rate.Numerator, edit_rate.Denominator);
+	    ParseResult = RESULT_FORMAT;
+	    return false;
+	  }
+
+	EditRate = edit_rate;
+	m_TCFrameRate = ( edit_rate == EditRate_23_98  ) ? 24 : edit_rate.Numerator;
+
+	while ( ! m_PendingTimeOuts.empty() )
+	  {
+	    AddTimeOut(m_PendingTimeOuts.front());
+	    m_PendingTimeOuts.pop_front();
+	  }
+
+	return true;
+      }
+
+      ui32_t TCFrameRate() const { return m_TCFrameRate; }
+    };
 }
 
 //
 Result_t
 ASDCP::TimedText::DCSubtitleParser::h__SubtitleParser::OpenRead(const std::string& filename)
 {
-  Result_t result = ReadFileIntoString(filename, m_XMLDoc);
-
-  if ( KM_SUCCESS(result) )
-    result = OpenRead();
-
+  m_XMLDoc.clear();
   m_Filename = filename;
-  return result;
+  return OpenRead();
 }
 
 //
@@ -205,159 +395,110 @@ ASDCP::TimedText::DCSubtitleParser::h__SubtitleParser::OpenRead(const std::strin
   return OpenRead();
 }
 
-//
+// The document is parsed as a stream, no element tree is built. A document opened
+// by name is not held in memory, see ReadTimedTextResource().
 Result_t
 ASDCP::TimedText::DCSubtitleParser::h__SubtitleParser::OpenRead()
 {
-  if ( ! m_Root.ParseString(m_XMLDoc) )
+  DCSubtitleScanner Scanner;
+  bool parsed = m_XMLDoc.empty() ? ParseXMLFile(m_Filename, Scanner)
+    : ParseXMLStream(m_XMLDoc.c_str(), m_XMLDoc.size(), Scanner);
+
+  if ( KM_FAILURE(Scanner.ParseResult) )
+    return Scanner.ParseResult;
+
+  if ( ! parsed )
     return RESULT_FORMAT;
 
   m_TDesc.EncodingName = "UTF-8"; // the XML parser demands UTF-8
   m_TDesc.ResourceList.clear();
   m_TDesc.ContainerDuration = 0;
-  const XMLNamespace* ns = m_Root.Namespace();
 
-  if ( ns == 0 )
+  if ( Scanner.NamespaceName.empty() )
     {
       DefaultLogSink(). Warn("Document has no namespace name, assuming \"%s\".\n", c_dcst_namespace_name);
       m_TDesc.NamespaceName = c_dcst_namespace_name;
     }
   else
     {
-      m_TDesc.NamespaceName = ns->Name();
+      m_TDesc.NamespaceName = Scanner.NamespaceName;
     }
 
-  UUID DocID;
-  if ( ! get_UUID_from_child_element("Id", &m_Root, DocID) )
+  if ( ! Scanner.HasId )
     {
       DefaultLogSink(). Error("Id element missing from input document.\n");
       return RESULT_FORMAT;
     }
 
-  memcpy(m_TDesc.AssetID, DocID.Value(), DocID.Size());
-  XMLElement* EditRate = m_Root.GetChildWithName("EditRate");
+  memcpy(m_TDesc.AssetID, Scanner.DocID.Value(), Scanner.DocID.Size());
 
-  if ( EditRate == 0 )
+  if ( ! Scanner.HasEditRate )
     {
       DefaultLogSink().Error("EditRate element missing from input document.\n");
       return RESULT_FORMAT;
     }
 
-  if ( ! DecodeRational(EditRate->GetBody().c_str(), m_TDesc.EditRate) )
-    {
-      DefaultLogSink().Error("Error decoding edit rate value: \"%s\"\n", EditRate->GetBody().c_str());
-      return RESULT_FORMAT;
-    }
-
-  if ( m_TDesc.EditRate != EditRate_23_98
-       && m_TDesc.EditRate != EditRate_24
-       && m_TDesc.EditRate != EditRate_25
-       && m_TDesc.EditRate != EditRate_30
-       && m_TDesc.EditRate != EditRate_48
-       && m_TDesc.EditRate != EditRate_50
-       && m_TDesc.EditRate != EditRate_60
-       && m_TDesc.EditRate != EditRate_96
-       && m_TDesc.EditRate != EditRate_100
-       && m_TDesc.EditRate != EditRate_120
-       && m_TDesc.EditRate != EditRate_192
-       && m_TDesc.EditRate != EditRate_200
-       && m_TDesc.EditRate != EditRate_240 )
-    {
-      DefaultLogSink(). Error("Unexpected EditRate: %d/%d\n",
-			      m_TDesc.EditRate.Numerator, m_TDesc.EditRate.Denominator);
-      return RESULT_FORMAT;
-    }
+  m_TDesc.EditRate = Scanner.EditRate;
 
   // list of fonts
-  ElementList FontList;
-  m_Root.GetChildrenWithName("LoadFont", FontList);
+  std::list<UUID>::const_iterator i;
 
-  for ( Elem_i i = FontList.begin(); i != FontList.end(); i++ )
+  for ( i = Scanner.FontList.begin(); i != Scanner.FontList.end(); ++i )
     {
-      UUID AssetID;
-      if ( ! get_UUID_from_element(*i, AssetID) )
-	{
-	  DefaultLogSink(). Error("LoadFont element does not contain a urn:uuid value as expected.\n");
-	  return RESULT_FORMAT;
-	}
-
       TimedTextResourceDescriptor TmpResource;
-      memcpy(TmpResource.ResourceID, AssetID.Value(), UUIDlen);
+      memcpy(TmpResource.ResourceID, i->Value(), UUIDlen);
       TmpResource.Type = MT_OPENTYPE;
       m_TDesc.ResourceList.push_back(TmpResource);
-      m_ResourceTypes.insert(ResourceTypeMap_t::value_type(UUID(TmpResource.ResourceID), MT_OPENTYPE));
+      m_ResourceTypes.insert(ResourceTypeMap_t::value_type(*i, MT_OPENTYPE));
     }
 
-  // list of images
-  ElementList ImageList;
-  m_Root.GetChildrenWithName("Image", ImageList);
-  std::set<Kumu::UUID> visited_items;
-
-  for ( Elem_i i = ImageList.begin(); i != ImageList.end(); i++ )
+  // list of images, without duplicates
+  for ( i = Scanner.ImageList.begin(); i != Scanner.ImageList.end(); ++i )
     {
-      UUID AssetID;
-      if ( ! get_UUID_from_element(*i, AssetID) )
-	{
-	  DefaultLogSink(). Error("Image element does not contain a urn:uuid value as expected.\n");
-	  return RESULT_FORMAT;
-	}
-
-      if ( visited_items.find(AssetID) == visited_items.end() )
-	{
-	  TimedTextResourceDescriptor TmpResource;
-	  memcpy(TmpResource.ResourceID, AssetID.Value(), UUIDlen);
-	  TmpResource.Type = MT_PNG;
-	  m_TDesc.ResourceList.push_back(TmpResource);
-	  m_ResourceTypes.insert(ResourceTypeMap_t::value_type(UUID(TmpResource.ResourceID), MT_PNG));
-	  visited_items.insert(AssetID);
-	}
+      TimedTextResourceDescriptor TmpResource;
+      memcpy(TmpResource.ResourceID, i->Value(), UUIDlen);
+      TmpResource.Type = MT_PNG;
+      m_TDesc.ResourceList.push_back(TmpResource);
+      m_ResourceTypes.insert(ResourceTypeMap_t::value_type(*i, MT_PNG));
     }
 
-  // Calculate the timeline duration.
-  // This is a little ugly because the last element in the file is not necessarily
-  // the last instance to be displayed, e.g., element n and element n-1 may have the
-  // same start time but n-1 may have a greater duration making it the last to be seen.
-  // We must scan the list to accumulate the latest TimeOut value.
-  ElementList InstanceList;
-  ElementList::const_iterator ei;
-  ui32_t end_count = 0;
-  
-  m_Root.GetChildrenWithName("Subtitle", InstanceList);
-
-  if ( InstanceList.empty() )
+  // The timeline ends at the latest TimeOut value, which is not necessarily that of
+  // the last Subtitle element in the file. The scanner accumulated it.
+  if ( Scanner.SubtitleCount == 0 )
     {
       DefaultLogSink(). Error("XML document contains no Subtitle elements.\n");
       return RESULT_FORMAT;
     }
 
-  // assumes edit rate is constrained above
-  ui32_t TCFrameRate = ( m_TDesc.EditRate == EditRate_23_98  ) ? 24 : m_TDesc.EditRate.Numerator;
-
   S12MTimecode beginTC;
-  beginTC.SetFPS(TCFrameRate);
-  XMLElement* StartTime = m_Root.GetChildWithName("StartTime");
-
-  if ( StartTime != 0 )
-    beginTC.DecodeString(StartTime->GetBody());
+  beginTC.SetFPS(Scanner.TCFrameRate());
 
-  for ( ei = InstanceList.begin(); ei != InstanceList.end(); ei++ )
-    {
-      S12MTimecode tmpTC((*ei)->GetAttrWithName("TimeOut"), TCFrameRate);
-      if ( end_count < tmpTC.GetFrames() )
-	end_count = tmpTC.GetFrames();
-    }
+  if ( Scanner.HasStartTime )
+    beginTC.DecodeString(Scanner.StartTimeText);
 
-  if ( end_count <= beginTC.GetFrames() )
+  if ( Scanner.EndCount <= beginTC.GetFrames() )
     {
       DefaultLogSink(). Error("Timed Text file has zero-length timeline.\n");
       return RESULT_FORMAT;
     }
 
-  m_TDesc.ContainerDuration = end_count - beginTC.GetFrames();
+  m_TDesc.ContainerDuration = Scanner.EndCount - beginTC.GetFrames();
 
   return RESULT_OK;
 }
 
+// A document opened by name is read again from the file.
+Result_t
+ASDCP::TimedText::DCSubtitleParser::h__SubtitleParser::ReadTimedTextResource(std::string& s) const
+{
+  if ( ! m_XMLDoc.empty() )
+    {
+      s = m_XMLDoc;
+      return RESULT_OK;
+    }
+
+  return ReadFileIntoString(m_Filename, s, (ui32_t)Kumu::xmin<fsize_t>(FileSize(m_Filename), 0xffffffff));
+}
 
 //
 Result_t
@@ -455,8 +596,7 @@ ASDCP::TimedText::DCSubtitleParser::ReadTimedTextResource(std::string& s) const
   if ( m_Parser.empty() )
     return RESULT_INIT;
 
-  s = m_Parser->m_XMLDoc;
-  return RESULT_OK;
+  return m_Parser->ReadTimedTextResource(s);
 }
 
 //
@@ -79,6 +79,9 @@ public:
   }
 } s_MyInfo;
 
+// per-stage timing, printed when --stats is given
+static ASDCP::StageStats s_StageStats;
+
 
 
 // Increment the iterator, test for an additional non-option command line argument.
@@ -132,6 +135,7 @@ USAGE: %s [-h|-help] [-V]\n\
   fprintf(stream, "\
 Options:\n\
   -h | -help        - Show help\n\
+  --stats           - Print the time spent in each stage of writing essence\n\
   -V                - Show version information\n\
   -a <uuid>         - Specify the Asset ID of the file\n\
   -A <w>/<h>        - Set aspect ratio for image (default 4/3)\n\
@@ -272,6 +276,7 @@ public:
   bool   no_write_flag;  // true if no output files are to be written
   bool   version_flag;   // true if the version display option was selected
   bool   help_flag;      // true if the help display option was selected
+  bool   stats_flag;     // true if per-stage timing is to be printed
   ui32_t duration;       // number of frames to be processed
   bool   j2c_pedantic;   // passed to JP2K::SequenceParser::OpenRead
   bool   write_j2clayout; // true if a J2CLayout field should be written
@@ -513,7 +518,7 @@ public:
   CommandOptions(int argc, const char** argv) :
     error_flag(true), key_flag(false), key_id_flag(false), asset_id_flag(false),
     encrypt_header_flag(true), write_hmac(true), verbose_flag(false), fb_dump_size(0),
-    no_write_flag(false), version_flag(false), help_flag(false),
+    no_write_flag(false), version_flag(false), help_flag(false), stats_flag(false),
     duration(0xffffffff), j2c_pedantic(true), write_j2clayout(false), use_cdci_descriptor(false),
     edit_rate(24,1), fb_size(FRAME_BUFFER_SIZE),
     show_ul_values_flag(false), index_strategy(AS_02::IS_FOLLOW), partition_space(60),
@@ -542,6 +547,12 @@ public:
 	    help_flag = true;
 	    continue;
 	  }
+
+	if ( (strcmp( argv[i], "--stats") == 0) )
+	  {
+	    stats_flag = true;
+	    continue;
+	  }
          
 	if ( (strcmp( argv[i], "-suba") == 0) )
 	  {
@@ -1194,6 +1205,9 @@ write_JP2K_file(CommandOptions& Options)
 	{
 	  result = Writer.OpenWrite(Options.out_file, Info, essence_descriptor, essence_sub_descriptors,
 				    Options.edit_rate, Options.mxf_header_size, Options.index_strategy, Options.partition_space);
+
+	  if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+	    result = Writer.SetStageStats(&s_StageStats);
 	}
     }
 
@@ -1413,6 +1427,9 @@ write_ACES_file(CommandOptions& Options)
     {
       result = Writer.OpenWrite(Options.out_file, Info, essence_descriptor, essence_sub_descriptors,
         Options.edit_rate, AS_02::ACES::ResourceList_t(), Options.mxf_header_size, Options.index_strategy, Options.partition_space);
+
+      if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+	result = Writer.SetStageStats(&s_StageStats);
     }
   }
 
@@ -1612,6 +1629,9 @@ write_PCM_file(CommandOptions& Options)
 	{
 	  result = Writer.OpenWrite(Options.out_file.c_str(), Info, essence_descriptor,
 				    Options.mca_config, Options.edit_rate);
+
+	  if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+	    result = Writer.SetStageStats(&s_StageStats);
 	}
     }
 
@@ -1739,6 +1759,9 @@ write_timed_text_file(CommandOptions& Options)
 
       if ( ASDCP_SUCCESS(result) )
 	result = Writer.OpenWrite(Options.out_file.c_str(), Info, TDesc);
+
+      if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+	result = Writer.SetStageStats(&s_StageStats);
     }
 
   if ( ASDCP_FAILURE(result) )
@@ -1898,6 +1921,9 @@ write_isxd_file(CommandOptions& Options)
 	  }
 
 	result = Writer.OpenWrite(Options.out_file, Info, Options.isxd_document_namespace, Options.edit_rate);
+
+	if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+	  result = Writer.SetStageStats(&s_StageStats);
       }
   }
 
@@ -2089,6 +2115,9 @@ main(int argc, const char** argv)
       return 1;
     }
 
+  if ( Options.stats_flag )
+    s_StageStats.Dump();
+
   return 0;
 }
 
@@ -0,0 +1,1488 @@
+/*
+Copyright (c) 2003-2015, John Hurst
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+3. The name of the author may not be used to endorse or promote products
+   derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*! \file    asdcp-bench.cpp
+    \version $Id$
+    \brief   AS-DCP and AS-02 throughput benchmark
+
+  This program synthesizes JPEG 2000-like, PCM, IAB and Timed Text essence
+  in memory, wraps it into scratch track files as AS-DCP and as AS-02, and
+  measures the throughput of wrapping, unwrapping, encrypted wrapping and
+  unwrapping, header open, index lookup and a KLV walk of each file. AES and
+  HMAC are also measured alone over frame-sized buffers.
+
+  Every measurement is repeated and the fastest run is reported. The results
+  are written as JSON so that the output of two builds can be compared by a
+  script.
+
+  For more information about asdcplib, please refer to the header file AS_DCP.h
+*/
+
+#include <KM_fileio.h>
+#include <KM_prng.h>
+#include <KM_thread.h>
+#include "AS_02_internal.h"
+#include "AS_02_IAB.h"
+
+using namespace Kumu;
+using namespace ASDCP;
+
+//------------------------------------------------------------------------------------------
+//
+// command line option parser class
+
+static const char* PROGRAM_NAME = "asdcp-bench";  // program name for messages
+
+// Increment the iterator, test for an additional non-option command line argument.
+// Causes the caller to return if there are no remaining arguments or if the next
+// argument begins with '-'.
+#define TEST_EXTRA_ARG(i,c)						\
+  if ( ++i >= argc || argv[(i)][0] == '-' ) {				\
+    fprintf(stderr, "Argument not found for option -%c.\n", (c));	\
+    return;								\
+  }
+
+//
+void
+banner(FILE* stream = stdout)
+{
+  fprintf(stream, "\n\
+%s (asdcplib %s)\n\n\
+Copyright (c) 2003-2015 John Hurst\n\n\
+asdcplib may be copied only under the terms of the license found at\n\
+the top of every file in the asdcplib distribution kit.\n\n\
+Specify the -h (help) option for further information about %s\n\n",
+	  PROGRAM_NAME, ASDCP::Version(), PROGRAM_NAME);
+}
+
+//
+void
+usage(FILE* stream = stdout)
+{
+  fprintf(stream, "\
+USAGE:%s [-h|-help] [-V]\n\
+\n\
+       %s [options]\n\
+\n\
+Options:\n\
+  -d <directory>    - Directory for the scratch track files (default: .)\n\
+  -h | -help        - Show help\n\
+  -k                - Keep the scratch track files\n\
+  -n <count>        - Number of frames (or Timed Text resources) per track\n\
+                      file (default: 240)\n\
+  -o <filename>     - Write the JSON results to a file (default: stdout)\n\
+  -r <count>        - Number of runs of each measurement; the fastest\n\
+                      run is reported (default: 3)\n\
+  -s <bytes>        - Size of a JPEG 2000 frame (default: 250000)\n\
+  -t <essence>      - Only measure one essence type: jp2k, pcm, iab or\n\
+                      timed-text (default: all)\n\
+  -v                - Verbose, prints progress to stderr\n\
+  -V                - Show version information\n\
+\n\
+  NOTES: o There is no option grouping, all options must be distinct arguments.\n\
+         o All option arguments must be separated from the option by whitespace.\n\n",
+	  PROGRAM_NAME, PROGRAM_NAME);
+}
+
+//
+class CommandOptions
+{
+  CommandOptions();
+
+public:
+  bool   error_flag;     // true if the given options are in error or not complete
+  bool   version_flag;   // true if the version display option was selected
+  bool   help_flag;      // true if the help display option was selected
+  bool   verbose_flag;   // true if the verbose option was selected
+  bool   keep_flag;      // true if the scratch files are not to be deleted
+  ui32_t frame_count;    // number of frames in each track file
+  ui32_t frame_size;     // size of a JPEG 2000 frame
+  ui32_t repeat_count;   // number of runs of each measurement
+  std::string scratch_dir;   // directory for the track files
+  std::string out_file;      // JSON output file, stdout if empty
+  std::string essence_type;  // the only essence type to measure, all if empty
+
+  //
+  CommandOptions(int argc, const char** argv) :
+    error_flag(true), version_flag(false), help_flag(false), verbose_flag(false),
+    keep_flag(false), frame_count(240), frame_size(250000), repeat_count(3), scratch_dir(".")
+  {
+    for ( int i = 1; i < argc; ++i )
+      {
+
+	if ( (strcmp( argv[i], "-help") == 0) )
+	  {
+	    help_flag = true;
+	    continue;
+	  }
+
+	if ( argv[i][0] == '-'
+	     && ( isalpha(argv[i][1]) || isdigit(argv[i][1]) )
+	     && argv[i][2] == 0 )
+	  {
+	    switch ( argv[i][1] )
+	      {
+	      case 'd':
+		TEST_EXTRA_ARG(i, 'd');
+		scratch_dir = argv[i];
+		break;
+
+	      case 'h': help_flag = true; break;
+	      case 'k': keep_flag = true; break;
+
+	      case 'n':
+		TEST_EXTRA_ARG(i, 'n');
+		frame_count = Kumu::xmax<ui32_t>(1, Kumu::xabs(strtol(argv[i], 0, 10)));
+		break;
+
+	      case 'o':
+		TEST_EXTRA_ARG(i, 'o');
+		out_file = argv[i];
+		break;
+
+	      case 'r':
+		TEST_EXTRA_ARG(i, 'r');
+		repeat_count = Kumu::xmax<ui32_t>(1, Kumu::xabs(strtol(argv[i], 0, 10)));
+		break;
+
+	      case 's':
+		TEST_EXTRA_ARG(i, 's');
+		frame_size = Kumu::xclamp<ui32_t>(Kumu::xabs(strtol(argv[i], 0, 10)), 64, 256 * Kumu::Megabyte);
+		break;
+
+	      case 't':
+		TEST_EXTRA_ARG(i, 't');
+		essence_type = argv[i];
+		break;
+
+	      case 'V': version_flag = true; break;
+	      case 'v': verbose_flag = true; break;
+
+	      default:
+		fprintf(stderr, "Unrecognized option: %s\n", argv[i]);
+		return;
+	      }
+	  }
+	else
+	  {
+	    fprintf(stderr, "Unrecognized argument: %s\n", argv[i]);
+	    return;
+	  }
+      }
+
+    if ( help_flag || version_flag )
+      return;
+
+    if ( ! essence_type.empty() && essence_type != "jp2k" && essence_type != "pcm"
+	 && essence_type != "iab" && essence_type != "timed-text" )
+      {
+	fprintf(stderr, "Unknown essence type: %s\n", essence_type.c_str());
+	return;
+      }
+
+    if ( ! PathIsDirectory(scratch_dir) )
+      {
+	fprintf(stderr, "Not a directory: %s\n", scratch_dir.c_str());
+	return;
+      }
+
+    error_flag = false;
+  }
+};
+
+//------------------------------------------------------------------------------------------
+//
+
+// local program identification info written to file headers
+class MyInfo : public WriterInfo
+{
+public:
+  MyInfo()
+  {
+      static byte_t default_ProductUUID_Data[UUIDlen] =
+      { 0x3c, 0x1e, 0x62, 0x0d, 0x8f, 0x54, 0x4b, 0x71,
+	0x9a, 0x26, 0xd1, 0x58, 0x04, 0xee, 0x27, 0xb3 };
+
+      memcpy(ProductUUID, default_ProductUUID_Data, UUIDlen);
+      CompanyName = "WidgetCo";
+      ProductName = "asdcp-bench";
+      ProductVersion = ASDCP::Version();
+  }
+} s_MyInfo;
+
+// the measurements
+enum Operation_t {
+  OP_WRAP,        // write a plaintext track file
+  OP_UNWRAP,      // read every frame of the plaintext track file
+  OP_ENCRYPT,     // write an encrypted track file, with HMAC
+  OP_DECRYPT,     // read and decrypt every frame of the encrypted track file, checking the HMAC
+  OP_OPEN,        // open and close the plaintext track file
+  OP_LOOKUP,      // look up random frames in the index
+  OP_KLV_WALK,    // read every KLV packet of the plaintext track file
+  OP_AES_ENCRYPT, // AES-CBC over frame-sized buffers
+  OP_AES_DECRYPT,
+  OP_HMAC,        // HMAC-SHA1 over frame-sized buffers
+  OP_MAX
+};
+
+static const char* OperationNames[OP_MAX] = {
+  "wrap", "unwrap", "encrypt", "decrypt", "header-open", "index-lookup", "klv-walk",
+  "aes-encrypt", "aes-decrypt", "hmac"
+};
+
+const ui32_t OpenCount = 100;       // header opens per run
+const ui32_t LookupCount = 100000;  // index lookups per run
+
+// One measurement. The counts are those handled by one run.
+struct BenchResult
+{
+  std::string essence;
+  std::string format;
+  Operation_t operation;
+  ui64_t      bytes;
+  ui64_t      items;
+  double      seconds;
+
+  BenchResult() : operation(OP_MAX), bytes(0), items(0), seconds(0.0) {}
+};
+
+typedef std::list<BenchResult> ResultList_t;
+
+// A few distinct frames of synthesized essence, used in turn so that the cost
+// of producing essence is not part of any measurement.
+class FrameSet
+{
+  ByteString m_Data;
+  ui32_t     m_FrameSize;
+
+  KM_NO_COPY_CONSTRUCT(FrameSet);
+
+public:
+  static const ui32_t Count = 8;
+
+  FrameSet() : m_FrameSize(0) {}
+  ~FrameSet() {}
+
+  //
+  Result_t Init(ui32_t frame_size, FortunaRNG& RNG)
+  {
+    m_FrameSize = frame_size;
+    Result_t result = m_Data.Capacity(frame_size * Count);
+
+    if ( KM_SUCCESS(result) )
+      {
+	RNG.FillRandom(m_Data.Data(), frame_size * Count);
+	m_Data.Length(frame_size * Count);
+      }
+
+    return result;
+  }
+
+  inline ui32_t  FrameSize() const { return m_FrameSize; }
+  inline byte_t* Frame(ui32_t i) { return m_Data.Data() + ( i % Count ) * m_FrameSize; }
+
+  // points frame_buf at frame i, without copying
+  void Wrap(ui32_t i, ASDCP::FrameBuffer& frame_buf)
+  {
+    frame_buf.SetData(Frame(i), m_FrameSize);
+    frame_buf.Size(m_FrameSize);
+  }
+};
+
+// State shared by all of the benchmarks: options, keys and crypto contexts.
+struct BenchContext
+{
+  const CommandOptions& Options;
+  Kumu::FileReaderFactory FileReaderFactory;
+  FortunaRNG RNG;
+  byte_t Key[KeyLen];
+  bool   CryptoReady;
+#ifdef HAVE_OPENSSL
+  AESEncContext EncContext;
+  AESDecContext DecContext;
+  HMACContext   HMAC;
+#endif
+
+  BenchContext(const CommandOptions& options) : Options(options), CryptoReady(false)
+  {
+    RNG.FillRandom(Key, KeyLen);
+#ifdef HAVE_OPENSSL
+    byte_t IV_buf[CBC_BLOCK_SIZE];
+    CryptoReady = KM_SUCCESS(EncContext.InitKey(Key))
+      && KM_SUCCESS(EncContext.SetIVec(RNG.FillRandom(IV_buf, CBC_BLOCK_SIZE)))
+      && KM_SUCCESS(DecContext.InitKey(Key))
+      && KM_SUCCESS(HMAC.InitKey(Key, LS_MXF_SMPTE));
+#endif
+  }
+
+  //
+  WriterInfo MakeWriterInfo(bool encrypted)
+  {
+    WriterInfo Info = s_MyInfo;
+    Info.LabelSetType = LS_MXF_SMPTE;
+    Kumu::GenRandomUUID(Info.AssetUUID);
+
+    if ( encrypted )
+      {
+	Info.EncryptedEssence = true;
+	Info.UsesHMAC = true;
+	Kumu::GenRandomUUID(Info.ContextID);
+	Kumu::GenRandomUUID(Info.CryptographicKeyID);
+      }
+
+    return Info;
+  }
+};
+
+//------------------------------------------------------------------------------------------
+//
+
+// Something that can be measured. Run() performs one run of the operation and
+// reports the number of essence bytes and items (frames, resources, packets or
+// lookups) handled.
+class Benchmark
+{
+  KM_NO_COPY_CONSTRUCT(Benchmark);
+
+protected:
+  BenchContext& m_Ctx;
+
+public:
+  Benchmark(BenchContext& ctx) : m_Ctx(ctx) {}
+  virtual ~Benchmark() {}
+
+  virtual const char* Essence() const = 0;
+  virtual const char* Format() const = 0;
+  virtual bool Supports(Operation_t) const = 0;
+  virtual Result_t Run(Operation_t, ui64_t& bytes, ui64_t& items) = 0;
+};
+
+// AES and HMAC alone, over the JPEG 2000 frames
+class CryptoBenchmark : public Benchmark
+{
+  FrameSet&  m_Frames;
+  ByteString m_Output;
+
+public:
+  CryptoBenchmark(BenchContext& ctx, FrameSet& frames) : Benchmark(ctx), m_Frames(frames) {}
+  virtual ~CryptoBenchmark() {}
+
+  virtual const char* Essence() const { return "jp2k"; }
+  virtual const char* Format() const { return "memory"; }
+
+  virtual bool Supports(Operation_t op) const {
+    return m_Ctx.CryptoReady && ( op == OP_AES_ENCRYPT || op == OP_AES_DECRYPT || op == OP_HMAC );
+  }
+
+  //
+  virtual Result_t Run(Operation_t op, ui64_t& bytes, ui64_t& items)
+  {
+    Result_t result = RESULT_NOTIMPL;
+#ifdef HAVE_OPENSSL
+    ui32_t block_length = m_Frames.FrameSize() - ( m_Frames.FrameSize() % CBC_BLOCK_SIZE );
+    result = m_Output.Capacity(block_length);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Ctx.Options.frame_count; ++i )
+      {
+	switch ( op )
+	  {
+	  case OP_AES_ENCRYPT:
+	    result = m_Ctx.EncContext.EncryptBlock(m_Frames.Frame(i), m_Output.Data(), block_length);
+	    break;
+
+	  case OP_AES_DECRYPT:
+	    result = m_Ctx.DecContext.DecryptBlock(m_Frames.Frame(i), m_Output.Data(), block_length);
+	    break;
+
+	  case OP_HMAC:
+	    m_Ctx.HMAC.Reset();
+	    result = m_Ctx.HMAC.Update(m_Frames.Frame(i), m_Frames.FrameSize());
+
+	    if ( KM_SUCCESS(result) )
+	      result = m_Ctx.HMAC.Finalize();
+	    break;
+
+	  default:
+	    return RESULT_NOTIMPL;
+	  }
+
+	bytes += ( op == OP_HMAC ) ? m_Frames.FrameSize() : block_length;
+	++items;
+      }
+#endif // HAVE_OPENSSL
+    return result;
+  }
+};
+
+// Reads every KLV packet in the file.
+static Result_t
+walk_klv(const std::string& filename, ui64_t& bytes, ui64_t& items)
+{
+  Kumu::FileReader Reader;
+  KLVFilePacket KP;
+  Result_t result = Reader.OpenRead(filename);
+
+  while ( KM_SUCCESS(result) )
+    {
+      result = KP.InitFromFile(Reader);
+
+      if ( KM_SUCCESS(result) )
+	{
+	  bytes += KP.PacketLength();
+	  ++items;
+	}
+    }
+
+  if ( result == RESULT_ENDOFFILE )
+    result = RESULT_OK;
+
+  return result;
+}
+
+// A track file of one essence type in one format. Subclasses write and read
+// the file; the encrypted operations use a second file.
+class TrackFileBenchmark : public Benchmark
+{
+protected:
+  std::string m_Filename;
+  std::string m_CryptFilename;
+
+  virtual Result_t Write(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items) = 0;
+  virtual Result_t Read(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items) = 0;
+  virtual Result_t OpenClose(const std::string& filename) = 0;
+  virtual Result_t Lookup(const std::string&, ui32_t) { return RESULT_NOTIMPL; }
+  virtual bool     CanEncrypt() const { return true; }
+  virtual bool     HasIndex() const { return true; }
+
+#ifdef HAVE_OPENSSL
+  inline AESEncContext* EncContext(bool encrypted) { return encrypted ? &m_Ctx.EncContext : 0; }
+  inline AESDecContext* DecContext(bool encrypted) { return encrypted ? &m_Ctx.DecContext : 0; }
+  inline HMACContext*   HMAC(bool encrypted) { return encrypted ? &m_Ctx.HMAC : 0; }
+#else
+  inline AESEncContext* EncContext(bool) { return 0; }
+  inline AESDecContext* DecContext(bool) { return 0; }
+  inline HMACContext*   HMAC(bool) { return 0; }
+#endif
+
+  // returns a pseudo-random frame number for the index lookups
+  inline ui32_t LookupFrame(ui32_t i) const {
+    return (ui32_t)( ( (ui64_t)i * 2654435761UL ) % m_Ctx.Options.frame_count );
+  }
+
+public:
+  TrackFileBenchmark(BenchContext& ctx) : Benchmark(ctx) {}
+
+  virtual ~TrackFileBenchmark()
+  {
+    if ( ! m_Ctx.Options.keep_flag )
+      {
+	if ( PathIsFile(m_Filename) )
+	  DeleteFile(m_Filename);
+
+	if ( PathIsFile(m_CryptFilename) )
+	  DeleteFile(m_CryptFilename);
+      }
+  }
+
+  //
+  void InitFilenames()
+  {
+    std::string base = std::string(PROGRAM_NAME) + "-" + Essence() + "-" + Format();
+    m_Filename = PathJoin(m_Ctx.Options.scratch_dir, base + ".mxf");
+    m_CryptFilename = PathJoin(m_Ctx.Options.scratch_dir, base + "-enc.mxf");
+  }
+
+  // removes the output of an earlier wrap run; not part of any measurement
+  void Prepare(Operation_t op)
+  {
+    if ( op == OP_WRAP && PathIsFile(m_Filename) )
+      DeleteFile(m_Filename);
+
+    if ( op == OP_ENCRYPT && PathIsFile(m_CryptFilename) )
+      DeleteFile(m_CryptFilename);
+  }
+
+  //
+  virtual bool Supports(Operation_t op) const
+  {
+    switch ( op )
+      {
+      case OP_WRAP: case OP_UNWRAP: case OP_OPEN: case OP_KLV_WALK:
+	return true;
+
+      case OP_ENCRYPT: case OP_DECRYPT:
+	return m_Ctx.CryptoReady && CanEncrypt();
+
+      case OP_LOOKUP:
+	return HasIndex();
+
+      default:
+	break;
+      }
+
+    return false;
+  }
+
+  //
+  virtual Result_t Run(Operation_t op, ui64_t& bytes, ui64_t& items)
+  {
+    switch ( op )
+      {
+      case OP_WRAP:     return Write(m_Filename, false, bytes, items);
+      case OP_UNWRAP:   return Read(m_Filename, false, bytes, items);
+      case OP_ENCRYPT:  return Write(m_CryptFilename, true, bytes, items);
+      case OP_DECRYPT:  return Read(m_CryptFilename, true, bytes, items);
+      case OP_KLV_WALK: return walk_klv(m_Filename, bytes, items);
+
+      case OP_OPEN:
+	{
+	  Result_t result = RESULT_OK;
+
+	  for ( ui32_t i = 0; KM_SUCCESS(result) && i < OpenCount; ++i )
+	    result = OpenClose(m_Filename);
+
+	  items = OpenCount;
+	  return result;
+	}
+
+      case OP_LOOKUP:
+	items = LookupCount;
+	return Lookup(m_Filename, LookupCount);
+
+      default:
+	break;
+      }
+
+    return RESULT_NOTIMPL;
+  }
+};
+
+//------------------------------------------------------------------------------------------
+// JPEG 2000
+
+//
+static void
+make_picture_descriptor(JP2K::PictureDescriptor& PDesc, ui32_t frame_count)
+{
+  PDesc = JP2K::PictureDescriptor();
+  PDesc.EditRate = EditRate_24;
+  PDesc.SampleRate = EditRate_24;
+  PDesc.ContainerDuration = frame_count;
+  PDesc.StoredWidth = PDesc.Xsize = PDesc.XTsize = 2048;
+  PDesc.StoredHeight = PDesc.Ysize = PDesc.YTsize = 1080;
+  PDesc.AspectRatio = ASDCP::Rational(2048, 1080);
+  PDesc.Csize = 3;
+
+  for ( ui32_t i = 0; i < PDesc.Csize; ++i )
+    {
+      PDesc.ImageComponents[i].Ssize = 11; // 12 bits
+      PDesc.ImageComponents[i].XRsize = 1;
+      PDesc.ImageComponents[i].YRsize = 1;
+    }
+}
+
+// Makes the frames look like codestreams: SOC and SIZ markers at the start
+// and EOC at the end.
+static void
+mark_codestreams(FrameSet& frames)
+{
+  for ( ui32_t i = 0; i < FrameSet::Count; ++i )
+    {
+      byte_t* p = frames.Frame(i);
+      p[0] = 0xff; p[1] = 0x4f;
+      p[2] = 0xff; p[3] = 0x51;
+      p[frames.FrameSize() - 2] = 0xff;
+      p[frames.FrameSize() - 1] = 0xd9;
+    }
+}
+
+//
+class JP2KBenchmark : public TrackFileBenchmark
+{
+  FrameSet& m_Frames;
+
+public:
+  JP2KBenchmark(BenchContext& ctx, FrameSet& frames) : TrackFileBenchmark(ctx), m_Frames(frames) { InitFilenames(); }
+  virtual ~JP2KBenchmark() {}
+
+  virtual const char* Essence() const { return "jp2k"; }
+  virtual const char* Format() const { return "as-dcp"; }
+
+  //
+  virtual Result_t Write(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    JP2K::MXFWriter Writer;
+    JP2K::FrameBuffer FrameBuffer;
+    JP2K::PictureDescriptor PDesc;
+    make_picture_descriptor(PDesc, m_Ctx.Options.frame_count);
+
+    Result_t result = Writer.OpenWrite(filename, m_Ctx.MakeWriterInfo(encrypted), PDesc);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Ctx.Options.frame_count; ++i )
+      {
+	m_Frames.Wrap(i, FrameBuffer);
+	result = Writer.WriteFrame(FrameBuffer, EncContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    if ( KM_SUCCESS(result) )
+      result = Writer.Finalize();
+
+    return result;
+  }
+
+  //
+  virtual Result_t Read(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    JP2K::MXFReader Reader(m_Ctx.FileReaderFactory);
+    JP2K::FrameBuffer FrameBuffer(m_Frames.FrameSize());
+    Result_t result = Reader.OpenRead(filename);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Ctx.Options.frame_count; ++i )
+      {
+	result = Reader.ReadFrame(i, FrameBuffer, DecContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    return result;
+  }
+
+  //
+  virtual Result_t OpenClose(const std::string& filename)
+  {
+    JP2K::MXFReader Reader(m_Ctx.FileReaderFactory);
+    Result_t result = Reader.OpenRead(filename);
+
+    if ( KM_SUCCESS(result) )
+      result = Reader.Close();
+
+    return result;
+  }
+
+  //
+  virtual Result_t Lookup(const std::string& filename, ui32_t count)
+  {
+    JP2K::MXFReader Reader(m_Ctx.FileReaderFactory);
+    MXF::IndexTableSegment::IndexEntry Entry;
+    Result_t result = Reader.OpenRead(filename);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < count; ++i )
+      result = Reader.OPAtomIndexFooter().Lookup(LookupFrame(i), Entry);
+
+    return result;
+  }
+};
+
+//
+class AS02JP2KBenchmark : public TrackFileBenchmark
+{
+  FrameSet& m_Frames;
+
+public:
+  AS02JP2KBenchmark(BenchContext& ctx, FrameSet& frames) : TrackFileBenchmark(ctx), m_Frames(frames) { InitFilenames(); }
+  virtual ~AS02JP2KBenchmark() {}
+
+  virtual const char* Essence() const { return "jp2k"; }
+  virtual const char* Format() const { return "as-02"; }
+
+  //
+  virtual Result_t Write(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    AS_02::JP2K::MXFWriter Writer;
+    JP2K::FrameBuffer FrameBuffer;
+    JP2K::PictureDescriptor PDesc;
+    make_picture_descriptor(PDesc, m_Ctx.Options.frame_count);
+
+    const Dictionary* dict = &DefaultSMPTEDict();
+    MXF::RGBAEssenceDescriptor* essence_descriptor = new MXF::RGBAEssenceDescriptor(dict);
+    MXF::InterchangeObject_list_t essence_sub_descriptors;
+    essence_sub_descriptors.push_back(new MXF::JPEG2000PictureSubDescriptor(dict));
+
+    Result_t result = JP2K_PDesc_to_MD(PDesc, *dict, *essence_descriptor,
+				       *static_cast<MXF::JPEG2000PictureSubDescriptor*>(essence_sub_descriptors.back()));
+
+    if ( KM_SUCCESS(result) )
+      result = Writer.OpenWrite(filename, m_Ctx.MakeWriterInfo(encrypted), essence_descriptor,
+				essence_sub_descriptors, EditRate_24);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Ctx.Options.frame_count; ++i )
+      {
+	m_Frames.Wrap(i, FrameBuffer);
+	result = Writer.WriteFrame(FrameBuffer, EncContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    if ( KM_SUCCESS(result) )
+      result = Writer.Finalize();
+
+    return result;
+  }
+
+  //
+  virtual Result_t Read(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    AS_02::JP2K::MXFReader Reader(m_Ctx.FileReaderFactory);
+    JP2K::FrameBuffer FrameBuffer(m_Frames.FrameSize());
+    Result_t result = Reader.OpenRead(filename);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Ctx.Options.frame_count; ++i )
+      {
+	result = Reader.ReadFrame(i, FrameBuffer, DecContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    return result;
+  }
+
+  //
+  virtual Result_t OpenClose(const std::string& filename)
+  {
+    AS_02::JP2K::MXFReader Reader(m_Ctx.FileReaderFactory);
+    Result_t result = Reader.OpenRead(filename);
+
+    if ( KM_SUCCESS(result) )
+      result = Reader.Close();
+
+    return result;
+  }
+
+  //
+  virtual Result_t Lookup(const std::string& filename, ui32_t count)
+  {
+    AS_02::JP2K::MXFReader Reader(m_Ctx.FileReaderFactory);
+    MXF::IndexTableSegment::IndexEntry Entry;
+    Result_t result = Reader.OpenRead(filename);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < count; ++i )
+      result = Reader.AS02IndexReader().Lookup(LookupFrame(i), Entry);
+
+    return result;
+  }
+};
+
+//------------------------------------------------------------------------------------------
+// PCM, 48 kHz 24 bit 6 channels at 24 frames per second
+
+//
+static void
+make_audio_descriptor(PCM::AudioDescriptor& ADesc, ui32_t frame_count)
+{
+  ADesc.EditRate = EditRate_24;
+  ADesc.AudioSamplingRate = SampleRate_48k;
+  ADesc.Locked = 0;
+  ADesc.ChannelCount = 6;
+  ADesc.QuantizationBits = 24;
+  ADesc.BlockAlign = ADesc.ChannelCount * 3;
+  ADesc.AvgBps = ADesc.BlockAlign * 48000;
+  ADesc.LinkedTrackID = 0;
+  ADesc.ContainerDuration = frame_count;
+  ADesc.ChannelFormat = PCM::CF_NONE;
+}
+
+//
+class PCMBenchmark : public TrackFileBenchmark
+{
+  FrameSet& m_Frames;
+
+public:
+  PCMBenchmark(BenchContext& ctx, FrameSet& frames) : TrackFileBenchmark(ctx), m_Frames(frames) { InitFilenames(); }
+  virtual ~PCMBenchmark() {}
+
+  virtual const char* Essence() const { return "pcm"; }
+  virtual const char* Format() const { return "as-dcp"; }
+
+  //
+  virtual Result_t Write(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    PCM::MXFWriter Writer;
+    PCM::FrameBuffer FrameBuffer;
+    PCM::AudioDescriptor ADesc;
+    make_audio_descriptor(ADesc, m_Ctx.Options.frame_count);
+
+    Result_t result = Writer.OpenWrite(filename, m_Ctx.MakeWriterInfo(encrypted), ADesc);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Ctx.Options.frame_count; ++i )
+      {
+	m_Frames.Wrap(i, FrameBuffer);
+	result = Writer.WriteFrame(FrameBuffer, EncContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    if ( KM_SUCCESS(result) )
+      result = Writer.Finalize();
+
+    return result;
+  }
+
+  //
+  virtual Result_t Read(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    PCM::MXFReader Reader(m_Ctx.FileReaderFactory);
+    PCM::FrameBuffer FrameBuffer(m_Frames.FrameSize());
+    Result_t result = Reader.OpenRead(filename);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Ctx.Options.frame_count; ++i )
+      {
+	result = Reader.ReadFrame(i, FrameBuffer, DecContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    return result;
+  }
+
+  //
+  virtual Result_t OpenClose(const std::string& filename)
+  {
+    PCM::MXFReader Reader(m_Ctx.FileReaderFactory);
+    Result_t result = Reader.OpenRead(filename);
+
+    if ( KM_SUCCESS(result) )
+      result = Reader.Close();
+
+    return result;
+  }
+
+  //
+  virtual Result_t Lookup(const std::string& filename, ui32_t count)
+  {
+    PCM::MXFReader Reader(m_Ctx.FileReaderFactory);
+    MXF::IndexTableSegment::IndexEntry Entry;
+    Result_t result = Reader.OpenRead(filename);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < count; ++i )
+      result = Reader.OPAtomIndexFooter().Lookup(LookupFrame(i), Entry);
+
+    return result;
+  }
+};
+
+// AS-02 PCM is clip-wrapped; the frames are written and read as edit units
+// of the same size as the AS-DCP frames.
+class AS02PCMBenchmark : public TrackFileBenchmark
+{
+  FrameSet& m_Frames;
+
+public:
+  AS02PCMBenchmark(BenchContext& ctx, FrameSet& frames) : TrackFileBenchmark(ctx), m_Frames(frames) { InitFilenames(); }
+  virtual ~AS02PCMBenchmark() {}
+
+  virtual const char* Essence() const { return "pcm"; }
+  virtual const char* Format() const { return "as-02"; }
+
+  //
+  virtual Result_t Write(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    AS_02::PCM::MXFWriter Writer;
+    PCM::FrameBuffer FrameBuffer;
+    PCM::AudioDescriptor ADesc;
+    make_audio_descriptor(ADesc, m_Ctx.Options.frame_count);
+
+    MXF::WaveAudioDescriptor* essence_descriptor = new MXF::WaveAudioDescriptor(&DefaultSMPTEDict());
+    MXF::InterchangeObject_list_t essence_sub_descriptors;
+    Result_t result = PCM_ADesc_to_MD(ADesc, essence_descriptor);
+
+    if ( KM_SUCCESS(result) )
+      result = Writer.OpenWrite(filename, m_Ctx.MakeWriterInfo(encrypted), essence_descriptor,
+				essence_sub_descriptors, EditRate_24);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Ctx.Options.frame_count; ++i )
+      {
+	m_Frames.Wrap(i, FrameBuffer);
+	result = Writer.WriteFrame(FrameBuffer, EncContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    if ( KM_SUCCESS(result) )
+      result = Writer.Finalize();
+
+    return result;
+  }
+
+  //
+  virtual Result_t Read(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    AS_02::PCM::MXFReader Reader(m_Ctx.FileReaderFactory);
+    PCM::FrameBuffer FrameBuffer(m_Frames.FrameSize());
+    Result_t result = Reader.OpenRead(filename, EditRate_24);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Ctx.Options.frame_count; ++i )
+      {
+	result = Reader.ReadFrame(i, FrameBuffer, DecContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    return result;
+  }
+
+  //
+  virtual Result_t OpenClose(const std::string& filename)
+  {
+    AS_02::PCM::MXFReader Reader(m_Ctx.FileReaderFactory);
+    Result_t result = Reader.OpenRead(filename, EditRate_24);
+
+    if ( KM_SUCCESS(result) )
+      result = Reader.Close();
+
+    return result;
+  }
+
+  // clip-wrapped essence cannot be encrypted, and has a single index entry
+  virtual bool CanEncrypt() const { return false; }
+  virtual bool HasIndex() const { return false; }
+};
+
+//------------------------------------------------------------------------------------------
+// IAB, AS-02 only
+
+// Makes the frames look like IA Frames: an empty preamble followed by the
+// IA Frame element holding the rest of the buffer.
+static void
+mark_ia_frames(FrameSet& frames)
+{
+  for ( ui32_t i = 0; i < FrameSet::Count; ++i )
+    {
+      byte_t* p = frames.Frame(i);
+      p[0] = 0x01; // preamble tag
+      i2p<ui32_t>(KM_i32_BE(0), p + 1);
+      p[5] = 0x02; // IA Frame tag
+      i2p<ui32_t>(KM_i32_BE(frames.FrameSize() - 10), p + 6);
+    }
+}
+
+//
+class AS02IABBenchmark : public TrackFileBenchmark
+{
+  FrameSet& m_Frames;
+
+public:
+  AS02IABBenchmark(BenchContext& ctx, FrameSet& frames) : TrackFileBenchmark(ctx), m_Frames(frames) { InitFilenames(); }
+  virtual ~AS02IABBenchmark() {}
+
+  virtual const char* Essence() const { return "iab"; }
+  virtual const char* Format() const { return "as-02"; }
+
+  // the IAB writer has no encryption, and the reader does not expose its index
+  virtual bool CanEncrypt() const { return false; }
+  virtual bool HasIndex() const { return false; }
+
+  //
+  virtual Result_t Write(const std::string& filename, bool, ui64_t& bytes, ui64_t& items)
+  {
+    AS_02::IAB::MXFWriter Writer;
+    ASDCP::FrameBuffer FrameBuffer;
+    const Dictionary* dict = &DefaultSMPTEDict();
+    MXF::IABSoundfieldLabelSubDescriptor iab_subdescr(dict);
+    std::vector<UL> conforms_to_spec;
+    conforms_to_spec.push_back(dict->ul(MDD_IMF_IABTrackFileLevel0));
+
+    Result_t result = Writer.OpenWrite(filename, m_Ctx.MakeWriterInfo(false), iab_subdescr,
+				       conforms_to_spec, EditRate_24);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Ctx.Options.frame_count; ++i )
+      {
+	m_Frames.Wrap(i, FrameBuffer);
+	result = Writer.WriteFrame(FrameBuffer);
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    if ( KM_SUCCESS(result) )
+      result = Writer.Finalize();
+
+    return result;
+  }
+
+  //
+  virtual Result_t Read(const std::string& filename, bool, ui64_t& bytes, ui64_t& items)
+  {
+    AS_02::IAB::MXFReader Reader(m_Ctx.FileReaderFactory);
+    ASDCP::FrameBuffer FrameBuffer;
+    Result_t result = FrameBuffer.Capacity(m_Frames.FrameSize());
+
+    if ( KM_SUCCESS(result) )
+      result = Reader.OpenRead(filename);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Ctx.Options.frame_count; ++i )
+      {
+	result = Reader.ReadFrame(i, FrameBuffer);
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    return result;
+  }
+
+  //
+  virtual Result_t OpenClose(const std::string& filename)
+  {
+    AS_02::IAB::MXFReader Reader(m_Ctx.FileReaderFactory);
+    Result_t result = Reader.OpenRead(filename);
+
+    if ( KM_SUCCESS(result) )
+      result = Reader.Close();
+
+    return result;
+  }
+};
+
+//------------------------------------------------------------------------------------------
+// Timed Text: a document referencing one PNG resource per frame
+
+const ui32_t ResourceSize = 16384;
+
+// Synthesizes the document and the resource list. The frames become the PNG
+// resources.
+class TimedTextSource
+{
+  KM_NO_COPY_CONSTRUCT(TimedTextSource);
+  TimedTextSource();
+
+public:
+  FrameSet& Frames;
+  TimedText::TimedTextDescriptor TDesc;
+  std::string XMLDoc;
+
+  TimedTextSource(FrameSet& frames, ui32_t resource_count) : Frames(frames)
+  {
+    char buf[64];
+    TDesc.EditRate = EditRate_24;
+    TDesc.ContainerDuration = resource_count * 24;
+    TDesc.NamespaceName = "http://www.smpte-ra.org/schemas/428-7/2010/DCST";
+    Kumu::GenRandomUUID(TDesc.AssetID);
+
+    XMLDoc = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<SubtitleReel xmlns=\"http://www.smpte-ra.org/schemas/428-7/2010/DCST\">\n"
+      "  <Id>urn:uuid:";
+    XMLDoc += Kumu::UUID(TDesc.AssetID).EncodeHex(buf, 64);
+    XMLDoc += "</Id>\n  <EditRate>24 1</EditRate>\n  <TimeCodeRate>24</TimeCodeRate>\n  <SubtitleList>\n";
+
+    for ( ui32_t i = 0; i < resource_count; ++i )
+      {
+	TimedText::TimedTextResourceDescriptor Resource;
+	Kumu::GenRandomUUID(Resource.ResourceID);
+	Resource.Type = TimedText::MT_PNG;
+	TDesc.ResourceList.push_back(Resource);
+
+	char line[256];
+	snprintf(line, 256, "    <Subtitle SpotNumber=\"%u\" TimeIn=\"%02u:%02u:%02u:00\" TimeOut=\"%02u:%02u:%02u:12\">"
+		 "<Image>urn:uuid:%s</Image></Subtitle>\n", i + 1,
+		 i / 3600, ( i / 60 ) % 60, i % 60, i / 3600, ( i / 60 ) % 60, i % 60,
+		 Kumu::UUID(Resource.ResourceID).EncodeHex(buf, 64));
+	XMLDoc += line;
+      }
+
+    XMLDoc += "  </SubtitleList>\n</SubtitleReel>\n";
+
+    static const byte_t PNGMagic[8] = { 0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a };
+
+    for ( ui32_t i = 0; i < FrameSet::Count; ++i )
+      memcpy(Frames.Frame(i), PNGMagic, 8);
+  }
+
+  //
+  void WrapResource(ui32_t i, const TimedText::TimedTextResourceDescriptor& Resource, TimedText::FrameBuffer& frame_buf)
+  {
+    Frames.Wrap(i, frame_buf);
+    frame_buf.AssetID(Resource.ResourceID);
+    frame_buf.MIMEType("image/png");
+  }
+};
+
+//
+class TimedTextBenchmark : public TrackFileBenchmark
+{
+  TimedTextSource& m_Source;
+
+public:
+  TimedTextBenchmark(BenchContext& ctx, TimedTextSource& source) : TrackFileBenchmark(ctx), m_Source(source) { InitFilenames(); }
+  virtual ~TimedTextBenchmark() {}
+
+  virtual const char* Essence() const { return "timed-text"; }
+  virtual const char* Format() const { return "as-dcp"; }
+  virtual bool HasIndex() const { return false; }
+
+  //
+  virtual Result_t Write(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    TimedText::MXFWriter Writer;
+    TimedText::FrameBuffer FrameBuffer;
+    Result_t result = Writer.OpenWrite(filename, m_Ctx.MakeWriterInfo(encrypted), m_Source.TDesc);
+
+    if ( KM_SUCCESS(result) )
+      {
+	result = Writer.WriteTimedTextResource(m_Source.XMLDoc, EncContext(encrypted), HMAC(encrypted));
+	bytes += m_Source.XMLDoc.size();
+	++items;
+      }
+
+    TimedText::ResourceList_t::const_iterator ri = m_Source.TDesc.ResourceList.begin();
+    for ( ui32_t i = 0; KM_SUCCESS(result) && ri != m_Source.TDesc.ResourceList.end(); ++ri, ++i )
+      {
+	m_Source.WrapResource(i, *ri, FrameBuffer);
+	result = Writer.WriteAncillaryResource(FrameBuffer, EncContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    if ( KM_SUCCESS(result) )
+      result = Writer.Finalize();
+
+    return result;
+  }
+
+  //
+  virtual Result_t Read(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    TimedText::MXFReader Reader(m_Ctx.FileReaderFactory);
+    TimedText::FrameBuffer FrameBuffer(2 * Kumu::Megabyte);
+    std::string XMLDoc;
+    Result_t result = Reader.OpenRead(filename);
+
+    if ( KM_SUCCESS(result) )
+      {
+	result = Reader.ReadTimedTextResource(XMLDoc, DecContext(encrypted), HMAC(encrypted));
+	bytes += XMLDoc.size();
+	++items;
+      }
+
+    TimedText::ResourceList_t::const_iterator ri = m_Source.TDesc.ResourceList.begin();
+    for ( ; KM_SUCCESS(result) && ri != m_Source.TDesc.ResourceList.end(); ++ri )
+      {
+	result = Reader.ReadAncillaryResource(ri->ResourceID, FrameBuffer, DecContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    return result;
+  }
+
+  //
+  virtual Result_t OpenClose(const std::string& filename)
+  {
+    TimedText::MXFReader Reader(m_Ctx.FileReaderFactory);
+    Result_t result = Reader.OpenRead(filename);
+
+    if ( KM_SUCCESS(result) )
+      result = Reader.Close();
+
+    return result;
+  }
+};
+
+//
+class AS02TimedTextBenchmark : public TrackFileBenchmark
+{
+  TimedTextSource& m_Source;
+
+public:
+  AS02TimedTextBenchmark(BenchContext& ctx, TimedTextSource& source) : TrackFileBenchmark(ctx), m_Source(source) { InitFilenames(); }
+  virtual ~AS02TimedTextBenchmark() {}
+
+  virtual const char* Essence() const { return "timed-text"; }
+  virtual const char* Format() const { return "as-02"; }
+  virtual bool HasIndex() const { return false; }
+
+  //
+  virtual Result_t Write(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    AS_02::TimedText::MXFWriter Writer;
+    TimedText::FrameBuffer FrameBuffer;
+    Result_t result = Writer.OpenWrite(filename, m_Ctx.MakeWriterInfo(encrypted), m_Source.TDesc);
+
+    if ( KM_SUCCESS(result) )
+      {
+	result = Writer.WriteTimedTextResource(m_Source.XMLDoc, EncContext(encrypted), HMAC(encrypted));
+	bytes += m_Source.XMLDoc.size();
+	++items;
+      }
+
+    TimedText::ResourceList_t::const_iterator ri = m_Source.TDesc.ResourceList.begin();
+    for ( ui32_t i = 0; KM_SUCCESS(result) && ri != m_Source.TDesc.ResourceList.end(); ++ri, ++i )
+      {
+	m_Source.WrapResource(i, *ri, FrameBuffer);
+	result = Writer.WriteAncillaryResource(FrameBuffer, EncContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    if ( KM_SUCCESS(result) )
+      result = Writer.Finalize();
+
+    return result;
+  }
+
+  //
+  virtual Result_t Read(const std::string& filename, bool encrypted, ui64_t& bytes, ui64_t& items)
+  {
+    AS_02::TimedText::MXFReader Reader(m_Ctx.FileReaderFactory);
+    TimedText::FrameBuffer FrameBuffer(2 * Kumu::Megabyte);
+    std::string XMLDoc;
+    Result_t result = Reader.OpenRead(filename);
+
+    if ( KM_SUCCESS(result) )
+      {
+	result = Reader.ReadTimedTextResource(XMLDoc, DecContext(encrypted), HMAC(encrypted));
+	bytes += XMLDoc.size();
+	++items;
+      }
+
+    TimedText::ResourceList_t::const_iterator ri = m_Source.TDesc.ResourceList.begin();
+    for ( ; KM_SUCCESS(result) && ri != m_Source.TDesc.ResourceList.end(); ++ri )
+      {
+	result = Reader.ReadAncillaryResource(Kumu::UUID(ri->ResourceID), FrameBuffer,
+					      DecContext(encrypted), HMAC(encrypted));
+	bytes += FrameBuffer.Size();
+	++items;
+      }
+
+    return result;
+  }
+
+  //
+  virtual Result_t OpenClose(const std::string& filename)
+  {
+    AS_02::TimedText::MXFReader Reader(m_Ctx.FileReaderFactory);
+    Result_t result = Reader.OpenRead(filename);
+
+    if ( KM_SUCCESS(result) )
+      result = Reader.Close();
+
+    return result;
+  }
+};
+
+//------------------------------------------------------------------------------------------
+//
+
+// Runs each supported operation Options.repeat_count times, in order, and
+// records the fastest run. The operations are listed so that every read
+// follows the write that produces its file.
+static Result_t
+measure(BenchContext& Ctx, Benchmark& bench, ResultList_t& results)
+{
+  static const Operation_t Order[OP_MAX] = {
+    OP_WRAP, OP_UNWRAP, OP_ENCRYPT, OP_DECRYPT, OP_OPEN, OP_LOOKUP, OP_KLV_WALK,
+    OP_AES_ENCRYPT, OP_AES_DECRYPT, OP_HMAC
+  };
+
+  TrackFileBenchmark* track_bench = dynamic_cast<TrackFileBenchmark*>(&bench);
+  Result_t result = RESULT_OK;
+
+  for ( ui32_t i = 0; KM_SUCCESS(result) && i < OP_MAX; ++i )
+    {
+      Operation_t op = Order[i];
+
+      if ( ! bench.Supports(op) )
+	continue;
+
+      BenchResult best;
+      best.essence = bench.Essence();
+      best.format = bench.Format();
+      best.operation = op;
+
+      for ( ui32_t run = 0; KM_SUCCESS(result) && run < Ctx.Options.repeat_count; ++run )
+	{
+	  ui64_t bytes = 0, items = 0;
+
+	  if ( track_bench != 0 )
+	    track_bench->Prepare(op);
+
+	  ui64_t start = Kumu::MonotonicMicroseconds();
+	  result = bench.Run(op, bytes, items);
+	  double seconds = ( Kumu::MonotonicMicroseconds() - start ) / 1000000.0;
+
+	  if ( KM_SUCCESS(result) && ( run == 0 || seconds < best.seconds ) )
+	    {
+	      best.bytes = bytes;
+	      best.items = items;
+	      best.seconds = seconds;
+	    }
+	}
+
+      if ( KM_FAILURE(result) )
+	{
+	  fprintf(stderr, "%s %s %s: %s\n", best.essence.c_str(), best.format.c_str(),
+		  OperationNames[op], result.Label());
+	  break;
+	}
+
+      if ( Ctx.Options.verbose_flag )
+	fprintf(stderr, "%-10s %-6s %-12s %10.3f ms\n", best.essence.c_str(), best.format.c_str(),
+		OperationNames[op], best.seconds * 1000.0);
+
+      results.push_back(best);
+    }
+
+  return result;
+}
+
+//
+static void
+write_json(FILE* stream, const CommandOptions& Options, const ResultList_t& results)
+{
+  char buf1[IntBufferLen], buf2[IntBufferLen];
+
+  fprintf(stream, "{\n");
+  fprintf(stream, "  \"program\": \"%s\",\n", PROGRAM_NAME);
+  fprintf(stream, "  \"version\": \"%s\",\n", ASDCP::Version());
+  fprintf(stream, "  \"frame_count\": %u,\n", Options.frame_count);
+  fprintf(stream, "  \"frame_size\": %u,\n", Options.frame_size);
+  fprintf(stream, "  \"repeat_count\": %u,\n", Options.repeat_count);
+  fprintf(stream, "  \"results\": [");
+
+  ResultList_t::const_iterator i;
+  for ( i = results.begin(); i != results.end(); ++i )
+    {
+      double seconds = Kumu::xmax(i->seconds, 0.000001);
+
+      fprintf(stream, "%s\n    { \"essence\": \"%s\", \"format\": \"%s\", \"operation\": \"%s\",",
+	      ( i == results.begin() ? "" : "," ), i->essence.c_str(), i->format.c_str(), OperationNames[i->operation]);
+      fprintf(stream, " \"bytes\": %s, \"items\": %s, \"seconds\": %.6f,",
+	      ui64sz(i->bytes, buf1), ui64sz(i->items, buf2), i->seconds);
+      fprintf(stream, " \"mb_per_second\": %.3f, \"items_per_second\": %.1f }",
+	      i->bytes / seconds / 1000000.0, i->items / seconds);
+    }
+
+  fprintf(stream, "\n  ]\n}\n");
+}
+
+//
+int
+main(int argc, const char** argv)
+{
+  CommandOptions Options(argc, argv);
+
+  if ( Options.version_flag )
+    banner();
+
+  if ( Options.help_flag )
+    usage();
+
+  if ( Options.version_flag || Options.help_flag )
+    return 0;
+
+  if ( Options.error_flag )
+    {
+      fprintf(stderr, "There was a problem. Type %s -h for help.\n", PROGRAM_NAME);
+      return 3;
+    }
+
+  BenchContext Ctx(Options);
+  FrameSet JP2KFrames, PCMFrames, IABFrames, ResourceFrames;
+  PCM::AudioDescriptor ADesc;
+  make_audio_descriptor(ADesc, Options.frame_count);
+
+  Result_t result = JP2KFrames.Init(Options.frame_size, Ctx.RNG);
+
+  if ( KM_SUCCESS(result) )
+    result = PCMFrames.Init(PCM::CalcFrameBufferSize(ADesc), Ctx.RNG);
+
+  if ( KM_SUCCESS(result) )
+    result = IABFrames.Init(Kumu::xmax<ui32_t>(64, Options.frame_size / 8), Ctx.RNG);
+
+  if ( KM_SUCCESS(result) )
+    result = ResourceFrames.Init(ResourceSize, Ctx.RNG);
+
+  if ( KM_FAILURE(result) )
+    {
+      fprintf(stderr, "Unable to allocate essence: %s\n", result.Label());
+      return 1;
+    }
+
+  mark_codestreams(JP2KFrames);
+  mark_ia_frames(IABFrames);
+  TimedTextSource TTSource(ResourceFrames, Options.frame_count);
+
+  // the track files are deleted when the benchmarks are destroyed
+  std::list<Benchmark*> benchmarks;
+  const std::string& type = Options.essence_type;
+
+  if ( type.empty() || type == "jp2k" )
+    {
+      benchmarks.push_back(new JP2KBenchmark(Ctx, JP2KFrames));
+      benchmarks.push_back(new AS02JP2KBenchmark(Ctx, JP2KFrames));
+      benchmarks.push_back(new CryptoBenchmark(Ctx, JP2KFrames));
+    }
+
+  if ( type.empty() || type == "pcm" )
+    {
+      benchmarks.push_back(new PCMBenchmark(Ctx, PCMFrames));
+      benchmarks.push_back(new AS02PCMBenchmark(Ctx, PCMFrames));
+    }
+
+  if ( type.empty() || type == "iab" )
+    benchmarks.push_back(new AS02IABBenchmark(Ctx, IABFrames));
+
+  if ( type.empty() || type == "timed-text" )
+    {
+      benchmarks.push_back(new TimedTextBenchmark(Ctx, TTSource));
+      benchmarks.push_back(new AS02TimedTextBenchmark(Ctx, TTSource));
+    }
+
+  ResultList_t results;
+  std::list<Benchmark*>::iterator i;
+
+  for ( i = benchmarks.begin(); i != benchmarks.end(); ++i )
+    {
+      if ( KM_SUCCESS(result) )
+	result = measure(Ctx, **i, results);
+
+      delete *i;
+    }
+
+  FILE* stream = stdout;
+
+  if ( ! Options.out_file.empty() )
+    {
+      stream = fopen(Options.out_file.c_str(), "w");
+
+      if ( stream == 0 )
+	{
+	  fprintf(stderr, "Unable to open %s: %s\n", Options.out_file.c_str(), strerror(errno));
+	  return 1;
+	}
+    }
+
+  write_json(stream, Options, results);
+
+  if ( stream != stdout )
+    fclose(stream);
+
+  return KM_SUCCESS(result) ? 0 : 1;
+}
+
+
+//
+// end asdcp-bench.cpp
+//
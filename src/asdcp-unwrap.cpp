@@ -96,6 +96,7 @@ Options:\n\
   -f <start-frame>  - Starting frame number, default 0\n                \
   -G                - Perform GOP start lookup test on MXF+Interop MPEG file\n\
   -h | -help        - Show help\n\
+  --stats           - Print the time spent in each stage of reading essence\n\
   -k <key-string>   - Use key for ciphertext operations\n\
   -m                - verify HMAC values when reading\n\
   -p <rate>         - Alternative picture rate when unwrapping PCM:\n\
@@ -140,6 +141,7 @@ public:
   bool   no_write_flag;  // true if no output files are to be written
   bool   version_flag;   // true if the version display option was selected
   bool   help_flag;      // true if the help display option was selected
+  bool   stats_flag;     // true if per-stage timing is to be printed
   bool   stereo_image_flag; // if true, expect stereoscopic JP2K input (left eye first)
   ui32_t number_width;   // number of digits in a serialized filename (for JPEG extract)
   ui32_t start_frame;    // frame number to begin processing
@@ -183,7 +185,7 @@ public:
   CommandOptions(int argc, const char** argv) :
     mode(MMT_EXTRACT), error_flag(true), key_flag(false), read_hmac(false), split_wav(false),
     mono_wav(false), verbose_flag(false), fb_dump_size(0), no_write_flag(false),
-    version_flag(false), help_flag(false), stereo_image_flag(false), number_width(6),
+    version_flag(false), help_flag(false), stats_flag(false), stereo_image_flag(false), number_width(6),
     start_frame(0), duration(0xffffffff), duration_flag(false), j2c_pedantic(true),
     picture_rate(24), fb_size(FRAME_BUFFER_SIZE), file_prefix(0),
     channel_fmt(PCM::CF_NONE), input_filename(0), extension("dcdata")
@@ -200,6 +202,12 @@ public:
 	    continue;
 	  }
 
+	if ( (strcmp( argv[i], "--stats") == 0) )
+	  {
+	    stats_flag = true;
+	    continue;
+	  }
+
 	if ( argv[i][0] == '-'
 	     && ( isalpha(argv[i][1]) || isdigit(argv[i][1]) )
 	     && argv[i][2] == 0 )
@@ -317,6 +325,9 @@ public:
   }
 };
 
+// per-stage timing, printed when --stats is given
+static ASDCP::StageStats s_StageStats;
+
 //------------------------------------------------------------------------------------------
 // MPEG2 essence
 
@@ -336,6 +347,9 @@ read_MPEG2_file(CommandOptions& Options, const Kumu::IFileReaderFactory& fileRea
 
   Result_t result = Reader.OpenRead(Options.input_filename);
 
+  if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+    Reader.SetStageStats(&s_StageStats);
+
   if ( ASDCP_SUCCESS(result) )
     {
       MPEG2::VideoDescriptor VDesc;
@@ -417,6 +431,9 @@ gop_start_test(CommandOptions& Options, const Kumu::IFileReaderFactory& fileRead
 
   Result_t result = Reader.OpenRead(Options.input_filename);
 
+  if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+    Reader.SetStageStats(&s_StageStats);
+
   if ( ASDCP_SUCCESS(result) )
     {
       MPEG2::VideoDescriptor VDesc;
@@ -471,6 +488,9 @@ read_JP2K_S_file(CommandOptions& Options, const Kumu::IFileReaderFactory& fileRe
 
   Result_t result = Reader.OpenRead(Options.input_filename);
 
+  if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+    Reader.SetStageStats(&s_StageStats);
+
   if ( ASDCP_SUCCESS(result) )
     {
       JP2K::PictureDescriptor PDesc;
@@ -579,6 +599,9 @@ read_JP2K_file(CommandOptions& Options, const Kumu::IFileReaderFactory& fileRead
 
   Result_t result = Reader.OpenRead(Options.input_filename);
 
+  if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+    Reader.SetStageStats(&s_StageStats);
+
   if ( ASDCP_SUCCESS(result) )
     {
       JP2K::PictureDescriptor PDesc;
@@ -670,6 +693,9 @@ read_PCM_file(CommandOptions& Options, const Kumu::IFileReaderFactory& fileReade
 
   Result_t result = Reader.OpenRead(Options.input_filename);
 
+  if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+    Reader.SetStageStats(&s_StageStats);
+
   if ( ASDCP_SUCCESS(result) )
     {
       Reader.FillAudioDescriptor(ADesc);
@@ -789,6 +815,9 @@ read_timed_text_file(CommandOptions& Options, const Kumu::IFileReaderFactory& fi
 
   Result_t result = Reader.OpenRead(Options.input_filename);
 
+  if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+    Reader.SetStageStats(&s_StageStats);
+
   if ( ASDCP_SUCCESS(result) )
     {
       Reader.FillTimedTextDescriptor(TDesc);
@@ -882,6 +911,9 @@ read_DCData_file(CommandOptions& Options, const Kumu::IFileReaderFactory& fileRe
 
   Result_t result = Reader.OpenRead(Options.input_filename);
 
+  if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+    Reader.SetStageStats(&s_StageStats);
+
   if ( ASDCP_SUCCESS(result) )
     {
       DCData::DCDataDescriptor DDesc;
@@ -1052,6 +1084,9 @@ main(int argc, const char** argv)
       return 1;
     }
 
+  if ( Options.stats_flag )
+    s_StageStats.Dump();
+
   return 0;
 }
 
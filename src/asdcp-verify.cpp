@@ -0,0 +1,790 @@
+/*
+Copyright (c) 2003-2015, John Hurst
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+3. The name of the author may not be used to endorse or promote products
+   derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*! \file    asdcp-verify.cpp
+    \version $Id$
+    \brief   AS-DCP and AS-02 file integrity verification utility
+
+  This program reads every frame of a frame-wrapped AS-DCP or AS-02 file
+  and checks the KLV structure of each essence packet. If a key is given,
+  encrypted frames are decrypted to test the check value and padding, and
+  the integrity pack (asset ID, sequence number and HMAC) is verified.
+
+  The frame positions are taken from the index, sorted by file offset and
+  grouped into large contiguous chunks. Each chunk is fetched with a single
+  read and its frames are verified by one of a pool of worker threads.
+
+  AS-02 IAB is clip-wrapped, so its index points at IA Frames rather than
+  KLV packets. Those files are verified by reading each IA Frame in turn
+  with AS_02::IAB::MXFReader.
+
+  For more information about asdcplib, please refer to the header file AS_DCP.h
+*/
+
+#include <KM_fileio.h>
+#include <KM_mutex.h>
+#include <KM_thread.h>
+#include "AS_02_internal.h"
+#include "AS_02_IAB.h"
+
+#include <algorithm>
+
+using namespace Kumu;
+using namespace ASDCP;
+
+//------------------------------------------------------------------------------------------
+//
+// command line option parser class
+
+static const char* PROGRAM_NAME = "asdcp-verify";  // program name for messages
+
+// Increment the iterator, test for an additional non-option command line argument.
+// Causes the caller to return if there are no remaining arguments or if the next
+// argument begins with '-'.
+#define TEST_EXTRA_ARG(i,c)						\
+  if ( ++i >= argc || argv[(i)][0] == '-' ) {				\
+    fprintf(stderr, "Argument not found for option -%c.\n", (c));	\
+    return;								\
+  }
+
+//
+void
+banner(FILE* stream = stdout)
+{
+  fprintf(stream, "\n\
+%s (asdcplib %s)\n\n\
+Copyright (c) 2003-2015 John Hurst\n\n\
+asdcplib may be copied only under the terms of the license found at\n\
+the top of every file in the asdcplib distribution kit.\n\n\
+Specify the -h (help) option for further information about %s\n\n",
+	  PROGRAM_NAME, ASDCP::Version(), PROGRAM_NAME);
+}
+
+//
+void
+usage(FILE* stream = stdout)
+{
+  fprintf(stream, "\
+USAGE:%s [-h|-help] [-V]\n\
+\n\
+       %s [options] <input-file>+\n\
+\n\
+Options:\n\
+  -h | -help        - Show help\n\
+  -j <count>        - Number of worker threads (default: one per processor)\n\
+  -k <key-string>   - Use key for decryption and HMAC checks (hex string)\n\
+  -s <megabytes>    - Largest contiguous read (default: 16)\n\
+  -v                - Verbose, prints informative messages to stderr\n\
+  -V                - Show version information\n\
+\n\
+  Without a key, encrypted frames are checked for structure only.\n\
+\n\
+  NOTES: o There is no option grouping, all options must be distinct arguments.\n\
+         o All option arguments must be separated from the option by whitespace.\n\n",
+	  PROGRAM_NAME, PROGRAM_NAME);
+}
+
+//
+class CommandOptions
+{
+  CommandOptions();
+
+public:
+  bool   error_flag;     // true if the given options are in error or not complete
+  bool   version_flag;   // true if the version display option was selected
+  bool   help_flag;      // true if the help display option was selected
+  bool   verbose_flag;   // true if the verbose option was selected
+  bool   key_flag;       // true if an encryption key was given
+  byte_t key_value[KeyLen];  // value of given encryption key (when key_flag is true)
+  ui32_t thread_count;   // number of verification threads
+  ui32_t chunk_size;     // largest number of bytes fetched by a single read
+  PathList_t filenames;  // list of filenames to be processed
+
+  //
+  CommandOptions(int argc, const char** argv) :
+    error_flag(true), version_flag(false), help_flag(false), verbose_flag(false),
+    key_flag(false), thread_count(Kumu::HardwareConcurrency()), chunk_size(16 * Kumu::Megabyte)
+  {
+    memset(key_value, 0, KeyLen);
+
+    for ( int i = 1; i < argc; ++i )
+      {
+
+	if ( (strcmp( argv[i], "-help") == 0) )
+	  {
+	    help_flag = true;
+	    continue;
+	  }
+
+	if ( argv[i][0] == '-'
+	     && ( isalpha(argv[i][1]) || isdigit(argv[i][1]) )
+	     && argv[i][2] == 0 )
+	  {
+	    switch ( argv[i][1] )
+	      {
+	      case 'h': help_flag = true; break;
+
+	      case 'j':
+		TEST_EXTRA_ARG(i, 'j');
+		thread_count = Kumu::xmax<ui32_t>(1, Kumu::xabs(strtol(argv[i], 0, 10)));
+		break;
+
+	      case 'k': key_flag = true;
+		TEST_EXTRA_ARG(i, 'k');
+		{
+		  ui32_t length;
+		  Kumu::hex2bin(argv[i], key_value, KeyLen, &length);
+
+		  if ( length != KeyLen )
+		    {
+		      fprintf(stderr, "Unexpected key length: %u, expecting %u characters.\n", length, KeyLen);
+		      return;
+		    }
+		}
+		break;
+
+	      case 's':
+		TEST_EXTRA_ARG(i, 's');
+		chunk_size = Kumu::xclamp<ui32_t>(Kumu::xabs(strtol(argv[i], 0, 10)), 1, 1024) * Kumu::Megabyte;
+		break;
+
+	      case 'V': version_flag = true; break;
+	      case 'v': verbose_flag = true; break;
+
+	      default:
+		fprintf(stderr, "Unrecognized option: %s\n", argv[i]);
+		return;
+	      }
+	  }
+	else
+	  {
+	    if ( argv[i][0] != '-' )
+	      {
+		filenames.push_back(argv[i]);
+	      }
+	    else
+	      {
+		fprintf(stderr, "Unrecognized argument: %s\n", argv[i]);
+		return;
+	      }
+	  }
+      }
+
+    if ( help_flag || version_flag )
+      return;
+
+    if ( filenames.empty() )
+      {
+	fputs("At least one filename argument is required.\n", stderr);
+	return;
+      }
+
+    error_flag = false;
+  }
+};
+
+//------------------------------------------------------------------------------------------
+//
+
+// The location of one edit unit. The extent runs from the frame's own
+// position to the position of the next frame in file order.
+struct FrameExtent
+{
+  Kumu::fpos_t offset;
+  Kumu::fpos_t end;
+  ui32_t       frame_num;
+
+  bool operator<(const FrameExtent& rhs) const {
+    return ( offset < rhs.offset ) || ( offset == rhs.offset && frame_num < rhs.frame_num );
+  }
+};
+
+// A run of frames, in file order, fetched with a single read.
+struct FrameChunk
+{
+  ui32_t first;  // index into the sorted extent list
+  ui32_t count;
+};
+
+//
+struct FrameError
+{
+  ui32_t      frame_num;
+  std::string message;
+
+  bool operator<(const FrameError& rhs) const { return frame_num < rhs.frame_num; }
+};
+
+// State shared by the verification workers. Everything except the chunk
+// counter and the error list is read-only once the workers are started.
+//
+class VerifyJob
+{
+  KM_NO_COPY_CONSTRUCT(VerifyJob);
+  VerifyJob();
+
+public:
+  const CommandOptions&    m_Options;
+  const std::string        m_Filename;
+  const Dictionary&        m_Dict;
+  const WriterInfo&        m_Info;
+  UL                       m_EssenceUL;
+  ui32_t                   m_PacketsPerFrame;
+  std::vector<FrameExtent> m_Extents;
+  std::vector<FrameChunk>  m_Chunks;
+  volatile ui32_t          m_NextChunk;
+  volatile ui32_t          m_FramesVerified;
+  Kumu::Mutex              m_ErrorLock;
+  std::list<FrameError>    m_Errors;
+
+  VerifyJob(const CommandOptions& options, const std::string& filename,
+	    const Dictionary& dict, const WriterInfo& info) :
+    m_Options(options), m_Filename(filename), m_Dict(dict), m_Info(info),
+    m_PacketsPerFrame(1), m_NextChunk(0), m_FramesVerified(0) {}
+
+  //
+  void AddError(ui32_t frame_num, const std::string& message)
+  {
+    FrameError tmp_error;
+    tmp_error.frame_num = frame_num;
+    tmp_error.message = message;
+    Kumu::AutoMutex L(m_ErrorLock);
+    m_Errors.push_back(tmp_error);
+  }
+
+  // returns false when all chunks have been claimed
+  bool ClaimChunk(ui32_t& chunk_index)
+  {
+    chunk_index = Kumu::AtomicAdd(&m_NextChunk, 1) - 1;
+    return chunk_index < m_Chunks.size();
+  }
+
+  // groups the sorted extents into runs of at most m_Options.chunk_size bytes
+  void MakeChunks()
+  {
+    FrameChunk tmp_chunk;
+    tmp_chunk.first = 0;
+    tmp_chunk.count = 0;
+
+    for ( ui32_t i = 0; i < m_Extents.size(); ++i )
+      {
+	if ( tmp_chunk.count > 0
+	     && ( m_Extents[i].end - m_Extents[tmp_chunk.first].offset ) > m_Options.chunk_size )
+	  {
+	    m_Chunks.push_back(tmp_chunk);
+	    tmp_chunk.first = i;
+	    tmp_chunk.count = 0;
+	  }
+
+	++tmp_chunk.count;
+      }
+
+    if ( tmp_chunk.count > 0 )
+      m_Chunks.push_back(tmp_chunk);
+  }
+};
+
+//
+class VerifyWorker : public Kumu::Thread
+{
+  KM_NO_COPY_CONSTRUCT(VerifyWorker);
+  VerifyWorker();
+
+  VerifyJob&         m_Job;
+  Kumu::FileReader   m_File;
+  ChunkReader        m_ChunkReader;
+  Kumu::ByteString   m_ChunkBuf;
+  ASDCP::FrameBuffer m_FrameBuf;
+  ASDCP::FrameBuffer m_CtFrameBuf;
+  AESDecContext*     m_Context;
+  HMACContext*       m_HMAC;
+
+  //
+  void VerifyChunk(const FrameChunk& chunk)
+  {
+    const FrameExtent& first = m_Job.m_Extents[chunk.first];
+    const FrameExtent& last = m_Job.m_Extents[chunk.first + chunk.count - 1];
+    ui32_t chunk_length = (ui32_t)( last.end - first.offset );
+    ui32_t largest_frame = 0;
+
+    for ( ui32_t i = chunk.first; i < chunk.first + chunk.count; ++i )
+      largest_frame = Kumu::xmax<ui32_t>(largest_frame, (ui32_t)( m_Job.m_Extents[i].end - m_Job.m_Extents[i].offset ));
+
+    Result_t result = m_ChunkBuf.Capacity(chunk_length);
+    ui32_t read_count = 0;
+
+    if ( KM_SUCCESS(result) )
+      result = m_FrameBuf.Capacity(largest_frame);
+
+    if ( KM_SUCCESS(result) )
+      result = m_File.Seek(first.offset);
+
+    if ( KM_SUCCESS(result) )
+      result = m_File.Read(m_ChunkBuf.Data(), chunk_length, &read_count);
+
+    if ( KM_FAILURE(result) )
+      {
+	for ( ui32_t i = chunk.first; i < chunk.first + chunk.count; ++i )
+	  m_Job.AddError(m_Job.m_Extents[i].frame_num, result.Label());
+
+	return;
+      }
+
+    // a short read leaves the trailing frames to fail in the packet reader
+    m_ChunkReader.SetChunk(m_ChunkBuf.RoData(), read_count, first.offset);
+
+    for ( ui32_t i = chunk.first; i < chunk.first + chunk.count; ++i )
+      {
+	VerifyFrame(m_Job.m_Extents[i]);
+	Kumu::AtomicAdd(&m_Job.m_FramesVerified, 1);
+      }
+  }
+
+  //
+  void VerifyFrame(const FrameExtent& extent)
+  {
+    Kumu::fpos_t last_position = extent.offset;
+    Result_t result = m_ChunkReader.Seek(extent.offset);
+
+    for ( ui32_t i = 0; KM_SUCCESS(result) && i < m_Job.m_PacketsPerFrame; ++i )
+      {
+	ui32_t sequence_num = extent.frame_num * m_Job.m_PacketsPerFrame + i + 1;
+	result = Read_EKLV_Packet(m_ChunkReader, m_Job.m_Dict, m_Job.m_Info, last_position, m_CtFrameBuf,
+				  extent.frame_num, sequence_num, m_FrameBuf, m_Job.m_EssenceUL.Value(),
+				  m_Context, m_HMAC);
+      }
+
+    if ( KM_FAILURE(result) )
+      {
+	m_Job.AddError(extent.frame_num, result.Label());
+      }
+    else if ( m_ChunkReader.TellPosition() > extent.end )
+      {
+	char buf[IntBufferLen];
+	snprintf(buf, IntBufferLen, "Frame overruns the next frame by %d bytes.",
+		 (int)( m_ChunkReader.TellPosition() - extent.end ));
+	m_Job.AddError(extent.frame_num, buf);
+      }
+  }
+
+public:
+  VerifyWorker(VerifyJob& job) : m_Job(job), m_Context(0), m_HMAC(0) {}
+
+  virtual ~VerifyWorker()
+  {
+    delete m_Context;
+    delete m_HMAC;
+  }
+
+  //
+  Result_t Init()
+  {
+    Result_t result = m_File.OpenRead(m_Job.m_Filename);
+
+    if ( KM_SUCCESS(result) && m_Job.m_Options.key_flag && m_Job.m_Info.EncryptedEssence )
+      {
+	m_Context = new AESDecContext;
+	result = m_Context->InitKey(m_Job.m_Options.key_value);
+
+	if ( KM_SUCCESS(result) && m_Job.m_Info.UsesHMAC )
+	  {
+	    m_HMAC = new HMACContext;
+	    result = m_HMAC->InitKey(m_Job.m_Options.key_value, m_Job.m_Info.LabelSetType);
+	  }
+      }
+
+    return result;
+  }
+
+  //
+  virtual void Run()
+  {
+    ui32_t chunk_index;
+
+    while ( m_Job.ClaimChunk(chunk_index) )
+      VerifyChunk(m_Job.m_Chunks[chunk_index]);
+  }
+};
+
+//------------------------------------------------------------------------------------------
+//
+
+// Read the key of the first frame's essence packet. For an encrypted
+// packet this is the SourceKey item of the triplet.
+//
+Result_t
+read_essence_ul(Kumu::IFileReader& File, const Dictionary& Dict, const Kumu::fpos_t& position, UL& EssenceUL)
+{
+  KLReader Reader;
+  Result_t result = File.Seek(position);
+
+  if ( KM_SUCCESS(result) )
+    result = Reader.ReadKLFromFile(File);
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  UL Key(Reader.Key());
+
+  if ( ! Key.MatchIgnoreStream(Dict.ul(MDD_CryptEssence)) )
+    {
+      EssenceUL.Set(Key.Value());
+      return RESULT_OK;
+    }
+
+  // ContextID, PlaintextOffset and SourceKey items, each with a four byte length
+  const ui32_t header_length = ( MXF_BER_LENGTH * 3 ) + UUIDlen + sizeof(ui64_t) + SMPTE_UL_LENGTH;
+  byte_t header_buf[header_length];
+  ui32_t read_count;
+  result = File.Read(header_buf, header_length, &read_count);
+
+  if ( KM_SUCCESS(result) && read_count != header_length )
+    result = RESULT_READFAIL;
+
+  if ( KM_SUCCESS(result) )
+    {
+      byte_t* p = header_buf;
+
+      if ( Kumu::read_test_BER(&p, UUIDlen) )
+	{
+	  p += UUIDlen;
+
+	  if ( Kumu::read_test_BER(&p, sizeof(ui64_t)) )
+	    {
+	      p += sizeof(ui64_t);
+
+	      if ( Kumu::read_test_BER(&p, SMPTE_UL_LENGTH) )
+		{
+		  EssenceUL.Set(p);
+		  return RESULT_OK;
+		}
+	    }
+	}
+
+      result = RESULT_FORMAT;
+    }
+
+  return result;
+}
+
+// Find the end of the last essence packet of the edit unit at the given position.
+//
+Result_t
+read_frame_end(Kumu::IFileReader& File, ui32_t packet_count, Kumu::fpos_t& position)
+{
+  Result_t result = File.Seek(position);
+
+  for ( ui32_t i = 0; KM_SUCCESS(result) && i < packet_count; ++i )
+    {
+      KLReader Reader;
+      result = Reader.ReadKLFromFile(File);
+
+      if ( KM_SUCCESS(result) )
+	{
+	  position += Reader.KLLength() + Reader.Length();
+	  result = File.Seek(position);
+	}
+    }
+
+  return result;
+}
+
+// AS-DCP index positions are relative to the start of the body, AS-02
+// index positions are absolute.
+//
+ui64_t frame_count(h__ASDCPReader& Reader) { return Reader.m_IndexAccess.ContainerDuration(); }
+ui64_t frame_count(AS_02::h__AS02Reader& Reader) { return Reader.m_IndexAccess.GetDuration(); }
+Kumu::fpos_t body_offset(h__ASDCPReader& Reader) { return Reader.m_HeaderPart.BodyOffset; }
+Kumu::fpos_t body_offset(AS_02::h__AS02Reader&) { return 0; }
+
+//
+template <class ReaderType>
+Result_t
+verify_file(CommandOptions& Options, const std::string& filename, const Kumu::IFileReaderFactory& fileReaderFactory,
+	    ui32_t packets_per_frame)
+{
+  ReaderType Reader(&DefaultCompositeDict(), fileReaderFactory);
+  Result_t result = Reader.OpenMXFRead(filename);
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  VerifyJob Job(Options, filename, DefaultCompositeDict(), Reader.m_Info);
+  Job.m_PacketsPerFrame = packets_per_frame;
+  ui64_t duration = frame_count(Reader);
+
+  if ( duration == 0 )
+    {
+      fprintf(stderr, "%s: File contains no indexed frames.\n", filename.c_str());
+      return RESULT_FORMAT;
+    }
+
+  if ( duration > 0xffffffffUL )
+    {
+      fprintf(stderr, "%s: Unsupported container duration.\n", filename.c_str());
+      return RESULT_FORMAT;
+    }
+
+  Job.m_Extents.resize((ui32_t)duration);
+
+  // all the index lookups are done here, the workers never touch the index
+  for ( ui32_t i = 0; KM_SUCCESS(result) && i < Job.m_Extents.size(); ++i )
+    {
+      IndexTableSegment::IndexEntry TmpEntry;
+      result = Reader.m_IndexAccess.Lookup(i, TmpEntry);
+
+      if ( KM_FAILURE(result) )
+	{
+	  fprintf(stderr, "%s: Frame %u not found in index.\n", filename.c_str(), i);
+	}
+      else
+	{
+	  Job.m_Extents[i].offset = body_offset(Reader) + TmpEntry.StreamOffset;
+	  Job.m_Extents[i].frame_num = i;
+	}
+    }
+
+  if ( KM_SUCCESS(result) )
+    result = read_essence_ul(*Reader.m_File, Job.m_Dict, Job.m_Extents.front().offset, Job.m_EssenceUL);
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  std::sort(Job.m_Extents.begin(), Job.m_Extents.end());
+
+  for ( ui32_t i = 1; i < Job.m_Extents.size(); ++i )
+    {
+      Job.m_Extents[i-1].end = Job.m_Extents[i].offset;
+
+      if ( Job.m_Extents[i-1].offset == Job.m_Extents[i].offset )
+	{
+	  char buf[IntBufferLen];
+	  snprintf(buf, IntBufferLen, "Index entry has the same position as frame %u.", Job.m_Extents[i-1].frame_num);
+	  Job.AddError(Job.m_Extents[i].frame_num, buf);
+	}
+    }
+
+  Job.m_Extents.back().end = Job.m_Extents.back().offset;
+  result = read_frame_end(*Reader.m_File, packets_per_frame, Job.m_Extents.back().end);
+
+  if ( KM_FAILURE(result) )
+    {
+      fprintf(stderr, "%s: Cannot read the last frame in file order.\n", filename.c_str());
+      return result;
+    }
+
+  Job.MakeChunks();
+
+  if ( Job.m_Info.EncryptedEssence && ! Options.key_flag )
+    fprintf(stderr, "%s: Essence is encrypted and no key was given, checking structure only.\n", filename.c_str());
+
+  // the calling thread is also a worker
+  ui32_t worker_count = Kumu::xmin<ui32_t>(Options.thread_count, Job.m_Chunks.size());
+  std::vector<VerifyWorker*> workers;
+
+  for ( ui32_t i = 0; KM_SUCCESS(result) && i < worker_count; ++i )
+    {
+      workers.push_back(new VerifyWorker(Job));
+      result = workers.back()->Init();
+    }
+
+  if ( KM_SUCCESS(result) )
+    {
+      if ( Options.verbose_flag )
+	fprintf(stderr, "%s: %u frames in %u reads, %u threads\n", filename.c_str(),
+		(ui32_t)Job.m_Extents.size(), (ui32_t)Job.m_Chunks.size(), worker_count);
+
+      for ( ui32_t i = 1; i < workers.size(); ++i )
+	workers[i]->Start();
+
+      workers.front()->Run();
+
+      for ( ui32_t i = 1; i < workers.size(); ++i )
+	workers[i]->Join();
+    }
+
+  for ( ui32_t i = 0; i < workers.size(); ++i )
+    delete workers[i];
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  Job.m_Errors.sort();
+  std::list<FrameError>::const_iterator ei;
+
+  for ( ei = Job.m_Errors.begin(); ei != Job.m_Errors.end(); ++ei )
+    fprintf(stdout, "%s: Frame %u: %s\n", filename.c_str(), ei->frame_num, ei->message.c_str());
+
+  fprintf(stdout, "%s: %u frames verified, %u errors\n", filename.c_str(),
+	  Kumu::AtomicLoad(&Job.m_FramesVerified), (ui32_t)Job.m_Errors.size());
+
+  return Job.m_Errors.empty() ? RESULT_OK : RESULT_FAIL;
+}
+
+// IAB essence is not encrypted and the reader is not shared between threads,
+// so the frames are read in order by the calling thread.
+//
+Result_t
+verify_iab_file(CommandOptions& Options, const std::string& filename, const Kumu::IFileReaderFactory& fileReaderFactory)
+{
+  AS_02::IAB::MXFReader Reader(fileReaderFactory);
+  Result_t result = Reader.OpenRead(filename);
+  ui32_t duration = 0;
+
+  if ( KM_SUCCESS(result) )
+    result = Reader.GetFrameCount(duration);
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  if ( duration == 0 )
+    {
+      fprintf(stderr, "%s: File contains no indexed frames.\n", filename.c_str());
+      return RESULT_FORMAT;
+    }
+
+  if ( Options.verbose_flag )
+    fprintf(stderr, "%s: %u IA frames, read in order\n", filename.c_str(), duration);
+
+  AS_02::IAB::MXFReader::Frame Frame;
+  ui32_t error_count = 0;
+
+  for ( ui32_t i = 0; i < duration; ++i )
+    {
+      // a failed read leaves the reader open, the next read seeks to its frame
+      result = Reader.ReadFrame(i, Frame);
+
+      if ( KM_FAILURE(result) )
+	{
+	  fprintf(stdout, "%s: Frame %u: %s\n", filename.c_str(), i, result.Label());
+	  ++error_count;
+	}
+    }
+
+  fprintf(stdout, "%s: %u frames verified, %u errors\n", filename.c_str(), duration, error_count);
+  return error_count == 0 ? RESULT_OK : RESULT_FAIL;
+}
+
+//
+Result_t
+verify_file(CommandOptions& Options, const std::string& filename, const Kumu::IFileReaderFactory& fileReaderFactory)
+{
+  EssenceType_t EssenceType;
+  Result_t result = ASDCP::EssenceType(filename, EssenceType, fileReaderFactory);
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  switch ( EssenceType )
+    {
+    case ESS_MPEG2_VES:
+    case ESS_JPEG_2000:
+    case ESS_PCM_24b_48k:
+    case ESS_PCM_24b_96k:
+    case ESS_TIMED_TEXT:
+    case ESS_DCDATA_UNKNOWN:
+    case ESS_DCDATA_DOLBY_ATMOS:
+    case ESS_JPEG_XS:
+      result = verify_file<h__ASDCPReader>(Options, filename, fileReaderFactory, 1);
+      break;
+
+    case ESS_JPEG_2000_S: // left and right eye packets share an index entry
+      result = verify_file<h__ASDCPReader>(Options, filename, fileReaderFactory, 2);
+      break;
+
+    case ESS_AS02_JPEG_2000:
+    case ESS_AS02_TIMED_TEXT:
+    case ESS_AS02_ISXD:
+    case ESS_AS02_ACES:
+    case ESS_AS02_JPEG_XS:
+      result = verify_file<AS_02::h__AS02Reader>(Options, filename, fileReaderFactory, 1);
+      break;
+
+    case ESS_AS02_IAB:
+      result = verify_iab_file(Options, filename, fileReaderFactory);
+      break;
+
+    case ESS_AS02_PCM_24b_48k:
+    case ESS_AS02_PCM_24b_96k:
+      fprintf(stderr, "%s: Clip-wrapped essence cannot be verified frame by frame.\n", filename.c_str());
+      result = RESULT_NOTIMPL;
+      break;
+
+    default:
+      fprintf(stderr, "%s: Unknown file type, not AS-DCP or AS-02 essence.\n", filename.c_str());
+      result = RESULT_FORMAT;
+    }
+
+  return result;
+}
+
+//
+int
+main(int argc, const char** argv)
+{
+  Result_t result = RESULT_OK;
+  CommandOptions Options(argc, argv);
+
+  if ( Options.version_flag )
+    banner();
+
+  if ( Options.help_flag )
+    usage();
+
+  if ( Options.version_flag || Options.help_flag )
+    return 0;
+
+  if ( Options.error_flag )
+    {
+      fprintf(stderr, "There was a problem. Type %s -h for help.\n", PROGRAM_NAME);
+      return 3;
+    }
+
+  Kumu::FileReaderFactory defaultFactory;
+  bool errors_found = false;
+
+  while ( ! Options.filenames.empty() )
+    {
+      result = verify_file(Options, Options.filenames.front(), defaultFactory);
+
+      if ( KM_FAILURE(result) )
+	{
+	  errors_found = true;
+
+	  if ( result != RESULT_FAIL )
+	    fprintf(stderr, "%s: %s\n", Options.filenames.front().c_str(), result.Label());
+	}
+
+      Options.filenames.pop_front();
+    }
+
+  return errors_found ? 1 : 0;
+}
+
+
+//
+// end asdcp-verify.cpp
+//
@@ -88,6 +88,9 @@ public:
   }
 } s_MyInfo;
 
+// per-stage timing, printed when --stats is given
+static ASDCP::StageStats s_StageStats;
+
 
 
 // Increment the iterator, test for an additional non-option command line argument.
@@ -144,6 +147,7 @@ USAGE: %s [-h|-help] [-V]\n\
   fprintf(stream, "\
 Options:\n\
   -h | -help        - Show help\n\
+  --stats           - Print the time spent in each stage of writing essence\n\
   -V                - Show version information\n\
   -3                - Create a stereoscopic image file. Expects two\n\
                       directories of JP2K codestreams (directories must have\n\
@@ -234,6 +238,7 @@ public:
   bool   no_write_flag;  // true if no output files are to be written
   bool   version_flag;   // true if the version display option was selected
   bool   help_flag;      // true if the help display option was selected
+  bool   stats_flag;     // true if per-stage timing is to be printed
   bool   stereo_image_flag; // if true, expect stereoscopic JP2K input (left eye first)
   bool   write_partial_pcm_flag; // if true, write the last frame of PCM input even when it is incomplete
   ui32_t start_frame;    // frame number to begin processing
@@ -312,7 +317,7 @@ public:
     error_flag(true), key_flag(false), key_id_flag(false), asset_id_flag(false),
     encrypt_header_flag(true), write_hmac(true),
     verbose_flag(false), fb_dump_size(0),
-    no_write_flag(false), version_flag(false), help_flag(false), stereo_image_flag(false),
+    no_write_flag(false), version_flag(false), help_flag(false), stats_flag(false), stereo_image_flag(false),
     write_partial_pcm_flag(false), start_frame(0),
     duration(0xffffffff), use_smpte_labels(false), j2c_pedantic(true),
     fb_size(FRAME_BUFFER_SIZE),
@@ -336,6 +341,12 @@ public:
 	    continue;
 	  }
 
+	if ( (strcmp( argv[i], "--stats") == 0) )
+	  {
+	    stats_flag = true;
+	    continue;
+	  }
+
 	if ( argv[i][0] == '-'
 	     && ( isalpha(argv[i][1]) || isdigit(argv[i][1]) )
 	     && argv[i][2] == 0 )
@@ -537,11 +548,14 @@ write_MPEG2_file(CommandOptions& Options)
 {
   AESEncContext*     Context = 0;
   HMACContext*       HMAC = 0;
-  MPEG2::FrameBuffer FrameBuffer(Options.fb_size);
+  MPEG2::FrameBuffer FrameBuffer;
   MPEG2::Parser      Parser;
   MPEG2::MXFWriter   Writer;
   MPEG2::VideoDescriptor VDesc;
 
+  FrameBuffer.Allocator(&PooledFrameBufferAllocator());
+  FrameBuffer.Capacity(Options.fb_size);
+
   // set up essence parser
   Result_t result = Parser.OpenRead(Options.filenames.front());
 
@@ -608,6 +622,9 @@ write_MPEG2_file(CommandOptions& Options)
 
       if ( ASDCP_SUCCESS(result) )
 	result = Writer.OpenWrite(Options.out_file, Info, VDesc);
+
+      if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+	result = Writer.SetStageStats(&s_StageStats);
     }
 
   if ( ASDCP_SUCCESS(result) )
@@ -695,11 +712,14 @@ write_JP2K_S_file(CommandOptions& Options)
   AESEncContext*          Context = 0;
   HMACContext*            HMAC = 0;
   JP2K::MXFSWriter        Writer;
-  JP2K::FrameBuffer       FrameBuffer(Options.fb_size);
+  JP2K::FrameBuffer       FrameBuffer;
   JP2K::PictureDescriptor PDesc;
   JP2K::SequenceParser    ParserLeft, ParserRight;
   byte_t                  IV_buf[CBC_BLOCK_SIZE];
 
+  FrameBuffer.Allocator(&PooledFrameBufferAllocator());
+  FrameBuffer.Capacity(Options.fb_size);
+
   if ( Options.filenames.size() != 2 )
     {
       fprintf(stderr, "Two inputs are required for stereoscopic option.\n");
@@ -781,6 +801,9 @@ write_JP2K_S_file(CommandOptions& Options)
       if ( ASDCP_SUCCESS(result) )
 	result = Writer.OpenWrite(Options.out_file, Info, PDesc);
 
+      if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+	result = Writer.SetStageStats(&s_StageStats);
+
       if ( ASDCP_SUCCESS(result) && Options.picture_coding.HasValue() )
 	{
 	  MXF::RGBAEssenceDescriptor *descriptor = 0;
@@ -847,11 +870,14 @@ write_JP2K_file(CommandOptions& Options)
   AESEncContext*          Context = 0;
   HMACContext*            HMAC = 0;
   JP2K::MXFWriter         Writer;
-  JP2K::FrameBuffer       FrameBuffer(Options.fb_size);
+  JP2K::FrameBuffer       FrameBuffer;
   JP2K::PictureDescriptor PDesc;
   JP2K::SequenceParser    Parser;
   byte_t                  IV_buf[CBC_BLOCK_SIZE];
 
+  FrameBuffer.Allocator(&PooledFrameBufferAllocator());
+  FrameBuffer.Capacity(Options.fb_size);
+
   // set up essence parser
   Result_t result = Parser.OpenRead(Options.filenames.front(), Options.j2c_pedantic);
 
@@ -922,6 +948,9 @@ write_JP2K_file(CommandOptions& Options)
       if ( ASDCP_SUCCESS(result) )
 	result = Writer.OpenWrite(Options.out_file, Info, PDesc);
 
+      if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+	result = Writer.SetStageStats(&s_StageStats);
+
       if ( ASDCP_SUCCESS(result) && Options.picture_coding.HasValue() )
 	{
 	  MXF::RGBAEssenceDescriptor *descriptor = 0;
@@ -1000,6 +1029,7 @@ write_PCM_file(CommandOptions& Options)
       Parser.FillAudioDescriptor(ADesc);
 
       ADesc.EditRate = PictureRate;
+      FrameBuffer.Allocator(&PooledFrameBufferAllocator());
       FrameBuffer.Capacity(PCM::CalcFrameBufferSize(ADesc));
       ADesc.ChannelFormat = Options.channel_fmt;
 
@@ -1068,6 +1098,9 @@ write_PCM_file(CommandOptions& Options)
       if ( ASDCP_SUCCESS(result) )
 	result = Writer.OpenWrite(Options.out_file, Info, ADesc);
 
+      if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+	result = Writer.SetStageStats(&s_StageStats);
+
       if ( ASDCP_SUCCESS(result)
 	   && ( Options.channel_assignment.HasValue()
 		|| ! Options.mca_config.empty() ) )
@@ -1208,6 +1241,7 @@ write_PCM_with_ATMOS_sync_file(CommandOptions& Options)
     Mixer.FillAudioDescriptor(ADesc);
 
     ADesc.EditRate = PictureRate;
+    FrameBuffer.Allocator(&PooledFrameBufferAllocator());
     FrameBuffer.Capacity(PCM::CalcFrameBufferSize(ADesc));
     ADesc.ChannelFormat = PCM::CF_CFG_4;
 
@@ -1261,6 +1295,9 @@ write_PCM_with_ATMOS_sync_file(CommandOptions& Options)
 
     if ( ASDCP_SUCCESS(result) )
       result = Writer.OpenWrite(Options.out_file, Info, ADesc);
+
+    if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+      result = Writer.SetStageStats(&s_StageStats);
   }
 
   if ( ASDCP_SUCCESS(result) )
@@ -1338,6 +1375,7 @@ write_timed_text_file(CommandOptions& Options)
   if ( ASDCP_SUCCESS(result) )
     {
       Parser.FillTimedTextDescriptor(TDesc);
+      FrameBuffer.Allocator(&PooledFrameBufferAllocator());
       FrameBuffer.Capacity(Options.fb_size);
 
       if ( Options.verbose_flag )
@@ -1393,6 +1431,9 @@ write_timed_text_file(CommandOptions& Options)
 
       if ( ASDCP_SUCCESS(result) )
 	result = Writer.OpenWrite(Options.out_file, Info, TDesc);
+
+      if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+	result = Writer.SetStageStats(&s_StageStats);
     }
 
   if ( ASDCP_FAILURE(result) )
@@ -1447,11 +1488,14 @@ write_dolby_atmos_file(CommandOptions& Options)
   AESEncContext*          Context = 0;
   HMACContext*            HMAC = 0;
   ATMOS::MXFWriter         Writer;
-  DCData::FrameBuffer       FrameBuffer(Options.fb_size);
+  DCData::FrameBuffer       FrameBuffer;
   ATMOS::AtmosDescriptor ADesc;
   DCData::SequenceParser    Parser;
   byte_t                  IV_buf[CBC_BLOCK_SIZE];
 
+  FrameBuffer.Allocator(&PooledFrameBufferAllocator());
+  FrameBuffer.Capacity(Options.fb_size);
+
   // set up essence parser
   Result_t result = Parser.OpenRead(Options.filenames.front());
 
@@ -1519,6 +1563,9 @@ write_dolby_atmos_file(CommandOptions& Options)
 
     if ( ASDCP_SUCCESS(result) )
       result = Writer.OpenWrite(Options.out_file, Info, ADesc);
+
+    if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+      result = Writer.SetStageStats(&s_StageStats);
   }
 
   if ( ASDCP_SUCCESS(result) )
@@ -1571,11 +1618,14 @@ write_aux_data_file(CommandOptions& Options)
   AESEncContext*          Context = 0;
   HMACContext*            HMAC = 0;
   DCData::MXFWriter       Writer;
-  DCData::FrameBuffer     FrameBuffer(Options.fb_size);
+  DCData::FrameBuffer     FrameBuffer;
   DCData::DCDataDescriptor DDesc;
   DCData::SequenceParser  Parser;
   byte_t                  IV_buf[CBC_BLOCK_SIZE];
 
+  FrameBuffer.Allocator(&PooledFrameBufferAllocator());
+  FrameBuffer.Capacity(Options.fb_size);
+
   // set up essence parser
   Result_t result = Parser.OpenRead(Options.filenames.front());
 
@@ -1638,6 +1688,9 @@ write_aux_data_file(CommandOptions& Options)
 
     if ( ASDCP_SUCCESS(result) )
       result = Writer.OpenWrite(Options.out_file, Info, DDesc);
+
+    if ( ASDCP_SUCCESS(result) && Options.stats_flag )
+      result = Writer.SetStageStats(&s_StageStats);
   }
 
   if ( ASDCP_SUCCESS(result) )
@@ -1788,6 +1841,9 @@ main(int argc, const char** argv)
       return 1;
     }
 
+  if ( Options.stats_flag )
+    s_StageStats.Dump();
+
   return 0;
 }
 
@@ -64,26 +64,251 @@ AS_02::default_md_object_init()
 
     
 AS_02::MXF::AS02IndexReader::AS02IndexReader(const ASDCP::Dictionary* d) :
-  ASDCP::MXF::Partition(d), m_Duration(0), m_BytesPerEditUnit(0) {
+  ASDCP::MXF::Partition(d), m_Duration(0), m_BytesPerEditUnit(0), m_CompactIndexOpen(true) {
   assert(d);
 }
 
 AS_02::MXF::AS02IndexReader::~AS02IndexReader() {}
 
+//------------------------------------------------------------------------------------------
+// partition discovery
+
+static const ui32_t PartitionReadAhead = 16 * Kumu::Kilobyte; // a partition pack and, usually, its index segments
+static const ui32_t PartitionFetchThreads = 8;                // maximum number of helper readers
+static const ui32_t PartitionsPerFetchThread = 32;            // smallest share of the work worth a helper reader
+
+// makes the first need bytes of the packet at the reader's starting offset
+// available in buf, the first have bytes of which have already been read
+static Result_t
+read_partition_bytes(const Kumu::IFileReader& reader, Kumu::ByteString& buf, ui32_t& have, ui32_t need)
+{
+  if ( have >= need )
+    return RESULT_OK;
+
+  buf.Length(have);
+  Result_t result = buf.Capacity(need);
+  ui32_t read_count = 0;
+
+  if ( KM_SUCCESS(result) )
+    result = reader.Read(buf.Data() + have, need - have, &read_count);
+
+  if ( KM_SUCCESS(result) )
+    have += read_count;
+
+  return result;
+}
+
+// reads the partition pack at offset and the index segments that follow it,
+// using a single read when the index is small
+static Result_t
+read_partition(const Kumu::IFileReader& reader, Kumu::fpos_t offset, ASDCP::MXF::Partition& part,
+	       Kumu::ByteString& index_data, Kumu::ByteString& buf)
+{
+  ui32_t have = 0;
+  Result_t result = reader.Seek(offset);
+
+  if ( KM_SUCCESS(result) )
+    result = read_partition_bytes(reader, buf, have, PartitionReadAhead);
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  if ( have < ( SMPTE_UL_LENGTH + 1 ) )
+    {
+      DefaultLogSink().Error("Short read of Key and Length got %u\n", have);
+      return RESULT_READFAIL;
+    }
+
+  ASDCP::KLVPacket pack;
+  result = pack.InitFromBuffer(buf.RoData(), have);
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  if ( pack.PacketLength() > 0xFFFFFFFFL )
+    return AS_02::RESULT_AS02_FORMAT;
+
+  ui32_t pack_length = (ui32_t)pack.PacketLength();
+  result = read_partition_bytes(reader, buf, have, pack_length);
+
+  if ( KM_SUCCESS(result) && have < pack_length )
+    {
+      DefaultLogSink().Error("Short read of partition pack: got %u, expecting %u\n", have, pack_length);
+      return RESULT_READFAIL;
+    }
+
+  if ( KM_SUCCESS(result) )
+    result = part.InitFromBuffer(buf.RoData() + pack.KLLength(), (ui32_t)pack.ValueLength());
+
+  if ( KM_FAILURE(result) || part.IndexByteCount == 0 )
+    return result;
+
+  if ( part.IndexByteCount > (ui64_t)( 0xFFFFFFFFUL - pack_length ) )
+    return AS_02::RESULT_AS02_FORMAT;
+
+  ui32_t index_length = (ui32_t)part.IndexByteCount;
+  result = read_partition_bytes(reader, buf, have, pack_length + index_length);
+
+  if ( KM_SUCCESS(result) && have < pack_length + index_length )
+    {
+      DefaultLogSink().Error("Short read of index partition: got %u, expecting %u\n",
+			     have - pack_length, index_length);
+      return AS_02::RESULT_AS02_FORMAT;
+    }
+
+  if ( KM_SUCCESS(result) )
+    result = index_data.Capacity(index_length);
+
+  if ( KM_SUCCESS(result) )
+    result = index_data.Set(buf.RoData() + pack_length, index_length);
+
+  return result;
+}
+
+// The partition packs named by a RIP and the index segments that follow them.
+// Any number of threads may call FetchAll(), each with its own reader; every
+// partition is read exactly once.
+class AS_02::MXF::AS02IndexReader::h__PartitionSet
+{
+  ASDCP_NO_COPY_CONSTRUCT(h__PartitionSet);
+  h__PartitionSet();
+
+public:
+  class Slot
+  {
+    ASDCP_NO_COPY_CONSTRUCT(Slot);
+    Slot();
+
+  public:
+    ASDCP::MXF::Partition Part;
+    Kumu::ByteString      IndexData; // the IndexByteCount bytes that follow the pack
+    Result_t              Result;
+
+    Slot(const ASDCP::Dictionary* d) : Part(d), Result(RESULT_STATE) {}
+  };
+
+  // reads partitions with its own reader until none remain
+  class Worker : public Kumu::Thread
+  {
+    ASDCP_NO_COPY_CONSTRUCT(Worker);
+    Worker();
+
+    h__PartitionSet& m_Set;
+    const Kumu::IFileReaderFactory& m_Factory;
+    const std::string& m_Filename;
+
+  public:
+    Worker(h__PartitionSet& set, const Kumu::IFileReaderFactory& factory, const std::string& filename) :
+      m_Set(set), m_Factory(factory), m_Filename(filename) {}
+
+    void Run()
+    {
+      Kumu::mem_ptr<Kumu::IFileReader> reader(m_Factory.CreateFileReader());
+
+      // a worker that cannot open the file claims no partitions
+      if ( ! reader.empty() && KM_SUCCESS(reader->OpenRead(m_Filename)) )
+	m_Set.FetchAll(*reader);
+    }
+  };
+
+  std::vector<Kumu::fpos_t> m_Offsets; // in RIP order
+  std::vector<Slot*>        m_Slots;
+  volatile ui32_t           m_NextSlot;
+
+  h__PartitionSet(const ASDCP::Dictionary* d, const ASDCP::MXF::RIP& rip) : m_NextSlot(0)
+  {
+    RIP::const_pair_iterator i;
+    for ( i = rip.PairArray.begin(); i != rip.PairArray.end(); ++i )
+      {
+	m_Offsets.push_back(i->ByteOffset);
+	m_Slots.push_back(new Slot(d));
+      }
+  }
+
+  ~h__PartitionSet()
+  {
+    std::vector<Slot*>::iterator i;
+    for ( i = m_Slots.begin(); i != m_Slots.end(); ++i )
+      delete *i;
+  }
+
+  //
+  void FetchAll(const Kumu::IFileReader& reader)
+  {
+    Kumu::ByteString buf;
+    ui32_t n;
+
+    while ( ( n = Kumu::AtomicAdd(&m_NextSlot, 1) - 1 ) < m_Slots.size() )
+      {
+	Slot& slot = *m_Slots[n];
+	slot.Result = read_partition(reader, m_Offsets[n], slot.Part, slot.IndexData, buf);
+      }
+  }
+};
+
 //    
 Result_t
 AS_02::MXF::AS02IndexReader::InitFromFile(const Kumu::IFileReader& reader, const ASDCP::MXF::RIP& rip, const bool has_header_essence)
 {
-  typedef std::list<Kumu::mem_ptr<ASDCP::MXF::Partition> > body_part_array_t;
+  h__PartitionSet partitions(m_Dict, rip);
+  partitions.FetchAll(reader);
+  return InitFromPartitionSet(partitions, rip, has_header_essence);
+}
+
+//
+Result_t
+AS_02::MXF::AS02IndexReader::InitFromFile(const Kumu::IFileReader& reader, const Kumu::IFileReaderFactory& factory,
+					  const std::string& filename, const ASDCP::MXF::RIP& rip,
+					  const bool has_header_essence)
+{
+  h__PartitionSet partitions(m_Dict, rip);
+
+  // the calling thread reads with the given reader alongside the helpers, and
+  // finishes the job alone if no helper can open the file
+  ui32_t helper_count = Kumu::xmin(PartitionFetchThreads, (ui32_t)partitions.m_Slots.size() / PartitionsPerFetchThread);
+  std::vector<h__PartitionSet::Worker*> helpers;
+
+  for ( ui32_t i = 0; i < helper_count; ++i )
+    {
+      h__PartitionSet::Worker* helper = new h__PartitionSet::Worker(partitions, factory, filename);
+
+      if ( ! helper->Start() )
+	{
+	  delete helper;
+	  break;
+	}
+
+      helpers.push_back(helper);
+    }
+
+  partitions.FetchAll(reader);
+
+  std::vector<h__PartitionSet::Worker*>::iterator hi;
+  for ( hi = helpers.begin(); hi != helpers.end(); ++hi )
+    {
+      (*hi)->Join();
+      delete *hi;
+    }
+
+  return InitFromPartitionSet(partitions, rip, has_header_essence);
+}
+
+// assembles the index from the partitions, in RIP order
+Result_t
+AS_02::MXF::AS02IndexReader::InitFromPartitionSet(h__PartitionSet& partitions, const ASDCP::MXF::RIP& rip,
+						  const bool has_header_essence)
+{
+  typedef std::list<ASDCP::MXF::Partition*> body_part_array_t;
   body_part_array_t body_part_array;
   body_part_array_t::const_iterator body_part_iter;
 
   RIP::const_pair_iterator i;
-  Result_t result = m_IndexSegmentData.Capacity(128*Kumu::Kilobyte); // will be grown if needed
+  Result_t result = RESULT_OK;
   ui32_t first_body_sid = 0;
+  ui32_t n = 0;
 
   // create a list of body parts and index parts
-  for ( i = rip.PairArray.begin(); KM_SUCCESS(result) && i != rip.PairArray.end(); ++i )
+  for ( i = rip.PairArray.begin(); KM_SUCCESS(result) && i != rip.PairArray.end(); ++i, ++n )
     {
       if ( i->BodySID == 0 )
 	continue;
@@ -98,26 +323,18 @@ AS_02::MXF::AS02IndexReader::InitFromFile(const Kumu::IFileReader& reader, const
 	  continue;
 	}
 
-      reader.Seek(i->ByteOffset);
-      ASDCP::MXF::Partition *this_partition = new ASDCP::MXF::Partition(m_Dict);
-      assert(this_partition);
+      h__PartitionSet::Slot& slot = *partitions.m_Slots[n];
 
-      result = this_partition->InitFromFile(reader);
+      if ( KM_FAILURE(slot.Result) )
+	return slot.Result;
 
-      if ( KM_FAILURE(result) )
-	{
-	  delete this_partition;
-	  return result;
-	}
-
-      if ( this_partition->BodySID != i->BodySID )
+      if ( slot.Part.BodySID != i->BodySID )
 	{
 	  DefaultLogSink().Error("Partition BodySID %d does not match RIP BodySID %d.\n",
-				 this_partition->BodySID, i->BodySID);
+				 slot.Part.BodySID, i->BodySID);
 	}
 
-      body_part_array.push_back(0);
-      body_part_array.back().set(this_partition);
+      body_part_array.push_back(&slot.Part);
     }
 
   if ( body_part_array.empty() )
@@ -126,16 +343,26 @@ AS_02::MXF::AS02IndexReader::InitFromFile(const Kumu::IFileReader& reader, const
       return RESULT_AS02_FORMAT;
     }
 
+  // the parsed segments point into m_IndexSegmentData, so room is made for all
+  // of the index up front and each partition's bytes are copied in and parsed there
+  ui64_t index_bytes = 0;
+
+  for ( n = 0; n < partitions.m_Slots.size(); ++n )
+    index_bytes += partitions.m_Slots[n]->IndexData.Length();
+
+  if ( index_bytes <= 0xFFFFFFFFUL )
+    result = ReserveIndexData((ui32_t)index_bytes);
+
   body_part_iter = body_part_array.begin();
 
-  for ( i = rip.PairArray.begin(); KM_SUCCESS(result) && i != rip.PairArray.end(); ++i )
+  for ( n = 0; KM_SUCCESS(result) && n < partitions.m_Slots.size(); ++n )
     {
-      reader.Seek(i->ByteOffset);
-      ASDCP::MXF::Partition plain_part(m_Dict);
-      result = plain_part.InitFromFile(reader);
+      h__PartitionSet::Slot& slot = *partitions.m_Slots[n];
+
+      if ( KM_FAILURE(slot.Result) )
+	return slot.Result;
 
-      if ( KM_FAILURE(result) )
-	return result;
+      ASDCP::MXF::Partition& plain_part = slot.Part;
 
       if ( plain_part.IndexByteCount > 0 )
 	{
@@ -150,67 +377,39 @@ AS_02::MXF::AS02IndexReader::InitFromFile(const Kumu::IFileReader& reader, const
 	      DefaultLogSink().Warn("File footer partition contains index data.\n");
 	    }
 
-	  // slurp up the remainder of the partition
-	  ui32_t read_count = 0;
-
-	  assert (plain_part.IndexByteCount <= 0xFFFFFFFFL);
-	  ui32_t bytes_this_partition = (ui32_t)plain_part.IndexByteCount;
+	  ui64_t current_body_offset = 0;
+	  ui64_t current_ec_offset = 0;
+	  assert(*body_part_iter != 0);
+	  ASDCP::MXF::Partition *tmp_partition = *body_part_iter;
 
-	  result = m_IndexSegmentData.Capacity(m_IndexSegmentData.Length() + bytes_this_partition);
-
-	  if ( KM_SUCCESS(result) )
-	    result = reader.Read(m_IndexSegmentData.Data() + m_IndexSegmentData.Length(),
-				 bytes_this_partition, &read_count);
-
-	  if ( KM_SUCCESS(result) && read_count != bytes_this_partition )
+	  if ( has_header_essence && tmp_partition->ThisPartition == 0 )
 	    {
-	      DefaultLogSink().Error("Short read of index partition: got %u, expecting %u\n",
-				     read_count, bytes_this_partition);
-	      return RESULT_AS02_FORMAT;
+	      current_body_offset = 0;
+	      current_ec_offset = tmp_partition->HeaderByteCount + tmp_partition->ArchiveSize();
 	    }
-
-	  if ( KM_SUCCESS(result) )
+	  else
 	    {
-	      ui64_t current_body_offset = 0;
-	      ui64_t current_ec_offset = 0;
-	      assert(body_part_iter != body_part_array.end());
-
-	      assert(!body_part_iter->empty());
-	      ASDCP::MXF::Partition *tmp_partition = body_part_iter->get();
-
-	      if ( has_header_essence && tmp_partition->ThisPartition == 0 )
-		{
-		  current_body_offset = 0;
-		  current_ec_offset = tmp_partition->HeaderByteCount + tmp_partition->ArchiveSize();
-		}
-	      else
-		{
-		  current_body_offset = tmp_partition->BodyOffset;
-		  current_ec_offset += tmp_partition->ThisPartition + tmp_partition->ArchiveSize();
-		}
-
-	      result = InitFromBuffer(m_IndexSegmentData.RoData() + m_IndexSegmentData.Length(), bytes_this_partition, current_body_offset, current_ec_offset);
-	      m_IndexSegmentData.Length(m_IndexSegmentData.Length() + bytes_this_partition);
-	      ++body_part_iter;
+	      current_body_offset = tmp_partition->BodyOffset;
+	      current_ec_offset += tmp_partition->ThisPartition + tmp_partition->ArchiveSize();
 	    }
-	}
-    }
 
-  if ( KM_SUCCESS(result) )
-    {
-      std::list<InterchangeObject*>::const_iterator ii;
-  
-      for ( ii = m_PacketList->m_List.begin(); ii != m_PacketList->m_List.end(); ++ii )
-	{
-	  IndexTableSegment *segment = dynamic_cast<IndexTableSegment*>(*ii);
+	  ui32_t bytes_this_partition = slot.IndexData.Length();
+	  result = ReserveIndexData(bytes_this_partition);
 
-	  if ( segment != 0 )
+	  if ( KM_SUCCESS(result) )
 	    {
-	      m_Duration += segment->IndexDuration;
+	      byte_t* index_p = m_IndexSegmentData.Data() + m_IndexSegmentData.Length();
+	      memcpy(index_p, slot.IndexData.RoData(), bytes_this_partition);
+	      m_IndexSegmentData.Length(m_IndexSegmentData.Length() + bytes_this_partition);
+	      result = InitFromBuffer(index_p, bytes_this_partition, current_body_offset, current_ec_offset);
 	    }
+
+	  ++body_part_iter;
 	}
     }
 
+  m_CompactIndex.Trim();
+
 #if 0
   char identbuf[IdentBufferLen];
   std::list<InterchangeObject*>::iterator j;
@@ -248,6 +447,57 @@ AS_02::MXF::AS02IndexReader::InitFromFile(const Kumu::IFileReader& reader, const
   return result;
 }
 
+// slurp up the index segments of one index partition, the reader must be
+// positioned at the first segment
+Result_t
+AS_02::MXF::AS02IndexReader::AppendFromFile(const Kumu::IFileReader& reader, const ui64_t& index_byte_count,
+					    const ui64_t& body_offset, const ui64_t& essence_container_offset)
+{
+  ui32_t read_count = 0;
+
+  assert (index_byte_count <= 0xFFFFFFFFL);
+  ui32_t bytes_this_partition = (ui32_t)index_byte_count;
+
+  Result_t result = ReserveIndexData(bytes_this_partition);
+  byte_t* index_p = m_IndexSegmentData.Data() + m_IndexSegmentData.Length();
+
+  if ( KM_SUCCESS(result) )
+    result = reader.Read(index_p, bytes_this_partition, &read_count);
+
+  if ( KM_SUCCESS(result) && read_count != bytes_this_partition )
+    {
+      DefaultLogSink().Error("Short read of index partition: got %u, expecting %u\n",
+			     read_count, bytes_this_partition);
+      return RESULT_AS02_FORMAT;
+    }
+
+  if ( KM_SUCCESS(result) )
+    {
+      m_IndexSegmentData.Length(m_IndexSegmentData.Length() + bytes_this_partition);
+      result = InitFromBuffer(index_p, bytes_this_partition, body_offset, essence_container_offset);
+    }
+
+  return result;
+}
+
+// makes room for bytes more index data at the end of m_IndexSegmentData. The
+// parsed segments point into the buffer, so a full buffer is set aside in
+// m_RetiredIndexData rather than grown in place.
+Result_t
+AS_02::MXF::AS02IndexReader::ReserveIndexData(ui32_t bytes)
+{
+  if ( m_IndexSegmentData.Capacity() - m_IndexSegmentData.Length() >= bytes )
+    return RESULT_OK;
+
+  if ( m_IndexSegmentData.Length() > 0 )
+    {
+      m_RetiredIndexData.push_back(Kumu::ByteString());
+      m_RetiredIndexData.back().Swap(m_IndexSegmentData);
+    }
+
+  return m_IndexSegmentData.Capacity(Kumu::xmax(bytes, (ui32_t)(128*Kumu::Kilobyte)));
+}
+
 //
 ASDCP::Result_t
 AS_02::MXF::AS02IndexReader::InitFromBuffer(const byte_t* p, ui32_t l, const ui64_t& body_offset, const ui64_t& essence_container_offset)
@@ -274,6 +524,8 @@ AS_02::MXF::AS02IndexReader::InitFromBuffer(const byte_t* p, ui32_t l, const ui6
 	    {
 	      segment->RtFileOffset = essence_container_offset;
 	      segment->RtEntryOffset = body_offset;
+	      m_Duration += segment->IndexDuration;
+	      CompactSegment(*segment);
 	      m_PacketList->AddPacket(object); // takes ownership
 	    }
 	  else
@@ -296,6 +548,33 @@ AS_02::MXF::AS02IndexReader::InitFromBuffer(const byte_t* p, ui32_t l, const ui6
   return result;
 }
 
+// moves the entries of a VBR segment that continues the compact index into it
+void
+AS_02::MXF::AS02IndexReader::CompactSegment(IndexTableSegment& segment)
+{
+  if ( ! m_CompactIndexOpen )
+    return;
+
+  if ( segment.EditUnitByteCount > 0
+       || segment.IndexStartPosition != m_CompactIndex.Size()
+       || segment.IndexEntryArray.size() != segment.IndexDuration )
+    {
+      m_CompactIndexOpen = false;
+      return;
+    }
+
+  std::vector<IndexTableSegment::IndexEntry>::const_iterator i;
+  for ( i = segment.IndexEntryArray.begin(); i != segment.IndexEntryArray.end(); ++i )
+    {
+      IndexTableSegment::IndexEntry tmp_entry = *i;
+      tmp_entry.StreamOffset = tmp_entry.StreamOffset - segment.RtEntryOffset + segment.RtFileOffset;
+      m_CompactIndex.Append(tmp_entry);
+    }
+
+  ASDCP::MXF::Array<IndexTableSegment::IndexEntry> empty_array;
+  segment.IndexEntryArray.Swap(empty_array);
+}
+
 //
 void
 AS_02::MXF::AS02IndexReader::Dump(FILE* stream)
@@ -303,9 +582,39 @@ AS_02::MXF::AS02IndexReader::Dump(FILE* stream)
   if ( stream == 0 )
     stream = stderr;
 
+  if ( m_CompactIndex.Size() > 0 )
+    fprintf(stream, "  Compact index: %u entries in %s bytes\n",
+	    m_CompactIndex.Size(), Kumu::ui64Printer(m_CompactIndex.MemorySize()).c_str());
+
   std::list<InterchangeObject*>::iterator i = m_PacketList->m_List.begin();
   for ( ; i != m_PacketList->m_List.end(); ++i )
-    (*i)->Dump(stream);
+    {
+      IndexTableSegment *segment = dynamic_cast<IndexTableSegment*>(*i);
+
+      if ( segment == 0 || ! segment->IndexEntryArray.empty() || segment->EditUnitByteCount > 0
+	   || segment->IndexDuration == 0
+	   || segment->IndexStartPosition + segment->IndexDuration > m_CompactIndex.Size() )
+	{
+	  (*i)->Dump(stream);
+	  continue;
+	}
+
+      // the entries of this segment were moved to the compact index, lend
+      // them back for the dump so that it shows what the file holds
+      ASDCP::MXF::Array<IndexTableSegment::IndexEntry> tmp_array;
+      IndexTableSegment::IndexEntry tmp_entry;
+
+      for ( ui32_t j = 0; j < segment->IndexDuration; ++j )
+	{
+	  m_CompactIndex.Lookup((ui32_t)segment->IndexStartPosition + j, tmp_entry);
+	  tmp_entry.StreamOffset = tmp_entry.StreamOffset - segment->RtFileOffset + segment->RtEntryOffset;
+	  tmp_array.push_back(tmp_entry);
+	}
+
+      segment->IndexEntryArray.Swap(tmp_array);
+      segment->Dump(stream);
+      segment->IndexEntryArray.Swap(tmp_array);
+    }
 }
 
 //
@@ -346,6 +655,9 @@ AS_02::MXF::AS02IndexReader::GetDuration() const
 Result_t
 AS_02::MXF::AS02IndexReader::Lookup(ui32_t frame_num, ASDCP::MXF::IndexTableSegment::IndexEntry& Entry) const
 {
+  if ( frame_num < m_CompactIndex.Size() )
+    return m_CompactIndex.Lookup(frame_num, Entry);
+
   std::list<InterchangeObject*>::iterator i;
   for ( i = m_PacketList->m_List.begin(); i != m_PacketList->m_List.end(); ++i )
     {
@@ -395,7 +707,11 @@ AS_02::MXF::AS02IndexReader::Lookup(ui32_t frame_num, ASDCP::MXF::IndexTableSegm
 //
 
 
-AS_02::h__AS02Reader::h__AS02Reader(const ASDCP::Dictionary *d, const Kumu::IFileReaderFactory& fileReaderFactory) : ASDCP::MXF::TrackFileReader<ASDCP::MXF::OP1aHeader, AS_02::MXF::AS02IndexReader>(d, fileReaderFactory) {}
+AS_02::h__AS02Reader::h__AS02Reader(const ASDCP::Dictionary *d, const Kumu::IFileReaderFactory& fileReaderFactory) :
+  ASDCP::MXF::TrackFileReader<ASDCP::MXF::OP1aHeader, AS_02::MXF::AS02IndexReader>(d, fileReaderFactory),
+  m_FileReaderFactory(fileReaderFactory), m_Growing(false), m_GrowingComplete(false), m_ScanPosition(0), m_ScanBodySID(0), m_ScanHasBody(false),
+  m_ScanBodyOffset(0), m_ScanEssenceOffset(0) {}
+
 AS_02::h__AS02Reader::~h__AS02Reader() {}
 
 
@@ -404,6 +720,7 @@ Result_t
 AS_02::h__AS02Reader::OpenMXFRead(const std::string& filename)
 {
   bool has_header_essence = false;
+  m_Growing = false;
   Result_t result = ASDCP::MXF::TrackFileReader<OP1aHeader, AS_02::MXF::AS02IndexReader>::OpenMXFRead(filename);
 
   if ( KM_SUCCESS(result) )
@@ -477,12 +794,147 @@ AS_02::h__AS02Reader::OpenMXFRead(const std::string& filename)
   if ( KM_SUCCESS(result) )
     {
       m_IndexAccess.m_Lookup = &m_HeaderPart.m_Primer;
-      result = m_IndexAccess.InitFromFile(*m_File, m_RIP, has_header_essence);
+      result = m_IndexAccess.InitFromFile(*m_File, m_FileReaderFactory, filename, m_RIP, has_header_essence);
     }
 
   return result;
 }
 
+// Opens a file that has no footer or RIP yet. The partitions are found by walking
+// the KLV packets that follow the header, see Refresh().
+Result_t
+AS_02::h__AS02Reader::OpenMXFReadGrowing(const std::string& filename)
+{
+  m_LastPosition = 0;
+  m_Growing = false;
+  Result_t result = m_File->OpenRead(filename);
+
+  if ( KM_SUCCESS(result) )
+    result = m_HeaderPart.InitFromFile(*m_File);
+
+  if ( KM_FAILURE(result) )
+    {
+      DefaultLogSink().Error("h__AS02Reader::OpenMXFReadGrowing, header init failed\n");
+      return result;
+    }
+
+  result = ASDCP::MXF::TrackFileReader<OP1aHeader, AS_02::MXF::AS02IndexReader>::InitInfo();
+
+  if ( KM_SUCCESS(result) )
+    {
+      m_Info.LabelSetType = LS_MXF_SMPTE;
+      m_IndexAccess.m_Lookup = &m_HeaderPart.m_Primer;
+      m_Growing = true;
+      m_GrowingComplete = false;
+      m_ScanPosition = m_HeaderPart.ArchiveSize() + m_HeaderPart.HeaderByteCount + m_HeaderPart.IndexByteCount;
+      m_ScanBodySID = 0;
+      m_ScanHasBody = false;
+
+      ui32_t frame_count;
+      bool is_complete;
+      result = Refresh(frame_count, is_complete);
+    }
+
+  return result;
+}
+
+// Walks the KLV packets written since the last call. A body partition pack supplies
+// the offsets of the essence that follows it, and the index partition written after
+// that essence is added to the index. The walk stops at the first packet that is not
+// yet complete on disk and resumes there on the next call.
+Result_t
+AS_02::h__AS02Reader::Refresh(ui32_t& frame_count, bool& is_complete)
+{
+  Result_t result = RESULT_OK;
+
+  if ( m_Growing && ! m_GrowingComplete )
+    {
+      Kumu::fpos_t file_size = m_File->Size();
+
+      while ( KM_SUCCESS(result) && ! m_GrowingComplete
+	      && m_ScanPosition + SMPTE_UL_LENGTH + MXF_BER_LENGTH <= file_size )
+	{
+	  KLReader Reader;
+	  result = m_File->Seek(m_ScanPosition);
+
+	  if ( KM_SUCCESS(result) )
+	    result = Reader.ReadKLFromFile(*m_File);
+
+	  if ( result == RESULT_READFAIL || result == Kumu::RESULT_ENDOFFILE )
+	    {
+	      result = RESULT_OK; // the writer has not finished the length field
+	      break;
+	    }
+
+	  if ( KM_FAILURE(result) )
+	    break;
+
+	  Kumu::fpos_t packet_end = m_ScanPosition + Reader.KLLength() + Reader.Length();
+
+	  if ( packet_end > file_size )
+	    break;
+
+	  if ( AS_02::MXF::IsPartitionPackKey(Reader.Key()) )
+	    {
+	      ASDCP::MXF::Partition this_partition(m_Dict);
+	      result = m_File->Seek(m_ScanPosition);
+
+	      if ( KM_SUCCESS(result) )
+		result = this_partition.InitFromFile(*m_File);
+
+	      if ( KM_FAILURE(result) )
+		break;
+
+	      packet_end += this_partition.HeaderByteCount + this_partition.IndexByteCount;
+
+	      if ( packet_end > file_size )
+		break; // wait for the index segments
+
+	      if ( this_partition.BodySID != 0 )
+		{
+		  if ( m_ScanBodySID == 0 )
+		    m_ScanBodySID = this_partition.BodySID;
+
+		  if ( this_partition.BodySID == m_ScanBodySID )
+		    {
+		      m_ScanHasBody = true;
+		      m_ScanBodyOffset = this_partition.BodyOffset;
+		      m_ScanEssenceOffset = this_partition.ThisPartition + this_partition.ArchiveSize();
+		    }
+		}
+
+	      if ( this_partition.IndexByteCount > 0 )
+		{
+		  if ( ! m_ScanHasBody )
+		    {
+		      DefaultLogSink().Error("Index and Body partitions do not match.\n");
+		      result = RESULT_AS02_FORMAT;
+		      break;
+		    }
+
+		  result = m_File->Seek(m_ScanPosition + this_partition.ArchiveSize() + this_partition.HeaderByteCount);
+
+		  if ( KM_SUCCESS(result) )
+		    result = m_IndexAccess.AppendFromFile(*m_File, this_partition.IndexByteCount,
+							  m_ScanBodyOffset, m_ScanEssenceOffset);
+		  m_ScanHasBody = false;
+		}
+
+	      if ( Reader.Key()[13] == 0x04 ) // footer
+		m_GrowingComplete = true;
+	    }
+
+	  m_ScanPosition = packet_end;
+	}
+
+      m_LastPosition = 0; // the file pointer was moved
+    }
+
+  frame_count = m_IndexAccess.GetDuration();
+  is_complete = ! m_Growing || m_GrowingComplete;
+  return result;
+}
+
 // AS-DCP method of reading a plaintext or encrypted frame
 Result_t
 AS_02::h__AS02Reader::ReadEKLVFrame(ui32_t FrameNum, ASDCP::FrameBuffer& FrameBuf,
@@ -491,6 +943,40 @@ AS_02::h__AS02Reader::ReadEKLVFrame(ui32_t FrameNum, ASDCP::FrameBuffer& FrameBu
   return ASDCP::MXF::TrackFileReader<OP1aHeader, AS_02::MXF::AS02IndexReader>::ReadEKLVFrame(FrameNum, FrameBuf, EssenceUL, Ctx, HMAC);
 }
 
+//
+Result_t
+AS_02::h__AS02Reader::ReadEKLVFrames(const std::vector<ui32_t>& frame_numbers, ASDCP::FrameBuffer& FrameBuf,
+				      const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC,
+				      ASDCP::FrameReadCallback& Callback)
+{
+  // index entries are absolute; stop at the duration because lookups past it are logged
+  return ASDCP::MXF::TrackFileReader<OP1aHeader, AS_02::MXF::AS02IndexReader>::ReadEKLVFrames(0, m_IndexAccess.GetDuration(), frame_numbers, FrameBuf,
+											       EssenceUL, Ctx, HMAC, Callback);
+}
+
+//
+Result_t
+AS_02::h__AS02Reader::ReadEKLVFrameRange(ui32_t FrameNum, ui32_t offset, ui32_t length, ASDCP::FrameBuffer& FrameBuf,
+					  const byte_t* EssenceUL, AESDecContext* Ctx)
+{
+  return ASDCP::MXF::TrackFileReader<OP1aHeader, AS_02::MXF::AS02IndexReader>::ReadEKLVFrameRange(0, FrameNum, offset, length,
+												   FrameBuf, EssenceUL, Ctx);
+}
+
+//
+bool
+AS_02::MXF::IsPartitionPackKey(const byte_t* key)
+{
+  static const byte_t partition_pack_prefix[13] = {
+    0x06, 0x0e, 0x2b, 0x34, 0x02, 0x05, 0x01, 0x01,
+    0x0d, 0x01, 0x02, 0x01, 0x01 };
+
+  assert(key);
+  return memcmp(key, partition_pack_prefix, sizeof(partition_pack_prefix)) == 0
+    && key[13] >= 0x02 && key[13] <= 0x04 // header, body or footer
+    && key[14] >= 0x01 && key[14] <= 0x04;
+}
+
 //
 // end h__02_Reader.cpp
 //
@@ -37,79 +37,98 @@ using namespace ASDCP;
 using namespace ASDCP::MXF;
 
 static const ui32_t CBRIndexEntriesPerSegment = 5000;
+static const ui32_t VBRIndexSegmentsPerPartition = 16;
 
 
 //------------------------------------------------------------------------------------------
 //
 
 AS_02::MXF::AS02IndexWriterVBR::AS02IndexWriterVBR(const ASDCP::Dictionary* d) :
-  Partition(d), m_CurrentSegment(0), m_Dict(d), m_Lookup(0)
+  Partition(d), m_CurrentSegment(0), m_SegmentCount(0), m_PartitionDuration(0), m_PartitionSpace(0), m_StartPosition(0),
+  m_Dict(d), m_Lookup(0)
 {
   BodySID = 0;
   IndexSID = 129;
   MinorVersion = 3;
 }
 
-AS_02::MXF::AS02IndexWriterVBR::~AS02IndexWriterVBR() {}
+AS_02::MXF::AS02IndexWriterVBR::~AS02IndexWriterVBR()
+{
+  delete m_CurrentSegment;
+}
 
+// The current segment is not a child object, it is reused for each segment
+// in turn. Full segments are serialized into m_IndexBodyBuffer, which holds
+// the index body of the partition being built. SetPartitionSpace() sizes the
+// buffer for a whole partition; otherwise it grows a segment at a time.
 //
 Result_t
-AS_02::MXF::AS02IndexWriterVBR::WriteToFile(Kumu::FileWriter& Writer)
+AS_02::MXF::AS02IndexWriterVBR::SerializeCurrentSegment()
 {
-  assert(m_Dict);
-  ASDCP::FrameBuffer index_body_buffer;
-  ui32_t index_body_size = (ui32_t)m_PacketList->m_List.size() * MaxIndexSegmentSize; // segment-count * max-segment-size
-  Result_t result = index_body_buffer.Capacity(index_body_size); 
-  ui64_t start_position = 0;
+  assert(m_CurrentSegment);
+  ui32_t entry_count = (ui32_t)m_CurrentSegment->IndexEntryArray.size();
 
-  if ( m_CurrentSegment != 0 )
-    {
-      m_CurrentSegment->IndexDuration = m_CurrentSegment->IndexEntryArray.size();
-      start_position = m_CurrentSegment->IndexStartPosition + m_CurrentSegment->IndexDuration;
-      m_CurrentSegment = 0;
-    }
+  if ( entry_count == 0 )
+    return RESULT_OK;
+
+  Result_t result = RESULT_OK;
+  ui32_t needed = m_IndexBodyBuffer.Length() + MaxIndexSegmentSize;
 
-  std::list<InterchangeObject*>::iterator pl_i = m_PacketList->m_List.begin();
-  for ( ; pl_i != m_PacketList->m_List.end() && KM_SUCCESS(result); pl_i++ )
+  if ( m_IndexBodyBuffer.Capacity() < needed )
+    result = m_IndexBodyBuffer.Capacity(Kumu::xmax(needed, m_IndexBodyBuffer.Capacity() * 2));
+
+  if ( KM_SUCCESS(result) )
     {
-      InterchangeObject* object = *pl_i;
-      object->m_Lookup = m_Lookup;
+      m_CurrentSegment->IndexDuration = entry_count;
+      m_CurrentSegment->m_Lookup = m_Lookup;
 
       ASDCP::FrameBuffer WriteWrapper;
-      WriteWrapper.SetData(index_body_buffer.Data() + index_body_buffer.Size(),
-			   index_body_buffer.Capacity() - index_body_buffer.Size());
-      result = object->WriteToBuffer(WriteWrapper);
-      index_body_buffer.Size(index_body_buffer.Size() + WriteWrapper.Size());
-      delete *pl_i;
-      *pl_i = 0;
+      WriteWrapper.SetData(m_IndexBodyBuffer.Data() + m_IndexBodyBuffer.Length(),
+			   m_IndexBodyBuffer.Capacity() - m_IndexBodyBuffer.Length());
+      result = m_CurrentSegment->WriteToBuffer(WriteWrapper);
+      m_IndexBodyBuffer.Length(m_IndexBodyBuffer.Length() + WriteWrapper.Size());
     }
 
-  m_PacketList->m_List.clear();
-
   if ( KM_SUCCESS(result) )
     {
-      IndexByteCount = index_body_buffer.Size();
-      UL body_ul(m_Dict->ul(MDD_ClosedCompleteBodyPartition));
-      result = Partition::WriteToFile(Writer, body_ul);
+      ++m_SegmentCount;
+      m_CurrentSegment->IndexStartPosition += entry_count;
+      m_CurrentSegment->IndexEntryArray.clear();
+      m_CurrentSegment->InstanceUID.Reset();
+      GenRandomValue(m_CurrentSegment->InstanceUID);
     }
 
+  return result;
+}
+
+//
+Result_t
+AS_02::MXF::AS02IndexWriterVBR::WriteToFile(Kumu::FileWriter& Writer)
+{
+  assert(m_Dict);
+  Result_t result = RESULT_OK;
+
+  if ( m_CurrentSegment != 0 )
+    result = SerializeCurrentSegment();
+
   if ( KM_SUCCESS(result) )
     {
-      ui32_t write_count = 0;
-      result = Writer.Write(index_body_buffer.RoData(), index_body_buffer.Size(), &write_count);
-      assert(write_count == index_body_buffer.Size());
+      IndexByteCount = m_IndexBodyBuffer.Length();
+      UL body_ul(m_Dict->ul(MDD_ClosedCompleteBodyPartition));
+      result = Partition::WriteToFile(Writer, body_ul);
     }
 
-  if ( KM_SUCCESS(result) )
+  if ( KM_SUCCESS(result) && m_IndexBodyBuffer.Length() > 0 )
     {
-      m_CurrentSegment = new IndexTableSegment(m_Dict);
-      assert(m_CurrentSegment);
-      AddChildObject(m_CurrentSegment);
-      m_CurrentSegment->DeltaEntryArray.push_back(IndexTableSegment::DeltaEntry());
-      m_CurrentSegment->IndexEditRate = m_EditRate;
-      m_CurrentSegment->IndexStartPosition = start_position;
+      ui32_t write_count = 0;
+      result = Writer.Write(m_IndexBodyBuffer.RoData(), m_IndexBodyBuffer.Length(), &write_count);
+      assert(write_count == m_IndexBodyBuffer.Length());
     }
 
+  // the buffer keeps its allocation for the next partition
+  m_IndexBodyBuffer.Length(0);
+  m_SegmentCount = 0;
+  m_PartitionDuration = 0;
   return result;
 }
 
@@ -122,10 +141,10 @@ AS_02::MXF::AS02IndexWriterVBR::Dump(FILE* stream)
 
   Partition::Dump(stream);
 
-  std::list<InterchangeObject*>::iterator i = m_PacketList->m_List.begin();
-  for ( ; i != m_PacketList->m_List.end(); ++i )
+  if ( m_CurrentSegment != 0 )
     {
-      (*i)->Dump(stream);
+      fprintf(stream, "  %u segments serialized (%u bytes)\n", m_SegmentCount, m_IndexBodyBuffer.Length());
+      m_CurrentSegment->Dump(stream);
     }
 }
 
@@ -133,19 +152,16 @@ AS_02::MXF::AS02IndexWriterVBR::Dump(FILE* stream)
 ui32_t
 AS_02::MXF::AS02IndexWriterVBR::GetDuration() const
 {
-  ui32_t duration = 0;
-  std::list<InterchangeObject*>::const_iterator i;
-
-  for ( i = m_PacketList->m_List.begin(); i != m_PacketList->m_List.end(); ++i )
-    {
-      IndexTableSegment* segment = dynamic_cast<IndexTableSegment*>(*i);
-      if ( segment != 0 )
-	{
-	  duration += (ui32_t)segment->IndexEntryArray.size();
-	}
-    }
+  return m_PartitionDuration;
+}
 
-  return duration;
+// Returns true when the partition holds VBRIndexSegmentsPerPartition full
+// segments. Frame-wrapping writers start a new partition at this point so
+// that the index memory they hold does not depend on the partition duration.
+bool
+AS_02::MXF::AS02IndexWriterVBR::IsFull() const
+{
+  return m_PartitionDuration >= ( CBRIndexEntriesPerSegment * VBRIndexSegmentsPerPartition );
 }
 
 //
@@ -154,32 +170,61 @@ AS_02::MXF::AS02IndexWriterVBR::PushIndexEntry(const IndexTableSegment::IndexEnt
 {
   // do we have an available segment?
   if ( m_CurrentSegment == 0 )
-    { // no, set up a new segment
+    { // no, set up the segment
       m_CurrentSegment = new IndexTableSegment(m_Dict);
       assert(m_CurrentSegment);
-      AddChildObject(m_CurrentSegment);
+      GenRandomValue(m_CurrentSegment->InstanceUID);
       m_CurrentSegment->DeltaEntryArray.push_back(IndexTableSegment::DeltaEntry());
       m_CurrentSegment->IndexEditRate = m_EditRate;
-      m_CurrentSegment->IndexStartPosition = 0;
-    } else if (m_CurrentSegment->IndexEntryArray.size() >= CBRIndexEntriesPerSegment) { // no, this one is full, start another
-      m_CurrentSegment->IndexDuration = m_CurrentSegment->IndexEntryArray.size();
-      ui64_t StartPosition = m_CurrentSegment->IndexStartPosition + m_CurrentSegment->IndexDuration;
+      m_CurrentSegment->IndexStartPosition = m_StartPosition;
 
-      m_CurrentSegment = new IndexTableSegment(m_Dict);
-      assert(m_CurrentSegment);
-      AddChildObject(m_CurrentSegment);
-      m_CurrentSegment->DeltaEntryArray.push_back(IndexTableSegment::DeltaEntry());
-      m_CurrentSegment->IndexEditRate = m_EditRate;
-      m_CurrentSegment->IndexStartPosition = StartPosition;
-  }
+      if ( m_PartitionSpace > 0 )
+	m_CurrentSegment->IndexEntryArray.reserve(Kumu::xmin(m_PartitionSpace, CBRIndexEntriesPerSegment));
+    }
+  else if ( m_CurrentSegment->IndexEntryArray.size() >= CBRIndexEntriesPerSegment )
+    { // this one is full, serialize it and start another
+      Result_t result = SerializeCurrentSegment();
+
+      if ( KM_FAILURE(result) )
+	DefaultLogSink().Error("Index segment serialization failed: %s\n", result.Label());
+    }
 
   m_CurrentSegment->IndexEntryArray.push_back(Entry);
+  ++m_PartitionDuration;
+}
+
+void
+AS_02::MXF::AS02IndexWriterVBR::SetStartPosition(ui64_t start_position)
+{
+  assert(m_CurrentSegment == 0);
+  m_StartPosition = start_position;
+}
+
+// Reserves the serialized index of a partition of edit_units frames, at most
+// VBRIndexSegmentsPerPartition full segments, so that the buffer is not grown
+// while the partition is written. The segment set up by the next
+// PushIndexEntry() reserves its entries from the same value.
+Result_t
+AS_02::MXF::AS02IndexWriterVBR::SetPartitionSpace(ui32_t edit_units)
+{
+  m_PartitionSpace = edit_units;
+  ui32_t entry_count = Kumu::xmin(edit_units, CBRIndexEntriesPerSegment * VBRIndexSegmentsPerPartition);
+  ui32_t segment_count = ( entry_count + CBRIndexEntriesPerSegment - 1 ) / CBRIndexEntriesPerSegment;
+
+  if ( segment_count == 0 )
+    return RESULT_OK;
+
+  return m_IndexBodyBuffer.Capacity(segment_count * MaxIndexSegmentSize);
 }
 
+//
 void
 AS_02::MXF::AS02IndexWriterVBR::SetEditRate(const ASDCP::Rational& edit_rate)
 {
   m_EditRate = edit_rate;
+
+  if ( m_CurrentSegment != 0 )
+    m_CurrentSegment->IndexEditRate = edit_rate;
 }
 
 //------------------------------------------------------------------------------------------
@@ -198,9 +243,14 @@ AS_02::h__AS02WriterFrame::WriteEKLVPacket(const ASDCP::FrameBuffer& FrameBuf,co
 					   AESEncContext* Ctx, HMACContext* HMAC)
 {
   ui64_t this_stream_offset = m_StreamOffset; // m_StreamOffset will be changed by the call to Write_EKLV_Packet
+  Result_t result = RESULT_OK;
 
-  Result_t result = Write_EKLV_Packet(m_File, *m_Dict, m_HeaderPart, m_Info, m_CtFrameBuf, m_FramesWritten,
-				      m_StreamOffset, FrameBuf, EssenceUL, MinEssenceElementBerLength, Ctx, HMAC);
+  if ( m_FramesWritten == 0 )
+    result = m_IndexWriter.SetPartitionSpace(m_PartitionSpace);
+
+  if ( KM_SUCCESS(result) )
+    result = Write_EKLV_Packet(m_File, *m_Dict, m_HeaderPart, m_Info, m_CtFrameBuf, m_FramesWritten,
+			       m_StreamOffset, FrameBuf, EssenceUL, MinEssenceElementBerLength, Ctx, HMAC, m_Stats);
 
   if ( KM_SUCCESS(result) )
     {  
@@ -209,7 +259,8 @@ AS_02::h__AS02WriterFrame::WriteEKLVPacket(const ASDCP::FrameBuffer& FrameBuf,co
       m_IndexWriter.PushIndexEntry(Entry);
     }
 
-  if ( m_FramesWritten > 1 && ( ( m_FramesWritten + 1 ) % m_PartitionSpace ) == 0 )
+  if ( ( m_FramesWritten > 1 && ( ( m_FramesWritten + 1 ) % m_PartitionSpace ) == 0 )
+       || m_IndexWriter.IsFull() )
     {
       assert(m_IndexWriter.GetDuration() > 0);
       FlushIndexPartition();
@@ -222,6 +273,7 @@ AS_02::h__AS02WriterFrame::WriteEKLVPacket(const ASDCP::FrameBuffer& FrameBuf,co
       body_part.OperationalPattern = m_HeaderPart.OperationalPattern;
       body_part.EssenceContainers = m_HeaderPart.EssenceContainers;
       body_part.ThisPartition = m_File.TellPosition();
+      body_part.PreviousPartition = m_RIP.PairArray.back().ByteOffset;
 
       body_part.BodyOffset = m_StreamOffset;
       result = body_part.WriteToFile(m_File, body_ul);
@@ -309,3 +361,457 @@ AS_02::MXF::AS02IndexWriterCBR::SetEditRate(const ASDCP::Rational& edit_rate, co
 
 //------------------------------------------------------------------------------------------
 //
+// Recovery of files left incomplete by a writer that did not reach Finalize().
+//
+// Each index flush closes a checkpoint: a complete index partition follows the
+// essence it describes, and every partition pack carries the offset of the one
+// before it. The last checkpoint is found by scanning backward from the end of
+// the file, so only the essence written since that checkpoint is read in bulk.
+
+static const ui32_t s_RecoveryScanBlockSize = Kumu::Megabyte;
+
+// reads the partition pack at the given position and checks that it knows where it is
+static Result_t
+read_partition_pack(Kumu::IFileReader& reader, const Kumu::fpos_t& position, Partition& partition)
+{
+  Result_t result = reader.Seek(position);
+
+  if ( KM_SUCCESS(result) )
+    result = partition.InitFromFile(reader);
+
+  if ( KM_SUCCESS(result) && partition.ThisPartition != (ui64_t)position )
+    result = AS_02::RESULT_AS02_FORMAT;
+
+  return result;
+}
+
+// finds the last complete partition pack that starts before limit
+static Result_t
+find_last_partition(Kumu::IFileReader& reader, const Kumu::fpos_t& limit, Kumu::fpos_t& position)
+{
+  Kumu::ByteString block_buf;
+  Result_t result = block_buf.Capacity(s_RecoveryScanBlockSize + SMPTE_UL_LENGTH);
+  Kumu::fpos_t block_end = limit;
+
+  while ( KM_SUCCESS(result) && block_end > 0 )
+    {
+      // overlap the blocks so that a key on a boundary is seen whole
+      Kumu::fpos_t block_start = ( block_end > s_RecoveryScanBlockSize ) ? block_end - s_RecoveryScanBlockSize : 0;
+      ui32_t block_length = (ui32_t)( Kumu::xmin<Kumu::fpos_t>(block_end + SMPTE_UL_LENGTH, limit) - block_start );
+      ui32_t read_count = 0;
+      result = reader.Seek(block_start);
+
+      if ( KM_SUCCESS(result) )
+	result = reader.Read(block_buf.Data(), block_length, &read_count);
+
+      if ( KM_SUCCESS(result) && read_count != block_length )
+	result = RESULT_READFAIL;
+
+      for ( i32_t i = (i32_t)( block_end - block_start ) - 1; KM_SUCCESS(result) && i >= 0; --i )
+	{
+	  if ( (ui32_t)i + SMPTE_UL_LENGTH <= block_length
+	       && AS_02::MXF::IsPartitionPackKey(block_buf.RoData() + i) )
+	    {
+	      Partition tmp_partition(&DefaultCompositeDict());
+
+	      if ( KM_SUCCESS(read_partition_pack(reader, block_start + i, tmp_partition)) )
+		{
+		  position = block_start + i;
+		  return RESULT_OK;
+		}
+	    }
+	}
+
+      block_end = block_start;
+    }
+
+  return KM_SUCCESS(result) ? AS_02::RESULT_AS02_FORMAT : result;
+}
+
+// builds the list of partitions from the start of the file up to the given one,
+// following the PreviousPartition links back to the header
+static Result_t
+collect_partitions(Kumu::IFileReader& reader, const Kumu::fpos_t& last_position, std::list<RIP::PartitionPair>& pair_list)
+{
+  Kumu::fpos_t position = last_position;
+  Result_t result = RESULT_OK;
+
+  while ( KM_SUCCESS(result) )
+    {
+      Partition tmp_partition(&DefaultCompositeDict());
+      result = read_partition_pack(reader, position, tmp_partition);
+
+      if ( KM_SUCCESS(result) )
+	{
+	  pair_list.push_front(RIP::PartitionPair(tmp_partition.BodySID, position));
+
+	  if ( position == 0 )
+	    break;
+
+	  if ( tmp_partition.PreviousPartition >= (ui64_t)position )
+	    result = AS_02::RESULT_AS02_FORMAT;
+	  else
+	    position = tmp_partition.PreviousPartition;
+	}
+    }
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  // files written before the partitions were linked have a broken chain, walk
+  // every KLV packet between the header and the last partition instead
+  if ( pair_list.size() > 2 || last_position == 0 )
+    return RESULT_OK;
+
+  Partition header_part(&DefaultCompositeDict());
+  result = read_partition_pack(reader, 0, header_part);
+  Kumu::fpos_t header_end = header_part.ArchiveSize() + header_part.HeaderByteCount;
+
+  if ( KM_FAILURE(result) || header_end == last_position )
+    return result;
+
+  DefaultLogSink().Warn("Partitions are not linked, scanning the file.\n");
+  pair_list.clear();
+  pair_list.push_back(RIP::PartitionPair(0, 0));
+  position = header_end;
+
+  while ( KM_SUCCESS(result) && position < last_position )
+    {
+      KLReader Reader;
+      result = reader.Seek(position);
+
+      if ( KM_SUCCESS(result) )
+	result = Reader.ReadKLFromFile(reader);
+
+      if ( KM_SUCCESS(result) && AS_02::MXF::IsPartitionPackKey(Reader.Key()) )
+	{
+	  Partition tmp_partition(&DefaultCompositeDict());
+	  result = read_partition_pack(reader, position, tmp_partition);
+
+	  if ( KM_SUCCESS(result) )
+	    pair_list.push_back(RIP::PartitionPair(tmp_partition.BodySID, position));
+	}
+
+      position += Reader.KLLength() + Reader.Length();
+    }
+
+  if ( KM_SUCCESS(result) )
+    pair_list.push_back(RIP::PartitionPair(header_part.BodySID, last_position));
+
+  return result;
+}
+
+// Walks the essence packets that follow a body partition pack. A frame starts
+// with a packet having the same key as the first one and ends where the next
+// frame starts. Frames must all have the same number of packets, the walk stops
+// at the first packet that is not complete before limit.
+static Result_t
+collect_trailing_frames(Kumu::IFileReader& reader, const Dictionary& dict,
+			const Kumu::fpos_t& essence_start, const Kumu::fpos_t& limit,
+			std::list<Kumu::fpos_t>& frame_list, Kumu::fpos_t& data_end)
+{
+  Kumu::fpos_t position = essence_start;
+  Kumu::fpos_t frame_start = 0;
+  ui32_t packets_per_frame = 0, frame_packets = 0;
+  UL frame_key;
+  data_end = essence_start;
+
+  while ( position < limit )
+    {
+      KLReader Reader;
+
+      if ( KM_FAILURE(reader.Seek(position)) || KM_FAILURE(Reader.ReadKLFromFile(reader)) )
+	break;
+
+      Kumu::fpos_t packet_end = position + Reader.KLLength() + Reader.Length();
+
+      if ( packet_end > limit || AS_02::MXF::IsPartitionPackKey(Reader.Key()) )
+	break;
+
+      UL key(Reader.Key());
+
+      if ( ! key.MatchIgnoreStream(dict.ul(MDD_KLVFill)) )
+	{
+	  if ( ! frame_key.HasValue() )
+	    frame_key.Set(key.Value());
+
+	  if ( key.MatchIgnoreStream(frame_key) )
+	    {
+	      if ( frame_packets > 0 )
+		{
+		  if ( packets_per_frame == 0 )
+		    packets_per_frame = frame_packets;
+
+		  if ( frame_packets != packets_per_frame )
+		    break;
+
+		  frame_list.push_back(frame_start);
+		  data_end = position;
+		}
+
+	      frame_start = position;
+	      frame_packets = 0;
+	    }
+
+	  ++frame_packets;
+	}
+
+      position = packet_end;
+    }
+
+  if ( frame_packets > 0 && ( packets_per_frame == 0 || frame_packets == packets_per_frame ) )
+    {
+      frame_list.push_back(frame_start);
+      data_end = position;
+    }
+
+  return RESULT_OK;
+}
+
+// the fill value is written in pieces of this size
+static const ui32_t FillChunkSize = 16 * Kumu::Kilobyte;
+
+//
+static Result_t
+write_fill_item(Kumu::FileWriter& writer, const Dictionary& dict, ui32_t fill_length)
+{
+  assert(fill_length >= kl_length);
+  KLVFilePacket fill_packet;
+  Result_t result = fill_packet.WriteKLToFile(writer, dict.ul(MDD_KLVFill), fill_length - kl_length);
+  byte_t nil_buf[FillChunkSize];
+  memset(nil_buf, 0, FillChunkSize);
+  ui32_t remainder = fill_length - kl_length;
+
+  while ( KM_SUCCESS(result) && remainder > 0 )
+    {
+      ui32_t write_size = Kumu::xmin(remainder, FillChunkSize);
+      result = writer.Write(nil_buf, write_size);
+      remainder -= write_size;
+    }
+
+  return result;
+}
+
+//
+Result_t
+AS_02::RecoverFile(const std::string& filename, ui32_t& duration)
+{
+  const Dictionary& dict = DefaultCompositeDict();
+  Kumu::FileWriter file;
+  duration = 0;
+  Result_t result = file.OpenModify(filename);
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  OP1aHeader header_part(&dict);
+  result = header_part.InitFromFile(file);
+
+  if ( KM_FAILURE(result) )
+    {
+      DefaultLogSink().Error("RecoverFile: the header partition is not readable.\n");
+      return result;
+    }
+
+  Kumu::fpos_t file_end = file.Size();
+
+  {
+    RIP tmp_rip(&dict);
+
+    if ( KM_SUCCESS(SeekToRIP(file)) && KM_SUCCESS(tmp_rip.InitFromFile(file)) && ! tmp_rip.PairArray.empty() )
+      {
+	AS_02::MXF::AS02IndexReader index_reader(&dict);
+	index_reader.m_Lookup = &header_part.m_Primer;
+	result = index_reader.InitFromFile(file, tmp_rip, false);
+	duration = index_reader.GetDuration();
+	DefaultLogSink().Info("RecoverFile: %s is complete.\n", filename.c_str());
+	return result;
+      }
+  }
+
+  // find the last checkpoint. A footer or an incomplete index partition is
+  // discarded, the data before it is kept.
+  Kumu::fpos_t limit = file_end, position = 0, data_end = 0;
+  std::list<Kumu::fpos_t> frame_list;
+  Partition last_part(&dict);
+  result = find_last_partition(file, limit, position);
+
+  while ( KM_SUCCESS(result) )
+    {
+      result = read_partition_pack(file, position, last_part);
+
+      if ( KM_FAILURE(result) )
+	break;
+
+      if ( position == 0 )
+	{
+	  DefaultLogSink().Error("RecoverFile: the file has no body partition.\n");
+	  result = AS_02::RESULT_AS02_FORMAT;
+	}
+      else if ( last_part.FooterPartition == last_part.ThisPartition )
+	{
+	  limit = position;
+	  position = last_part.PreviousPartition;
+	}
+      else if ( last_part.BodySID == 0 )
+	{
+	  Kumu::fpos_t index_end = position + last_part.ArchiveSize() + last_part.IndexByteCount;
+
+	  if ( index_end <= limit )
+	    {
+	      data_end = index_end;
+	      break;
+	    }
+
+	  limit = position;
+	  position = last_part.PreviousPartition;
+	}
+      else
+	{
+	  result = collect_trailing_frames(file, dict, position + last_part.ArchiveSize(), limit, frame_list, data_end);
+	  break;
+	}
+    }
+
+  std::list<RIP::PartitionPair> pair_list;
+
+  if ( KM_SUCCESS(result) )
+    result = collect_partitions(file, position, pair_list);
+
+  if ( KM_FAILURE(result) )
+    {
+      DefaultLogSink().Error("RecoverFile: no usable partition structure was found.\n");
+      return result;
+    }
+
+  RIP rip(&dict);
+  std::list<RIP::PartitionPair>::const_iterator pi;
+
+  for ( pi = pair_list.begin(); pi != pair_list.end(); ++pi )
+    rip.PairArray.push_back(*pi);
+
+  // the index so far
+  AS_02::MXF::AS02IndexReader index_reader(&dict);
+  index_reader.m_Lookup = &header_part.m_Primer;
+  result = index_reader.InitFromFile(file, rip, false);
+
+  if ( KM_FAILURE(result) && frame_list.empty() )
+    return result;
+
+  duration = KM_SUCCESS(result) ? index_reader.GetDuration() : 0;
+  result = RESULT_OK;
+
+  // the essence descriptor supplies the index edit rate
+  FileDescriptor* descriptor = 0;
+  InterchangeObject* object = 0;
+
+  if ( KM_SUCCESS(header_part.GetMDObjectByType(dict.ul(MDD_SourcePackage), &object)) )
+    {
+      SourcePackage* package = dynamic_cast<SourcePackage*>(object);
+
+      if ( package != 0 && KM_SUCCESS(header_part.GetMDObjectByID(package->Descriptor, &object)) )
+	descriptor = dynamic_cast<FileDescriptor*>(object);
+    }
+
+  if ( descriptor == 0 )
+    {
+      DefaultLogSink().Error("RecoverFile: the header has no essence descriptor.\n");
+      return AS_02::RESULT_AS02_FORMAT;
+    }
+
+  result = file.Seek(data_end);
+
+  if ( KM_SUCCESS(result) && ! frame_list.empty() )
+    {
+      // index the frames written since the last checkpoint
+      Kumu::fpos_t essence_start = last_part.ThisPartition + last_part.ArchiveSize();
+      AS_02::MXF::AS02IndexWriterVBR index_writer(&dict);
+      index_writer.SetPrimerLookup(&header_part.m_Primer);
+      index_writer.SetEditRate(descriptor->SampleRate);
+      index_writer.SetStartPosition(duration);
+      index_writer.MajorVersion = header_part.MajorVersion;
+      index_writer.MinorVersion = header_part.MinorVersion;
+      index_writer.OperationalPattern.Set(header_part.OperationalPattern.Value());
+      index_writer.EssenceContainers = header_part.EssenceContainers;
+      index_writer.IndexSID = 129;
+
+      std::list<Kumu::fpos_t>::const_iterator fi;
+
+      for ( fi = frame_list.begin(); fi != frame_list.end(); ++fi )
+	{
+	  IndexTableSegment::IndexEntry Entry;
+	  Entry.StreamOffset = last_part.BodyOffset + ( *fi - essence_start );
+	  index_writer.PushIndexEntry(Entry);
+	}
+
+      index_writer.ThisPartition = data_end;
+      index_writer.PreviousPartition = rip.PairArray.back().ByteOffset;
+      result = index_writer.WriteToFile(file);
+      rip.PairArray.push_back(RIP::PartitionPair(0, index_writer.ThisPartition));
+      duration += (ui32_t)frame_list.size();
+    }
+
+  Kumu::fpos_t footer_position = file.TellPosition();
+
+  if ( KM_SUCCESS(result) )
+    {
+      Partition footer_part(&dict);
+      footer_part.MajorVersion = header_part.MajorVersion;
+      footer_part.MinorVersion = header_part.MinorVersion;
+      footer_part.OperationalPattern.Set(header_part.OperationalPattern.Value());
+      footer_part.EssenceContainers = header_part.EssenceContainers;
+      footer_part.PreviousPartition = rip.PairArray.back().ByteOffset;
+      footer_part.FooterPartition = footer_position;
+      footer_part.ThisPartition = footer_position;
+      rip.PairArray.push_back(RIP::PartitionPair(0, footer_position));
+
+      UL footer_ul(dict.ul(MDD_CompleteFooter));
+      result = footer_part.WriteToFile(file, footer_ul);
+    }
+
+  if ( KM_SUCCESS(result) )
+    {
+      // the RIP must end the file, cover whatever is left of the old data
+      Kumu::fpos_t here = file.TellPosition();
+      ui32_t rip_length = kl_length + ( (ui32_t)rip.PairArray.size() * RIP::PartitionPair().Size() ) + sizeof(ui32_t);
+
+      if ( here + rip_length < file_end )
+	result = write_fill_item(file, dict, Kumu::xmax<ui32_t>(kl_length, (ui32_t)( file_end - here - rip_length )));
+    }
+
+  if ( KM_SUCCESS(result) )
+    result = rip.WriteToFile(file);
+
+  // bring the header up to date
+  if ( KM_SUCCESS(result) )
+    {
+      const MDD_t component_types[] = { MDD_Sequence, MDD_SourceClip, MDD_TimecodeComponent };
+
+      for ( ui32_t i = 0; i < sizeof(component_types) / sizeof(MDD_t); ++i )
+	{
+	  std::list<InterchangeObject*> object_list;
+	  header_part.GetMDObjectsByType(dict.ul(component_types[i]), object_list);
+	  std::list<InterchangeObject*>::iterator oi;
+
+	  for ( oi = object_list.begin(); oi != object_list.end(); ++oi )
+	    {
+	      StructuralComponent* component = dynamic_cast<StructuralComponent*>(*oi);
+
+	      if ( component != 0 && ! component->Duration.empty() )
+		component->Duration = duration;
+	    }
+	}
+
+      descriptor->ContainerDuration = duration;
+      header_part.FooterPartition = footer_position;
+      result = file.Seek(0);
+    }
+
+  if ( KM_SUCCESS(result) )
+    result = header_part.WriteToFile(file, (ui32_t)( ++pair_list.begin() )->ByteOffset); // the first body partition follows the header
+
+  if ( KM_SUCCESS(result) )
+    DefaultLogSink().Info("RecoverFile: %s repaired, %u frames.\n", filename.c_str(), duration);
+
+  return result;
+}
@@ -165,6 +165,24 @@ ASDCP::h__ASDCPReader::ReadEKLVFrame(ui32_t FrameNum, ASDCP::FrameBuffer& FrameB
 										     EssenceUL, Ctx, HMAC);
 }
 
+Result_t
+ASDCP::h__ASDCPReader::ReadEKLVFrames(const std::vector<ui32_t>& frame_numbers, ASDCP::FrameBuffer& FrameBuf,
+				      const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC,
+				      FrameReadCallback& Callback)
+{
+  // OPAtomIndexFooter lookups past the last frame fail quietly, so no limit is needed
+  return ASDCP::MXF::TrackFileReader<OP1aHeader, OPAtomIndexFooter>::ReadEKLVFrames(m_HeaderPart.BodyOffset, 0xffffffffUL, frame_numbers,
+										      FrameBuf, EssenceUL, Ctx, HMAC, Callback);
+}
+
+Result_t
+ASDCP::h__ASDCPReader::ReadEKLVFrameRange(ui32_t FrameNum, ui32_t offset, ui32_t length, ASDCP::FrameBuffer& FrameBuf,
+					  const byte_t* EssenceUL, AESDecContext* Ctx)
+{
+  return ASDCP::MXF::TrackFileReader<OP1aHeader, OPAtomIndexFooter>::ReadEKLVFrameRange(m_HeaderPart.BodyOffset, FrameNum, offset, length,
+											  FrameBuf, EssenceUL, Ctx);
+}
+
 Result_t
 ASDCP::h__ASDCPReader::LocateFrame(ui32_t FrameNum, Kumu::fpos_t& streamOffset,
                            i8_t& temporalOffset, i8_t& keyFrameOffset)
@@ -234,6 +252,69 @@ ASDCP::KLReader::ReadKLFromFile(Kumu::IFileReader& Reader)
 }
 
 
+//------------------------------------------------------------------------------------------
+//
+
+//
+void
+ASDCP::ChunkReader::SetChunk(const byte_t* data, ui32_t length, const Kumu::fpos_t& base)
+{
+  m_Data = data;
+  m_Length = length;
+  m_Base = m_Position = base;
+}
+
+//
+Result_t
+ASDCP::ChunkReader::Seek(Kumu::fpos_t position, Kumu::SeekPos_t whence) const
+{
+  switch ( whence )
+    {
+    case Kumu::SP_BEGIN: m_Position = position; break;
+    case Kumu::SP_POS:   m_Position += position; break;
+    case Kumu::SP_END:   m_Position = m_Base + m_Length + position; break;
+    }
+
+  return RESULT_OK;
+}
+
+//
+Result_t
+ASDCP::ChunkReader::Tell(Kumu::fpos_t* position) const
+{
+  if ( position == 0 )
+    return RESULT_PTR;
+
+  *position = m_Position;
+  return RESULT_OK;
+}
+
+//
+Result_t
+ASDCP::ChunkReader::Read(byte_t* buf, ui32_t buf_len, ui32_t* read_count) const
+{
+  if ( buf == 0 )
+    return RESULT_PTR;
+
+  if ( m_Position < m_Base )
+    return RESULT_READFAIL;
+
+  Kumu::fpos_t end = m_Base + m_Length;
+  ui32_t tmp_count = ( m_Position < end ) ? (ui32_t)Kumu::xmin<Kumu::fpos_t>(buf_len, end - m_Position) : 0;
+
+  // the destination may lie inside the chunk
+  if ( tmp_count > 0 )
+    memmove(buf, m_Data + ( m_Position - m_Base ), tmp_count);
+
+  m_Position += tmp_count;
+
+  if ( read_count != 0 )
+    *read_count = tmp_count;
+
+  return ( tmp_count == 0 && buf_len > 0 ) ? RESULT_ENDOFFILE : RESULT_OK;
+}
+
+
 //------------------------------------------------------------------------------------------
 //
 
@@ -243,14 +324,18 @@ Result_t
 ASDCP::Read_EKLV_Packet(Kumu::IFileReader& File, const ASDCP::Dictionary& Dict,
 			const ASDCP::WriterInfo& Info, Kumu::fpos_t& LastPosition, ASDCP::FrameBuffer& CtFrameBuf,
 			ui32_t FrameNum, ui32_t SequenceNum, ASDCP::FrameBuffer& FrameBuf,
-			const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC)
+			const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC,
+			StageStats* Stats)
 {
   KLReader Reader;
+  StageTimer kl_timer(Stats, StageStats::STAGE_KL_PARSE);
   Result_t result = Reader.ReadKLFromFile(File);
 
   if ( KM_FAILURE(result) )
     return result;
 
+  kl_timer.Stop(Reader.KLLength());
+
   UL Key(Reader.Key());
   ui64_t PacketLength = Reader.Length();
   LastPosition = LastPosition + Reader.KLLength() + PacketLength;
@@ -265,13 +350,20 @@ ASDCP::Read_EKLV_Packet(Kumu::IFileReader& File, const ASDCP::Dictionary& Dict,
 
       // read encrypted triplet value into internal buffer
       assert(PacketLength <= 0xFFFFFFFFL);
-      CtFrameBuf.Capacity((ui32_t) PacketLength);
+      result = CtFrameBuf.Reserve((ui32_t) PacketLength, FBG_GEOMETRIC | FBG_ALIGN_64);
+
+      if ( ASDCP_FAILURE(result) )
+	return result;
+
       ui32_t read_count;
+      StageTimer read_timer(Stats, StageStats::STAGE_FILE_READ);
       result = File.Read(CtFrameBuf.Data(), (ui32_t) PacketLength, &read_count);
 
       if ( ASDCP_FAILURE(result) )
 	return result;
 
+      read_timer.Stop(read_count);
+
       if ( read_count != PacketLength )
 	{
 	  DefaultLogSink().Error("read length is smaller than EKLV packet length.\n");
@@ -368,14 +460,18 @@ ASDCP::Read_EKLV_Packet(Kumu::IFileReader& File, const ASDCP::Dictionary& Dict,
 	  TmpWrapper.SourceLength(SourceLength);
 	  TmpWrapper.PlaintextOffset(PlaintextOffset);
 
+	  StageTimer decrypt_timer(Stats, StageStats::STAGE_DECRYPT);
 	  result = DecryptFrameBuffer(TmpWrapper, FrameBuf, Ctx);
 	  FrameBuf.FrameNumber(FrameNum);
+	  decrypt_timer.Stop(tmp_len);
   
 	  // detect and test integrity pack
 	  if ( ASDCP_SUCCESS(result) && Info.UsesHMAC && HMAC )
 	    {
 	      IntegrityPack IntPack;
+	      StageTimer hmac_timer(Stats, StageStats::STAGE_HMAC);
 	      result = IntPack.TestValues(TmpWrapper, Info.AssetUUID, SequenceNum, HMAC);
+	      hmac_timer.Stop(tmp_len);
 	    }
 	}
       else // return ciphertext to caller
@@ -409,11 +505,14 @@ ASDCP::Read_EKLV_Packet(Kumu::IFileReader& File, const ASDCP::Dictionary& Dict,
       // read the data into the supplied buffer
       ui32_t read_count;
       assert(PacketLength <= 0xFFFFFFFFL);
+      StageTimer read_timer(Stats, StageStats::STAGE_FILE_READ);
       result = File.Read(FrameBuf.Data(), (ui32_t) PacketLength, &read_count);
 	  
       if ( ASDCP_FAILURE(result) )
 	return result;
 
+      read_timer.Stop(read_count);
+
       if ( read_count != PacketLength )
 	{
 	  char intbuf1[IntBufferLen];
@@ -449,6 +548,643 @@ ASDCP::Read_EKLV_Packet(Kumu::IFileReader& File, const ASDCP::Dictionary& Dict,
 }
 
 
+//------------------------------------------------------------------------------------------
+//
+
+// a run of sparse frame requests fetched with one read
+struct SparseChunk
+{
+  Kumu::fpos_t        Offset;
+  Kumu::fpos_t        End;
+  ui32_t              Pending; // requests in the run not yet delivered
+  ASDCP::FrameBuffer* Data;    // 0 while the run is not held in memory
+};
+
+// orders request indexes by file position
+class SparseRequestOrder
+{
+  const std::vector<SparseFrameRequest>& m_Requests;
+
+public:
+  SparseRequestOrder(const std::vector<SparseFrameRequest>& requests) : m_Requests(requests) {}
+
+  bool operator()(ui32_t lhs, ui32_t rhs) const {
+    return m_Requests[lhs].Offset < m_Requests[rhs].Offset;
+  }
+};
+
+//
+static void
+release_sparse_chunk(std::vector<SparseChunk>& chunks, ui32_t index, std::list<ui32_t>& held, ui64_t& held_bytes)
+{
+  SparseChunk& chunk = chunks[index];
+  assert(chunk.Data);
+  held_bytes -= chunk.End - chunk.Offset;
+  held.remove(index);
+  delete chunk.Data;
+  chunk.Data = 0;
+}
+
+// reads a run into memory, first dropping the oldest held runs if the retain limit would be passed
+static Result_t
+fetch_sparse_chunk(Kumu::IFileReader& File, std::vector<SparseChunk>& chunks, ui32_t index,
+		   std::list<ui32_t>& held, ui64_t& held_bytes, StageStats* Stats)
+{
+  SparseChunk& chunk = chunks[index];
+  ui32_t length = (ui32_t)( chunk.End - chunk.Offset );
+
+  while ( ! held.empty() && held_bytes + length > SparseReadRetainLimit )
+    release_sparse_chunk(chunks, held.front(), held, held_bytes);
+
+  chunk.Data = new ASDCP::FrameBuffer;
+  chunk.Data->Allocator(&PooledFrameBufferAllocator());
+  Result_t result = chunk.Data->Capacity(length);
+  ui32_t read_count = 0;
+
+  if ( KM_SUCCESS(result) )
+    result = File.Seek(chunk.Offset);
+
+  if ( KM_SUCCESS(result) )
+    {
+      StageTimer read_timer(Stats, StageStats::STAGE_FILE_READ);
+      result = File.Read(chunk.Data->Data(), length, &read_count);
+      read_timer.Stop(read_count);
+    }
+
+  if ( KM_FAILURE(result) )
+    {
+      delete chunk.Data;
+      chunk.Data = 0;
+      return result;
+    }
+
+  // a short read leaves the trailing frames to fail in the packet reader
+  chunk.Data->Size(read_count);
+  held.push_back(index);
+  held_bytes += length;
+  return RESULT_OK;
+}
+
+//
+Result_t
+ASDCP::Read_EKLV_Frames(Kumu::IFileReader& File, const ASDCP::Dictionary& Dict,
+			const ASDCP::WriterInfo& Info, ASDCP::FrameBuffer& CtFrameBuf,
+			const std::vector<SparseFrameRequest>& Requests, ASDCP::FrameBuffer& FrameBuf,
+			const byte_t* EssenceUL, AESDecContext* Ctx, HMACContext* HMAC,
+			FrameReadCallback& Callback, StageStats* Stats)
+{
+  const ui32_t no_chunk = 0xffffffffUL;
+  std::vector<ui32_t> chunk_of(Requests.size(), no_chunk);
+  std::vector<SparseChunk> chunks;
+  std::vector<ui32_t> order;
+
+  // frames of unknown or unreasonable length are read on their own
+  for ( ui32_t i = 0; i < Requests.size(); ++i )
+    {
+      if ( Requests[i].End > Requests[i].Offset
+	   && Requests[i].End - Requests[i].Offset <= SparseReadMaxChunk )
+	order.push_back(i);
+    }
+
+  std::stable_sort(order.begin(), order.end(), SparseRequestOrder(Requests));
+
+  // group the frames into runs, in file order
+  std::vector<ui32_t>::const_iterator oi;
+  for ( oi = order.begin(); oi != order.end(); ++oi )
+    {
+      const SparseFrameRequest& request = Requests[*oi];
+
+      if ( chunks.empty()
+	   || request.Offset > chunks.back().End + SparseReadMaxGap
+	   || Kumu::xmax(request.End, chunks.back().End) - chunks.back().Offset > SparseReadMaxChunk )
+	{
+	  SparseChunk tmp_chunk;
+	  tmp_chunk.Offset = request.Offset;
+	  tmp_chunk.End = request.End;
+	  tmp_chunk.Pending = 0;
+	  tmp_chunk.Data = 0;
+	  chunks.push_back(tmp_chunk);
+	}
+      else
+	{
+	  chunks.back().End = Kumu::xmax(request.End, chunks.back().End);
+	}
+
+      ++chunks.back().Pending;
+      chunk_of[*oi] = (ui32_t)( chunks.size() - 1 );
+    }
+
+  // deliver in request order, reading each run when it is first needed
+  ChunkReader chunk_reader;
+  std::list<ui32_t> held; // runs held in memory, oldest first
+  ui64_t held_bytes = 0;
+  Result_t result = RESULT_OK;
+
+  for ( ui32_t i = 0; KM_SUCCESS(result) && i < Requests.size(); ++i )
+    {
+      const SparseFrameRequest& request = Requests[i];
+      Kumu::fpos_t last_position = request.Offset;
+
+      if ( chunk_of[i] == no_chunk )
+	{
+	  result = File.Seek(request.Offset);
+
+	  if ( KM_SUCCESS(result) )
+	    result = Read_EKLV_Packet(File, Dict, Info, last_position, CtFrameBuf, request.FrameNum,
+				      request.FrameNum + 1, FrameBuf, EssenceUL, Ctx, HMAC, Stats);
+	}
+      else
+	{
+	  SparseChunk& chunk = chunks[chunk_of[i]];
+
+	  if ( chunk.Data == 0 )
+	    result = fetch_sparse_chunk(File, chunks, chunk_of[i], held, held_bytes, Stats);
+
+	  if ( KM_SUCCESS(result) )
+	    {
+	      chunk_reader.SetChunk(chunk.Data->RoData(), chunk.Data->Size(), chunk.Offset);
+	      result = chunk_reader.Seek(request.Offset);
+	    }
+
+	  // the run was counted as a file read when it was fetched
+	  if ( KM_SUCCESS(result) )
+	    result = Read_EKLV_Packet(chunk_reader, Dict, Info, last_position, CtFrameBuf, request.FrameNum,
+				      request.FrameNum + 1, FrameBuf, EssenceUL, Ctx, HMAC);
+
+	  if ( --chunk.Pending == 0 && chunk.Data != 0 )
+	    release_sparse_chunk(chunks, chunk_of[i], held, held_bytes);
+	}
+
+      if ( KM_SUCCESS(result) )
+	result = Callback.FrameRead(i, FrameBuf);
+    }
+
+  while ( ! held.empty() )
+    release_sparse_chunk(chunks, held.front(), held, held_bytes);
+
+  return result;
+}
+
+
+//------------------------------------------------------------------------------------------
+//
+
+// encrypted essence is staged through a buffer of this size
+static const ui32_t EKLVStreamChunkSize = 64 * Kumu::Kilobyte;
+
+//
+ASDCP::EKLVPacketReader::EKLVPacketReader() :
+  m_File(0), m_Info(0), m_Ctx(0), m_HMAC(0), m_Sequence(0), m_Decrypt(false), m_Remaining(0),
+  m_PlaintextLeft(0), m_BlocksLeft(0), m_LastBlockDiff(0), m_LastBlockRead(false),
+  m_PendingStart(0), m_PendingEnd(0), m_Open(false)
+{
+  memset(m_Pending, 0, CBC_BLOCK_SIZE);
+}
+
+//
+Result_t
+ASDCP::EKLVPacketReader::Begin(Kumu::IFileReader& File, const ASDCP::Dictionary& Dict, const ASDCP::WriterInfo& Info,
+			       const byte_t* EssenceUL, ui32_t sequence, AESDecContext* Ctx, HMACContext* HMAC,
+			       ui64_t& value_length)
+{
+  ASDCP_TEST_NULL(EssenceUL);
+  m_Open = false;
+  value_length = 0;
+
+  KLReader Reader;
+  Result_t result = Reader.ReadKLFromFile(File);
+
+  if ( KM_FAILURE(result) )
+    return result;
+
+  UL Key(Reader.Key());
+  ui64_t PacketLength = Reader.Length();
+
+  m_File = &File;
+  m_Info = &Info;
+  m_Ctx = 0;
+  m_HMAC = 0;
+  m_Sequence = sequence;
+  m_Decrypt = false;
+  m_PendingStart = m_PendingEnd = 0;
+
+  if ( Key.MatchIgnoreStream(Dict.ul(MDD_CryptEssence)) )  // ignore the stream numbers
+    {
+      if ( ! Info.EncryptedEssence )
+	{
+	  DefaultLogSink().Error("EKLV packet found, no Cryptographic Context in header.\n");
+	  return RESULT_FORMAT;
+	}
+
+      // read the triplet header up to the ESV length, which may be coded
+      // with more than MXF_BER_LENGTH bytes
+      byte_t header[klv_cryptinfo_size + 8];
+      ui32_t fixed_length = klv_cryptinfo_size - MXF_BER_LENGTH + 1;
+      ui32_t read_count = 0;
+      result = File.Read(header, fixed_length, &read_count);
+
+      if ( KM_SUCCESS(result) && read_count != fixed_length )
+	result = RESULT_READFAIL;
+
+      ui32_t ber_length = 1;
+
+      if ( KM_SUCCESS(result) && ( header[fixed_length - 1] & 0x80 ) != 0 )
+	{
+	  ber_length += header[fixed_length - 1] & 0x7f;
+
+	  if ( ber_length > 9 )
+	    return RESULT_FORMAT;
+
+	  result = File.Read(header + fixed_length, ber_length - 1, &read_count);
+
+	  if ( KM_SUCCESS(result) && read_count != ber_length - 1 )
+	    result = RESULT_READFAIL;
+	}
+
+      if ( KM_FAILURE(result) )
+	return result;
+
+      byte_t* ess_p = header;
+
+      // read context ID length
+      if ( ! Kumu::read_test_BER(&ess_p, UUIDlen) )
+	return RESULT_FORMAT;
+
+      // test the context ID
+      if ( memcmp(ess_p, Info.ContextID, UUIDlen) != 0 )
+	{
+	  DefaultLogSink().Error("Packet's Cryptographic Context ID does not match the header.\n");
+	  return RESULT_FORMAT;
+	}
+      ess_p += UUIDlen;
+
+      // read PlaintextOffset length
+      if ( ! Kumu::read_test_BER(&ess_p, sizeof(ui64_t)) )
+	return RESULT_FORMAT;
+
+      ui32_t PlaintextOffset = (ui32_t)KM_i64_BE(Kumu::cp2i<ui64_t>(ess_p));
+      ess_p += sizeof(ui64_t);
+
+      // read essence UL length
+      if ( ! Kumu::read_test_BER(&ess_p, SMPTE_UL_LENGTH) )
+	return RESULT_FORMAT;
+
+      // test essence UL
+      if ( ! UL(ess_p).MatchIgnoreStream(EssenceUL) ) // ignore the stream number
+	{
+	  char strbuf[IntBufferLen];
+	  DefaultLogSink().Warn("Unexpected Essence UL found: %s.\n", UL(ess_p).EncodeString(strbuf, IntBufferLen));
+	  return RESULT_FORMAT;
+	}
+      ess_p += SMPTE_UL_LENGTH;
+
+      // read SourceLength length
+      if ( ! Kumu::read_test_BER(&ess_p, sizeof(ui64_t)) )
+	return RESULT_FORMAT;
+
+      ui32_t SourceLength = (ui32_t)KM_i64_BE(Kumu::cp2i<ui64_t>(ess_p));
+      ess_p += sizeof(ui64_t);
+
+      if ( SourceLength == 0 || PlaintextOffset > SourceLength )
+	return RESULT_FORMAT;
+
+      ui32_t esv_length = calc_esv_length(SourceLength, PlaintextOffset);
+
+      // read ESV length
+      if ( ! Kumu::read_test_BER(&ess_p, esv_length) )
+	{
+	  DefaultLogSink().Error("read_test_BER did not return %u\n", esv_length);
+	  return RESULT_FORMAT;
+	}
+
+      ui32_t tmp_len = esv_length + (Info.UsesHMAC ? klv_intpack_size : 0);
+
+      if ( PacketLength < (ui64_t)( ess_p - header ) + tmp_len )
+	{
+	  DefaultLogSink().Error("Frame length is larger than EKLV packet length.\n");
+	  return RESULT_FORMAT;
+	}
+
+#ifdef HAVE_OPENSSL
+      if ( Ctx )
+	{
+	  // get the ivec and test the check value
+	  byte_t esv_header[CBC_BLOCK_SIZE * 2];
+	  byte_t CheckValue[CBC_BLOCK_SIZE];
+	  result = File.Read(esv_header, CBC_BLOCK_SIZE * 2, &read_count);
+
+	  if ( KM_SUCCESS(result) && read_count != CBC_BLOCK_SIZE * 2 )
+	    result = RESULT_READFAIL;
+
+	  if ( KM_SUCCESS(result) )
+	    result = Ctx->SetIVec(esv_header);
+
+	  if ( KM_SUCCESS(result) )
+	    result = Ctx->DecryptBlock(esv_header + CBC_BLOCK_SIZE, CheckValue, CBC_BLOCK_SIZE);
+
+	  if ( KM_SUCCESS(result) && memcmp(CheckValue, ESV_CheckValue, CBC_BLOCK_SIZE) != 0 )
+	    result = RESULT_CHECKFAIL;
+
+	  if ( KM_FAILURE(result) )
+	    return result;
+
+	  if ( Info.UsesHMAC && HMAC )
+	    {
+	      m_HMAC = HMAC;
+	      m_HMAC->Reset();
+	      m_HMAC->Update(esv_header, CBC_BLOCK_SIZE * 2);
+	    }
+
+	  ui32_t ct_size = SourceLength - PlaintextOffset;
+	  m_Ctx = Ctx;
+	  m_Decrypt = true;
+	  m_PlaintextLeft = PlaintextOffset;
+	  m_LastBlockDiff = ct_size % CBC_BLOCK_SIZE;
+	  m_BlocksLeft = ct_size - m_LastBlockDiff;
+	  m_LastBlockRead = false;
+	  m_Remaining = SourceLength;
+	}
+      else // return ciphertext to caller
+#endif //HAVE_OPENSSL
+	{
+	  m_Remaining = tmp_len;
+	}
+    }
+  else if ( Key.MatchIgnoreStream(EssenceUL) ) // ignore the stream number
+    {
+      m_Remaining = PacketLength;
+    }
+  else
+    {
+      char strbuf[IntBufferLen];
+      const MDDEntry* Entry = Dict.FindULAnyVersion(Key.Value());
+
+      if ( Entry == 0 )
+	{
+	  DefaultLogSink().Warn("Unexpected Essence UL found: %s.\n", Key.EncodeString(strbuf, IntBufferLen));
+	}
+      else
+	{
+	  DefaultLogSink().Warn("Unexpected Essence UL found: %s.\n", Entry->name);
+	}
+
+      return RESULT_FORMAT;
+    }
+
+  value_length = m_Remaining;
+  m_Open = true;
+  return RESULT_OK;
+}
+
+// reads part of the encrypted source value, adding it to the HMAC
+Result_t
+ASDCP::EKLVPacketReader::ReadAndHash(byte_t* buf, ui32_t buf_len)
+{
+  ui32_t read_count = 0;
+  Result_t result = m_File->Read(buf, buf_len, &read_count);
+
+  if ( KM_SUCCESS(result) && read_count != buf_len )
+    {
+      DefaultLogSink().Error("read length is smaller than EKLV packet length.\n");
+      result = RESULT_READFAIL;
+    }
+
+  if ( KM_SUCCESS(result) && m_HMAC != 0 )
+    result = m_HMAC->Update(buf, buf_len);
+
+  return result;
+}
+
+// reads and decrypts whole blocks
+Result_t
+ASDCP::EKLVPacketReader::DecryptBlocks(byte_t* buf, ui32_t buf_len)
+{
+  assert(buf_len % CBC_BLOCK_SIZE == 0);
+  Result_t result = RESULT_OK;
+
+#ifdef HAVE_OPENSSL
+  if ( m_Scratch.Capacity() < EKLVStreamChunkSize )
+    result = m_Scratch.Capacity(EKLVStreamChunkSize);
+
+  while ( KM_SUCCESS(result) && buf_len > 0 )
+    {
+      ui32_t chunk = Kumu::xmin(buf_len, EKLVStreamChunkSize);
+      result = ReadAndHash(m_Scratch.Data(), chunk);
+
+      if ( KM_SUCCESS(result) )
+	result = m_Ctx->DecryptBlock(m_Scratch.RoData(), buf, chunk);
+
+      buf += chunk;
+      buf_len -= chunk;
+    }
+#else
+  result = RESULT_CRYPT_CTX;
+#endif //HAVE_OPENSSL
+
+  return result;
+}
+
+// decrypts the padded last block into the pending buffer
+Result_t
+ASDCP::EKLVPacketReader::ReadLastBlock()
+{
+  assert(m_BlocksLeft == 0);
+  Result_t result = DecryptBlocks(m_Pending, CBC_BLOCK_SIZE);
+
+  if ( KM_SUCCESS(result) && m_Pending[m_LastBlockDiff] != 0 )
+    {
+      DefaultLogSink().Error("Unexpected non-zero padding value.\n");
+      result = RESULT_FORMAT;
+    }
+
+  m_PendingStart = 0;
+  m_PendingEnd = m_LastBlockDiff;
+  m_LastBlockRead = true;
+  return result;
+}
+
+//
+Result_t
+ASDCP::EKLVPacketReader::Read(byte_t* buf, ui32_t buf_len, ui32_t& read_count)
+{
+  ASDCP_TEST_NULL(buf);
+  read_count = 0;
+
+  if ( ! m_Open )
+    return RESULT_STATE;
+
+  Result_t result = RESULT_OK;
+
+  while ( KM_SUCCESS(result) && buf_len > 0 && m_Remaining > 0 )
+    {
+      ui32_t chunk = 0;
+
+      if ( ! m_Decrypt )
+	{
+	  chunk = (ui32_t)Kumu::xmin((ui64_t)buf_len, m_Remaining);
+	  ui32_t tmp_count = 0;
+	  result = m_File->Read(buf, chunk, &tmp_count);
+
+	  if ( KM_SUCCESS(result) && tmp_count != chunk )
+	    result = RESULT_READFAIL;
+	}
+      else if ( m_PlaintextLeft > 0 )
+	{
+	  chunk = Kumu::xmin(buf_len, m_PlaintextLeft);
+	  result = ReadAndHash(buf, chunk);
+	  m_PlaintextLeft -= chunk;
+	}
+      else if ( m_PendingStart < m_PendingEnd )
+	{
+	  chunk = Kumu::xmin(buf_len, m_PendingEnd - m_PendingStart);
+	  memcpy(buf, m_Pending + m_PendingStart, chunk);
+	  m_PendingStart += chunk;
+	}
+      else if ( m_BlocksLeft > 0 )
+	{
+	  if ( buf_len < CBC_BLOCK_SIZE )
+	    {
+	      // stage a block for a small read
+	      result = DecryptBlocks(m_Pending, CBC_BLOCK_SIZE);
+	      m_PendingStart = 0;
+	      m_PendingEnd = CBC_BLOCK_SIZE;
+	      m_BlocksLeft -= CBC_BLOCK_SIZE;
+	      continue;
+	    }
+
+	  chunk = Kumu::xmin(buf_len - ( buf_len % CBC_BLOCK_SIZE ), m_BlocksLeft);
+	  result = DecryptBlocks(buf, chunk);
+	  m_BlocksLeft -= chunk;
+	}
+      else
+	{
+	  assert(! m_LastBlockRead);
+	  result = ReadLastBlock();
+	  continue;
+	}
+
+      buf += chunk;
+      buf_len -= chunk;
+      read_count += chunk;
+      m_Remaining -= chunk;
+    }
+
+  return result;
+}
+
+// The unencrypted prefix and whole ciphertext blocks are skipped with a seek; the
+// ciphertext block before the first one still to be read becomes the IV.
+Result_t
+ASDCP::EKLVPacketReader::Skip(ui64_t count)
+{
+  if ( ! m_Open )
+    return RESULT_STATE;
+
+  if ( count > m_Remaining )
+    return RESULT_RANGE;
+
+  // the HMAC no longer covers the whole value
+  m_HMAC = 0;
+
+  if ( ! m_Decrypt )
+    {
+      m_Remaining -= count;
+      return m_File->Seek(count, Kumu::SP_POS);
+    }
+
+  Result_t result = RESULT_OK;
+  ui32_t chunk = (ui32_t)Kumu::xmin<ui64_t>(count, m_PlaintextLeft);
+
+  if ( chunk > 0 )
+    {
+      result = m_File->Seek(chunk, Kumu::SP_POS);
+      m_PlaintextLeft -= chunk;
+      m_Remaining -= chunk;
+      count -= chunk;
+    }
+
+  chunk = (ui32_t)Kumu::xmin<ui64_t>(count, m_PendingEnd - m_PendingStart);
+  m_PendingStart += chunk;
+  m_Remaining -= chunk;
+  count -= chunk;
+
+#ifdef HAVE_OPENSSL
+  chunk = (ui32_t)Kumu::xmin<ui64_t>(count - ( count % CBC_BLOCK_SIZE ), m_BlocksLeft);
+
+  if ( KM_SUCCESS(result) && chunk > 0 )
+    {
+      byte_t ivec[CBC_BLOCK_SIZE];
+      result = m_File->Seek(chunk - CBC_BLOCK_SIZE, Kumu::SP_POS);
+
+      if ( KM_SUCCESS(result) )
+	result = ReadAndHash(ivec, CBC_BLOCK_SIZE);
+
+      if ( KM_SUCCESS(result) )
+	result = m_Ctx->SetIVec(ivec);
+
+      m_BlocksLeft -= chunk;
+      m_Remaining -= chunk;
+      count -= chunk;
+    }
+#endif //HAVE_OPENSSL
+
+  // what is left lies within a block and is decrypted and dropped
+  while ( KM_SUCCESS(result) && count > 0 )
+    {
+      byte_t tmp_buf[CBC_BLOCK_SIZE];
+      ui32_t read_count = 0;
+      result = Read(tmp_buf, (ui32_t)Kumu::xmin<ui64_t>(count, CBC_BLOCK_SIZE), read_count);
+
+      if ( KM_SUCCESS(result) && read_count == 0 )
+	result = RESULT_READFAIL;
+
+      count -= read_count;
+    }
+
+  return result;
+}
+
+//
+Result_t
+ASDCP::EKLVPacketReader::End()
+{
+  if ( ! m_Open )
+    return RESULT_STATE;
+
+  m_Open = false;
+
+  if ( m_HMAC == 0 )
+    return RESULT_OK;
+
+  if ( m_Remaining > 0 )
+    {
+      DefaultLogSink().Error("Cannot test the integrity pack, the packet has not been read.\n");
+      return RESULT_STATE;
+    }
+
+  Result_t result = RESULT_OK;
+
+#ifdef HAVE_OPENSSL
+  // the padding block is not read if the source ended on a block boundary
+  if ( ! m_LastBlockRead )
+    result = ReadLastBlock();
+
+  IntegrityPack IntPack;
+  ui32_t read_count = 0;
+
+  if ( KM_SUCCESS(result) )
+    result = m_File->Read(IntPack.Data, klv_intpack_size, &read_count);
+
+  if ( KM_SUCCESS(result) && read_count != klv_intpack_size )
+    result = RESULT_READFAIL;
+
+  if ( KM_SUCCESS(result) )
+    result = IntPack.TestValues(m_Info->AssetUUID, m_Sequence, m_HMAC);
+#endif //HAVE_OPENSSL
+
+  return result;
+}
+
 //
 // end h__Reader.cpp
 //
@@ -324,7 +324,7 @@ ASDCP::h__ASDCPWriter::WriteEKLVPacket(const ASDCP::FrameBuffer& FrameBuf,const
 {
   return Write_EKLV_Packet(m_File, *m_Dict, m_HeaderPart, m_Info, m_CtFrameBuf, m_FramesWritten,
 			   m_StreamOffset, FrameBuf, EssenceUL, MinEssenceElementBerLength,
-			   Ctx, HMAC);
+			   Ctx, HMAC, m_Stats);
 }
 
 // standard method of writing the header and footer of a completed MXF file
@@ -384,7 +384,7 @@ ASDCP::Write_EKLV_Packet(Kumu::FileWriter& File, const ASDCP::Dictionary& Dict,
 			 const ASDCP::WriterInfo& Info, ASDCP::FrameBuffer& CtFrameBuf, ui32_t& FramesWritten,
 			 ui64_t & StreamOffset, const ASDCP::FrameBuffer& FrameBuf, const byte_t* EssenceUL,
 			 const ui32_t& MinEssenceElementBerLength,
-			 AESEncContext* Ctx, HMACContext* HMAC)
+			 AESEncContext* Ctx, HMACContext* HMAC, StageStats* Stats)
 {
   Result_t result = RESULT_OK;
   IntegrityPack IntPack;
@@ -400,6 +400,7 @@ ASDCP::Write_EKLV_Packet(Kumu::FileWriter& File, const ASDCP::Dictionary& Dict,
   // overwritten/get corrupted.
   byte_t hmoverhead[512];
   Kumu::MemIOWriter HMACOverhead(hmoverhead, 512);
+  ui64_t start_offset = StreamOffset;
 
   if ( FrameBuf.Size() == 0 )
     {
@@ -422,11 +423,17 @@ ASDCP::Write_EKLV_Packet(Kumu::FileWriter& File, const ASDCP::Dictionary& Dict,
 	return RESULT_LARGE_PTO;
 
       // encrypt the essence data (create encrypted source value)
+      StageTimer encrypt_timer(Stats, StageStats::STAGE_ENCRYPT);
       result = EncryptFrameBuffer(FrameBuf, CtFrameBuf, Ctx);
+      encrypt_timer.Stop(FrameBuf.Size());
 
       // create HMAC
       if ( ASDCP_SUCCESS(result) && Info.UsesHMAC )
-      	result = IntPack.CalcValues(CtFrameBuf, Info.AssetUUID, FramesWritten + 1, HMAC);
+	{
+	  StageTimer hmac_timer(Stats, StageStats::STAGE_HMAC);
+	  result = IntPack.CalcValues(CtFrameBuf, Info.AssetUUID, FramesWritten + 1, HMAC);
+	  hmac_timer.Stop(CtFrameBuf.Size());
+	}
 
       if ( ASDCP_SUCCESS(result) )
 	{ // write UL
@@ -526,8 +533,336 @@ ASDCP::Write_EKLV_Packet(Kumu::FileWriter& File, const ASDCP::Dictionary& Dict,
 	StreamOffset += Overhead.Length() + FrameBuf.Size();
     }
 
+  // the packet is written here, the calls above only gather the buffers
+  if ( ASDCP_SUCCESS(result) )
+    {
+      StageTimer write_timer(Stats, StageStats::STAGE_FILE_WRITE);
+      result = File.Writev();
+
+      if ( ASDCP_SUCCESS(result) )
+	write_timer.Stop(StreamOffset - start_offset);
+    }
+
+  return result;
+}
+
+//------------------------------------------------------------------------------------------
+//
+
+// encrypted essence is staged through a buffer of this size
+static const ui32_t EKLVStreamChunkSize = 64 * Kumu::Kilobyte;
+
+//
+ASDCP::EKLVPacketWriter::EKLVPacketWriter() :
+  m_File(0), m_Info(0), m_Ctx(0), m_HMAC(0), m_Sequence(0), m_SourceLength(0),
+  m_PlaintextOffset(0), m_Appended(0), m_BytesWritten(0), m_CarryLength(0), m_Open(false)
+{
+  memset(m_Carry, 0, CBC_BLOCK_SIZE);
+}
+
+//
+Result_t
+ASDCP::EKLVPacketWriter::Begin(Kumu::FileWriter& File, const ASDCP::Dictionary& Dict, const ASDCP::WriterInfo& Info,
+			       const byte_t* EssenceUL, ui32_t source_length, ui32_t plaintext_offset,
+			       ui32_t sequence, AESEncContext* Ctx, HMACContext* HMAC)
+{
+  ASDCP_TEST_NULL(EssenceUL);
+
+  if ( m_Open )
+    return RESULT_STATE;
+
+  if ( source_length == 0 )
+    {
+      DefaultLogSink().Error("Cannot write empty frame buffer\n");
+      return RESULT_EMPTY_FB;
+    }
+
+  byte_t overhead[128];
+  Kumu::MemIOWriter Overhead(overhead, 128);
+  Result_t result = RESULT_OK;
+
+  if ( Info.EncryptedEssence )
+    {
+#ifndef HAVE_OPENSSL
+      return RESULT_CRYPT_CTX;
+#else
+      if ( ! Ctx )
+	return RESULT_CRYPT_CTX;
+
+      if ( Info.UsesHMAC && ! HMAC )
+	return RESULT_HMAC_CTX;
+
+      if ( plaintext_offset > source_length )
+	return RESULT_LARGE_PTO;
+
+      // same layout as Write_EKLV_Packet()
+      ui32_t esv_length = calc_esv_length(source_length, plaintext_offset);
+      ui32_t ETLength = klv_cryptinfo_size + esv_length;
+      ui32_t essence_element_BER_length = MXF_BER_LENGTH;
+
+      if ( Info.UsesHMAC )
+	ETLength += klv_intpack_size;
+      else
+	ETLength += (MXF_BER_LENGTH * 3); // for empty intpack
+
+      if ( ETLength > 0x00ffffff ) // Need BER integer longer than MXF_BER_LENGTH bytes
+	{
+	  essence_element_BER_length = Kumu::get_BER_length_for_value(ETLength);
+	  ETLength += essence_element_BER_length - MXF_BER_LENGTH;
+
+	  if ( essence_element_BER_length == 0 )
+	    return RESULT_KLV_CODING;
+	}
+
+      if ( ! ( Overhead.WriteRaw(Dict.ul(MDD_CryptEssence), SMPTE_UL_LENGTH)
+	       && Overhead.WriteBER(ETLength, essence_element_BER_length)
+	       && Overhead.WriteBER(UUIDlen, MXF_BER_LENGTH)
+	       && Overhead.WriteRaw(Info.ContextID, UUIDlen)
+	       && Overhead.WriteBER(sizeof(ui64_t), MXF_BER_LENGTH)
+	       && Overhead.WriteUi64BE(plaintext_offset)
+	       && Overhead.WriteBER(SMPTE_UL_LENGTH, MXF_BER_LENGTH)
+	       && Overhead.WriteRaw((byte_t*)EssenceUL, SMPTE_UL_LENGTH)
+	       && Overhead.WriteBER(sizeof(ui64_t), MXF_BER_LENGTH)
+	       && Overhead.WriteUi64BE(source_length)
+	       && Overhead.WriteBER(esv_length, essence_element_BER_length) ) )
+	{
+	  return RESULT_KLV_CODING;
+	}
+
+      // the ESV begins with the IV and the encrypted check value
+      byte_t esv_header[CBC_BLOCK_SIZE * 2];
+      result = Ctx->GetIVec(esv_header);
+
+      if ( ASDCP_SUCCESS(result) )
+	result = Ctx->EncryptBlock(ESV_CheckValue, esv_header + CBC_BLOCK_SIZE, CBC_BLOCK_SIZE);
+
+      if ( ASDCP_SUCCESS(result) )
+	result = File.Write(Overhead.Data(), Overhead.Length());
+
+      if ( ASDCP_SUCCESS(result) )
+	{
+	  m_BytesWritten = Overhead.Length();
+
+	  if ( Info.UsesHMAC )
+	    HMAC->Reset();
+
+	  m_File = &File;
+	  m_Info = &Info;
+	  m_HMAC = Info.UsesHMAC ? HMAC : 0;
+	  result = WriteESV(esv_header, CBC_BLOCK_SIZE * 2);
+	}
+#endif //HAVE_OPENSSL
+    }
+  else
+    {
+      ui32_t essence_element_BER_length = MXF_BER_LENGTH;
+
+      if ( source_length > 0x00ffffff ) // Need BER integer longer than MXF_BER_LENGTH bytes
+	{
+	  essence_element_BER_length = Kumu::get_BER_length_for_value(source_length);
+
+	  if ( essence_element_BER_length == 0 )
+	    return RESULT_KLV_CODING;
+	}
+
+      Overhead.WriteRaw((byte_t*)EssenceUL, SMPTE_UL_LENGTH);
+      Overhead.WriteBER(source_length, essence_element_BER_length);
+      result = File.Write(Overhead.Data(), Overhead.Length());
+      m_BytesWritten = Overhead.Length();
+      m_HMAC = 0;
+    }
+
+  if ( ASDCP_SUCCESS(result) )
+    {
+      m_File = &File;
+      m_Info = &Info;
+      m_Ctx = Info.EncryptedEssence ? Ctx : 0;
+      m_Sequence = sequence;
+      m_SourceLength = source_length;
+      m_PlaintextOffset = plaintext_offset;
+      m_Appended = 0;
+      m_CarryLength = 0;
+      m_Open = true;
+    }
+
+  return result;
+}
+
+// writes part of the encrypted source value, adding it to the HMAC
+Result_t
+ASDCP::EKLVPacketWriter::WriteESV(const byte_t* buf, ui32_t buf_len)
+{
+  Result_t result = m_File->Write(buf, buf_len);
+
   if ( ASDCP_SUCCESS(result) )
-    result = File.Writev();
+    {
+      m_BytesWritten += buf_len;
+
+      if ( m_HMAC != 0 )
+	result = m_HMAC->Update(buf, buf_len);
+    }
+
+  return result;
+}
+
+// encrypts and writes whole blocks
+Result_t
+ASDCP::EKLVPacketWriter::EncryptAndWrite(const byte_t* buf, ui32_t buf_len)
+{
+  assert(buf_len % CBC_BLOCK_SIZE == 0);
+  Result_t result = RESULT_OK;
+
+#ifdef HAVE_OPENSSL
+  if ( m_Scratch.Capacity() < EKLVStreamChunkSize )
+    result = m_Scratch.Capacity(EKLVStreamChunkSize);
+
+  while ( ASDCP_SUCCESS(result) && buf_len > 0 )
+    {
+      ui32_t chunk = Kumu::xmin(buf_len, EKLVStreamChunkSize);
+      result = m_Ctx->EncryptBlock(buf, m_Scratch.Data(), chunk);
+
+      if ( ASDCP_SUCCESS(result) )
+	result = WriteESV(m_Scratch.RoData(), chunk);
+
+      buf += chunk;
+      buf_len -= chunk;
+    }
+#endif //HAVE_OPENSSL
+
+  return result;
+}
+
+//
+Result_t
+ASDCP::EKLVPacketWriter::Append(const byte_t* buf, ui32_t buf_len)
+{
+  ASDCP_TEST_NULL(buf);
+
+  if ( ! m_Open )
+    return RESULT_STATE;
+
+  if ( buf_len > m_SourceLength - m_Appended )
+    {
+      DefaultLogSink().Error("Packet data exceeds the declared length of %u bytes.\n", m_SourceLength);
+      return RESULT_RANGE;
+    }
+
+  Result_t result = RESULT_OK;
+
+  if ( m_Ctx == 0 )
+    {
+      result = m_File->Write(buf, buf_len);
+
+      if ( ASDCP_SUCCESS(result) )
+	{
+	  m_BytesWritten += buf_len;
+	  m_Appended += buf_len;
+	}
+
+      return result;
+    }
+
+  // the plaintext region is stored as-is
+  if ( m_Appended < m_PlaintextOffset )
+    {
+      ui32_t plain_len = Kumu::xmin(buf_len, m_PlaintextOffset - m_Appended);
+      result = WriteESV(buf, plain_len);
+      buf += plain_len;
+      buf_len -= plain_len;
+      m_Appended += plain_len;
+    }
+
+  // complete a block left over from the previous call
+  if ( ASDCP_SUCCESS(result) && m_CarryLength > 0 && buf_len > 0 )
+    {
+      ui32_t fill_len = Kumu::xmin(buf_len, CBC_BLOCK_SIZE - m_CarryLength);
+      memcpy(m_Carry + m_CarryLength, buf, fill_len);
+      m_CarryLength += fill_len;
+      buf += fill_len;
+      buf_len -= fill_len;
+      m_Appended += fill_len;
+
+      if ( m_CarryLength == CBC_BLOCK_SIZE )
+	{
+	  result = EncryptAndWrite(m_Carry, CBC_BLOCK_SIZE);
+	  m_CarryLength = 0;
+	}
+    }
+
+  if ( ASDCP_SUCCESS(result) && buf_len > 0 )
+    {
+      ui32_t diff = buf_len % CBC_BLOCK_SIZE;
+      result = EncryptAndWrite(buf, buf_len - diff);
+
+      if ( ASDCP_SUCCESS(result) && diff > 0 )
+	{
+	  memcpy(m_Carry, buf + buf_len - diff, diff);
+	  m_CarryLength = diff;
+	}
+
+      m_Appended += buf_len;
+    }
+
+  return result;
+}
+
+//
+Result_t
+ASDCP::EKLVPacketWriter::End()
+{
+  if ( ! m_Open )
+    return RESULT_STATE;
+
+  m_Open = false;
+
+  if ( m_Appended != m_SourceLength )
+    {
+      DefaultLogSink().Error("Packet is incomplete: %u of %u bytes written.\n", m_Appended, m_SourceLength);
+      return RESULT_STATE;
+    }
+
+  Result_t result = RESULT_OK;
+
+#ifdef HAVE_OPENSSL
+  if ( m_Ctx != 0 )
+    {
+      // construct and encrypt the padding
+      byte_t the_last_block[CBC_BLOCK_SIZE];
+      ui32_t diff = m_CarryLength;
+      memcpy(the_last_block, m_Carry, diff);
+
+      for (ui32_t i = 0; diff < CBC_BLOCK_SIZE; diff++, i++ )
+	the_last_block[diff] = i;
+
+      result = EncryptAndWrite(the_last_block, CBC_BLOCK_SIZE);
+
+      if ( ASDCP_SUCCESS(result) )
+	{
+	  IntegrityPack IntPack;
+
+	  if ( m_HMAC != 0 )
+	    {
+	      result = IntPack.CalcValues(m_Info->AssetUUID, m_Sequence, m_HMAC);
+
+	      if ( ASDCP_SUCCESS(result) )
+		result = m_File->Write(IntPack.Data, klv_intpack_size);
+
+	      m_BytesWritten += klv_intpack_size;
+	    }
+	  else
+	    { // we still need the var-pack length values if the intpack is empty
+	      byte_t hmoverhead[MXF_BER_LENGTH * 3];
+	      Kumu::MemIOWriter HMACOverhead(hmoverhead, MXF_BER_LENGTH * 3);
+
+	      for ( ui32_t i = 0; i < 3 ; i++ )
+		HMACOverhead.WriteBER(0, MXF_BER_LENGTH);
+
+	      result = m_File->Write(HMACOverhead.Data(), HMACOverhead.Length());
+	      m_BytesWritten += HMACOverhead.Length();
+	    }
+	}
+    }
+#endif //HAVE_OPENSSL
 
   return result;
 }
@@ -77,10 +77,11 @@ usage(FILE* stream = stderr)
   fprintf(stream, "\
 USAGE: %s [-h|-help] [-V]\n\
 \n\
-       %s [-r] [-v] <filename> [...]\n\
+       %s [-i] [-r] [-v] <filename> [...]\n\
 \n\
   -V           - Show version\n\
   -h           - Show help\n\
+  -i           - Show the tile-part and packet length index\n\
   -r           - Show raw data\n\
   -v           - Print extra detail\n\
 \n\
@@ -100,12 +101,13 @@ public:
   bool   version_flag;   // true if the version display option was selected
   bool   verbose_flag;   // true if the verbose option was selected
   bool   detail_flag;   // true if the version display option was selected
+  bool   index_flag;     // true if the index display option was selected
   bool   help_flag;      // true if the help display option was selected
   std::list<std::string> filename_list;
 
   CommandOptions(int argc, const char** argv) :
     error_flag(true), version_flag(false), verbose_flag(false),
-    detail_flag(false), help_flag(false)
+    detail_flag(false), index_flag(false), help_flag(false)
   {
     for ( int i = 1; i < argc; i++ )
       {
@@ -115,6 +117,7 @@ public:
 	      {
 	      case 'V': version_flag = true; break;
 	      case 'h': help_flag = true; break;
+	      case 'i': index_flag = true; break;
 	      case 'r': detail_flag = true; break;
 	      case 'v': verbose_flag = true; break;
 
@@ -284,6 +287,15 @@ main(int argc, const char** argv)
 		}
 	    }
 	  */
+
+	  if ( Options.index_flag )
+	    {
+	      CodestreamIndex index;
+	      result = index.Build(frame_buffer);
+
+	      if ( ASDCP_SUCCESS(result) )
+		index.Dump(stdout);
+	    }
 	}
 
       if ( marker_count == 0 )